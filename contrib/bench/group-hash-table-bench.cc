@@ -0,0 +1,120 @@
+/* Lookup benchmark for group_hash_table.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* Time the same insertions and lookups of present and absent keys on a
+   hash_table and on a group_hash_table, with scattered keys, for which
+   group_hash_table is meant, and with dense integer keys, which
+   hash_table lays out sequentially.  The sizes to run, in keys, can be
+   given on the command line.
+
+   Build it against a configured and built GCC tree OBJDIR, with the
+   generator support objects, for instance:
+
+     g++ -O2 -DGENERATOR_FILE -I$OBJDIR/gcc -I$SRCDIR/gcc \
+       -I$SRCDIR/include -I$SRCDIR/libcpp/include \
+       $SRCDIR/contrib/bench/group-hash-table-bench.cc \
+       $OBJDIR/gcc/build/{hash-table,vec,ggc-none,errors,sort}.o \
+       $OBJDIR/libiberty/libiberty.a -o group-hash-table-bench  */
+
+#include "bconfig.h"
+#include "system.h"
+#include "coretypes.h"
+#include "hash-table.h"
+#include "group-hash-table.h"
+
+/* Descriptor for integers hashed like scattered string hashes.  */
+
+struct scattered_int_hash : int_hash <int, 0, 1>
+{
+  static hashval_t hash (int i) { return (hashval_t) i * 0x9e3779b1; }
+};
+
+/* Insert N keys into a TABLE hashed by HASHER, then look up each of them
+   and as many absent keys four times.  Add the number of keys found to
+   *FOUND and return the time taken in seconds.  */
+
+template<typename Table, typename Hasher>
+static double
+time_int_lookups (unsigned n, unsigned *found)
+{
+  Table t (n);
+  long start = get_run_time ();
+
+  for (unsigned i = 0; i < n; i++)
+    {
+      int k = 2 + i;
+      *t.find_slot_with_hash (k, Hasher::hash (k), INSERT) = k;
+    }
+  for (unsigned r = 0; r < 4; r++)
+    for (unsigned i = 0; i < 2 * n; i++)
+      {
+	int k = 2 + i;
+	if (t.find_with_hash (k, Hasher::hash (k)))
+	  (*found)++;
+      }
+  return (get_run_time () - start) / 1e6;
+}
+
+/* Run the lookup workload with N keys hashed by HASHER on a hash_table
+   and on a group_hash_table and print the times, labelled with NAME.
+   Return false if the tables do not agree.  */
+
+template<typename Hasher>
+static bool
+time_group_hash_table (const char *name, unsigned n)
+{
+  unsigned hfound = 0, gfound = 0;
+  double htime = time_int_lookups<hash_table<Hasher>, Hasher> (n, &hfound);
+  double gtime
+    = time_int_lookups<group_hash_table<Hasher>, Hasher> (n, &gfound);
+
+  printf ("%s keys, %u elements: hash_table %.3fs, "
+	  "group_hash_table %.3fs\n", name, n, htime, gtime);
+  return hfound == 4 * n && gfound == hfound;
+}
+
+int
+main (int argc, char **argv)
+{
+  static const unsigned sizes[] = { 10000, 100000, 1000000, 2000000 };
+  bool ok = true;
+
+  if (argc > 1)
+    for (int i = 1; i < argc; i++)
+      {
+	unsigned n = atoi (argv[i]);
+	ok &= time_group_hash_table<scattered_int_hash> ("scattered", n);
+	ok &= time_group_hash_table<int_hash <int, 0, 1> > ("dense", n);
+      }
+  else
+    for (unsigned i = 0; i < ARRAY_SIZE (sizes); i++)
+      {
+	ok &= time_group_hash_table<scattered_int_hash> ("scattered",
+							 sizes[i]);
+	ok &= time_group_hash_table<int_hash <int, 0, 1> > ("dense",
+							    sizes[i]);
+      }
+
+  if (!ok)
+    {
+      fprintf (stderr, "group_hash_table and hash_table disagree\n");
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,179 @@
+/* Benchmark for skipping conditional blocks in libcpp.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* Preprocess a file with a block skipped by #if 0 that mixes code,
+   comments, literals, nested conditionals and directives, followed by
+   one token, and time how long getting to that token takes.  The
+   numbers of skipped lines to run can be given on the command line.
+
+   Build it against a configured and built GCC tree OBJDIR, for
+   instance:
+
+     g++ -O2 -I$OBJDIR/libcpp -I$SRCDIR/libcpp -I$SRCDIR/include \
+       -I$SRCDIR/libcpp/include \
+       $SRCDIR/contrib/bench/lexer-skip-bench.cc \
+       $OBJDIR/libcpp/libcpp.a $OBJDIR/libiberty/libiberty.a \
+       -o lexer-skip-bench  */
+
+#include "config.h"
+#include "system.h"
+#include "cpplib.h"
+#include "line-map.h"
+
+/* libcpp expects its client to provide these.  */
+
+void
+fancy_abort (const char *file, int line, const char *function)
+{
+  fprintf (stderr, "internal error at %s:%d (%s)\n", file, line, function);
+  exit (2);
+}
+
+expanded_location
+linemap_client_expand_location_to_spelling_point (const line_maps *set,
+						  location_t loc,
+						  enum location_aspect)
+{
+  loc = linemap_resolve_location (set, loc, LRK_SPELLING_LOCATION, NULL);
+  return linemap_expand_location (set, linemap_lookup (set, loc), loc);
+}
+
+/* Report the preprocessor diagnostics, which the generated source is
+   not expected to have.  */
+
+static bool
+report_diagnostic (cpp_reader *, enum cpp_diagnostic_level,
+		   enum cpp_warning_reason, rich_location *,
+		   const char *msg, va_list *ap)
+{
+  vfprintf (stderr, msg, *ap);
+  fputc ('\n', stderr);
+  return true;
+}
+
+/* Write a file with NUM_LINES lines in a block skipped by #if 0,
+   followed by the token "found", and return its name.  */
+
+static char *
+write_skipped_block (unsigned num_lines)
+{
+  char *name = make_temp_file (".c");
+  FILE *f = fopen (name, "w");
+  if (!f)
+    {
+      perror (name);
+      exit (1);
+    }
+
+  fputs ("#if 0\n", f);
+  for (unsigned i = 0; i < num_lines; i++)
+    switch (i % 6)
+      {
+      case 0:
+	fprintf (f, "static int f%u (int x, const char *s);\n", i);
+	break;
+      case 1:
+	fprintf (f, "  /* Return X times %u.  */\n", i);
+	break;
+      case 2:
+	fprintf (f, "  return g (\"%%d: #%u\", '#') + x * %u; // #endif\n",
+		 i, i);
+	break;
+      case 3:
+	fprintf (f, "#define M%u(x) ((x) + %u)\n", i, i);
+	break;
+      case 4:
+	fprintf (f, "#ifdef M%u\n", i - 1);
+	break;
+      default:
+	fputs ("#endif\n", f);
+	break;
+      }
+  fputs ("#endif\nfound\n", f);
+
+  if (fclose (f))
+    {
+      perror (name);
+      exit (1);
+    }
+  return name;
+}
+
+/* Preprocess a file with NUM_LINES skipped lines, print the time taken
+   to get to the token after them, and return false if that token is
+   not the expected one.  */
+
+static bool
+time_skipped_block (unsigned num_lines)
+{
+  char *name = write_skipped_block (num_lines);
+
+  line_maps *line_table = XCNEW (line_maps);
+  /* GCC reserves location 1 for its built-in declarations.  */
+  linemap_init (line_table, 1);
+  line_table->m_reallocator = xrealloc;
+  line_table->m_round_alloc_size = [] (size_t size) { return size; };
+  line_table->default_range_bits = 5;
+  cpp_reader *parser = cpp_create_reader (CLK_GNUC99, NULL, line_table);
+  cpp_get_callbacks (parser)->diagnostic = report_diagnostic;
+  cpp_set_include_chains (parser, NULL, NULL, false);
+
+  bool ok = false;
+  if (cpp_read_main_file (parser, name))
+    {
+      location_t loc;
+      long start = get_run_time ();
+      const cpp_token *tok = cpp_get_token_with_location (parser, &loc);
+      double time = (get_run_time () - start) / 1e6;
+
+      expanded_location exploc = linemap_expand_location
+	(line_table, linemap_lookup (line_table, loc), loc);
+      ok = (tok->type == CPP_NAME
+	    && strcmp ((const char *) NODE_NAME (tok->val.node.node),
+		       "found") == 0
+	    && exploc.line == (int) num_lines + 3);
+      printf ("%u skipped lines: %.3fs\n", num_lines, time);
+    }
+
+  cpp_destroy (parser);
+  unlink (name);
+  free (name);
+  return ok;
+}
+
+int
+main (int argc, char **argv)
+{
+  static const unsigned sizes[] = { 10000, 100000, 1000000 };
+  bool ok = true;
+
+  if (argc > 1)
+    for (int i = 1; i < argc; i++)
+      ok &= time_skipped_block (atoi (argv[i]));
+  else
+    for (unsigned i = 0; i < ARRAY_SIZE (sizes); i++)
+      ok &= time_skipped_block (sizes[i]);
+
+  if (!ok)
+    {
+      fprintf (stderr, "the token after the skipped block is wrong\n");
+      return 1;
+    }
+  return 0;
+}
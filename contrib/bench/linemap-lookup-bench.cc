@@ -0,0 +1,202 @@
+/* Location lookup benchmark for the line maps of libcpp.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* Preprocess a translation unit that includes a number of generated
+   headers, each of which defines a macro that expands those of a few
+   headers before it, and record the locations of all of its tokens as
+   the front ends get them.  Then replay lookups of these locations the
+   way debug output and diagnostics do, in two interleaved streams: one
+   from the start of the translation unit and one from its middle.  The
+   numbers of headers to run can be given on the command line.
+
+   Build it against a configured and built GCC tree OBJDIR, for
+   instance:
+
+     g++ -O2 -I$OBJDIR/libcpp -I$SRCDIR/libcpp -I$SRCDIR/include \
+       -I$SRCDIR/libcpp/include \
+       $SRCDIR/contrib/bench/linemap-lookup-bench.cc \
+       $OBJDIR/libcpp/libcpp.a $OBJDIR/libiberty/libiberty.a \
+       -o linemap-lookup-bench  */
+
+#include "config.h"
+#include "system.h"
+#include "cpplib.h"
+#include "line-map.h"
+
+/* libcpp expects its client to provide these.  */
+
+void
+fancy_abort (const char *file, int line, const char *function)
+{
+  fprintf (stderr, "internal error at %s:%d (%s)\n", file, line, function);
+  exit (2);
+}
+
+expanded_location
+linemap_client_expand_location_to_spelling_point (const line_maps *set,
+						  location_t loc,
+						  enum location_aspect)
+{
+  loc = linemap_resolve_location (set, loc, LRK_SPELLING_LOCATION, NULL);
+  return linemap_expand_location (set, linemap_lookup (set, loc), loc);
+}
+
+/* Report the preprocessor diagnostics, which the generated sources are
+   not expected to have.  */
+
+static bool
+report_diagnostic (cpp_reader *, enum cpp_diagnostic_level,
+		   enum cpp_warning_reason, rich_location *,
+		   const char *msg, va_list *ap)
+{
+  vfprintf (stderr, msg, *ap);
+  fputc ('\n', stderr);
+  return true;
+}
+
+/* Write TEXT to a new temporary file with SUFFIX and return its name.  */
+
+static char *
+write_temp_file (const char *suffix, const char *text)
+{
+  char *name = make_temp_file (suffix);
+  FILE *f = fopen (name, "w");
+  if (!f || fputs (text, f) == EOF || fclose (f))
+    {
+      perror (name);
+      exit (1);
+    }
+  return name;
+}
+
+/* Preprocess a translation unit that includes NUM_HEADERS headers and
+   replay the lookups of its token locations REPS times.  Print the time
+   taken by the replays and return false if a lookup found another map
+   than the one found while preprocessing.  */
+
+static bool
+time_linemap_replay (unsigned num_headers, unsigned reps)
+{
+  char **headers = XNEWVEC (char *, num_headers);
+  char *content = xstrdup ("");
+
+  for (unsigned i = 0; i < num_headers; i++)
+    {
+      char *text;
+      if (i % 8 == 0)
+	text = xasprintf ("#define M%u(x) ((x) + %u)\n"
+			  "int v%u = M%u (%u);\n", i, i, i, i, i);
+      else
+	text = xasprintf ("#define M%u(x) (M%u (x) * M%u (%u))\n"
+			  "int v%u = M%u (v%u) + M%u (%u);\n",
+			  i, i - 1, i - 1, i, i, i, i - 1, i, i);
+      headers[i] = write_temp_file (".h", text);
+      free (text);
+
+      text = xasprintf ("#include \"%s\"\nint w%u = M%u (%u);\n",
+			headers[i], i, i, i);
+      content = reconcat (content, content, text, NULL);
+      free (text);
+    }
+  char *main_file = write_temp_file (".c", content);
+  free (content);
+
+  line_maps *line_table = XCNEW (line_maps);
+  /* GCC reserves location 1 for its built-in declarations.  */
+  linemap_init (line_table, 1);
+  line_table->m_reallocator = xrealloc;
+  line_table->m_round_alloc_size = [] (size_t size) { return size; };
+  line_table->default_range_bits = 5;
+  cpp_reader *parser = cpp_create_reader (CLK_GNUC99, NULL, line_table);
+  cpp_get_callbacks (parser)->diagnostic = report_diagnostic;
+  cpp_set_include_chains (parser, NULL, NULL, false);
+  if (!cpp_read_main_file (parser, main_file))
+    return false;
+
+  unsigned n = 0, alloc = 1024;
+  location_t *locs = XNEWVEC (location_t, alloc);
+  location_t *starts = XNEWVEC (location_t, alloc);
+  location_t loc;
+  const cpp_token *tok;
+  while ((tok = cpp_get_token_with_location (parser, &loc))->type
+	 != CPP_EOF)
+    if (tok->type != CPP_PADDING)
+      {
+	if (n == alloc)
+	  {
+	    alloc *= 2;
+	    locs = XRESIZEVEC (location_t, locs, alloc);
+	    starts = XRESIZEVEC (location_t, starts, alloc);
+	  }
+	locs[n] = loc;
+	starts[n] = MAP_START_LOCATION (linemap_lookup (line_table, loc));
+	n++;
+      }
+
+  unsigned found = 0;
+  long start = get_run_time ();
+  for (unsigned r = 0; r < reps; r++)
+    for (unsigned i = 0; i < n; i++)
+      {
+	unsigned k = (i & 1) ? n / 2 + i / 2 : i / 2;
+	const line_map_ordinary *map;
+	linemap_resolve_location (line_table, locs[k], LRK_SPELLING_LOCATION,
+				  &map);
+	found += (MAP_START_LOCATION (linemap_lookup (line_table, locs[k]))
+		  == starts[k]);
+      }
+  double time = (get_run_time () - start) / 1e6;
+
+  printf ("%u headers, %u macro maps, %u locations: %.3fs\n", num_headers,
+	  (unsigned) LINEMAPS_MACRO_USED (line_table), n, time);
+
+  cpp_destroy (parser);
+  for (unsigned i = 0; i < num_headers; i++)
+    {
+      unlink (headers[i]);
+      free (headers[i]);
+    }
+  free (headers);
+  unlink (main_file);
+  free (main_file);
+  free (locs);
+  free (starts);
+  return found == reps * n;
+}
+
+int
+main (int argc, char **argv)
+{
+  static const unsigned sizes[] = { 100, 1000, 4000 };
+  bool ok = true;
+
+  if (argc > 1)
+    for (int i = 1; i < argc; i++)
+      ok &= time_linemap_replay (atoi (argv[i]), 20);
+  else
+    for (unsigned i = 0; i < ARRAY_SIZE (sizes); i++)
+      ok &= time_linemap_replay (sizes[i], 20);
+
+  if (!ok)
+    {
+      fprintf (stderr, "a replayed lookup found the wrong map\n");
+      return 1;
+    }
+  return 0;
+}
@@ -31,6 +31,7 @@ mem_alloc_description<bitmap_usage> bitmap_mem_desc;
 bitmap_obstack bitmap_head::crashme;
 
 static bitmap_element *bitmap_tree_listify_from (bitmap, bitmap_element *);
+static inline int bitmap_element_zerop (const bitmap_element *);
 
 /* Register new bitmap.  */
 void
@@ -659,13 +660,631 @@ bitmap_tree_listify_from (bitmap head, bitmap_element *e)
   return e;
 }
 
-/* Convert bitmap HEAD from splay-tree view to linked-list view.  */
+/* Dense view of bitmaps.
+
+   In this representation, the elements of the bitmap are the slots of an
+   array that covers a range of indices, so the element for an index is
+   found in constant time and the elements of a dense set are adjacent in
+   memory.  The slots that have bits set are linked together as in the
+   linked-list view, with HEAD->first pointing to the first of them; the
+   other slots have all bits clear and are not linked.
+
+   The array starts with a header element whose INDX is the index of the
+   first slot, BITS[0] is the number of slots (a power of two) and BITS[1]
+   the number of linked slots.  Its PREV field points to the last linked
+   slot.  HEAD->current points to the header, or is NULL if no array has
+   been allocated yet.
+
+   When the array grows, or is replaced because the set became empty, the
+   old array is chained to the new one through the NEXT field of the
+   header and kept until the bitmap is cleared or copied into, so that an
+   iteration over the bitmap that is in progress can continue (it sees
+   the old contents of the set).  A bitmap that is copied into once per
+   block, like the live sets of the data flow problems, thus holds on to
+   the arrays superseded during one block only.  Likewise, converting the bitmap back to linked-list view
+   copies the linked slots to new elements and leaves the slots alone;
+   the arrays only go back to the freelists of the obstack.  */
+
+/* The minimum number of slots of an array, and the maximum ratio between
+   the number of indices covered by the elements of a set and the number
+   of elements for the set to stay in dense view.  */
+#define BITMAP_DENSE_MIN_SLOTS 8
+#define BITMAP_DENSE_SPARSITY 4
+
+/* Return true if a set of COUNT elements spanning NINDICES indices is
+   dense enough for the dense view.  */
+
+static inline bool
+bitmap_dense_fits_p (unsigned int nindices, unsigned int count)
+{
+  return (nindices <= BITMAP_DENSE_MIN_SLOTS
+	  || nindices / BITMAP_DENSE_SPARSITY <= count);
+}
+
+/* Return the slot for INDX of the dense bitmap HEAD, or NULL if INDX is
+   outside of its array.  */
+
+static inline bitmap_element *
+bitmap_dense_find_slot (const_bitmap head, unsigned int indx)
+{
+  bitmap_element *hdr = head->current;
+
+  if (!hdr)
+    return NULL;
+  unsigned int offset = indx - hdr->indx;
+  if (offset >= hdr->bits[0])
+    return NULL;
+  return hdr + 1 + offset;
+}
+
+/* Allocate an array of 2**LOG2_NSLOTS slots with clear bits for HEAD,
+   starting at index BASE.  Return its header.  */
+
+static bitmap_element *
+bitmap_dense_alloc (bitmap head, unsigned int base, unsigned int log2_nslots)
+{
+  bitmap_obstack *bit_obstack = head->obstack;
+  unsigned int nslots = 1u << log2_nslots;
+  bitmap_element *hdr;
+
+  gcc_checking_assert (log2_nslots < BITMAP_DENSE_CLASSES);
+  hdr = bit_obstack->dense_arrays[log2_nslots];
+  if (hdr)
+    bit_obstack->dense_arrays[log2_nslots] = hdr->next;
+  else
+    hdr = XOBNEWVEC (&bit_obstack->obstack, bitmap_element, nslots + 1);
+
+  if (GATHER_STATISTICS)
+    register_overhead (head, sizeof (bitmap_element) * (nslots + 1));
+
+  memset (hdr, 0, sizeof (bitmap_element) * (nslots + 1));
+  hdr->indx = base;
+  hdr->bits[0] = nslots;
+  for (unsigned int i = 1; i <= nslots; i++)
+    hdr[i].indx = base + i - 1;
+  return hdr;
+}
+
+/* Put the array with header HDR of HEAD and the arrays chained to it
+   on the freelists of the obstack of HEAD.  */
+
+static void
+bitmap_dense_free (bitmap head, bitmap_element *hdr)
+{
+  bitmap_obstack *bit_obstack = head->obstack;
+
+  while (hdr)
+    {
+      bitmap_element *next = hdr->next;
+      unsigned int log2_nslots = exact_log2 (hdr->bits[0]);
+
+      if (GATHER_STATISTICS)
+	release_overhead (head, sizeof (bitmap_element) * (hdr->bits[0] + 1),
+			  false);
+
+      hdr->next = bit_obstack->dense_arrays[log2_nslots];
+      bit_obstack->dense_arrays[log2_nslots] = hdr;
+      hdr = next;
+    }
+}
+
+/* Clear the dense bitmap HEAD, releasing its arrays.  */
+
+static void
+bitmap_dense_clear (bitmap head)
+{
+  bitmap_dense_free (head, head->current);
+  head->first = head->current = NULL;
+  head->indx = 0;
+}
+
+/* Convert the dense bitmap HEAD to linked-list view.  The linked slots
+   of its arrays are copied to new elements and the arrays are released.
+   This may happen in the middle of an operation that sets bits, while
+   an iteration over HEAD is in progress; as the slots are not modified,
+   the iteration can continue over the old contents of the set.  */
+
+static void
+bitmap_dense_listify (bitmap head)
+{
+  bitmap_element *hdr = head->current;
+  bitmap_element *slot = head->first;
+  bitmap_element *prev = NULL;
+
+  gcc_checking_assert (head->dense_form);
+  head->dense_form = false;
+  head->first = NULL;
+  for (; slot; slot = slot->next)
+    {
+      bitmap_element *elt = bitmap_element_allocate (head);
+      elt->indx = slot->indx;
+      memcpy (elt->bits, slot->bits, sizeof (elt->bits));
+      elt->prev = prev;
+      elt->next = NULL;
+      if (prev)
+	prev->next = elt;
+      else
+	head->first = elt;
+      prev = elt;
+    }
+  bitmap_dense_free (head, hdr);
+
+  head->current = head->first;
+  head->indx = head->first ? head->first->indx : 0;
+}
+
+/* Copy the elements of the list starting at ELT to the slots of the
+   empty array with header HDR, link them and return the first one.  */
+
+static bitmap_element *
+bitmap_dense_fill (bitmap_element *hdr, const bitmap_element *elt)
+{
+  bitmap_element *first = NULL;
+  bitmap_element *prev = NULL;
+  unsigned int count = 0;
+
+  for (; elt; elt = elt->next)
+    {
+      bitmap_element *slot = hdr + 1 + (elt->indx - hdr->indx);
+
+      memcpy (slot->bits, elt->bits, sizeof (slot->bits));
+      slot->prev = prev;
+      if (prev)
+	prev->next = slot;
+      else
+	first = slot;
+      prev = slot;
+      count++;
+    }
+
+  hdr->prev = prev;
+  hdr->bits[1] = count;
+  return first;
+}
+
+/* Return the number of slots to allocate for an array that covers
+   NINDICES indices, as a log2.  */
+
+static inline unsigned int
+bitmap_dense_log2_nslots (unsigned int nindices)
+{
+  return ceil_log2 (MAX (nindices, (unsigned int) BITMAP_DENSE_MIN_SLOTS));
+}
+
+/* Make the array of the dense bitmap HEAD cover the indices LO to HI,
+   which include those of its linked slots, for a set of COUNT elements.
+   Return false if such a set is too sparse for the dense view; HEAD has
+   then been converted to linked-list view.  */
+
+static bool
+bitmap_dense_cover (bitmap head, unsigned int lo, unsigned int hi,
+		    unsigned int count)
+{
+  bitmap_element *old_hdr = head->current;
+
+  if (old_hdr
+      && lo >= old_hdr->indx
+      && hi - old_hdr->indx < old_hdr->bits[0])
+    return true;
+
+  if (!bitmap_dense_fits_p (hi - lo + 1, count))
+    {
+      bitmap_dense_listify (head);
+      return false;
+    }
+
+  /* At least double the array, and leave the new room on the side the
+     set is growing to.  */
+  unsigned int log2_nslots = bitmap_dense_log2_nslots (hi - lo + 1);
+  if (old_hdr && (1u << log2_nslots) <= old_hdr->bits[0])
+    log2_nslots = exact_log2 (old_hdr->bits[0]) + 1;
+  unsigned int nslots = 1u << log2_nslots;
+  unsigned int base = lo;
+  if (old_hdr && lo < old_hdr->indx)
+    base = hi + 1 >= nslots ? hi + 1 - nslots : 0;
+
+  bitmap_element *hdr = bitmap_dense_alloc (head, base, log2_nslots);
+  head->first = bitmap_dense_fill (hdr, head->first);
+  hdr->next = old_hdr;
+  head->current = hdr;
+  return true;
+}
+
+/* Return the slot for INDX of the dense bitmap HEAD, growing its array if
+   needed.  Return NULL if the set would become too sparse for the dense
+   view; HEAD has then been converted to linked-list view.  */
+
+static bitmap_element *
+bitmap_dense_get_slot (bitmap head, unsigned int indx)
+{
+  bitmap_element *slot = bitmap_dense_find_slot (head, indx);
+
+  if (slot)
+    return slot;
+
+  bitmap_element *hdr = head->current;
+  unsigned int lo = indx;
+  unsigned int hi = indx;
+
+  /* An empty set has nothing to preserve; just start over with a new
+     array.  The old one is kept for iterations in progress.  */
+  if (hdr && !head->first)
+    {
+      bitmap_element *new_hdr
+	= bitmap_dense_alloc (head, indx, bitmap_dense_log2_nslots (1));
+      new_hdr->next = hdr;
+      head->current = new_hdr;
+      return bitmap_dense_find_slot (head, indx);
+    }
+
+  unsigned int count = hdr ? hdr->bits[1] : 0;
+  if (hdr)
+    {
+      lo = MIN (lo, head->first->indx);
+      hi = MAX (hi, hdr->prev->indx);
+    }
+  if (!bitmap_dense_cover (head, lo, hi, count + 1))
+    return NULL;
+  return bitmap_dense_find_slot (head, indx);
+}
+
+/* Make the array of the dense bitmap HEAD, which is not empty, cover the
+   elements of B, so that an operation storing into those slots cannot
+   fail halfway.  Return false if HEAD has been converted to linked-list
+   view instead.  */
+
+static bool
+bitmap_dense_reserve (bitmap head, const_bitmap b)
+{
+  bitmap_element *hdr = head->current;
+  const bitmap_element *elt = b->first;
+  unsigned int count = hdr->bits[1] + 1;
+
+  if (!elt)
+    return true;
+  unsigned int lo = MIN (elt->indx, head->first->indx);
+  for (; elt->next; elt = elt->next)
+    count++;
+  unsigned int hi = MAX (elt->indx, hdr->prev->indx);
+  return bitmap_dense_cover (head, lo, hi, count);
+}
+
+/* Link SLOT of the dense bitmap HEAD, which just got bits set, into the
+   list of elements.  HINT is NULL or a linked slot before SLOT, which
+   bounds the search for the element preceding SLOT.  */
+
+static void
+bitmap_dense_link (bitmap head, bitmap_element *slot, bitmap_element *hint)
+{
+  bitmap_element *hdr = head->current;
+  bitmap_element *prev = hdr->prev;
+
+  if (prev && prev->indx > slot->indx)
+    {
+      if (head->first->indx > slot->indx)
+	prev = NULL;
+      else
+	{
+	  bitmap_element *stop = hint ? hint : head->first;
+	  for (prev = slot - 1; prev != stop; prev--)
+	    if (!bitmap_element_zerop (prev))
+	      break;
+	}
+    }
+
+  slot->prev = prev;
+  if (prev)
+    {
+      slot->next = prev->next;
+      prev->next = slot;
+    }
+  else
+    {
+      slot->next = head->first;
+      head->first = slot;
+    }
+  if (slot->next)
+    slot->next->prev = slot;
+  else
+    hdr->prev = slot;
+  hdr->bits[1]++;
+}
+
+/* Unlink SLOT of the dense bitmap HEAD, which just got all bits clear,
+   from the list of elements.  The NEXT field of SLOT is left alone, so
+   that iterators positioned on SLOT can continue.  */
+
+static void
+bitmap_dense_unlink (bitmap head, bitmap_element *slot)
+{
+  bitmap_element *hdr = head->current;
+  bitmap_element *next = slot->next;
+  bitmap_element *prev = slot->prev;
+
+  if (prev)
+    prev->next = next;
+  else
+    head->first = next;
+  if (next)
+    next->prev = prev;
+  else
+    hdr->prev = prev;
+  hdr->bits[1]--;
+}
+
+/* Convert bitmap HEAD from linked-list view to dense view.  HEAD stays
+   in linked-list view if its elements are too sparse.  */
+
+void
+bitmap_dense_view (bitmap head)
+{
+  bitmap_element *last = NULL;
+  unsigned int count = 0;
+
+  gcc_assert (!head->tree_form && !head->dense_form);
+  gcc_checking_assert (head->obstack);
+
+  for (bitmap_element *elt = head->first; elt; elt = elt->next)
+    {
+      last = elt;
+      count++;
+    }
+  if (!last)
+    {
+      head->dense_form = true;
+      head->current = NULL;
+      head->indx = 0;
+      return;
+    }
+
+  unsigned int nindices = last->indx - head->first->indx + 1;
+  if (!bitmap_dense_fits_p (nindices, count))
+    return;
+
+  bitmap_element *hdr
+    = bitmap_dense_alloc (head, head->first->indx,
+			  bitmap_dense_log2_nslots (nindices));
+  bitmap_element *first = bitmap_dense_fill (hdr, head->first);
+  bitmap_elt_clear_from (head, head->first);
+  head->dense_form = true;
+  head->first = first;
+  head->current = hdr;
+}
+
+/* The logical operations on a bitmap in dense view are implemented by
+   bitmap_dense_apply.  For each of them, a class provides the result
+   word of the destination as a function of its old word D and of the
+   words A, B and C of the operands.  DRIVE says which of the destination
+   and the first two operands have to be walked to find the elements that
+   may change: at the indices where all of these have no element, the
+   destination must be left unchanged.  */
+
+#define BITMAP_DENSE_DRIVE_DST 1
+#define BITMAP_DENSE_DRIVE_A 2
+#define BITMAP_DENSE_DRIVE_B 4
+
+#define BITMAP_DENSE_OP(NAME, DRIVE, EXPR)				\
+  struct bitmap_dense_##NAME						\
+  {									\
+    static const int drive = (DRIVE);					\
+    static inline BITMAP_WORD						\
+    apply (BITMAP_WORD d ATTRIBUTE_UNUSED, BITMAP_WORD a ATTRIBUTE_UNUSED, \
+	   BITMAP_WORD b ATTRIBUTE_UNUSED, BITMAP_WORD c ATTRIBUTE_UNUSED) \
+    {									\
+      return (EXPR);							\
+    }									\
+  }
+
+BITMAP_DENSE_OP (copy, BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A, a);
+BITMAP_DENSE_OP (and, BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A, a & b);
+BITMAP_DENSE_OP (and_into, BITMAP_DENSE_DRIVE_DST, d & a);
+BITMAP_DENSE_OP (and_compl, BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A,
+		 a & ~b);
+BITMAP_DENSE_OP (and_compl_into, BITMAP_DENSE_DRIVE_A, d & ~a);
+BITMAP_DENSE_OP (compl_and_into, BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A,
+		 ~d & a);
+BITMAP_DENSE_OP (ior, (BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A
+		       | BITMAP_DENSE_DRIVE_B), a | b);
+BITMAP_DENSE_OP (ior_into, BITMAP_DENSE_DRIVE_A, d | a);
+BITMAP_DENSE_OP (xor, (BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A
+		       | BITMAP_DENSE_DRIVE_B), a ^ b);
+BITMAP_DENSE_OP (xor_into, BITMAP_DENSE_DRIVE_A, d ^ a);
+BITMAP_DENSE_OP (ior_and_compl, (BITMAP_DENSE_DRIVE_DST | BITMAP_DENSE_DRIVE_A
+				 | BITMAP_DENSE_DRIVE_B), a | (b & ~c));
+BITMAP_DENSE_OP (ior_and_compl_into, BITMAP_DENSE_DRIVE_A, d | (a & ~b));
+BITMAP_DENSE_OP (ior_and_into, BITMAP_DENSE_DRIVE_A, d | (a & b));
+
+/* Compute DST = OP (DST, A, B, C) for the bitmap DST in dense view, where
+   the operands OP does not use may be NULL.  Set *CHANGED if DST changes.
+   The operands may be DST itself.  Return false if DST became too sparse
+   for the dense view before the operation was complete; DST is then in
+   linked-list view and the caller has to redo the operation, which is
+   only possible if applying OP twice gives the same result.  Otherwise
+   the caller uses bitmap_dense_reserve first, so that this cannot
+   happen.  */
+
+template<typename OP>
+static bool
+bitmap_dense_apply (bitmap dst, const_bitmap a, const_bitmap b,
+		    const_bitmap c, bool *changed)
+{
+  const bitmap_element *dst_elt
+    = (OP::drive & BITMAP_DENSE_DRIVE_DST) ? dst->first : NULL;
+  const bitmap_element *a_elt = a ? a->first : NULL;
+  const bitmap_element *b_elt = b ? b->first : NULL;
+  const bitmap_element *c_elt = c ? c->first : NULL;
+  const BITMAP_WORD *zero = bitmap_zero_bits.bits;
+  bitmap_element *hint = NULL;
+
+  gcc_checking_assert (dst->dense_form
+		       && (!a || !a->tree_form)
+		       && (!b || !b->tree_form)
+		       && (!c || !c->tree_form));
+
+  while (1)
+    {
+      unsigned int indx = -1U;
+      if (dst_elt)
+	indx = dst_elt->indx;
+      if ((OP::drive & BITMAP_DENSE_DRIVE_A) && a_elt && a_elt->indx < indx)
+	indx = a_elt->indx;
+      if ((OP::drive & BITMAP_DENSE_DRIVE_B) && b_elt && b_elt->indx < indx)
+	indx = b_elt->indx;
+      if (indx == -1U)
+	break;
+
+      while (a_elt && a_elt->indx < indx)
+	a_elt = a_elt->next;
+      while (b_elt && b_elt->indx < indx)
+	b_elt = b_elt->next;
+      while (c_elt && c_elt->indx < indx)
+	c_elt = c_elt->next;
+      const BITMAP_WORD *a_bits
+	= a_elt && a_elt->indx == indx ? a_elt->bits : zero;
+      const BITMAP_WORD *b_bits
+	= b_elt && b_elt->indx == indx ? b_elt->bits : zero;
+      const BITMAP_WORD *c_bits
+	= c_elt && c_elt->indx == indx ? c_elt->bits : zero;
+
+      bitmap_element *slot = bitmap_dense_find_slot (dst, indx);
+      const BITMAP_WORD *d_bits = slot ? slot->bits : zero;
+      BITMAP_WORD r[BITMAP_ELEMENT_WORDS];
+      BITMAP_WORD old_ior = 0, ior = 0, diff = 0;
+      unsigned ix;
+
+      for (ix = 0; ix < BITMAP_ELEMENT_WORDS; ix++)
+	{
+	  r[ix] = OP::apply (d_bits[ix], a_bits[ix], b_bits[ix], c_bits[ix]);
+	  old_ior |= d_bits[ix];
+	  ior |= r[ix];
+	  diff |= r[ix] ^ d_bits[ix];
+	}
+
+      if (dst_elt && dst_elt->indx == indx)
+	dst_elt = dst_elt->next;
+      if (a_bits != zero)
+	a_elt = a_elt->next;
+      if (b_bits != zero)
+	b_elt = b_elt->next;
+
+      if (diff)
+	{
+	  *changed = true;
+	  if (!slot)
+	    {
+	      slot = bitmap_dense_get_slot (dst, indx);
+	      if (!slot)
+		return false;
+	      /* The array may have been reallocated.  */
+	      if (dst_elt)
+		dst_elt = bitmap_dense_find_slot (dst, dst_elt->indx);
+	      if (hint)
+		hint = bitmap_dense_find_slot (dst, hint->indx);
+	    }
+	  memcpy (slot->bits, r, sizeof (slot->bits));
+	  if (!ior)
+	    bitmap_dense_unlink (dst, slot);
+	  else if (!old_ior)
+	    bitmap_dense_link (dst, slot, hint);
+	}
+      if (ior)
+	hint = slot;
+    }
+
+  return true;
+}
+
+/* Return the mask of the bits in [START, END) of the bitmap word that
+   starts at bit LO.  */
+
+static inline BITMAP_WORD
+bitmap_range_word_mask (unsigned int lo, unsigned int start, unsigned int end)
+{
+  BITMAP_WORD mask = ~(BITMAP_WORD) 0;
+
+  if (end <= lo || start >= lo + BITMAP_WORD_BITS)
+    return 0;
+  if (start > lo)
+    mask <<= start - lo;
+  if (end < lo + BITMAP_WORD_BITS)
+    mask &= (((BITMAP_WORD) 1) << (end - lo)) - 1;
+  return mask;
+}
+
+/* Set (if SET) or clear the COUNT bits from START in the dense bitmap
+   HEAD.  Return false if HEAD became too sparse for the dense view before
+   all bits were set; HEAD is then in linked-list view.  */
+
+static bool
+bitmap_dense_set_range (bitmap head, unsigned int start, unsigned int count,
+			bool set)
+{
+  unsigned int end = start + count;
+  unsigned int first_index = start / BITMAP_ELEMENT_ALL_BITS;
+  unsigned int last_index = (end - 1) / BITMAP_ELEMENT_ALL_BITS;
+
+  /* When clearing, only the slots of the array matter.  */
+  if (!set)
+    {
+      bitmap_element *hdr = head->current;
+      if (!hdr)
+	return true;
+      first_index = MAX (first_index, hdr->indx);
+      last_index = MIN (last_index,
+			hdr->indx + (unsigned int) hdr->bits[0] - 1);
+    }
+
+  for (unsigned int indx = first_index; indx <= last_index; indx++)
+    {
+      bitmap_element *slot;
+      if (set)
+	{
+	  slot = bitmap_dense_get_slot (head, indx);
+	  if (!slot)
+	    return false;
+	}
+      else
+	{
+	  slot = bitmap_dense_find_slot (head, indx);
+	  if (!slot)
+	    continue;
+	}
+
+      BITMAP_WORD old_ior = 0, ior = 0;
+      for (unsigned ix = 0; ix < BITMAP_ELEMENT_WORDS; ix++)
+	{
+	  unsigned int lo
+	    = (indx * BITMAP_ELEMENT_WORDS + ix) * BITMAP_WORD_BITS;
+	  BITMAP_WORD mask = bitmap_range_word_mask (lo, start, end);
+
+	  old_ior |= slot->bits[ix];
+	  if (set)
+	    slot->bits[ix] |= mask;
+	  else
+	    slot->bits[ix] &= ~mask;
+	  ior |= slot->bits[ix];
+	}
+      if (ior && !old_ior)
+	bitmap_dense_link (head, slot, NULL);
+      else if (!ior && old_ior)
+	bitmap_dense_unlink (head, slot);
+    }
+  return true;
+}
+
+/* Convert bitmap HEAD from splay-tree or dense view to linked-list view.  */
 
 void
 bitmap_list_view (bitmap head)
 {
   bitmap_element *ptr;
 
+  if (head->dense_form)
+    {
+      bitmap_dense_listify (head);
+      return;
+    }
+
   gcc_assert (head->tree_form);
 
   ptr = head->first;
@@ -685,7 +1304,7 @@ bitmap_list_view (bitmap head)
     }
 }
 
-/* Convert bitmap HEAD from linked-list view to splay-tree view.
+/* Convert bitmap HEAD from linked-list or dense view to splay-tree view.
    This is simply a matter of dropping the prev or next pointers
    and setting the tree_form flag.  The tree will balance itself
    if and when it is used.  */
@@ -695,6 +1314,8 @@ bitmap_tree_view (bitmap head)
 {
   bitmap_element *ptr;
 
+  if (head->dense_form)
+    bitmap_dense_listify (head);
   gcc_assert (! head->tree_form);
 
   ptr = head->first;
@@ -712,6 +1333,11 @@ bitmap_tree_view (bitmap head)
 void
 bitmap_clear (bitmap head)
 {
+  if (head->dense_form)
+    {
+      bitmap_dense_clear (head);
+      return;
+    }
   if (head->first == NULL)
     return;
   if (head->tree_form)
@@ -745,6 +1371,7 @@ bitmap_obstack_initialize (bitmap_obstack *bit_obstack)
 
   bit_obstack->elements = NULL;
   bit_obstack->heads = NULL;
+  memset (bit_obstack->dense_arrays, 0, sizeof (bit_obstack->dense_arrays));
   obstack_specify_allocation (&bit_obstack->obstack, OBSTACK_CHUNK_SIZE,
 			      __alignof__ (bitmap_element),
 			      obstack_chunk_alloc,
@@ -769,6 +1396,7 @@ bitmap_obstack_release (bitmap_obstack *bit_obstack)
 
   bit_obstack->elements = NULL;
   bit_obstack->heads = NULL;
+  memset (bit_obstack->dense_arrays, 0, sizeof (bit_obstack->dense_arrays));
   obstack_free (&bit_obstack->obstack, NULL);
 }
 
@@ -860,6 +1488,23 @@ bitmap_copy (bitmap to, const_bitmap from)
 
   gcc_checking_assert (!to->tree_form && !from->tree_form);
 
+  if (to->dense_form)
+    {
+      bool changed = false;
+      if (bitmap_dense_apply<bitmap_dense_copy> (to, from, NULL, NULL,
+						 &changed))
+	{
+	  /* As for bitmap_clear, no iteration over TO can continue across
+	     the copy, so the arrays it superseded can go.  */
+	  if (to->current)
+	    {
+	      bitmap_dense_free (to, to->current->next);
+	      to->current->next = NULL;
+	    }
+	  return;
+	}
+    }
+
   bitmap_clear (to);
 
   /* Copy elements in forward direction one at a time.  */
@@ -902,15 +1547,26 @@ bitmap_move (bitmap to, bitmap from)
   size_t sz = 0;
   if (GATHER_STATISTICS)
     {
-      for (bitmap_element *e = to->first; e; e = e->next)
-	sz += sizeof (bitmap_element);
+      if (from->dense_form)
+	for (bitmap_element *hdr = from->current; hdr; hdr = hdr->next)
+	  sz += sizeof (bitmap_element) * (hdr->bits[0] + 1);
+      else
+	for (bitmap_element *e = from->first; e; e = e->next)
+	  sz += sizeof (bitmap_element);
       register_overhead (to, sz);
     }
 
+  unsigned alloc_descriptor = to->alloc_descriptor;
   *to = *from;
+  to->alloc_descriptor = alloc_descriptor;
 
   if (GATHER_STATISTICS)
     release_overhead (from, sz, false);
+
+  /* FROM no longer owns the elements or the arrays; leave it empty, so
+     that clearing it does not release them.  */
+  from->first = from->current = NULL;
+  from->indx = 0;
 }
 
 /* Clear a single bit in a bitmap.  Return true if the bit changed.  */
@@ -921,7 +1577,9 @@ bitmap_clear_bit (bitmap head, int bit)
   unsigned int indx = bit / BITMAP_ELEMENT_ALL_BITS;
   bitmap_element *ptr;
 
-  if (!head->tree_form)
+  if (head->dense_form)
+    ptr = bitmap_dense_find_slot (head, indx);
+  else if (!head->tree_form)
     ptr = bitmap_list_find_element (head, indx);
   else
     ptr = bitmap_tree_find_element (head, indx);
@@ -938,7 +1596,9 @@ bitmap_clear_bit (bitmap head, int bit)
 	  if (!ptr->bits[word_num]
 	      && bitmap_element_zerop (ptr))
 	    {
-	      if (!head->tree_form)
+	      if (head->dense_form)
+		bitmap_dense_unlink (head, ptr);
+	      else if (!head->tree_form)
 		bitmap_list_unlink_element (head, ptr);
 	      else
 		bitmap_tree_unlink_element (head, ptr);
@@ -958,13 +1618,30 @@ bitmap_set_bit (bitmap head, int bit)
 {
   unsigned indx = bit / BITMAP_ELEMENT_ALL_BITS;
   bitmap_element *ptr;
+  unsigned word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
+  unsigned bit_num  = bit % BITMAP_WORD_BITS;
+  BITMAP_WORD bit_val = ((BITMAP_WORD) 1) << bit_num;
+
+  if (head->dense_form)
+    {
+      ptr = bitmap_dense_get_slot (head, indx);
+      if (ptr)
+	{
+	  if (ptr->bits[word_num] & bit_val)
+	    return false;
+	  bool was_zero = bitmap_element_zerop (ptr);
+	  ptr->bits[word_num] |= bit_val;
+	  if (was_zero)
+	    bitmap_dense_link (head, ptr, NULL);
+	  return true;
+	}
+      /* HEAD is now in linked-list view.  */
+    }
+
   if (!head->tree_form)
     ptr = bitmap_list_find_element (head, indx);
   else
     ptr = bitmap_tree_find_element (head, indx);
-  unsigned word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
-  unsigned bit_num  = bit % BITMAP_WORD_BITS;
-  BITMAP_WORD bit_val = ((BITMAP_WORD) 1) << bit_num;
 
   if (ptr != 0)
     {
@@ -994,7 +1671,9 @@ bitmap_bit_p (const_bitmap head, int bit)
   unsigned bit_num;
   unsigned word_num;
 
-  if (!head->tree_form)
+  if (head->dense_form)
+    ptr = bitmap_dense_find_slot (head, indx);
+  else if (!head->tree_form)
     ptr = bitmap_list_find_element (const_cast<bitmap> (head), indx);
   else
     ptr = bitmap_tree_find_element (const_cast<bitmap> (head), indx);
@@ -1026,15 +1705,37 @@ bitmap_set_aligned_chunk (bitmap head, unsigned int chunk,
   unsigned bit = chunk * chunk_size;
   unsigned indx = bit / BITMAP_ELEMENT_ALL_BITS;
   bitmap_element *ptr;
-  if (!head->tree_form)
-    ptr = bitmap_list_find_element (head, indx);
-  else
-    ptr = bitmap_tree_find_element (head, indx);
   unsigned word_num = bit / BITMAP_WORD_BITS % BITMAP_ELEMENT_WORDS;
   unsigned bit_num  = bit % BITMAP_WORD_BITS;
   BITMAP_WORD bit_val = chunk_value << bit_num;
   BITMAP_WORD mask = ~(max_value << bit_num);
 
+  if (head->dense_form)
+    {
+      if (chunk_value)
+	ptr = bitmap_dense_get_slot (head, indx);
+      else if (!(ptr = bitmap_dense_find_slot (head, indx)))
+	return;
+      if (ptr)
+	{
+	  bool was_zero = bitmap_element_zerop (ptr);
+	  ptr->bits[word_num] &= mask;
+	  ptr->bits[word_num] |= bit_val;
+	  bool is_zero = bitmap_element_zerop (ptr);
+	  if (was_zero && !is_zero)
+	    bitmap_dense_link (head, ptr, NULL);
+	  else if (!was_zero && is_zero)
+	    bitmap_dense_unlink (head, ptr);
+	  return;
+	}
+      /* HEAD is now in linked-list view.  */
+    }
+
+  if (!head->tree_form)
+    ptr = bitmap_list_find_element (head, indx);
+  else
+    ptr = bitmap_tree_find_element (head, indx);
+
   if (ptr != 0)
     {
       ptr->bits[word_num] &= mask;
@@ -1070,7 +1771,9 @@ bitmap_get_aligned_chunk (const_bitmap head, unsigned int chunk,
   unsigned bit_num;
   unsigned word_num;
 
-  if (!head->tree_form)
+  if (head->dense_form)
+    ptr = bitmap_dense_find_slot (head, indx);
+  else if (!head->tree_form)
     ptr = bitmap_list_find_element (const_cast<bitmap> (head), indx);
   else
     ptr = bitmap_tree_find_element (const_cast<bitmap> (head), indx);
@@ -1280,7 +1983,9 @@ bitmap_first_set_bit_worker (bitmap a, bool clear)
      if (!elt->bits[ix]
 	 && bitmap_element_zerop (elt))
        {
-	 if (!a->tree_form)
+	 if (a->dense_form)
+	   bitmap_dense_unlink (a, elt);
+	 else if (!a->tree_form)
 	   bitmap_list_unlink_element (a, elt);
 	 else
 	   bitmap_tree_unlink_element (a, elt);
@@ -1321,6 +2026,8 @@ bitmap_last_set_bit (const_bitmap a)
 
   if (a->tree_form)
     elt = a->first;
+  else if (a->dense_form)
+    elt = a->current ? a->current->prev : NULL;
   else
     elt = a->current ? a->current : a->first;
   gcc_checking_assert (elt);
@@ -1335,7 +2042,8 @@ bitmap_last_set_bit (const_bitmap a)
       if (word)
 	goto found_bit;
     }
-  gcc_assert (elt->bits[ix] != 0);
+  word = elt->bits[ix];
+  gcc_assert (word != 0);
  found_bit:
   bit_no += ix * BITMAP_WORD_BITS;
 #if GCC_VERSION >= 3004
@@ -1372,6 +2080,14 @@ bitmap_and (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
   gcc_assert (dst != a && dst != b);
 
+  if (dst->dense_form)
+    {
+      bool changed = false;
+      if (!bitmap_dense_apply<bitmap_dense_and> (dst, a, b, NULL, &changed))
+	bitmap_and (dst, a, b);
+      return;
+    }
+
   if (a == b)
     {
       bitmap_copy (dst, a);
@@ -1434,6 +2150,13 @@ bitmap_and_into (bitmap a, const_bitmap b)
   if (a == b)
     return false;
 
+  if (a->dense_form)
+    {
+      /* The result is a subset of A, so A stays in dense view.  */
+      bitmap_dense_apply<bitmap_dense_and_into> (a, b, NULL, NULL, &changed);
+      return changed;
+    }
+
   while (a_elt && b_elt)
     {
       if (a_elt->indx < b_elt->indx)
@@ -1529,6 +2252,14 @@ bitmap_and_compl (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
   gcc_assert (dst != a && dst != b);
 
+  if (dst->dense_form)
+    {
+      if (!bitmap_dense_apply<bitmap_dense_and_compl> (dst, a, b, NULL,
+						       &changed))
+	changed |= bitmap_and_compl (dst, a, b);
+      return changed;
+    }
+
   if (a == b)
     {
       changed = !bitmap_empty_p (dst);
@@ -1641,6 +2372,15 @@ bitmap_and_compl_into (bitmap a, const_bitmap b)
 
   gcc_checking_assert (!a->tree_form && !b->tree_form);
 
+  if (a->dense_form)
+    {
+      /* The result is a subset of A, so A stays in dense view.  */
+      bool dense_changed = false;
+      bitmap_dense_apply<bitmap_dense_and_compl_into> (a, b, NULL, NULL,
+						       &dense_changed);
+      return dense_changed;
+    }
+
   if (a == b)
     {
       if (bitmap_empty_p (a))
@@ -1704,6 +2444,10 @@ bitmap_set_range (bitmap head, unsigned int start, unsigned int count)
       return;
     }
 
+  if (head->dense_form
+      && bitmap_dense_set_range (head, start, count, true))
+    return;
+
   first_index = start / BITMAP_ELEMENT_ALL_BITS;
   end_bit_plus1 = start + count;
   last_index = (end_bit_plus1 - 1) / BITMAP_ELEMENT_ALL_BITS;
@@ -1811,6 +2555,12 @@ bitmap_clear_range (bitmap head, unsigned int start, unsigned int count)
       return;
     }
 
+  if (head->dense_form)
+    {
+      bitmap_dense_set_range (head, start, count, false);
+      return;
+    }
+
   first_index = start / BITMAP_ELEMENT_ALL_BITS;
   end_bit_plus1 = start + count;
   last_index = (end_bit_plus1 - 1) / BITMAP_ELEMENT_ALL_BITS;
@@ -1940,6 +2690,21 @@ bitmap_compl_and_into (bitmap a, const_bitmap b)
   gcc_checking_assert (!a->tree_form && !b->tree_form);
   gcc_assert (a != b);
 
+  if (a->dense_form)
+    {
+      /* A = ~A & B cannot be redone after a partial update, so make room
+	 for the result first.  */
+      bool changed = false;
+      if (!a->first)
+	bitmap_copy (a, b);
+      else if (bitmap_dense_reserve (a, b))
+	bitmap_dense_apply<bitmap_dense_compl_and_into> (a, b, NULL, NULL,
+							 &changed);
+      else
+	bitmap_compl_and_into (a, b);
+      return;
+    }
+
   if (bitmap_empty_p (a))
     {
       bitmap_copy (a, b);
@@ -2073,6 +2838,13 @@ bitmap_ior (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
   gcc_assert (dst != a && dst != b);
 
+  if (dst->dense_form)
+    {
+      if (!bitmap_dense_apply<bitmap_dense_ior> (dst, a, b, NULL, &changed))
+	changed |= bitmap_ior (dst, a, b);
+      return changed;
+    }
+
   while (a_elt || b_elt)
     {
       changed = bitmap_elt_ior (dst, dst_elt, dst_prev, a_elt, b_elt, changed);
@@ -2123,6 +2895,14 @@ bitmap_ior_into (bitmap a, const_bitmap b)
   if (a == b)
     return false;
 
+  if (a->dense_form)
+    {
+      if (!bitmap_dense_apply<bitmap_dense_ior_into> (a, b, NULL, NULL,
+						      &changed))
+	changed |= bitmap_ior_into (a, b);
+      return changed;
+    }
+
   while (b_elt)
     {
       /* If A lags behind B, just advance it.  */
@@ -2166,6 +2946,17 @@ bitmap_ior_into_and_free (bitmap a, bitmap *b_)
   if (a == b)
     return false;
 
+  /* The elements of B cannot be moved into or out of an array.  */
+  if (a->dense_form || b->dense_form)
+    {
+      changed = bitmap_ior_into (a, b);
+      if (b->obstack)
+	BITMAP_FREE (*b_);
+      else
+	bitmap_clear (b);
+      return changed;
+    }
+
   while (b_elt)
     {
       /* If A lags behind B, just advance it.  */
@@ -2211,6 +3002,14 @@ bitmap_xor (bitmap dst, const_bitmap a, const_bitmap b)
   gcc_checking_assert (!dst->tree_form && !a->tree_form && !b->tree_form);
   gcc_assert (dst != a && dst != b);
 
+  if (dst->dense_form)
+    {
+      bool changed = false;
+      if (!bitmap_dense_apply<bitmap_dense_xor> (dst, a, b, NULL, &changed))
+	bitmap_xor (dst, a, b);
+      return;
+    }
+
   if (a == b)
     {
       bitmap_clear (dst);
@@ -2296,6 +3095,21 @@ bitmap_xor_into (bitmap a, const_bitmap b)
       return;
     }
 
+  if (a->dense_form)
+    {
+      /* A ^= B cannot be redone after a partial update, so make room for
+	 the result first.  */
+      bool changed = false;
+      if (!a->first)
+	bitmap_copy (a, b);
+      else if (bitmap_dense_reserve (a, b))
+	bitmap_dense_apply<bitmap_dense_xor_into> (a, b, NULL, NULL,
+						   &changed);
+      else
+	bitmap_xor_into (a, b);
+      return;
+    }
+
   while (b_elt)
     {
       if (!a_elt || b_elt->indx < a_elt->indx)
@@ -2444,6 +3258,14 @@ bitmap_ior_and_compl (bitmap dst, const_bitmap a, const_bitmap b, const_bitmap k
 		       && !kill->tree_form);
   gcc_assert (dst != a && dst != b && dst != kill);
 
+  if (dst->dense_form)
+    {
+      if (!bitmap_dense_apply<bitmap_dense_ior_and_compl> (dst, a, b, kill,
+							   &changed))
+	changed |= bitmap_ior_and_compl (dst, a, b, kill);
+      return changed;
+    }
+
   /* Special cases.  We don't bother checking for bitmap_equal_p (b, kill).  */
   if (b == kill || bitmap_empty_p (b))
     {
@@ -2552,6 +3374,13 @@ bitmap_ior_and_compl_into (bitmap a, const_bitmap b, const_bitmap c)
 
   if (a == b)
     return false;
+  if (a->dense_form)
+    {
+      if (!bitmap_dense_apply<bitmap_dense_ior_and_compl_into> (a, b, c, NULL,
+								&changed))
+	changed |= bitmap_ior_and_compl_into (a, b, c);
+      return changed;
+    }
   if (bitmap_empty_p (c))
     return bitmap_ior_into (a, b);
   else if (bitmap_empty_p (a))
@@ -2631,6 +3460,13 @@ bitmap_ior_and_into (bitmap a, const_bitmap b, const_bitmap c)
     return bitmap_ior_into (a, b);
   if (bitmap_empty_p (b) || bitmap_empty_p (c))
     return false;
+  if (a->dense_form)
+    {
+      if (!bitmap_dense_apply<bitmap_dense_ior_and_into> (a, b, c, NULL,
+							  &changed))
+	changed |= bitmap_ior_and_into (a, b, c);
+      return changed;
+    }
 
   and_elt.indx = -1;
   while (b_elt && c_elt)
@@ -3009,6 +3845,282 @@ test_aligned_chunk (unsigned num_bits)
     }
 }
 
+/* Verify the basic operations on a bitmap in dense view, and that it
+   reverts to linked-list view when it becomes sparse.  */
+
+static void
+test_dense_view ()
+{
+  bitmap_obstack ob;
+  bitmap_obstack_initialize (&ob);
+  bitmap_head b;
+  bitmap_initialize (&b, &ob);
+  bitmap_dense_view (&b);
+  ASSERT_TRUE (b.dense_form);
+  ASSERT_TRUE (bitmap_empty_p (&b));
+
+  ASSERT_TRUE (bitmap_set_bit (&b, 1000));
+  ASSERT_FALSE (bitmap_set_bit (&b, 1000));
+  ASSERT_TRUE (bitmap_set_bit (&b, 5));
+  bitmap_set_range (&b, 300, 400);
+  ASSERT_TRUE (b.dense_form);
+  ASSERT_TRUE (bitmap_bit_p (&b, 5));
+  ASSERT_TRUE (bitmap_bit_p (&b, 699));
+  ASSERT_FALSE (bitmap_bit_p (&b, 700));
+  ASSERT_EQ (402, bitmap_count_bits (&b));
+  ASSERT_EQ (5, bitmap_first_set_bit (&b));
+  ASSERT_EQ (1000, bitmap_last_set_bit (&b));
+
+  ASSERT_TRUE (bitmap_clear_bit (&b, 1000));
+  ASSERT_EQ (699, bitmap_last_set_bit (&b));
+  bitmap_clear_range (&b, 0, 500);
+  ASSERT_EQ (500, bitmap_first_set_bit (&b));
+
+  unsigned i, n = 500;
+  bitmap_iterator bi;
+  EXECUTE_IF_SET_IN_BITMAP (&b, 0, i, bi)
+    {
+      ASSERT_EQ (n, i);
+      n++;
+    }
+  ASSERT_EQ (700, n);
+
+  /* A far away bit makes the set too sparse for the dense view.  */
+  bitmap_set_bit (&b, 1000000);
+  ASSERT_FALSE (b.dense_form);
+  ASSERT_EQ (201, bitmap_count_bits (&b));
+  ASSERT_EQ (1000000, bitmap_last_set_bit (&b));
+
+  bitmap_clear (&b);
+  bitmap_obstack_release (&ob);
+}
+
+/* Verify the set operations on bitmaps in dense view against the same
+   operations on bitmaps in linked-list view.  */
+
+static void
+test_dense_view_ops ()
+{
+  const int n = 4;
+  bitmap_obstack ob;
+  bitmap_obstack_initialize (&ob);
+  bitmap_head dense[n], list[n];
+  for (int i = 0; i < n; i++)
+    {
+      bitmap_initialize (&dense[i], &ob);
+      bitmap_initialize (&list[i], &ob);
+      bitmap_dense_view (&dense[i]);
+    }
+
+  unsigned int seed = 1;
+  for (int step = 0; step < 2000; step++)
+    {
+      seed = seed * 1103515245 + 12345;
+      unsigned int r = seed >> 8;
+      int i = r % n, j = (r / n) % n, k = (r / n / n) % n;
+      unsigned int bit = (r / 64) % (r % 16 ? 2000 : 50000);
+      bool dense_changed = false, list_changed = false;
+
+      switch ((r / 256) % 10)
+	{
+	case 0:
+	case 1:
+	  dense_changed = bitmap_set_bit (&dense[i], bit);
+	  list_changed = bitmap_set_bit (&list[i], bit);
+	  break;
+	case 2:
+	  dense_changed = bitmap_clear_bit (&dense[i], bit);
+	  list_changed = bitmap_clear_bit (&list[i], bit);
+	  break;
+	case 3:
+	  bitmap_set_range (&dense[i], bit, r % 300);
+	  bitmap_set_range (&list[i], bit, r % 300);
+	  break;
+	case 4:
+	  bitmap_clear_range (&dense[i], bit, r % 300);
+	  bitmap_clear_range (&list[i], bit, r % 300);
+	  break;
+	case 5:
+	  dense_changed = bitmap_ior_into (&dense[i], &dense[j]);
+	  list_changed = bitmap_ior_into (&list[i], &list[j]);
+	  break;
+	case 6:
+	  dense_changed = bitmap_and_compl_into (&dense[i], &dense[j]);
+	  list_changed = bitmap_and_compl_into (&list[i], &list[j]);
+	  break;
+	case 7:
+	  bitmap_xor_into (&dense[i], &dense[j]);
+	  bitmap_xor_into (&list[i], &list[j]);
+	  break;
+	case 8:
+	  if (i != j && i != k)
+	    {
+	      dense_changed = bitmap_ior_and_compl (&dense[i], &dense[j],
+						    &list[k], &dense[k]);
+	      list_changed = bitmap_ior_and_compl (&list[i], &list[j],
+						   &list[k], &list[k]);
+	    }
+	  break;
+	case 9:
+	  if (i != j)
+	    {
+	      bitmap_copy (&dense[i], &list[j]);
+	      bitmap_copy (&list[i], &list[j]);
+	    }
+	  break;
+	}
+      ASSERT_EQ (list_changed, dense_changed);
+      ASSERT_TRUE (bitmap_equal_p (&dense[i], &list[i]));
+      if (!bitmap_empty_p (&list[i]))
+	ASSERT_EQ (bitmap_last_set_bit (&list[i]),
+		   bitmap_last_set_bit (&dense[i]));
+      if (!dense[i].dense_form && r % 4 == 0)
+	bitmap_dense_view (&dense[i]);
+    }
+
+  for (int i = 0; i < n; i++)
+    {
+      bitmap_clear (&dense[i]);
+      bitmap_clear (&list[i]);
+    }
+  bitmap_obstack_release (&ob);
+}
+
+/* Verify that bitmap_move takes over the array of a bitmap in dense view
+   and leaves the source empty.  */
+
+static void
+test_dense_move ()
+{
+  bitmap_obstack ob;
+  bitmap_obstack_initialize (&ob);
+  bitmap_head a, b;
+  bitmap_initialize (&a, &ob);
+  bitmap_initialize (&b, &ob);
+  bitmap_dense_view (&a);
+  bitmap_set_range (&a, 10, 190);
+  bitmap_set_bit (&b, 5);
+
+  bitmap_move (&b, &a);
+  ASSERT_TRUE (b.dense_form);
+  ASSERT_EQ (190, bitmap_count_bits (&b));
+  ASSERT_FALSE (bitmap_bit_p (&b, 5));
+  ASSERT_TRUE (bitmap_empty_p (&a));
+
+  /* Clearing the source must not release the array of the destination.  */
+  bitmap_clear (&a);
+  bitmap_head c;
+  bitmap_initialize (&c, &ob);
+  bitmap_dense_view (&c);
+  bitmap_set_range (&c, 0, 1024);
+  ASSERT_EQ (190, bitmap_count_bits (&b));
+  ASSERT_TRUE (bitmap_set_bit (&b, 300));
+  ASSERT_EQ (191, bitmap_count_bits (&b));
+
+  bitmap_clear (&b);
+  bitmap_clear (&c);
+  bitmap_obstack_release (&ob);
+}
+
+/* Verify that an iteration over a bitmap in dense view continues over the
+   old contents of the set when the body clears bits and the bitmap
+   reverts to linked-list view or replaces its array.  */
+
+static void
+test_dense_clear_during_iteration ()
+{
+  bitmap_obstack ob;
+  bitmap_obstack_initialize (&ob);
+  bitmap_head b, c, d;
+  bitmap_initialize (&b, &ob);
+  bitmap_initialize (&c, &ob);
+  bitmap_initialize (&d, &ob);
+  unsigned i, n = 0;
+  bitmap_iterator bi;
+
+  bitmap_dense_view (&b);
+  bitmap_set_range (&b, 0, 1000);
+  EXECUTE_IF_SET_IN_BITMAP (&b, 0, i, bi)
+    {
+      ASSERT_EQ (n, i);
+      n++;
+      bitmap_clear_bit (&b, i);
+      /* A far away bit makes the set too sparse for the dense view.  */
+      if (i == 500)
+	bitmap_set_bit (&b, 10000000);
+    }
+  ASSERT_EQ (1000, n);
+  ASSERT_FALSE (b.dense_form);
+  ASSERT_EQ (1, bitmap_count_bits (&b));
+  ASSERT_TRUE (bitmap_bit_p (&b, 10000000));
+
+  /* Empty the set in the middle of the iteration, then set a bit outside
+     of its array, which replaces the array.  Allocating another array of
+     the same size must not reuse the one being iterated over.  */
+  n = 0;
+  bitmap_dense_view (&c);
+  bitmap_set_range (&c, 0, 256);
+  EXECUTE_IF_SET_IN_BITMAP (&c, 0, i, bi)
+    {
+      /* The rest of the word being visited is cached by the iterator.  */
+      ASSERT_EQ (n, i);
+      ASSERT_LT (i, 256);
+      n++;
+      if (i == 200)
+	{
+	  bitmap_clear_range (&c, 0, 256);
+	  bitmap_set_bit (&c, 5000);
+	  bitmap_dense_view (&d);
+	  bitmap_set_range (&d, 0, 1024);
+	}
+    }
+  ASSERT_TRUE (n >= 201);
+  ASSERT_TRUE (c.dense_form);
+  ASSERT_EQ (1, bitmap_count_bits (&c));
+
+  bitmap_clear (&b);
+  bitmap_clear (&c);
+  bitmap_clear (&d);
+  bitmap_obstack_release (&ob);
+}
+
+/* Verify that copying into a bitmap in dense view releases the arrays
+   that were superseded since the last copy or clear.  */
+
+static void
+test_dense_copy_releases_arrays ()
+{
+  bitmap_obstack ob;
+  bitmap_obstack_initialize (&ob);
+  bitmap_head live, from;
+  bitmap_initialize (&live, &ob);
+  bitmap_initialize (&from, &ob);
+  bitmap_dense_view (&live);
+
+  for (unsigned int block = 0; block < 100; block++)
+    {
+      bitmap_clear (&from);
+      bitmap_set_range (&from, block * 64, 512);
+      bitmap_copy (&live, &from);
+      ASSERT_TRUE (live.dense_form);
+      ASSERT_TRUE (bitmap_equal_p (&live, &from));
+      ASSERT_EQ (NULL, live.current->next);
+
+      /* Empty the set and set a bit outside of its array, which replaces
+	 the array, as the insns of a block may do.  */
+      unsigned int end = ((live.current->indx + live.current->bits[0])
+			  * BITMAP_ELEMENT_ALL_BITS);
+      bitmap_clear_range (&live, 0, end);
+      ASSERT_TRUE (bitmap_set_bit (&live, end + 1000));
+      ASSERT_TRUE (live.current->next != NULL);
+      bitmap_clear_bit (&live, end + 1000);
+    }
+
+  bitmap_clear (&live);
+  bitmap_clear (&from);
+  bitmap_obstack_release (&ob);
+}
+
 /* Run all of the selftests within this file.  */
 
 void
@@ -3023,6 +4135,11 @@ bitmap_cc_tests ()
   test_aligned_chunk (2);
   test_aligned_chunk (4);
   test_aligned_chunk (8);
+  test_dense_view ();
+  test_dense_view_ops ();
+  test_dense_move ();
+  test_dense_clear_during_iteration ();
+  test_dense_copy_releases_arrays ();
 }
 
 } // namespace selftest
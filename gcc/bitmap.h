@@ -73,7 +73,8 @@ along with GCC; see the file COPYING3.  If not see
    This is an O(E) operation:
 
      * from list to tree view	: bitmap_tree_view
-     * from tree to list view	: bitmap_list_view
+     * from list to dense view	: bitmap_dense_view
+     * from tree or dense view to list view : bitmap_list_view
 
    Traversing linked lists or trees can be cache-unfriendly.  Performance
    can be improved by keeping container nodes in the set grouped together
@@ -209,7 +210,36 @@ along with GCC; see the file COPYING3.  If not see
    The binary tree sparse set representation does *not* support any form
    of enumeration, and does also *not* support logical operations on sets.
    The binary tree representation is only supposed to be used for sets
-   on which many random-access membership tests will happen.  */
+   on which many random-access membership tests will happen.
+
+
+   DENSE FORM
+   ==========
+   A third view is meant for sets that are dense over a long range of
+   members, such as the live register sets of data flow problems.  In
+   dense form, the container nodes are the slots of a single array that
+   covers all indices from the smallest to the largest element of the
+   set, allocated on the bitmap's obstack.  The slots that hold set
+   members are linked together exactly as in linked-list form, so all
+   operations that only read the set, including iteration, work as for
+   the linked-list form; slots without members are not linked.
+
+   The following operations can be performed in O(1) time in dense view:
+
+     * member_p			: bitmap_bit_p
+     * add_member		: bitmap_set_bit
+     * remove_member		: bitmap_clear_bit
+     * largest_member		: bitmap_last_set_bit
+
+   The logical operations that modify a set in dense view visit only the
+   elements of the other operands, so for example bitmap_ior_into of a
+   small set into a large dense one is O(E) in the size of the small
+   set, and they do not chase pointers through the destination set.
+
+   When a set in dense view becomes too sparse for its array (fewer than
+   one in four slots in use), it is converted back to linked-list form
+   automatically.  Only bitmaps allocated on an obstack can use the dense
+   view.  */
 
 #include "obstack.h"
 #include "array-traits.h"
@@ -290,10 +320,17 @@ typedef unsigned long BITMAP_WORD;
 
 #define BITMAP_ELEMENT_ALL_BITS (BITMAP_ELEMENT_WORDS * BITMAP_WORD_BITS)
 
+/* Number of size classes of the element arrays of bitmaps in dense form.  */
+
+#define BITMAP_DENSE_CLASSES 32
+
 /* Obstack for allocating bitmaps and elements from.  */
 struct bitmap_obstack {
   struct bitmap_element *elements;
   bitmap_head *heads;
+  /* Free element arrays for the dense form, indexed by the log2 of their
+     number of elements.  */
+  struct bitmap_element *dense_arrays[BITMAP_DENSE_CLASSES];
   struct obstack obstack;
 };
 
@@ -330,22 +367,25 @@ public:
   static bitmap_obstack crashme;
   /* Poison obstack to not make it not a valid initialized GC bitmap.  */
   CONSTEXPR bitmap_head()
-    : indx (0), tree_form (false), padding (0), alloc_descriptor (0), first (NULL),
-      current (NULL), obstack (&crashme)
+    : indx (0), tree_form (false), dense_form (false), padding (0),
+      alloc_descriptor (0), first (NULL), current (NULL), obstack (&crashme)
   {}
   /* Index of last element looked at.  */
   unsigned int indx;
   /* False if the bitmap is in list form; true if the bitmap is in tree form.
-     Bitmap iterators only work on bitmaps in list form.  */
+     Bitmap iterators only work on bitmaps in list or dense form.  */
   unsigned tree_form: 1;
+  /* True if the bitmap is in dense form.  */
+  unsigned dense_form: 1;
   /* Next integer is shifted, so padding is needed.  */
-  unsigned padding: 2;
+  unsigned padding: 1;
   /* Bitmap UID used for memory allocation statistics.  */
   unsigned alloc_descriptor: 29;
   /* In list form, the first element in the linked list;
      in tree form, the root of the tree.   */
   bitmap_element *first;
-  /* Last element looked at.  */
+  /* Last element looked at; in dense form, the header of the array
+     of elements.  */
   bitmap_element * GTY((skip(""))) current;
   /* Obstack to allocate elements from.  If NULL, then use GGC allocation.  */
   bitmap_obstack * GTY((skip(""))) obstack;
@@ -366,9 +406,10 @@ public:
 extern bitmap_element bitmap_zero_bits;	/* Zero bitmap element */
 extern bitmap_obstack bitmap_default_obstack;   /* Default bitmap obstack */
 
-/* Change the view of the bitmap to list, or tree.  */
+/* Change the view of the bitmap to list, tree, or dense.  */
 void bitmap_list_view (bitmap);
 void bitmap_tree_view (bitmap);
+void bitmap_dense_view (bitmap);
 
 /* Clear a bitmap by freeing up the linked list.  */
 extern void bitmap_clear (bitmap);
@@ -467,7 +508,7 @@ inline void
 bitmap_initialize (bitmap head, bitmap_obstack *obstack CXX_MEM_STAT_INFO)
 {
   head->first = head->current = NULL;
-  head->indx = head->tree_form = 0;
+  head->indx = head->tree_form = head->dense_form = 0;
   head->padding = 0;
   head->alloc_descriptor = 0;
   head->obstack = obstack;
@@ -1247,6 +1247,7 @@ extern void c_parse_error (const char *, enum cpp_ttype, tree, unsigned char,
 
 /* In c-ppoutput.cc  */
 extern void init_pp_output (FILE *);
+extern void finish_pp_output (void);
 extern void preprocess_file (cpp_reader *);
 extern void pp_file_change (const line_map_ordinary *);
 extern void pp_dir_change (cpp_reader *, const char *);
@@ -78,6 +78,11 @@ static bool verbose;
 /* Dependency output file.  */
 static const char *deps_file;
 
+/* Key of the compilation given by the driver with -fdepfile-digests=,
+   and the time at which the option was seen.  */
+static const char *depfile_digests_key;
+static time_t depfile_digests_since;
+
 /* Structured dependency output file.  */
 static const char *fdeps_file;
 
@@ -378,6 +383,15 @@ c_common_handle_option (size_t scode, const char *arg, HOST_WIDE_INT value,
       fdeps_file = arg;
       break;
 
+    case OPT_fdepfile_digests:
+      /* Handled by the driver.  */
+      break;
+
+    case OPT_fdepfile_digests_:
+      depfile_digests_key = arg;
+      depfile_digests_since = time (NULL);
+      break;
+
     case OPT_fdeps_target_:
       deps_seen = true;
       defer_opt (code, arg);
@@ -1330,6 +1344,55 @@ c_common_parse_file (void)
   dumps->dump_finish (TDI_original);
 }
 
+/* Write the digests of the dependencies for -fdepfile-digests to
+   DEPS_FILE.sum, from which the driver decides whether the next
+   compilation can be skipped.  The digests describe the output only
+   if the compilation succeeded, and of a single input, as the files
+   not found in the include path are forgotten between inputs.  They do
+   not cover the profile of -fprofile-use or -fauto-profile, nor the
+   plugins, which are read without being dependencies.  Otherwise any
+   stale file is removed, so that the next compilation is not skipped.
+   The last line names the compiler itself, with equals signs in place
+   of the digest: the driver reuses the output only while the compiler
+   is older than the digests.  */
+static void
+write_depfile_digests (void)
+{
+  char *sum_file = concat (deps_file, ".sum", NULL);
+  const char *compiler = save_decoded_options[0].arg;
+  struct stat st;
+  FILE *f;
+  int err;
+
+  if (seen_error () || deps_append || num_in_fnames > 1
+      || flag_profile_use || flag_auto_profile || plugins_active_p ()
+      || strchr (compiler, '\n')
+      || stat (compiler, &st) != 0
+      || st.st_mtime >= depfile_digests_since)
+    {
+      unlink (sum_file);
+      free (sum_file);
+      return;
+    }
+
+  f = fopen (sum_file, "w");
+  if (!f)
+    fatal_error (input_location, "opening dependency file %s: %m", sum_file);
+  /* If a dependency could not be read back, or changed while we were
+     compiling, leave no digests so that the next compilation is not
+     skipped.  */
+  err = deps_write_digests (parse_in, f, depfile_digests_key,
+			    depfile_digests_since);
+  if (!err
+      && fprintf (f, "================================ %s\n", compiler) < 0)
+    err = -1;
+  if (fclose (f) != 0)
+    err = -1;
+  if (err)
+    unlink (sum_file);
+  free (sum_file);
+}
+
 /* Common finish hook for the C, ObjC and C++ front ends.  */
 void
 c_common_finish (void)
@@ -1337,6 +1400,11 @@ c_common_finish (void)
   FILE *deps_stream = NULL;
   FILE *fdeps_stream = NULL;
 
+  /* Write out what is left of the preprocessed output, before the
+     dependencies that might go to the same stream.  */
+  if (out_stream)
+    finish_pp_output ();
+
   /* Note that we write the dependencies even if there are errors. This is
      useful for handling outdated generated headers that now trigger errors
      (for example, with #error) which would be resolved by re-generating
@@ -1390,6 +1458,10 @@ c_common_finish (void)
       && (ferror (deps_stream) || fclose (deps_stream)))
     fatal_error (input_location, "closing dependency file %s: %m", deps_file);
 
+  if (depfile_digests_key && deps_file
+      && !(deps_file[0] == '-' && deps_file[1] == '\0'))
+    write_depfile_digests ();
+
   if (out_stream && (ferror (out_stream) || fclose (out_stream)))
     fatal_error (input_location, "when writing output to %s: %m", out_fname);
 }
@@ -27,11 +27,25 @@
 
 class token_streamer;
 
+/* What the line marker for a file change needs of its line map.  The
+   line maps are reallocated as more are added, so the maps of queued
+   file changes cannot be kept.  */
+struct file_change
+{
+  enum lc_reason reason;	/* Reason for the change.  */
+  location_t start_location;	/* Where the file is changed to.  */
+  location_t included_from;	/* Location of the #include for
+				   LC_ENTER.  */
+};
+
 /* Encapsulates state used to convert a stream of tokens into a text
    file.  */
 static struct
 {
   FILE *outf;			/* Stream to write to.  */
+  unsigned char *buf;		/* Output not yet written to OUTF.  */
+  unsigned char *buf_cur;	/* Where the next character goes.  */
+  unsigned char *buf_limit;	/* End of BUF.  */
   const cpp_token *prev;	/* Previous token.  */
   const cpp_token *source;	/* Source token for spacing.  */
   unsigned src_line;		/* Line number currently being written.  */
@@ -42,8 +56,15 @@ static struct
   const char *src_file;		/* Current source file.  */
   token_streamer *streamer;     /* Instance of class token_streamer using this
 				   object.  */
+  vec<file_change> queued_changes; /* File changes whose line markers
+				   are not written yet.  */
 } print;
 
+/* The size of print.buf.  Output is spelled into the buffer and only
+   written to the stream when it is full, which takes many fewer calls
+   than writing each token or character through stdio.  */
+#define PP_OUTPUT_BUFFER_SIZE (256 * 1024)
+
 /* Defined and undefined macros being queued for output with -dU at
    the next newline.  */
 struct macro_queue
@@ -63,12 +84,21 @@ static void account_for_newlines (const unsigned char *, size_t);
 static int dump_macro (cpp_reader *, cpp_hashnode *, void *);
 static void dump_queued_macros (cpp_reader *);
 
-static bool print_line_1 (location_t, const char*, FILE *);
+static bool print_line_1 (location_t, const char*);
 static bool print_line (location_t, const char *);
-static bool maybe_print_line_1 (location_t, FILE *);
+static bool maybe_print_line_1 (location_t);
 static bool maybe_print_line (location_t);
 static bool do_line_change (cpp_reader *, const cpp_token *,
 			    location_t, int);
+static void print_file_change (const file_change &);
+static void queue_file_change (const file_change &);
+static void print_queued_file_changes_1 (void);
+
+static void flush_pp_output (void);
+static void pp_write (const void *, size_t);
+static void pp_puts (const char *);
+static void pp_printf (const char *, ...) ATTRIBUTE_PRINTF_1;
+static inline void pp_output_token (const cpp_token *);
 
 /* Callback routines for the parser.   Most of these are active only
    in specific modes.  */
@@ -84,6 +114,111 @@ static void cb_def_pragma (cpp_reader *, location_t);
 static void cb_read_pch (cpp_reader *pfile, const char *name,
 			 int fd, const char *orig_name);
 
+/* Make room for at least LEN more characters in print.buf, and
+   return where they go.  */
+static inline unsigned char *
+pp_reserve (size_t len)
+{
+  if ((size_t) (print.buf_limit - print.buf_cur) < len)
+    {
+      flush_pp_output ();
+      if (print.buf + len > print.buf_limit)
+	{
+	  print.buf = XRESIZEVEC (unsigned char, print.buf, len);
+	  print.buf_cur = print.buf;
+	  print.buf_limit = print.buf + len;
+	}
+    }
+  return print.buf_cur;
+}
+
+/* Output the character C.  */
+static inline void
+pp_putc (char c)
+{
+  if (print.buf_cur == print.buf_limit)
+    flush_pp_output ();
+  *print.buf_cur++ = c;
+}
+
+/* Write the output held in print.buf to the stream.  */
+static void
+flush_pp_output (void)
+{
+  size_t len = print.buf_cur - print.buf;
+
+  if (len)
+    fwrite (print.buf, 1, len, print.outf);
+  print.buf_cur = print.buf;
+}
+
+/* Output LEN characters starting at BUF.  */
+static void
+pp_write (const void *buf, size_t len)
+{
+  if ((size_t) (print.buf_limit - print.buf_cur) < len)
+    {
+      flush_pp_output ();
+      /* Don't copy what would fill the buffer anyway.  */
+      if (len >= (size_t) (print.buf_limit - print.buf))
+	{
+	  fwrite (buf, 1, len, print.outf);
+	  return;
+	}
+    }
+  memcpy (print.buf_cur, buf, len);
+  print.buf_cur += len;
+}
+
+/* Output the string STR.  */
+static void
+pp_puts (const char *str)
+{
+  pp_write (str, strlen (str));
+}
+
+/* Output the string formatted from FMT and the rest of the arguments
+   as printf would.  */
+static void
+pp_printf (const char *fmt, ...)
+{
+  va_list ap;
+  size_t room = print.buf_limit - print.buf_cur;
+  int len;
+
+  va_start (ap, fmt);
+  len = vsnprintf ((char *) print.buf_cur, room, fmt, ap);
+  va_end (ap);
+  if ((size_t) len >= room)
+    {
+      /* It did not fit; vsnprintf has told us what does.  */
+      pp_reserve (len + 1);
+      va_start (ap, fmt);
+      vsnprintf ((char *) print.buf_cur, len + 1, fmt, ap);
+      va_end (ap);
+    }
+  print.buf_cur += len;
+}
+
+/* Output the spelling of TOKEN, without any preceding space.  */
+static inline void
+pp_output_token (const cpp_token *token)
+{
+  unsigned char *p = pp_reserve (cpp_token_len (token) + 2);
+  print.buf_cur = cpp_output_token_to_buffer (token, p);
+}
+
+/* If output is being queued for later (with -fcompact-line-markers),
+   write the line markers not yet output for file changes.  This has to
+   be done before anything else is output, and before anything looks at
+   print.src_line or print.src_file.  */
+static inline void
+print_queued_file_changes (void)
+{
+  if (!print.queued_changes.is_empty ())
+    print_queued_file_changes_1 ();
+}
+
 /* Preprocess and output.  */
 void
 preprocess_file (cpp_reader *pfile)
@@ -109,9 +244,22 @@ preprocess_file (cpp_reader *pfile)
   if (flag_dump_macros == 'M')
     cpp_forall_identifiers (pfile, dump_macro, NULL);
 
-  /* Flush any pending output.  */
+  /* Flush any pending output.  Line markers still queued are for
+     files that had nothing in them to output.  */
   if (print.printed)
-    putc ('\n', print.outf);
+    pp_putc ('\n');
+  print.queued_changes.release ();
+  flush_pp_output ();
+}
+
+/* Write out the output still held in print.buf.  Nothing may be output
+   after this.  */
+void
+finish_pp_output (void)
+{
+  flush_pp_output ();
+  XDELETEVEC (print.buf);
+  print.buf = print.buf_cur = print.buf_limit = NULL;
 }
 
 /* Don't emit #pragma or #ident directives if we are processing
@@ -175,6 +323,14 @@ init_pp_output (FILE *out_stream)
   print.src_file = "";
   print.prev_was_system_token = false;
   print.streamer = nullptr;
+  print.buf = XNEWVEC (unsigned char, PP_OUTPUT_BUFFER_SIZE);
+  print.buf_cur = print.buf;
+  print.buf_limit = print.buf + PP_OUTPUT_BUFFER_SIZE;
+
+  /* Make sure what has been output so far is written out if we exit
+     early because of a fatal error; finish_pp_output is not called
+     then.  */
+  atexit (flush_pp_output);
 }
 
 // FIXME: Ideally we'd just turn the entirety of the print struct into
@@ -226,6 +382,8 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
   if (token->type == CPP_EOF)
     return;
 
+  print_queued_file_changes ();
+
   /* Keep track when we move into and out of system locations.  */
   const bool is_system_token = in_system_header_at (loc);
   const bool system_state_changed
@@ -246,7 +404,7 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
 	  && !in_pragma)
 	{
 	  line_marker_emitted = do_line_change (pfile, token, loc, false);
-	  putc (' ', print.outf);
+	  pp_putc (' ');
 	  print.printed = true;
 	}
       else if (print.source->flags & PREV_WHITE
@@ -254,7 +412,7 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
 		   && cpp_avoid_paste (pfile, print.prev, token))
 	       || (print.prev == NULL && token->type == CPP_HASH))
 	{
-	  putc (' ', print.outf);
+	  pp_putc (' ');
 	  print.printed = true;
 	}
     }
@@ -266,7 +424,7 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
 	  && do_line_adjustments
 	  && !in_pragma)
 	line_marker_emitted = do_line_change (pfile, token, loc, false);
-      putc (' ', print.outf);
+      pp_putc (' ');
       print.printed = true;
     }
 
@@ -282,12 +440,12 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
 	  const char *name;
 
 	  line_marker_emitted = maybe_print_line (token->src_loc);
-	  fputs ("#pragma ", print.outf);
+	  pp_puts ("#pragma ");
 	  c_pp_lookup_pragma (token->val.pragma, &space, &name);
 	  if (space)
-	    fprintf (print.outf, "%s %s", space, name);
+	    pp_printf ("%s %s", space, name);
 	  else
-	    fprintf (print.outf, "%s", name);
+	    pp_puts (name);
 	  print.printed = true;
 	}
       if (token->val.pragma >= PRAGMA_FIRST_EXTERNAL)
@@ -302,7 +460,10 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
   else
     {
       if (cpp_get_options (parse_in)->debug)
-	linemap_dump_location (line_table, token->src_loc, print.outf);
+	{
+	  flush_pp_output ();
+	  linemap_dump_location (line_table, token->src_loc, print.outf);
+	}
 
       if (do_line_adjustments
 	  && !in_pragma
@@ -317,7 +478,7 @@ token_streamer::stream (cpp_reader *pfile, const cpp_token *token,
 	}
       if (!in_pragma || should_output_pragmas ())
 	{
-	  cpp_output_token (token, print.outf);
+	  pp_output_token (token);
 	  print.printed = true;
 	}
     }
@@ -389,11 +550,12 @@ directives_only_cb (cpp_reader *pfile, CPP_DO_task task, void *data_, ...)
 
     case CPP_DO_print:
       {
+	print_queued_file_changes ();
 	print.src_line += va_arg (args, unsigned);
 
 	const void *buf = va_arg (args, const void *);
 	size_t size = va_arg (args, size_t);
-	fwrite (buf, 1, size, print.outf);
+	pp_write (buf, size);
       }
       break;
 
@@ -459,7 +621,7 @@ scan_translation_unit_trad (cpp_reader *pfile)
     {
       size_t len = pfile->out.cur - pfile->out.base;
       maybe_print_line (pfile->out.first_line);
-      fwrite (pfile->out.base, 1, len, print.outf);
+      pp_write (pfile->out.base, len);
       print.printed = true;
       if (!CPP_OPTION (pfile, discard_comments))
 	account_for_newlines (pfile->out.base, len);
@@ -472,16 +634,18 @@ scan_translation_unit_trad (cpp_reader *pfile)
    return FALSE.  */
 
 static bool
-maybe_print_line_1 (location_t src_loc, FILE *stream)
+maybe_print_line_1 (location_t src_loc)
 {
   bool emitted_line_marker = false;
   unsigned src_line = LOCATION_LINE (src_loc);
   const char *src_file = LOCATION_FILE (src_loc);
 
+  print_queued_file_changes ();
+
   /* End the previous line of text.  */
   if (print.printed)
     {
-      putc ('\n', stream);
+      pp_putc ('\n');
       print.src_line++;
       print.printed = false;
     }
@@ -494,12 +658,12 @@ maybe_print_line_1 (location_t src_loc, FILE *stream)
     {
       while (src_line > print.src_line)
 	{
-	  putc ('\n', stream);
+	  pp_putc ('\n');
 	  print.src_line++;
 	}
     }
   else
-    emitted_line_marker = print_line_1 (src_loc, "", stream);
+    emitted_line_marker = print_line_1 (src_loc, "");
 
   return emitted_line_marker;
 }
@@ -513,9 +677,12 @@ static bool
 maybe_print_line (location_t src_loc)
 {
   if (cpp_get_options (parse_in)->debug)
-    linemap_dump_location (line_table, src_loc,
-			   print.outf);
-  return maybe_print_line_1 (src_loc, print.outf);
+    {
+      flush_pp_output ();
+      linemap_dump_location (line_table, src_loc,
+			     print.outf);
+    }
+  return maybe_print_line_1 (src_loc);
 }
 
 /* Output a line marker for logical line LINE.  Special flags are "1"
@@ -523,13 +690,15 @@ maybe_print_line (location_t src_loc)
    was effectively emitted, return TRUE otherwise return FALSE.  */
 
 static bool
-print_line_1 (location_t src_loc, const char *special_flags, FILE *stream)
+print_line_1 (location_t src_loc, const char *special_flags)
 {
   bool emitted_line_marker = false;
 
+  print_queued_file_changes ();
+
   /* End any previous line of text.  */
   if (print.printed)
-    putc ('\n', stream);
+    pp_putc ('\n');
   print.printed = false;
 
   if (src_loc != UNKNOWN_LOCATION && !flag_no_line_commands)
@@ -549,16 +718,16 @@ print_line_1 (location_t src_loc, const char *special_flags, FILE *stream)
       print.src_line = LOCATION_LINE (src_loc);
       print.src_file = file_path;
 
-      fprintf (stream, "# %u \"%s\"%s",
-	       print.src_line, to_file_quoted, special_flags);
+      pp_printf ("# %u \"%s\"%s",
+		 print.src_line, to_file_quoted, special_flags);
 
       int sysp = in_system_header_at (src_loc);
       if (sysp == 2)
-	fputs (" 3 4", stream);
+	pp_puts (" 3 4");
       else if (sysp == 1)
-	fputs (" 3", stream);
+	pp_puts (" 3");
 
-      putc ('\n', stream);
+      pp_putc ('\n');
       emitted_line_marker = true;
     }
 
@@ -573,9 +742,12 @@ static bool
 print_line (location_t src_loc, const char *special_flags)
 {
     if (cpp_get_options (parse_in)->debug)
-      linemap_dump_location (line_table, src_loc,
-			     print.outf);
-    return print_line_1 (src_loc, special_flags, print.outf);
+      {
+	flush_pp_output ();
+	linemap_dump_location (line_table, src_loc,
+			       print.outf);
+      }
+    return print_line_1 (src_loc, special_flags);
 }
 
 /* Helper function for cb_line_change and scan_translation_unit.
@@ -610,7 +782,7 @@ do_line_change (cpp_reader *pfile, const cpp_token *token,
       print.printed = true;
 
       while (-- spaces >= 0)
-	putc (' ', print.outf);
+	pp_putc (' ');
     }
 
   return emitted_line_marker;
@@ -630,7 +802,7 @@ cb_ident (cpp_reader *pfile ATTRIBUTE_UNUSED, location_t line,
 	  const cpp_string *str)
 {
   maybe_print_line (line);
-  fprintf (print.outf, "#ident %s\n", str->text);
+  pp_printf ("#ident %s\n", str->text);
   print.src_line++;
 }
 
@@ -640,16 +812,15 @@ cb_define (cpp_reader *pfile, location_t line, cpp_hashnode *node)
   const line_map_ordinary *map;
 
   maybe_print_line (line);
-  fputs ("#define ", print.outf);
+  pp_puts ("#define ");
 
   /* 'D' is whole definition; 'N' is name only.  */
   if (flag_dump_macros == 'D')
-    fputs ((const char *) cpp_macro_definition (pfile, node),
-	   print.outf);
+    pp_puts ((const char *) cpp_macro_definition (pfile, node));
   else
-    fputs ((const char *) NODE_NAME (node), print.outf);
+    pp_puts ((const char *) NODE_NAME (node));
 
-  putc ('\n', print.outf);
+  pp_putc ('\n');
   print.printed = false;
   linemap_resolve_location (line_table, line,
 			    LRK_MACRO_DEFINITION_LOCATION,
@@ -663,7 +834,7 @@ cb_undef (cpp_reader *pfile, location_t line, cpp_hashnode *node)
   if (lang_hooks.preprocess_undef)
     lang_hooks.preprocess_undef (pfile, line, node);
   maybe_print_line (line);
-  fprintf (print.outf, "#undef %s\n", NODE_NAME (node));
+  pp_printf ("#undef %s\n", NODE_NAME (node));
   print.src_line++;
 }
 
@@ -698,10 +869,12 @@ dump_queued_macros (cpp_reader *pfile ATTRIBUTE_UNUSED)
 {
   macro_queue *q;
 
+  print_queued_file_changes ();
+
   /* End the previous line of text.  */
   if (print.printed)
     {
-      putc ('\n', print.outf);
+      pp_putc ('\n');
       print.src_line++;
       print.printed = false;
     }
@@ -709,9 +882,9 @@ dump_queued_macros (cpp_reader *pfile ATTRIBUTE_UNUSED)
   for (q = define_queue; q;)
     {
       macro_queue *oq;
-      fputs ("#define ", print.outf);
-      fputs (q->macro, print.outf);
-      putc ('\n', print.outf);
+      pp_puts ("#define ");
+      pp_puts (q->macro);
+      pp_putc ('\n');
       print.printed = false;
       print.src_line++;
       oq = q;
@@ -723,7 +896,7 @@ dump_queued_macros (cpp_reader *pfile ATTRIBUTE_UNUSED)
   for (q = undef_queue; q;)
     {
       macro_queue *oq;
-      fprintf (print.outf, "#undef %s\n", q->macro);
+      pp_printf ("#undef %s\n", q->macro);
       print.src_line++;
       oq = q;
       q = q->next;
@@ -740,22 +913,22 @@ cb_include (cpp_reader *pfile ATTRIBUTE_UNUSED, location_t line,
 {
   maybe_print_line (line);
   if (angle_brackets)
-    fprintf (print.outf, "#%s <%s>", dir, header);
+    pp_printf ("#%s <%s>", dir, header);
   else
-    fprintf (print.outf, "#%s \"%s\"", dir, header);
+    pp_printf ("#%s \"%s\"", dir, header);
 
   if (comments != NULL)
     {
       while (*comments != NULL)
 	{
 	  if ((*comments)->flags & PREV_WHITE)
-	    putc (' ', print.outf);
-	  cpp_output_token (*comments, print.outf);
+	    pp_putc (' ');
+	  pp_output_token (*comments);
 	  ++comments;
 	}
     }
 
-  putc ('\n', print.outf);
+  pp_putc ('\n');
   print.printed = false;
   print.src_line++;
 }
@@ -774,7 +947,7 @@ pp_dir_change (cpp_reader *pfile ATTRIBUTE_UNUSED, const char *dir)
   /* cpp_quote_string does not nul-terminate, so we have to do it ourselves.  */
   p = cpp_quote_string (to_file_quoted, (const unsigned char *) dir, to_file_len);
   *p = '\0';
-  fprintf (print.outf, "# 1 \"%s//\"\n", to_file_quoted);
+  pp_printf ("# 1 \"%s//\"\n", to_file_quoted);
 }
 
 /* The file name, line number or system header flags have changed, as
@@ -783,43 +956,108 @@ pp_dir_change (cpp_reader *pfile ATTRIBUTE_UNUSED, const char *dir)
 void
 pp_file_change (const line_map_ordinary *map)
 {
-  const char *flags = "";
-
   if (flag_no_line_commands)
     return;
 
   if (map != NULL)
     {
+      file_change change;
+
+      change.reason = map->reason;
+      change.start_location = map->start_location;
+      change.included_from = linemap_included_from (map);
       input_location = map->start_location;
       if (print.first_time)
 	{
 	  /* Avoid printing foo.i when the main file is foo.c.  */
 	  if (!cpp_get_options (parse_in)->preprocessed)
-	    print_line (map->start_location, flags);
+	    print_line (map->start_location, "");
 	  print.first_time = 0;
 	}
+      else if (flag_compact_line_markers)
+	queue_file_change (change);
       else
-	{
-	  /* Bring current file to correct line when entering a new file.  */
-	  if (map->reason == LC_ENTER)
-	    {
-	      maybe_print_line (linemap_included_from (map));
-	      flags = " 1";
-	    }
-	  else if (map->reason == LC_LEAVE)
-	    flags = " 2";
-	  print_line (map->start_location, flags);
-	}
+	print_file_change (change);
     }
 }
 
+/* Output the line marker for CHANGE.  */
+
+static void
+print_file_change (const file_change &change)
+{
+  const char *flags = "";
+
+  /* Bring current file to correct line when entering a new file.  */
+  if (change.reason == LC_ENTER)
+    {
+      maybe_print_line (change.included_from);
+      flags = " 1";
+    }
+  else if (change.reason == LC_LEAVE)
+    flags = " 2";
+  print_line (change.start_location, flags);
+}
+
+/* Queue CHANGE, for its line marker to be output only once something
+   follows it.  Line markers that nothing depends on are dropped from
+   the queue instead: those for entering and leaving a file with nothing
+   in it to output, and those for a renaming superseded by another file
+   change.  */
+
+static void
+queue_file_change (const file_change &change)
+{
+  /* A renaming only changes the name and line that the next marker
+     gives anyway.  */
+  while (!print.queued_changes.is_empty ()
+	 && print.queued_changes.last ().reason != LC_ENTER
+	 && print.queued_changes.last ().reason != LC_LEAVE)
+    print.queued_changes.pop ();
+
+  if (change.reason == LC_LEAVE
+      && !print.queued_changes.is_empty ()
+      && print.queued_changes.last ().reason == LC_ENTER)
+    print.queued_changes.pop ();
+  else
+    print.queued_changes.safe_push (change);
+}
+
+/* Output the line markers queued by queue_file_change.  */
+
+static void
+print_queued_file_changes_1 (void)
+{
+  /* Take the queue, as print_file_change looks at it too.  */
+  vec<file_change> changes = print.queued_changes;
+  file_change change;
+  unsigned int i;
+
+  print.queued_changes = vNULL;
+  FOR_EACH_VEC_ELT (changes, i, change)
+    print_file_change (change);
+  changes.release ();
+}
+
 /* Copy a #pragma directive to the preprocessed output.  */
 static void
 cb_def_pragma (cpp_reader *pfile, location_t line)
 {
+  const cpp_token *token;
+
   maybe_print_line (line);
-  fputs ("#pragma ", print.outf);
-  cpp_output_line (pfile, print.outf);
+  pp_puts ("#pragma ");
+
+  /* Output the rest of the line as cpp_output_line would.  */
+  token = cpp_get_token (pfile);
+  while (token->type != CPP_EOF)
+    {
+      pp_output_token (token);
+      token = cpp_get_token (pfile);
+      if (token->flags & PREV_WHITE)
+	pp_putc (' ');
+    }
+  pp_putc ('\n');
   print.printed = false;
   print.src_line++;
 }
@@ -840,10 +1078,10 @@ dump_macro (cpp_reader *pfile, cpp_hashnode *node, void *v ATTRIBUTE_UNUSED)
 {
   if (cpp_user_macro_p (node))
     {
-      fputs ("#define ", print.outf);
-      fputs ((const char *) cpp_macro_definition (pfile, node),
-	     print.outf);
-      putc ('\n', print.outf);
+      print_queued_file_changes ();
+      pp_puts ("#define ");
+      pp_puts ((const char *) cpp_macro_definition (pfile, node));
+      pp_putc ('\n');
       print.printed = false;
       print.src_line++;
     }
@@ -861,7 +1099,8 @@ cb_read_pch (cpp_reader *pfile, const char *name,
 {
   c_common_read_pch (pfile, name, fd, orig_name);
 
-  fprintf (print.outf, "#pragma GCC pch_preprocess \"%s\"\n", name);
+  print_queued_file_changes ();
+  pp_printf ("#pragma GCC pch_preprocess \"%s\"\n", name);
   print.src_line++;
 
   /* The process of reading the PCH has destroyed the frontend parser,
@@ -887,7 +887,7 @@ struct GTY((tag ("SYMTAB_FUNCTION"))) cgraph_node : public symtab_node
       inlined_to (NULL), rtl (NULL),
       count (profile_count::uninitialized ()),
       count_materialization_scale (REG_BR_PROB_BASE), profile_id (0),
-      unit_id (0), tp_first_run (0), thunk (false),
+      unit_id (0), tp_first_run (0), text_sorted_order (0), thunk (false),
       used_as_abstract_origin (false),
       lowered (false), process (false), frequency (NODE_FREQUENCY_NORMAL),
       only_called_at_startup (false), only_called_at_exit (false),
@@ -1431,6 +1431,9 @@ struct GTY((tag ("SYMTAB_FUNCTION"))) cgraph_node : public symtab_node
   int unit_id;
   /* Time profiler: first run of function.  */
   int tp_first_run;
+  /* Position of the function in the order computed by
+     -freorder-functions-algorithm=call-chain-clustering, or 0.  */
+  int text_sorted_order;
 
   /* True when symbol is a thunk.  */
   unsigned thunk : 1;
@@ -2599,6 +2602,7 @@ cgraph_inline_failed_type_t cgraph_inline_failed_type (cgraph_inline_failed_t);
 /* In cgraphunit.cc  */
 void cgraphunit_cc_finalize (void);
 int tp_first_run_node_cmp (const void *pa, const void *pb);
+int text_sorted_order_node_cmp (const void *pa, const void *pb);
 
 /* In symtab-thunks.cc  */
 void symtab_thunks_cc_finalize (void);
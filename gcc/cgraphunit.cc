@@ -1947,6 +1947,28 @@ tp_first_run_node_cmp (const void *pa, const void *pb)
   return tp_first_run_a - tp_first_run_b;
 }
 
+/* Node comparator that puts the functions placed by call chain
+   clustering first, in the order it computed, and orders the others
+   as tp_first_run_node_cmp does.  */
+
+int
+text_sorted_order_node_cmp (const void *pa, const void *pb)
+{
+  const cgraph_node *a = *(const cgraph_node * const *) pa;
+  const cgraph_node *b = *(const cgraph_node * const *) pb;
+  unsigned int text_sorted_order_a = a->no_reorder ? 0 : a->text_sorted_order;
+  unsigned int text_sorted_order_b = b->no_reorder ? 0 : b->text_sorted_order;
+
+  if (text_sorted_order_a == text_sorted_order_b)
+    return tp_first_run_node_cmp (pa, pb);
+
+  /* Functions placed by call chain clustering go first.  */
+  text_sorted_order_a = (text_sorted_order_a - 1) & INT_MAX;
+  text_sorted_order_b = (text_sorted_order_b - 1) & INT_MAX;
+
+  return text_sorted_order_a - text_sorted_order_b;
+}
+
 /* Expand all functions that must be output.
 
    Attempt to topologically sort the nodes so function is output when
@@ -1977,16 +1999,18 @@ expand_all_functions (void)
   for (i = 0; i < order_pos; i++)
     if (order[i]->process)
       {
-	if (order[i]->tp_first_run
-	    && opt_for_fn (order[i]->decl, flag_profile_reorder_functions))
+	if ((order[i]->tp_first_run
+	     && opt_for_fn (order[i]->decl, flag_profile_reorder_functions))
+	    || order[i]->text_sorted_order)
 	  tp_first_run_order[tp_first_run_order_pos++] = order[i];
 	else
           order[new_order_pos++] = order[i];
       }
 
-  /* First output functions with time profile in specified order.  */
+  /* First output functions with time profile or placed by call chain
+     clustering in specified order.  */
   qsort (tp_first_run_order, tp_first_run_order_pos,
-	 sizeof (cgraph_node *), tp_first_run_node_cmp);
+	 sizeof (cgraph_node *), text_sorted_order_node_cmp);
   for (i = 0; i < tp_first_run_order_pos; i++)
     {
       node = tp_first_run_order[i];
@@ -1996,7 +2020,11 @@ expand_all_functions (void)
 	  expanded_func_count++;
 	  profiled_func_count++;
 
-	  if (symtab->dump_file)
+	  if (symtab->dump_file && node->text_sorted_order)
+	    fprintf (symtab->dump_file,
+		     "Call chain clustering order in expand_all_functions:%s:%d\n",
+		     node->dump_asm_name (), node->text_sorted_order);
+	  else if (symtab->dump_file)
 	    fprintf (symtab->dump_file,
 		     "Time profile order in expand_all_functions:%s:%d\n",
 		     node->dump_asm_name (), node->tp_first_run);
@@ -91,6 +91,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "print-rtl.h"
 #include "function-abi.h"
 #include "rtlanal.h"
+#include "rtlhash.h"
 
 /* Number of attempts to combine instructions in this function.  */
 
@@ -401,6 +402,49 @@ static struct undobuf undobuf;
 
 static int n_occurrences;
 
+/* The shape of a pattern recog failed to match, as computed by
+   inchash::add_rtx_shape.  */
+
+struct recog_shape
+{
+  hashval_t hash;
+  unsigned int len;
+  const HOST_WIDE_INT *words;
+};
+
+struct recog_shape_hasher : nofree_ptr_hash <recog_shape>
+{
+  static inline hashval_t hash (const recog_shape *);
+  static inline bool equal (const recog_shape *, const recog_shape *);
+};
+
+inline hashval_t
+recog_shape_hasher::hash (const recog_shape *shape)
+{
+  return shape->hash;
+}
+
+inline bool
+recog_shape_hasher::equal (const recog_shape *a, const recog_shape *b)
+{
+  return (a->len == b->len
+	  && !memcmp (a->words, b->words, a->len * sizeof (HOST_WIDE_INT)));
+}
+
+/* Patterns that recog failed to match in the current function.  Most
+   combination attempts fail and the same shapes come back again and
+   again, so combine_recog rejects these without running the recognizer.
+   The table is per function since insn conditions can depend on the
+   function's target and optimization options.  NULL when disabled.  */
+
+static hash_table<recog_shape_hasher> *recog_failures;
+static struct obstack recog_failure_obstack;
+
+/* Number of lookups in, and hits of, recog_failures.  */
+
+static int recog_cache_lookups;
+static int recog_cache_hits;
+
 static rtx reg_nonzero_bits_for_combine (const_rtx, scalar_int_mode,
 					 scalar_int_mode,
 					 unsigned HOST_WIDE_INT *);
@@ -1137,6 +1181,14 @@ combine_instructions (rtx_insn *f, unsigned int nregs)
 
   init_recog_no_volatile ();
 
+  recog_cache_lookups = 0;
+  recog_cache_hits = 0;
+  if (param_combine_recog_cache_size)
+    {
+      recog_failures = new hash_table<recog_shape_hasher> (256);
+      gcc_obstack_init (&recog_failure_obstack);
+    }
+
   /* Allocate array for insn info.  */
   max_uid_known = get_max_uid ();
   uid_log_links = XCNEWVEC (struct insn_link *, max_uid_known + 1);
@@ -1438,6 +1490,12 @@ retry:
 
   /* Clean up.  */
   obstack_free (&insn_link_obstack, NULL);
+  if (recog_failures)
+    {
+      delete recog_failures;
+      recog_failures = NULL;
+      obstack_free (&recog_failure_obstack, NULL);
+    }
   free (uid_log_links);
   free (uid_insn_cost);
   reg_stat.release ();
@@ -1456,6 +1514,8 @@ retry:
   statistics_counter_event (cfun, "merges", combine_merges);
   statistics_counter_event (cfun, "extras", combine_extras);
   statistics_counter_event (cfun, "successes", combine_successes);
+  statistics_counter_event (cfun, "recog cache lookups", recog_cache_lookups);
+  statistics_counter_event (cfun, "recog cache hits", recog_cache_hits);
 
   nonzero_sign_valid = 0;
   rtl_hooks = general_rtl_hooks;
@@ -11381,6 +11441,60 @@ simplify_shift_const (rtx x, enum rtx_code code, machine_mode result_mode,
   return x;
 }
 
+/* Like recog, but reject PAT at once if a pattern of the same shape has
+   already failed to match in this function, and remember PAT if it fails.
+   Only the outcome of recog itself is cached: whatever recog_for_combine_1
+   checks afterwards depends on where INSN is.  */
+
+static int
+combine_recog (rtx pat, rtx_insn *insn, int *pnum_clobbers)
+{
+  if (!recog_failures)
+    return recog (pat, insn, pnum_clobbers);
+
+  inchash::hash hstate;
+  auto_vec<HOST_WIDE_INT, 64> words;
+  auto_vec<unsigned int, 8> pseudos;
+  inchash::add_rtx_shape (pat, hstate, &words, &pseudos);
+
+  /* Predicates can look at the known alignment of pointer pseudos, and
+     insn conditions at whether the block is optimized for speed.  */
+  for (unsigned int regno : pseudos)
+    {
+      hstate.add_int (REGNO_POINTER_ALIGN (regno));
+      words.safe_push (REGNO_POINTER_ALIGN (regno));
+    }
+  hstate.add_flag (optimize_insn_for_speed_p ());
+  words.safe_push (optimize_insn_for_speed_p ());
+
+  recog_shape shape = { hstate.end (), words.length (), words.address () };
+  recog_cache_lookups++;
+  if (recog_failures->find (&shape))
+    {
+      recog_cache_hits++;
+      return -1;
+    }
+
+  timevar_push (TV_COMBINE_RECOG);
+  int insn_code_number = recog (pat, insn, pnum_clobbers);
+  timevar_pop (TV_COMBINE_RECOG);
+
+  if (insn_code_number < 0
+      && recog_failures->elements () < (size_t) param_combine_recog_cache_size)
+    {
+      recog_shape *copy = XOBNEW (&recog_failure_obstack, recog_shape);
+      *copy = shape;
+      copy->words
+	= (const HOST_WIDE_INT *) obstack_copy (&recog_failure_obstack,
+						words.address (),
+						words.length ()
+						* sizeof (HOST_WIDE_INT));
+      *recog_failures->find_slot (copy, INSERT) = copy;
+    }
+
+  return insn_code_number;
+}
+
 
 /* A subroutine of recog_for_combine.  See there for arguments and
    return value.  */
@@ -11411,7 +11525,7 @@ recog_for_combine_1 (rtx *pnewpat, rtx_insn *insn, rtx *pnotes)
   PATTERN (insn) = pat;
   REG_NOTES (insn) = NULL_RTX;
 
-  insn_code_number = recog (pat, insn, &num_clobbers_to_add);
+  insn_code_number = combine_recog (pat, insn, &num_clobbers_to_add);
   if (dump_file && (dump_flags & TDF_DETAILS))
     {
       if (insn_code_number < 0)
@@ -11445,7 +11559,7 @@ recog_for_combine_1 (rtx *pnewpat, rtx_insn *insn, rtx *pnotes)
 	pat = XVECEXP (pat, 0, 0);
 
       PATTERN (insn) = pat;
-      insn_code_number = recog (pat, insn, &num_clobbers_to_add);
+      insn_code_number = combine_recog (pat, insn, &num_clobbers_to_add);
       if (dump_file && (dump_flags & TDF_DETAILS))
 	{
 	  if (insn_code_number < 0)
@@ -96,6 +96,7 @@ static unsigned fn_ctr_mask; /* Mask of counters used.  */
 static GTY(()) tree fn_v_ctrs[GCOV_COUNTERS];   /* counter variables.  */
 static unsigned fn_n_ctrs[GCOV_COUNTERS]; /* Counters allocated.  */
 static unsigned fn_b_ctrs[GCOV_COUNTERS]; /* Allocation base.  */
+static GTY(()) tree fn_shard_ctrs;   /* thread-local edge counter shard.  */
 
 /* Coverage info VAR_DECL and function info type nodes.  */
 static GTY(()) tree gcov_info_var;
@@ -130,7 +131,7 @@ static const char *const ctr_names[GCOV_COUNTERS] = {
 #undef DEF_GCOV_COUNTER
 
 /* Forward declarations.  */
-static tree build_var (tree, tree, int);
+static tree build_var (tree, tree, int, bool = false);
 
 /* Return the type node for gcov_type.  */
 
@@ -427,6 +428,21 @@ coverage_counter_alloc (unsigned counter, unsigned num)
 	= build_var (current_function_decl, array_type, counter);
     }
 
+  /* With -fprofile-update=sharded each thread increments its own copy
+     of the edge counters, which libgcov adds to the shared ones when the
+     thread exits and when the profile is dumped.  */
+  if (counter == GCOV_COUNTER_ARCS
+      && flag_profile_update == PROFILE_UPDATE_SHARDED
+      && !fn_shard_ctrs)
+    {
+      tree array_type = build_array_type (get_gcov_type (), NULL_TREE);
+
+      fn_shard_ctrs
+	= build_var (current_function_decl, array_type, counter, true);
+      set_decl_tls_model (fn_shard_ctrs,
+			  decl_default_tls_model (fn_shard_ctrs));
+    }
+
   fn_b_ctrs[counter] = fn_n_ctrs[counter];
   fn_n_ctrs[counter] += num;
   
@@ -450,6 +466,24 @@ tree_coverage_counter_ref (unsigned counter, unsigned no)
 		 build_int_cst (integer_type_node, no), NULL, NULL);
 }
 
+/* Generate a tree to access the thread-local shard of edge counter NO.
+   NO may be one past the last edge counter, which is the element libgcov
+   uses to record that the current thread registered the shard.  */
+
+tree
+tree_coverage_shard_ref (unsigned no)
+{
+  tree gcov_type_node = get_gcov_type ();
+
+  gcc_assert (fn_shard_ctrs
+	      && fn_b_ctrs[GCOV_COUNTER_ARCS] == 0
+	      && no <= fn_n_ctrs[GCOV_COUNTER_ARCS]);
+
+  /* "no" here is an array index, scaled to bytes later.  */
+  return build4 (ARRAY_REF, gcov_type_node, fn_shard_ctrs,
+		 build_int_cst (integer_type_node, no), NULL, NULL);
+}
+
 /* Generate a tree to access the address of COUNTER NO.  */
 
 tree
@@ -728,6 +762,18 @@ coverage_end_function (unsigned lineno_checksum, unsigned cfg_checksum)
 	      varpool_node::finalize_decl (var);
 	    }
 	  
+	  if (i == GCOV_COUNTER_ARCS && fn_shard_ctrs)
+	    {
+	      tree var = fn_shard_ctrs;
+	      tree array_type = build_index_type (size_int (fn_n_ctrs[i]));
+	      array_type = build_array_type (get_gcov_type (), array_type);
+	      TREE_TYPE (var) = array_type;
+	      DECL_SIZE (var) = TYPE_SIZE (array_type);
+	      DECL_SIZE_UNIT (var) = TYPE_SIZE_UNIT (array_type);
+	      varpool_node::finalize_decl (var);
+	      fn_shard_ctrs = NULL_TREE;
+	    }
+
 	  fn_b_ctrs[i] = fn_n_ctrs[i] = 0;
 	  fn_v_ctrs[i] = NULL_TREE;
 	}
@@ -749,10 +795,11 @@ coverage_remove_note_file (void)
 }
 
 /* Build a coverage variable of TYPE for function FN_DECL.  If COUNTER
-   >= 0 it is a counter array, otherwise it is the function structure.  */
+   >= 0 it is a counter array, otherwise it is the function structure.
+   SHARD selects the thread-local shard of the counter array.  */
 
 static tree
-build_var (tree fn_decl, tree type, int counter)
+build_var (tree fn_decl, tree type, int counter, bool shard)
 {
   tree var = build_decl (BUILTINS_LOCATION, VAR_DECL, NULL_TREE, type);
   const char *fn_name = IDENTIFIER_POINTER (DECL_ASSEMBLER_NAME (fn_decl));
@@ -761,10 +808,12 @@ build_var (tree fn_decl, tree type, int counter)
 
   fn_name = targetm.strip_name_encoding (fn_name);
   fn_name_len = strlen (fn_name);
-  buf = XALLOCAVEC (char, fn_name_len + 8 + sizeof (int) * 3);
+  buf = XALLOCAVEC (char, fn_name_len + 14 + sizeof (int) * 3);
 
   if (counter < 0)
     strcpy (buf, "__gcov__");
+  else if (shard)
+    sprintf (buf, "__gcov%u_shard_", counter);
   else
     sprintf (buf, "__gcov%u_", counter);
   len = strlen (buf);
@@ -48,6 +48,8 @@ extern int coverage_counter_alloc (unsigned /*counter*/, unsigned/*num*/);
 extern tree tree_coverage_counter_ref (unsigned /*counter*/, unsigned/*num*/);
 /* Use a counter address from the most recent allocation.  */
 extern tree tree_coverage_counter_addr (unsigned /*counter*/, unsigned/*num*/);
+/* Use the thread-local shard of an edge counter.  */
+extern tree tree_coverage_shard_ref (unsigned/*num*/);
 
 /* Get all the counters for the current function.  */
 extern gcov_type *get_coverage_counts (unsigned /*counter*/,
@@ -3716,6 +3716,10 @@ df_note_compute (bitmap all_blocks)
   bitmap_initialize (&live, &df_bitmap_obstack);
   bitmap_initialize (&do_not_gen, &df_bitmap_obstack);
   bitmap_initialize (&artificial_uses, &df_bitmap_obstack);
+  /* The registers live within a block are mostly clustered, and each insn
+     tests and updates single bits of LIVE and DO_NOT_GEN.  */
+  bitmap_dense_view (&live);
+  bitmap_dense_view (&do_not_gen);
 
   EXECUTE_IF_SET_IN_BITMAP (all_blocks, 0, bb_index, bi)
   {
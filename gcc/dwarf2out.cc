@@ -75,6 +75,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "version.h"
 #include "flags.h"
 #include "rtlhash.h"
+#include "group-hash-table.h"
 #include "reload.h"
 #include "output.h"
 #include "expr.h"
@@ -231,9 +232,9 @@ struct indirect_string_hasher : ggc_ptr_hash<indirect_string_node>
   static bool equal (indirect_string_node *, const char *);
 };
 
-static GTY (()) hash_table<indirect_string_hasher> *debug_str_hash;
+static GTY (()) group_hash_table<indirect_string_hasher> *debug_str_hash;
 
-static GTY (()) hash_table<indirect_string_hasher> *debug_line_str_hash;
+static GTY (()) group_hash_table<indirect_string_hasher> *debug_line_str_hash;
 
 /* With split_debug_info, both the comp_dir and dwo_name go in the
    main object file, rather than the dwo, similar to the force_direct
@@ -254,7 +255,8 @@ static GTY (()) hash_table<indirect_string_hasher> *debug_line_str_hash;
    main object file.  This limits the complexity to just the places
    that need it.  */
 
-static GTY (()) hash_table<indirect_string_hasher> *skeleton_debug_str_hash;
+static GTY (()) group_hash_table<indirect_string_hasher>
+  *skeleton_debug_str_hash;
 
 static GTY(()) int dw2_string_counter;
 
@@ -4738,7 +4740,7 @@ indirect_string_hasher::equal (indirect_string_node *x1, const char *x2)
 
 static struct indirect_string_node *
 find_AT_string_in_table (const char *str,
-			 hash_table<indirect_string_hasher> *table,
+			 group_hash_table<indirect_string_hasher> *table,
 			 enum insert_option insert = INSERT)
 {
   struct indirect_string_node *node;
@@ -4764,7 +4766,7 @@ static struct indirect_string_node *
 find_AT_string (const char *str, enum insert_option insert = INSERT)
 {
   if (! debug_str_hash)
-    debug_str_hash = hash_table<indirect_string_hasher>::create_ggc (10);
+    debug_str_hash = group_hash_table<indirect_string_hasher>::create_ggc (10);
 
   return find_AT_string_in_table (str, debug_str_hash, insert);
 }
@@ -4859,7 +4861,7 @@ add_filepath_AT_string (dw_die_ref die, enum dwarf_attribute attr_kind,
 
       if (!debug_line_str_hash)
 	debug_line_str_hash
-	  = hash_table<indirect_string_hasher>::create_ggc (10);
+	  = group_hash_table<indirect_string_hasher>::create_ggc (10);
 
       node = find_AT_string_in_table (str, debug_line_str_hash);
       set_indirect_string (node);
@@ -11388,7 +11390,7 @@ add_skeleton_AT_string (dw_die_ref die, enum dwarf_attribute attr_kind,
 
   if (! skeleton_debug_str_hash)
     skeleton_debug_str_hash
-      = hash_table<indirect_string_hasher>::create_ggc (10);
+      = group_hash_table<indirect_string_hasher>::create_ggc (10);
 
   node = find_AT_string_in_table (str, skeleton_debug_str_hash);
   find_string_form (node);
@@ -12562,7 +12564,7 @@ output_line_string (enum dwarf_form form, const char *str,
     case DW_FORM_line_strp:
       if (!debug_line_str_hash)
 	debug_line_str_hash
-	  = hash_table<indirect_string_hasher>::create_ggc (10);
+	  = group_hash_table<indirect_string_hasher>::create_ggc (10);
 
       struct indirect_string_node *node;
       node = find_AT_string_in_table (str, debug_line_str_hash);
@@ -32272,7 +32274,7 @@ adjust_name_comp_dir (dw_die_ref die)
 
       if (!debug_line_str_hash)
 	debug_line_str_hash
-	  = hash_table<indirect_string_hasher>::create_ggc (10);
+	  = group_hash_table<indirect_string_hasher>::create_ggc (10);
 
       struct indirect_string_node *node
 	= find_AT_string_in_table (a->dw_attr_val.v.val_str->str,
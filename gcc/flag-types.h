@@ -260,6 +260,28 @@ enum callgraph_info_type
   CALLGRAPH_INFO_DYNAMIC_ALLOC = 4
 };
 
+/* The algorithm used to order functions.  */
+enum reorder_functions_algorithm
+{
+  /* Order functions by the time they were first run
+     (-fprofile-reorder-functions), then in call graph order.  */
+  REORDER_FUNCTIONS_ALGORITHM_FIRST_RUN = 0,
+
+  /* Cluster callers with their hottest callees.  */
+  REORDER_FUNCTIONS_ALGORITHM_CALL_CHAIN_CLUSTERING = 1
+};
+
+/* Format of the optimization records written by
+   -fsave-optimization-record.  */
+enum optrecord_format
+{
+  /* A single JSON document, written at the end of the compile.  */
+  OPTRECORD_FORMAT_JSON = 0,
+
+  /* One JSON value per line, written as the records are made.  */
+  OPTRECORD_FORMAT_JSONL = 1
+};
+
 /* Floating-point contraction mode.  */
 enum fp_contract_mode {
   FP_CONTRACT_OFF = 0,
@@ -43,6 +43,7 @@ compilation is specified by a string called a "spec".  */
 #include "flags.h"
 #include "opts.h"
 #include "filenames.h"
+#include "md5.h"
 #include "spellcheck.h"
 #include "opts-jobserver.h"
 #include "common/common-target.h"
@@ -455,10 +456,12 @@ static const char *debug_level_greater_than_spec_func (int, const char **);
 static const char *dwarf_version_greater_than_spec_func (int, const char **);
 static const char *find_fortran_preinclude_file (int, const char **);
 static const char *join_spec_func (int, const char **);
+static const char *depfile_digests_key_spec_func (int, const char **);
 static char *convert_white_space (char *);
 static char *quote_spec (char *);
 static char *quote_spec_arg (char *);
 static bool not_actual_file_p (const char *);
+static bool depfile_digests_fresh_p (void);
 
 
 /* The Specs Language
@@ -1250,7 +1253,8 @@ static const char *cpp_unique_options =
  %{H} %C %{D*&U*&A*} %{i*} %Z %i\
  %{E|M|MM:%W{o*}}\
  %{fdeps-format=*:%{!fdeps-file=*:-fdeps-file=%:join(%{!o:%b.ddi}%{o*:%.ddi%*})}}\
- %{fdeps-format=*:%{!fdeps-target=*:-fdeps-target=%:join(%{!o:%b.o}%{o*:%.o%*})}}";
+ %{fdeps-format=*:%{!fdeps-target=*:-fdeps-target=%:join(%{!o:%b.o}%{o*:%.o%*})}}\
+ %{fdepfile-digests:%{c:%{MD|MMD:%:depfile-digests-key()}}}";
 
 /* This contains cpp options which are common with cc1_options and are passed
    only when preprocessing only to avoid duplication.  We pass the cc1 spec
@@ -1768,6 +1772,7 @@ static const struct spec_function static_spec_functions[] =
   { "dwarf-version-gt",		dwarf_version_greater_than_spec_func },
   { "fortran-preinclude-file",	find_fortran_preinclude_file},
   { "join",			join_spec_func},
+  { "depfile-digests-key",	depfile_digests_key_spec_func},
 #ifdef EXTRA_SPEC_FUNCTIONS
   EXTRA_SPEC_FUNCTIONS
 #endif
@@ -9034,7 +9039,16 @@ driver::do_spec_on_infiles () const
 		  debug_check_temp_file[1] = NULL;
 		}
 
-	      value = do_spec (input_file_compiler->spec);
+	      if (depfile_digests_fresh_p ())
+		{
+		  if (verbose_flag)
+		    inform (UNKNOWN_LOCATION,
+			    "%s: dependencies unchanged, not recompiling",
+			    gcc_input_filename);
+		  value = 0;
+		}
+	      else
+		value = do_spec (input_file_compiler->spec);
 	      infiles[i].compiled = true;
 	      if (value < 0)
 		this_file_error = 1;
@@ -11069,6 +11083,214 @@ join_spec_func (int argc, const char **argv)
   return XOBFINISH (&obstack, const char *);
 }
 
+/* Return the key of the compilation of the current input file for
+   -fdepfile-digests, in hex.  It covers everything besides the
+   contents of the dependencies and of the compiler binary that the
+   output might depend on: the compiler version, the command line, the
+   specs as -specs= and the specs files left them, the working
+   directory and the environment variables that affect the
+   compilation.  */
+
+static const char *
+depfile_digests_key (void)
+{
+  static const char *const env_vars[] = {
+    "CPATH", "C_INCLUDE_PATH", "CPLUS_INCLUDE_PATH", "OBJC_INCLUDE_PATH",
+    "GCC_EXEC_PREFIX", "COMPILER_PATH", "SOURCE_DATE_EPOCH"
+  };
+  static char key[2 * 16 + 1];
+  unsigned char sum[16];
+  struct md5_ctx ctx;
+  const char *s;
+
+  md5_init_ctx (&ctx);
+  md5_process_bytes (version_string, strlen (version_string) + 1, &ctx);
+  md5_process_bytes (spec_machine, strlen (spec_machine) + 1, &ctx);
+  s = getpwd ();
+  if (s)
+    md5_process_bytes (s, strlen (s) + 1, &ctx);
+  md5_process_bytes (gcc_input_filename, strlen (gcc_input_filename) + 1,
+		     &ctx);
+  for (int i = 0; i < n_switches; i++)
+    {
+      md5_process_bytes ("-", 1, &ctx);
+      md5_process_bytes (switches[i].part1, strlen (switches[i].part1) + 1,
+			 &ctx);
+      if (switches[i].args)
+	for (const char **arg = switches[i].args; *arg; arg++)
+	  md5_process_bytes (*arg, strlen (*arg) + 1, &ctx);
+    }
+  for (struct spec_list *sl = specs; sl; sl = sl->next)
+    {
+      md5_process_bytes (sl->name, strlen (sl->name) + 1, &ctx);
+      if (*sl->ptr_spec)
+	md5_process_bytes (*sl->ptr_spec, strlen (*sl->ptr_spec) + 1, &ctx);
+    }
+  for (int i = 0; i < n_compilers; i++)
+    {
+      md5_process_bytes (compilers[i].suffix,
+			 strlen (compilers[i].suffix) + 1, &ctx);
+      if (compilers[i].spec)
+	md5_process_bytes (compilers[i].spec,
+			   strlen (compilers[i].spec) + 1, &ctx);
+      if (compilers[i].cpp_spec)
+	md5_process_bytes (compilers[i].cpp_spec,
+			   strlen (compilers[i].cpp_spec) + 1, &ctx);
+    }
+  for (unsigned i = 0; i < ARRAY_SIZE (env_vars); i++)
+    {
+      s = env.get (env_vars[i]);
+      md5_process_bytes (env_vars[i], strlen (env_vars[i]) + 1, &ctx);
+      if (s)
+	md5_process_bytes (s, strlen (s) + 1, &ctx);
+    }
+  md5_finish_ctx (&ctx, sum);
+
+  for (unsigned i = 0; i < sizeof (sum); i++)
+    sprintf (key + 2 * i, "%02x", sum[i]);
+  return key;
+}
+
+/* %:depfile-digests-key spec function.  Pass the key of the compilation
+   to the compiler, which records it together with the digests of the
+   dependencies in the .d.sum file.  */
+
+static const char *
+depfile_digests_key_spec_func (int argc, const char **argv ATTRIBUTE_UNUSED)
+{
+  if (argc != 0)
+    fatal_error (input_location,
+		 "too many arguments to %%:depfile-digests-key");
+
+  return concat ("-fdepfile-digests=", depfile_digests_key (), NULL);
+}
+
+/* Return true if the .d.sum file written by the last compilation of
+   the current input file with -fdepfile-digests shows that compiling it
+   again would produce the same object, so the existing one can be
+   reused.  That is the case if the last compilation had the same key,
+   the dependencies still have the recorded digests, the files it looked
+   for in the include path without finding them still do not exist, the
+   compiler that wrote the digests has not been modified since, and the
+   object was written after the digests were, so is known to be
+   complete.  The check of the files not found catches a header added
+   earlier in the include path than a dependency, or one that
+   #include_next or __has_include would now find.  Anything unexpected
+   means the input is compiled.  */
+
+static bool
+depfile_digests_fresh_p (void)
+{
+  struct stat sum_st, st;
+  char *sum_file, *obj_file, *buf = NULL, *p, *end;
+  const char *key;
+  bool fresh = false, have_compiler = false;
+  FILE *f;
+
+  /* The object is reused only for -c, and the digests only follow the
+     dependency file, whose name is determined as in cpp_unique_options.  */
+  do_spec_2 ("%{fdepfile-digests:%{c:%{!E:%{!S:%{!fsyntax-only:%{MD|MMD:"
+	     "%{MF*:%*;:%{!o:%b.d}%{o*:%.d%*}}}}}}}}", NULL);
+  do_spec_1 (" ", 0, NULL);
+  if (argbuf.is_empty ())
+    return false;
+  if (stat (argbuf.last (), &st) != 0)
+    return false;
+  sum_file = concat (argbuf.last (), ".sum", NULL);
+
+  do_spec_2 ("%{o*:%*;:%w%b%O}", NULL);
+  do_spec_1 (" ", 0, NULL);
+  if (argbuf.is_empty ())
+    {
+      free (sum_file);
+      return false;
+    }
+  obj_file = xstrdup (argbuf.last ());
+
+  f = fopen (sum_file, "rb");
+  if (!f)
+    goto done;
+  if (fstat (fileno (f), &sum_st) != 0
+      || stat (obj_file, &st) != 0
+      || st.st_mtime < sum_st.st_mtime)
+    {
+      fclose (f);
+      goto done;
+    }
+  buf = XNEWVEC (char, sum_st.st_size + 1);
+  if (fread (buf, 1, sum_st.st_size, f) != (size_t) sum_st.st_size)
+    {
+      fclose (f);
+      goto done;
+    }
+  fclose (f);
+  buf[sum_st.st_size] = '\0';
+  end = buf + sum_st.st_size;
+
+  /* The first line is "gcc-depfile-digests KEY", and each of the others
+     the digest in hex and the name of a dependency, dashes and the name
+     of a file that must not exist, or equals signs and the name of the
+     compiler.  */
+  key = depfile_digests_key ();
+  p = buf;
+  if (strncmp (p, "gcc-depfile-digests ", 20) != 0
+      || strncmp (p + 20, key, strlen (key)) != 0
+      || p[20 + strlen (key)] != '\n')
+    goto done;
+  p += 20 + strlen (key) + 1;
+  if (p == end)
+    goto done;
+
+  while (p < end)
+    {
+      char *nl = (char *) memchr (p, '\n', end - p);
+      unsigned char sum[16];
+      char hex[2 * 16 + 1];
+
+      if (!nl || nl - p <= (ptrdiff_t) sizeof (hex) || p[2 * 16] != ' ')
+	goto done;
+      *nl = '\0';
+      if (p[0] == '=')
+	{
+	  if (stat (p + sizeof (hex), &st) != 0
+	      || st.st_mtime >= sum_st.st_mtime)
+	    goto done;
+	  have_compiler = true;
+	  p = nl + 1;
+	  continue;
+	}
+      if (p[0] == '-')
+	{
+	  if (stat (p + sizeof (hex), &st) == 0
+	      || (errno != ENOENT && errno != ENOTDIR))
+	    goto done;
+	  p = nl + 1;
+	  continue;
+	}
+      f = fopen (p + sizeof (hex), "rb");
+      if (!f)
+	goto done;
+      if (md5_stream (f, sum) != 0)
+	{
+	  fclose (f);
+	  goto done;
+	}
+      fclose (f);
+      for (unsigned i = 0; i < sizeof (sum); i++)
+	sprintf (hex + 2 * i, "%02x", sum[i]);
+      if (memcmp (p, hex, 2 * 16) != 0)
+	goto done;
+      p = nl + 1;
+    }
+  fresh = have_compiler;
+
+ done:
+  free (buf);
+  free (obj_file);
+  free (sum_file);
+  return fresh;
+}
+
 /* If any character in ORIG fits QUOTE_P (_, P), reallocate the string
    so as to precede every one of them with a backslash.  Return the
    original string or the reallocated one.  */
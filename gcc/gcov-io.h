@@ -67,6 +67,14 @@ see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
 
 	filename-header : int32:magic int32:version string
 
+   A profile shard is written by each process instead of merging into
+   the data files when GCOV_PROFILE_SHARDS is set.  It is never read
+   back by the runtime, so it needs no locking; the merge-shards
+   subcommand of the gcov-tool folds shards into the data files.  Its
+   format is
+
+	shard : (filename-header file)*
+
    The magic ident is different for the notes and the data files as
    well as the filename header.  The magic ident is used to determine
    the endianness of the file, when reading.  The version is the same
@@ -231,6 +239,7 @@ typedef uint64_t gcov_type_unsigned;
 /* File suffixes.  */
 #define GCOV_DATA_SUFFIX ".gcda"
 #define GCOV_NOTE_SUFFIX ".gcno"
+#define GCOV_SHARD_SUFFIX ".gcsh"
 
 /* File magic. Must not be palindromes.  */
 #define GCOV_DATA_MAGIC ((gcov_unsigned_t)0x67636461) /* "gcda" */
@@ -273,8 +282,12 @@ typedef uint64_t gcov_type_unsigned;
 #define GCOV_TAG_PROGRAM_SUMMARY ((gcov_unsigned_t)0xa3000000) /* Obsolete */
 #define GCOV_TAG_AFDO_FILE_NAMES ((gcov_unsigned_t)0xaa000000)
 #define GCOV_TAG_AFDO_FUNCTION ((gcov_unsigned_t)0xac000000)
+#define GCOV_TAG_AFDO_MODULE_GROUPING ((gcov_unsigned_t)0xae000000)
 #define GCOV_TAG_AFDO_WORKING_SET ((gcov_unsigned_t)0xaf000000)
 
+/* The version of the AutoFDO profile format.  */
+#define AUTO_PROFILE_VERSION 2
+
 
 /* Counters that are collected.  */
 
@@ -23,6 +23,10 @@ a copy of the GCC Runtime Library Exception along with this program;
 see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
 <http://www.gnu.org/licenses/>.  */
 
+#define INCLUDE_ALGORITHM
+#define INCLUDE_MAP
+#define INCLUDE_STRING
+#define INCLUDE_VECTOR
 #include "config.h"
 #include "system.h"
 #include "coretypes.h"
@@ -31,6 +35,7 @@ see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
 #include "diagnostic.h"
 #include "version.h"
 #include "gcov-io.h"
+#include "backtrace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -43,11 +48,16 @@ see the files COPYING3 and COPYING.RUNTIME respectively.  If not, see
 extern struct gcov_info *gcov_profile_merge (struct gcov_info*,
 					     struct gcov_info*, int, int);
 extern struct gcov_info *gcov_profile_merge_stream (const char *, int, int);
+extern struct gcov_info *gcov_profile_fold_shards (const char *const *, int,
+						   char *);
+extern struct gcov_info *gcov_profile_merge_into_gcda (struct gcov_info *,
+						       int, int);
 extern int gcov_profile_overlap (struct gcov_info*, struct gcov_info*);
 extern int gcov_profile_normalize (struct gcov_info*, gcov_type);
 extern int gcov_profile_scale (struct gcov_info*, float, int, int);
 extern struct gcov_info* gcov_read_profile_dir (const char*, int);
-extern void gcov_do_dump (struct gcov_info *, int, int);
+extern int gcov_do_dump (struct gcov_info *, int, int);
+extern int gcov_dump_stream (struct gcov_info *, const char *);
 extern const char *gcov_get_filename (struct gcov_info *list);
 extern void gcov_set_verbose (void);
 
@@ -302,6 +312,269 @@ do_merge_stream (int argc, char **argv)
   return 0;
 }
 
+/* The profile shards collected for merge-shards.  */
+static const char **shard_files;
+static int n_shard_files;
+static int max_shard_files;
+
+/* Record NAME as a profile shard to be merged.  */
+
+static void
+add_shard_file (const char *name)
+{
+  if (n_shard_files == max_shard_files)
+    {
+      max_shard_files = max_shard_files ? max_shard_files * 2 : 64;
+      shard_files = XRESIZEVEC (const char *, shard_files, max_shard_files);
+    }
+  shard_files[n_shard_files++] = xstrdup (name);
+}
+
+#if HAVE_FTW_H
+
+/* Record file NAME if it has a shard suffix.  */
+
+static int
+collect_shard_file (const char *name,
+		    const struct stat *status ATTRIBUTE_UNUSED,
+		    int type)
+{
+  int len = strlen (name);
+  int len1 = strlen (GCOV_SHARD_SUFFIX);
+
+  if (type == FTW_F && len > len1
+      && !strcmp (name + len - len1, GCOV_SHARD_SUFFIX))
+    add_shard_file (name);
+
+  return 0;
+}
+#endif
+
+/* Fold the N profile shards in SHARD_FILES into one profile list, and set
+   FOLDED[I] to 1 if all of shard I went into it.  With more than one job,
+   the shards are split across JOBS worker processes; each writes its
+   partial sum to a temporary shard and which of its shards it folded to
+   a pipe, and the partial sums are folded here.  Workers are processes
+   rather than threads because the gcda reader keeps its state in
+   globals.  */
+
+static struct gcov_info *
+fold_shard_files (int n, int jobs, char *folded)
+{
+#ifdef HAVE_WORKING_FORK
+  if (jobs > 1 && n > jobs)
+    {
+      const char **partials = XNEWVEC (const char *, jobs);
+      char *partial_folded = XNEWVEC (char, jobs);
+      pid_t *pids = XNEWVEC (pid_t, jobs);
+      int *fds = XNEWVEC (int, jobs);
+      int n_partials = 0;
+
+      for (int j = 0; j < jobs; j++)
+	{
+	  int lo = (long) n * j / jobs;
+	  int hi = (long) n * (j + 1) / jobs;
+	  char *partial = make_temp_file (GCOV_SHARD_SUFFIX);
+	  int pipefd[2];
+
+	  if (pipe (pipefd) != 0)
+	    fatal_error (input_location, "cannot create pipe: %m");
+	  fflush (NULL);
+	  pid_t pid = fork ();
+	  if (pid < 0)
+	    fatal_error (input_location, "cannot fork: %m");
+	  if (pid == 0)
+	    {
+	      close (pipefd[0]);
+	      struct gcov_info *profile
+		= gcov_profile_fold_shards (shard_files + lo, hi - lo,
+					    folded + lo);
+	      if (profile && gcov_dump_stream (profile, partial))
+		_exit (FATAL_EXIT_CODE);
+	      if (write (pipefd[1], folded + lo, hi - lo) != hi - lo)
+		_exit (FATAL_EXIT_CODE);
+	      _exit (SUCCESS_EXIT_CODE);
+	    }
+	  close (pipefd[1]);
+	  pids[j] = pid;
+	  fds[j] = pipefd[0];
+	  partials[n_partials++] = partial;
+	}
+
+      for (int j = 0; j < jobs; j++)
+	{
+	  int lo = (long) n * j / jobs;
+	  int hi = (long) n * (j + 1) / jobs;
+	  int status;
+
+	  for (int i = lo; i < hi; )
+	    {
+	      ssize_t got = read (fds[j], folded + i, hi - i);
+	      if (got <= 0)
+		fatal_error (input_location,
+			     "shard merging worker %d failed", j);
+	      i += got;
+	    }
+	  close (fds[j]);
+	  if (waitpid (pids[j], &status, 0) < 0
+	      || !WIFEXITED (status)
+	      || WEXITSTATUS (status) != SUCCESS_EXIT_CODE)
+	    fatal_error (input_location, "shard merging worker %d failed", j);
+	}
+
+      struct gcov_info *profile
+	= gcov_profile_fold_shards (partials, n_partials, partial_folded);
+
+      /* A partial sum that does not match the others was left out, and
+	 with it all the shards of its worker.  */
+      for (int j = 0; j < n_partials; j++)
+	{
+	  if (!partial_folded[j])
+	    memset (folded + (long) n * j / jobs, 0,
+		    (long) n * (j + 1) / jobs - (long) n * j / jobs);
+	  unlink (partials[j]);
+	  free (CONST_CAST (char *, partials[j]));
+	}
+      free (partials);
+      free (partial_folded);
+      free (pids);
+      free (fds);
+      return profile;
+    }
+#endif
+
+  (void) jobs;
+  return gcov_profile_fold_shards (shard_files, n, folded);
+}
+
+/* Usage message for profile merge-shards.  */
+
+static void
+print_merge_shards_usage_message (int error_p)
+{
+  FILE *file = error_p ? stderr : stdout;
+
+  fnotice (file, "  merge-shards [options] <dir|file>...  Merge profile shards written under\n"
+		 "                                        GCOV_PROFILE_SHARDS into coverage files\n");
+  fnotice (file, "    -d, --delete                        Delete the shards once merged\n");
+  fnotice (file, "    -j, --jobs <n>                      Fold shards in <n> parallel workers\n");
+  fnotice (file, "    -v, --verbose                       Verbose mode\n");
+  fnotice (file, "    -w, --weight <w1,w2>                Set weights (float point values)\n");
+}
+
+static const struct option merge_shards_options[] =
+{
+  { "delete",                 no_argument,       NULL, 'd' },
+  { "jobs",                   required_argument, NULL, 'j' },
+  { "verbose",                no_argument,       NULL, 'v' },
+  { "weight",                 required_argument, NULL, 'w' },
+  { 0, 0, 0, 0 }
+};
+
+/* Print merge-shards usage and exit.  */
+
+static void ATTRIBUTE_NORETURN
+merge_shards_usage (void)
+{
+  fnotice (stderr, "Merge-shards subcommand usage:");
+  print_merge_shards_usage_message (true);
+  exit (FATAL_EXIT_CODE);
+}
+
+/* Driver for profile merge-shards subcommand.  */
+
+static int
+do_merge_shards (int argc, char **argv)
+{
+  int opt;
+  int w1 = 1, w2 = 1;
+  int jobs = 1;
+  bool delete_shards = false;
+  struct gcov_info *merged_profile;
+  char *folded;
+  int ret = 0;
+
+  optind = 0;
+  while ((opt = getopt_long (argc, argv, "dj:vw:",
+			     merge_shards_options, NULL)) != -1)
+    {
+      switch (opt)
+	{
+	case 'd':
+	  delete_shards = true;
+	  break;
+	case 'j':
+	  jobs = atoi (optarg);
+	  if (jobs < 1)
+	    fatal_error (input_location, "number of jobs needs to be positive");
+	  break;
+	case 'v':
+	  verbose = true;
+	  gcov_set_verbose ();
+	  break;
+	case 'w':
+	  sscanf (optarg, "%d,%d", &w1, &w2);
+	  if (w1 < 0 || w2 < 0)
+	    fatal_error (input_location, "weights need to be non-negative");
+	  break;
+	default:
+	  merge_shards_usage ();
+	}
+    }
+
+  if (argc - optind < 1)
+    merge_shards_usage ();
+
+  for (int i = optind; i < argc; i++)
+    {
+      struct stat st;
+
+      if (stat (argv[i], &st) == 0 && S_ISDIR (st.st_mode))
+	{
+#if HAVE_FTW_H
+	  if (ftw (argv[i], collect_shard_file, 64))
+	    fatal_error (input_location, "cannot scan directory %s: %m",
+			 argv[i]);
+#else
+	  fatal_error (input_location,
+		       "cannot scan directory %s on this host; "
+		       "name the shards instead", argv[i]);
+#endif
+	}
+      else
+	add_shard_file (argv[i]);
+    }
+
+  if (verbose)
+    fnotice (stdout, "merging %d profile shards\n", n_shard_files);
+
+  folded = XCNEWVEC (char, n_shard_files);
+  merged_profile = fold_shard_files (n_shard_files, jobs, folded);
+  if (merged_profile)
+    merged_profile = gcov_profile_merge_into_gcda (merged_profile, w1, w2);
+
+  /* Keep the shards if the merged profile could not be written, so that
+     the merge can be retried.  */
+  if (merged_profile && gcov_do_dump (merged_profile, 0, -1))
+    fatal_error (input_location, "cannot write the merged profile");
+  else if (!merged_profile && verbose)
+    fnotice (stdout, "no profile files were merged\n");
+
+  /* Only delete the shards whose counts are all in the merged profile;
+     the others are kept and reported.  */
+  for (int i = 0; i < n_shard_files; i++)
+    if (!folded[i])
+      {
+	error ("%s was not merged completely", shard_files[i]);
+	ret = 1;
+      }
+    else if (merged_profile && delete_shards && unlink (shard_files[i]))
+      fatal_error (input_location, "error in removing %s", shard_files[i]);
+
+  free (folded);
+  return ret;
+}
+
 /* If N_VAL is no-zero, normalize the profile by setting the largest counter
    counter value to N_VAL and scale others counters proportionally.
    Otherwise, multiply the all counters by SCALE.  */
@@ -563,6 +836,644 @@ do_overlap (int argc, char **argv)
   return ret;
 }
 
+/* Creating an AutoFDO profile from the output of perf script, without
+   the external create_gcov tool.
+
+   Each line of the input is expected to start with the sampled address,
+   followed by the branch records of the sample, if any, as printed by
+   "perf script -F ip,brstack" (or "perf script -F ip" without branch
+   records).  With branch records, the code between the target of each
+   branch and the source of the next one is known to have run once, and
+   every inline stack found in it is counted once; the branches to the
+   start of a function give its entry count.  Without them each sample
+   counts the inline stack of the sampled address.
+
+   Addresses are mapped to inline stacks with libbacktrace, using the
+   DWARF of the binary.  The profile gives each line as get_combined_location
+   computes it, from the line relative to the DW_AT_decl_line of its
+   function and the discriminator of the line, or of the inlined call.  */
+
+/* The longest run of code between two branches that is believed; longer
+   ones come from records that were lost or from unrelated code.  */
+#define AFDO_MAX_RANGE 4096
+
+/* An inline stack, innermost function first: the index of the name of
+   the function and the offset of the line in it, which is the line of
+   the sampled code for the innermost function and that of the call for
+   the others.  */
+typedef std::vector<std::pair<unsigned, unsigned> > afdo_stack;
+
+/* The profile of an instance of a function, with the profiles of the
+   functions inlined into it, in the form auto-profile.cc reads.  */
+
+struct afdo_instance
+{
+  afdo_instance () : head_count (0) {}
+  afdo_instance (const afdo_instance &) = delete;
+  afdo_instance &operator= (const afdo_instance &) = delete;
+  ~afdo_instance ()
+  {
+    for (auto &callsite : callsites)
+      delete callsite.second;
+  }
+
+  gcov_type head_count;
+  /* The counts of the lines, by offset.  */
+  std::map<unsigned, gcov_type> pos_counts;
+  /* The inlined callees, by the offset of the call and their name.  */
+  std::map<std::pair<unsigned, unsigned>, afdo_instance *> callsites;
+};
+
+/* The samples read so far, and what is known about the binary.  */
+
+class afdo_profile
+{
+public:
+  afdo_profile (uintptr_t load_base)
+    : state (NULL), base (load_base), error (NULL),
+      samples (0), branches (0), dropped (0)
+  {}
+
+  void add_sample (const char *line);
+  bool write (const char *filename) const;
+
+  backtrace_state *state;
+  /* The address the binary was loaded at.  */
+  uintptr_t base;
+  /* The first error libbacktrace reported, if any.  */
+  const char *error;
+
+  unsigned long samples;
+  unsigned long branches;
+  unsigned long dropped;
+
+private:
+  unsigned name_index (const char *name);
+  int stack_of (uintptr_t pc);
+  int entry_of (uintptr_t pc);
+  void add_range (uintptr_t begin, uintptr_t end);
+  void collect_names (unsigned name, const afdo_instance &instance,
+		      std::map<unsigned, unsigned> &indices) const;
+
+  /* The function names, and their indices.  */
+  std::vector<std::string> names;
+  std::map<std::string, unsigned> name_indices;
+
+  /* The inline stacks seen, their counts and their indices.  */
+  std::vector<afdo_stack> stacks;
+  std::vector<gcov_type> stack_counts;
+  std::map<afdo_stack, unsigned> stack_indices;
+
+  /* The inline stack of each address seen, or -1 if it has none.  */
+  std::map<uintptr_t, int> pc_stacks;
+  /* The function that starts at each branch target seen, or -1.  */
+  std::map<uintptr_t, int> entries;
+
+  /* The entry counts of the functions, by name.  */
+  std::map<unsigned, gcov_type> head_counts;
+};
+
+/* The data passed to the libbacktrace callbacks, which all start with
+   the profile whose error the error callback records.  */
+
+struct afdo_callback_data
+{
+  afdo_profile *profile;
+};
+
+/* The inline stack of an address, as libbacktrace reports it.  The
+   names of the functions are only interned afterwards.  */
+
+struct afdo_pcinfo_data : afdo_callback_data
+{
+  afdo_stack stack;
+  std::vector<const char *> functions;
+};
+
+/* The symbol containing an address.  */
+
+struct afdo_syminfo_data : afdo_callback_data
+{
+  const char *name;
+  uintptr_t value;
+};
+
+/* libbacktrace callback recording the first error in the profile of the
+   afdo_callback_data at DATA.  */
+
+static void
+afdo_error_callback (void *data, const char *msg, int)
+{
+  afdo_profile *profile = ((afdo_callback_data *) data)->profile;
+  if (!profile->error)
+    profile->error = msg;
+}
+
+/* libbacktrace callback pushing a frame to the afdo_pcinfo_data at DATA,
+   or clearing it if the address has no debug information.  The offset
+   of the line is computed the way get_combined_location does.  */
+
+static int
+afdo_pcinfo_callback (void *data, uintptr_t, const char *filename,
+		      int lineno, int discriminator, const char *function,
+		      int decl_lineno)
+{
+  afdo_pcinfo_data *pcinfo
+    = static_cast<afdo_pcinfo_data *> ((afdo_callback_data *) data);
+  if (!filename || !function || lineno <= 0)
+    {
+      pcinfo->stack.clear ();
+      pcinfo->functions.clear ();
+      return 1;
+    }
+  unsigned offset = (((unsigned) lineno - (unsigned) decl_lineno) << 16
+		     | (unsigned) discriminator);
+  pcinfo->stack.push_back (std::make_pair (0u, offset));
+  pcinfo->functions.push_back (function);
+  return 0;
+}
+
+/* libbacktrace callback storing the symbol found in the
+   afdo_syminfo_data at DATA.  */
+
+static void
+afdo_syminfo_callback (void *data, uintptr_t, const char *symname,
+		       uintptr_t symval, uintptr_t)
+{
+  afdo_syminfo_data *sym
+    = static_cast<afdo_syminfo_data *> ((afdo_callback_data *) data);
+  sym->name = symname;
+  sym->value = symval;
+}
+
+/* Return the index of function NAME.  */
+
+unsigned
+afdo_profile::name_index (const char *name)
+{
+  auto it = name_indices.find (name);
+  if (it != name_indices.end ())
+    return it->second;
+  unsigned index = names.size ();
+  names.push_back (name);
+  name_indices[name] = index;
+  return index;
+}
+
+/* Return the index of the inline stack of the code at PC, or -1 if it
+   has no debug information.  */
+
+int
+afdo_profile::stack_of (uintptr_t pc)
+{
+  auto cached = pc_stacks.find (pc);
+  if (cached != pc_stacks.end ())
+    return cached->second;
+
+  afdo_pcinfo_data pcinfo;
+  pcinfo.profile = this;
+  backtrace_pcinfo_detail (state, pc, afdo_pcinfo_callback,
+			   afdo_error_callback,
+			   (afdo_callback_data *) &pcinfo);
+  int index = -1;
+  if (!pcinfo.stack.empty ())
+    {
+      for (unsigned i = 0; i < pcinfo.stack.size (); i++)
+	pcinfo.stack[i].first = name_index (pcinfo.functions[i]);
+
+      auto it = stack_indices.find (pcinfo.stack);
+      if (it != stack_indices.end ())
+	index = it->second;
+      else
+	{
+	  index = stacks.size ();
+	  stacks.push_back (pcinfo.stack);
+	  stack_counts.push_back (0);
+	  stack_indices[pcinfo.stack] = index;
+	}
+    }
+  pc_stacks[pc] = index;
+  return index;
+}
+
+/* Return the index of the name of the function that starts at PC, or -1
+   if none does.  */
+
+int
+afdo_profile::entry_of (uintptr_t pc)
+{
+  auto cached = entries.find (pc);
+  if (cached != entries.end ())
+    return cached->second;
+
+  afdo_syminfo_data sym;
+  sym.profile = this;
+  sym.name = NULL;
+  int index = -1;
+  if (backtrace_syminfo (state, pc, afdo_syminfo_callback,
+			 afdo_error_callback, (afdo_callback_data *) &sym)
+      && sym.name
+      && sym.value == pc)
+    {
+      /* Use the name from the debug information, which is the one the
+	 inline stacks use.  */
+      int stack = stack_of (pc);
+      if (stack >= 0)
+	index = stacks[stack].back ().first;
+    }
+  entries[pc] = index;
+  return index;
+}
+
+/* Count once each inline stack of the code from BEGIN to END, which was
+   run from start to end.  */
+
+void
+afdo_profile::add_range (uintptr_t begin, uintptr_t end)
+{
+  if (end < begin || end - begin > AFDO_MAX_RANGE)
+    {
+      dropped++;
+      return;
+    }
+
+  std::vector<int> seen;
+  for (uintptr_t pc = begin; pc <= end; pc++)
+    {
+      int stack = stack_of (pc);
+      if (stack >= 0
+	  && std::find (seen.begin (), seen.end (), stack) == seen.end ())
+	{
+	  seen.push_back (stack);
+	  stack_counts[stack]++;
+	}
+    }
+}
+
+/* Add the sample described by LINE, a line of perf script output.  */
+
+void
+afdo_profile::add_sample (const char *line)
+{
+  char *end;
+  uintptr_t ip = strtoull (line, &end, 16);
+  if (end == line || (*end && !ISSPACE (*end)))
+    return;
+  samples++;
+
+  /* The branch records, most recent first.  */
+  std::vector<std::pair<uintptr_t, uintptr_t> > records;
+  const char *p = end;
+  while (*p)
+    {
+      while (ISSPACE (*p))
+	p++;
+      if (!*p)
+	break;
+      uintptr_t from = strtoull (p, &end, 16);
+      if (*end == '/')
+	{
+	  const char *q = end + 1;
+	  uintptr_t to = strtoull (q, &end, 16);
+	  if (end != q && *end == '/')
+	    records.push_back (std::make_pair (from - base, to - base));
+	}
+      while (*p && !ISSPACE (*p))
+	p++;
+    }
+
+  if (records.empty ())
+    {
+      int stack = stack_of (ip - base);
+      if (stack >= 0)
+	stack_counts[stack]++;
+      return;
+    }
+
+  branches += records.size ();
+  for (unsigned i = 0; i < records.size (); i++)
+    {
+      int entry = entry_of (records[i].second);
+      if (entry >= 0)
+	head_counts[entry]++;
+      if (i + 1 < records.size ())
+	add_range (records[i + 1].second, records[i].first);
+    }
+}
+
+/* Give the names used by INSTANCE of function NAME, and by the
+   functions inlined into it, an index in the string table INDICES.  */
+
+void
+afdo_profile::collect_names (unsigned name, const afdo_instance &instance,
+			     std::map<unsigned, unsigned> &indices) const
+{
+  if (indices.find (name) == indices.end ())
+    {
+      unsigned index = indices.size () + 1;
+      indices[name] = index;
+    }
+  for (auto &callsite : instance.callsites)
+    collect_names (callsite.first.second, *callsite.second, indices);
+}
+
+/* Write to F the integer VALUE, the counter VALUE or the string STR the
+   way gcov-io.cc does.  */
+
+static void
+afdo_write_unsigned (FILE *f, gcov_unsigned_t value)
+{
+  fwrite (&value, sizeof (value), 1, f);
+}
+
+static void
+afdo_write_counter (FILE *f, gcov_type value)
+{
+  afdo_write_unsigned (f, (gcov_unsigned_t) value);
+  afdo_write_unsigned (f, (gcov_unsigned_t) (value >> 32));
+}
+
+static void
+afdo_write_string (FILE *f, const char *str)
+{
+  gcov_unsigned_t length = strlen (str) + 1;
+  afdo_write_unsigned (f, length);
+  fwrite (str, length, 1, f);
+}
+
+/* Write to F the INSTANCE of function NAME, whose index in the string
+   table is given by INDICES, in the format that
+   function_instance::read_function_instance reads.  */
+
+static void
+afdo_write_instance (FILE *f, unsigned name, const afdo_instance &instance,
+		     const std::map<unsigned, unsigned> &indices)
+{
+  afdo_write_unsigned (f, indices.find (name)->second);
+  afdo_write_unsigned (f, instance.pos_counts.size ());
+  afdo_write_unsigned (f, instance.callsites.size ());
+  for (auto &pos : instance.pos_counts)
+    {
+      afdo_write_unsigned (f, pos.first);
+      /* No indirect call targets.  */
+      afdo_write_unsigned (f, 0);
+      afdo_write_counter (f, pos.second);
+    }
+  for (auto &callsite : instance.callsites)
+    {
+      afdo_write_unsigned (f, callsite.first.first);
+      afdo_write_instance (f, callsite.first.second, *callsite.second,
+			   indices);
+    }
+}
+
+/* Print to F the INSTANCE of function NAME, whose name is in NAMES,
+   indented by INDENT: the offset of each line from the declaration of
+   the function, with its discriminator if any, and its count, and the
+   inlined callees at each call.  */
+
+static void
+afdo_dump_instance (FILE *f, const std::vector<std::string> &names,
+		    unsigned name, const afdo_instance &instance,
+		    unsigned indent)
+{
+  fprintf (f, "%*s%s", indent, "", names[name].c_str ());
+  if (instance.head_count)
+    fprintf (f, " head %" PRId64, instance.head_count);
+  fprintf (f, "\n");
+  indent += 2;
+  for (auto &pos : instance.pos_counts)
+    {
+      fprintf (f, "%*s%u", indent, "", pos.first >> 16);
+      if (pos.first & 0xffff)
+	fprintf (f, ".%u", pos.first & 0xffff);
+      fprintf (f, ": %" PRId64 "\n", pos.second);
+    }
+  for (auto &callsite : instance.callsites)
+    {
+      fprintf (f, "%*s%u", indent, "", callsite.first.first >> 16);
+      if (callsite.first.first & 0xffff)
+	fprintf (f, ".%u", callsite.first.first & 0xffff);
+      fprintf (f, ":\n");
+      afdo_dump_instance (f, names, callsite.first.second, *callsite.second,
+			  indent + 2);
+    }
+}
+
+/* Write the profile to FILENAME in the format read_profile reads.
+   Return false if it cannot be written.  In verbose mode, also print
+   it.  */
+
+bool
+afdo_profile::write (const char *filename) const
+{
+  /* Build the function instances from the inline stacks.  */
+  std::map<unsigned, afdo_instance> functions;
+  for (unsigned i = 0; i < stacks.size (); i++)
+    {
+      const afdo_stack &stack = stacks[i];
+      if (!stack_counts[i])
+	continue;
+      unsigned outer = stack.size () - 1;
+      afdo_instance *instance = &functions[stack[outer].first];
+      for (unsigned j = outer; j > 0; j--)
+	{
+	  afdo_instance *&callee
+	    = instance->callsites[std::make_pair (stack[j].second,
+						  stack[j - 1].first)];
+	  if (!callee)
+	    callee = new afdo_instance;
+	  instance = callee;
+	}
+      instance->pos_counts[stack[0].second] += stack_counts[i];
+    }
+  for (auto &head : head_counts)
+    {
+      auto function = functions.find (head.first);
+      if (function != functions.end ())
+	function->second.head_count = head.second;
+    }
+
+  /* Index 0 of the string table cannot be looked up by
+     string_table::get_name, so it is given to an empty name.  */
+  std::map<unsigned, unsigned> indices;
+  for (auto &function : functions)
+    collect_names (function.first, function.second, indices);
+  std::vector<const char *> table (indices.size () + 1, "");
+  for (auto &index : indices)
+    table[index.second] = names[index.first].c_str ();
+
+  FILE *f = fopen (filename, "wb");
+  if (!f)
+    return false;
+
+  afdo_write_unsigned (f, GCOV_DATA_MAGIC);
+  afdo_write_unsigned (f, AUTO_PROFILE_VERSION);
+  afdo_write_unsigned (f, 0);
+
+  /* The lengths of the sections are not used by the reader.  */
+  afdo_write_unsigned (f, GCOV_TAG_AFDO_FILE_NAMES);
+  afdo_write_unsigned (f, 0);
+  afdo_write_unsigned (f, table.size ());
+  for (const char *name : table)
+    afdo_write_string (f, name);
+
+  afdo_write_unsigned (f, GCOV_TAG_AFDO_FUNCTION);
+  afdo_write_unsigned (f, 0);
+  afdo_write_unsigned (f, functions.size ());
+  for (auto &function : functions)
+    {
+      afdo_write_counter (f, function.second.head_count);
+      afdo_write_instance (f, function.first, function.second, indices);
+    }
+
+  /* An empty module grouping section.  */
+  afdo_write_unsigned (f, GCOV_TAG_AFDO_MODULE_GROUPING);
+  afdo_write_unsigned (f, 0);
+  afdo_write_unsigned (f, 0);
+
+  bool ok = !ferror (f);
+  if (fclose (f))
+    ok = false;
+  if (verbose)
+    {
+      fnotice (stdout, "%lu samples, %lu branch records (%lu ranges dropped);"
+	       " %u functions written to %s\n", samples, branches, dropped,
+	       (unsigned) functions.size (), filename);
+      for (auto &function : functions)
+	afdo_dump_instance (stdout, names, function.first, function.second, 0);
+    }
+  return ok;
+}
+
+/* Driver function to create the AutoFDO profile OUT for BINARY, loaded
+   at BASE, from the perf script output in PERF_SCRIPT.  Return 1 on
+   error and 0 if OK.  */
+
+static int
+create_afdo (const char *binary, const char *perf_script, const char *out,
+	     uintptr_t base)
+{
+  afdo_profile profile (base);
+  afdo_callback_data data = { &profile };
+  profile.state = backtrace_create_state (binary, 0, afdo_error_callback,
+					  &data);
+  if (!profile.state)
+    {
+      fnotice (stderr, "cannot read %s\n", binary);
+      return 1;
+    }
+
+  FILE *f = strcmp (perf_script, "-") ? fopen (perf_script, "r") : stdin;
+  if (!f)
+    {
+      fnotice (stderr, "cannot open %s: %s\n", perf_script,
+	       xstrerror (errno));
+      return 1;
+    }
+
+  std::string line;
+  char buf[4096];
+  while (fgets (buf, sizeof (buf), f))
+    {
+      line += buf;
+      if (line.back () != '\n' && !feof (f))
+	continue;
+      profile.add_sample (line.c_str ());
+      line.clear ();
+      if (profile.error)
+	break;
+    }
+  if (f != stdin)
+    fclose (f);
+
+  if (profile.error)
+    {
+      fnotice (stderr, "cannot read the debug information of %s: %s\n",
+	       binary, profile.error);
+      return 1;
+    }
+  if (!profile.samples)
+    {
+      fnotice (stderr, "no samples found in %s\n", perf_script);
+      return 1;
+    }
+  if (!profile.write (out))
+    {
+      fnotice (stderr, "cannot write %s\n", out);
+      return 1;
+    }
+  return 0;
+}
+
+/* Usage message for create-afdo.  */
+
+static void
+print_create_afdo_usage_message (int error_p)
+{
+  FILE *file = error_p ? stderr : stdout;
+
+  fnotice (file, "  create-afdo [options] <binary> <perf-script-output>\n");
+  fnotice (file, "                                        Create an AutoFDO profile from the output\n");
+  fnotice (file, "                                        of perf script -F ip,brstack\n");
+  fnotice (file, "    -b, --base <address>                Address the binary was loaded at\n");
+  fnotice (file, "    -o, --output <file>                 Output file\n");
+  fnotice (file, "    -v, --verbose                       Verbose mode\n");
+}
+
+static const struct option create_afdo_options[] =
+{
+  { "verbose",                no_argument,       NULL, 'v' },
+  { "output",                 required_argument, NULL, 'o' },
+  { "base",                   required_argument, NULL, 'b' },
+  { 0, 0, 0, 0 }
+};
+
+/* Print create-afdo usage and exit.  */
+
+static void ATTRIBUTE_NORETURN
+create_afdo_usage (void)
+{
+  fnotice (stderr, "Create-afdo subcommand usage:");
+  print_create_afdo_usage_message (true);
+  exit (FATAL_EXIT_CODE);
+}
+
+/* Driver for create-afdo subcommand.  */
+
+static int
+do_create_afdo (int argc, char **argv)
+{
+  int opt;
+  const char *output = "fbdata.afdo";
+  uintptr_t base = 0;
+
+  optind = 0;
+  while ((opt = getopt_long (argc, argv, "vo:b:", create_afdo_options,
+			     NULL)) != -1)
+    {
+      switch (opt)
+	{
+	case 'v':
+	  verbose = true;
+	  break;
+	case 'o':
+	  output = optarg;
+	  break;
+	case 'b':
+	  base = strtoull (optarg, NULL, 16);
+	  break;
+	default:
+	  create_afdo_usage ();
+	}
+    }
+
+  if (argc - optind != 2)
+    create_afdo_usage ();
+
+  return create_afdo (argv[optind], argv[optind + 1], output, base);
+}
+
 
 /* Print a usage message and exit.  If ERROR_P is nonzero, this is an error,
    otherwise the output of --help.  */
@@ -579,8 +1490,10 @@ print_usage (int error_p)
   fnotice (file, "  -v, --version                         Print version number, then exit\n");
   print_merge_usage_message (error_p);
   print_merge_stream_usage_message (error_p);
+  print_merge_shards_usage_message (error_p);
   print_rewrite_usage_message (error_p);
   print_overlap_usage_message (error_p);
+  print_create_afdo_usage_message (error_p);
   fnotice (file, "\nFor bug reporting instructions, please see:\n%s.\n",
            bug_report_url);
   exit (status);
@@ -670,10 +1583,14 @@ main (int argc, char **argv)
     return do_merge (argc - optind, argv + optind);
   else if (!strcmp (sub_command, "merge-stream"))
     return do_merge_stream (argc - optind, argv + optind);
+  else if (!strcmp (sub_command, "merge-shards"))
+    return do_merge_shards (argc - optind, argv + optind);
   else if (!strcmp (sub_command, "rewrite"))
     return do_rewrite (argc - optind, argv + optind);
   else if (!strcmp (sub_command, "overlap"))
     return do_overlap (argc - optind, argv + optind);
+  else if (!strcmp (sub_command, "create-afdo"))
+    return do_create_afdo (argc - optind, argv + optind);
 
   print_usage (true);
 }
@@ -222,12 +222,41 @@ fp_decl_done (FILE *f, const char *trailer)
 /* Line numbers for use by indirect line directives.  */
 static vec<int> dbg_line_numbers;
 
+/* Whether to instrument the generated code with per-pattern execution
+   counters (--instrument).  */
+static bool instrument_patterns;
+
+/* The "file:line" keys of the instrumented patterns, indexed by the
+   counter id.  */
+static vec<char *> pattern_count_keys;
+
+/* Execution counts of a pattern as recorded by an instrumented compiler.  */
+struct pattern_count
+{
+  uint64_t attempts;
+  uint64_t successes;
+};
+
+/* Pattern execution counts read from --profile=FILE, keyed by "file:line"
+   of the pattern, or NULL if no profile was given.  */
+static hash_map<nofree_string_hash, pattern_count> *pattern_profile;
+
 static void
 write_header_declarations (bool gimple, FILE *f)
 {
   fprintf (f, "\nextern void\n%s_dump_logs (const char *file1, int line1_id, "
 	      "const char *file2, int line2, bool simplify);\n",
 	      gimple ? "gimple" : "generic");
+
+  if (instrument_patterns)
+    fprintf (f, "\nstruct %s_match_count\n{\n"
+		"  const char *loc;\n"
+		"  unsigned HOST_WIDE_INT attempts;\n"
+		"  unsigned HOST_WIDE_INT successes;\n"
+		"};\n"
+		"extern %s_match_count %s_match_counts[];\n",
+	     gimple ? "gimple" : "generic", gimple ? "gimple" : "generic",
+	     gimple ? "gimple" : "generic");
 }
 
 static void
@@ -262,6 +291,148 @@ define_dump_logs (bool gimple, FILE *f)
   fprintf (f, "\n}\n\n");
 }
 
+/* Define the per-pattern counters declared by write_header_declarations
+   together with the code dumping them at exit.  Each pattern that was tried
+   appends a line "<gimple|generic> <file>:<line> <attempts> <successes>"
+   to the file named by the GCC_MATCH_PROFILE environment variable, which
+   is the format --profile= reads back.  */
+
+static void
+define_match_counts (bool gimple, FILE *f)
+{
+  if (!instrument_patterns || pattern_count_keys.is_empty ())
+    return;
+
+  const char *kind = gimple ? "gimple" : "generic";
+  fprintf (f, "%s_match_count %s_match_counts[%u] = {",
+	   kind, kind, pattern_count_keys.length ());
+  for (char *key : pattern_count_keys)
+    fprintf (f, "\n  { \"%s\", 0, 0 },", key);
+  fprintf (f, "\n};\n\n");
+
+  fprintf (f, "static void\n%s_dump_match_counts ()\n{\n", kind);
+  fprintf_indent (f, 2,
+		  "const char *name = getenv (\"GCC_MATCH_PROFILE\");\n");
+  fprintf_indent (f, 2, "if (!name)\n");
+  fprintf_indent (f, 2, "  return;\n");
+  fprintf_indent (f, 2, "FILE *prof = fopen (name, \"a\");\n");
+  fprintf_indent (f, 2, "if (!prof)\n");
+  fprintf_indent (f, 2, "  return;\n");
+  /* Buffer the whole profile so it is appended with a single write and
+     concurrent compilers sharing the file do not interleave lines.  */
+  fprintf_indent (f, 2, "setvbuf (prof, NULL, _IOFBF, 1 << 22);\n");
+  fprintf_indent (f, 2, "for (unsigned i = 0; i < %u; ++i)\n",
+		  pattern_count_keys.length ());
+  fprintf_indent (f, 2, "  if (%s_match_counts[i].attempts)\n", kind);
+  fprintf_indent (f, 2, "    fprintf (prof, \"%s %%s \" "
+		  "HOST_WIDE_INT_PRINT_UNSIGNED \" \"\n", kind);
+  fprintf_indent (f, 2, "             HOST_WIDE_INT_PRINT_UNSIGNED \"\\n\", "
+		  "%s_match_counts[i].loc,\n", kind);
+  fprintf_indent (f, 2, "             %s_match_counts[i].attempts, "
+		  "%s_match_counts[i].successes);\n", kind, kind);
+  fprintf_indent (f, 2, "fclose (prof);\n");
+  fprintf (f, "}\n\n");
+
+  fprintf (f, "static struct %s_match_counts_dumper\n{\n"
+	      "  ~%s_match_counts_dumper () { %s_dump_match_counts (); }\n"
+	      "} %s_match_counts_dumper_instance;\n\n",
+	   kind, kind, kind, kind);
+}
+
+/* Return the file name component of FILE.  */
+
+static const char *
+file_basename (const char *file)
+{
+  const char *base = strrchr (file, DIR_SEPARATOR);
+#if defined(DIR_SEPARATOR_2)
+  const char *pos2 = strrchr (file, DIR_SEPARATOR_2);
+  if (pos2 && (!base || (pos2 > base)))
+    base = pos2;
+#endif
+  return base ? base + 1 : file;
+}
+
+/* Return the "file:line" key identifying the pattern at LOCATION in
+   pattern profiles.  The caller owns the returned string.  */
+
+static char *
+pattern_location_key (location_t location)
+{
+  const line_map_ordinary *map;
+  linemap_resolve_location (line_table, location, LRK_SPELLING_LOCATION, &map);
+  expanded_location loc = linemap_expand_location (line_table, map, location);
+  return xasprintf ("%s:%d", file_basename (loc.file), loc.line);
+}
+
+/* Return the execution counter id of the pattern starting at LOCATION,
+   allocating a new counter on first use.  All lowered variants of a
+   source pattern share one counter.  */
+
+static unsigned
+pattern_count_id (location_t location)
+{
+  static hash_map<nofree_string_hash, unsigned> ids;
+  char *key = pattern_location_key (location);
+  bool existed;
+  unsigned &id = ids.get_or_insert (key, &existed);
+  if (existed)
+    free (key);
+  else
+    {
+      id = pattern_count_keys.length ();
+      pattern_count_keys.safe_push (key);
+    }
+  return id;
+}
+
+/* Return the number of times the pattern starting at LOCATION was tried
+   according to the pattern profile.  */
+
+static uint64_t
+pattern_profile_attempts (location_t location)
+{
+  if (!pattern_profile)
+    return 0;
+  char *key = pattern_location_key (location);
+  pattern_count *count = pattern_profile->get (key);
+  free (key);
+  return count ? count->attempts : 0;
+}
+
+/* Read the pattern profile NAME written by a compiler built with
+   --instrument, summing up the counts of the GIMPLE or GENERIC
+   patterns as indicated by GIMPLE.  */
+
+static void
+read_pattern_profile (const char *name, bool gimple)
+{
+  FILE *f = fopen (name, "r");
+  if (!f)
+    fatal ("cannot open pattern profile '%s'", name);
+
+  pattern_profile = new hash_map<nofree_string_hash, pattern_count>;
+  char kind[16], loc[1024];
+  uint64_t attempts, successes;
+  int n;
+  while ((n = fscanf (f, "%15s %1023s %" SCNu64 " %" SCNu64,
+		      kind, loc, &attempts, &successes)) == 4)
+    {
+      if (strcmp (kind, gimple ? "gimple" : "generic") != 0)
+	continue;
+      bool existed;
+      pattern_count &count
+	= pattern_profile->get_or_insert (xstrdup (loc), &existed);
+      if (!existed)
+	count.attempts = count.successes = 0;
+      count.attempts += attempts;
+      count.successes += successes;
+    }
+  if (n != EOF)
+    fatal ("malformed pattern profile '%s'", name);
+  fclose (f);
+}
+
 static void
 output_line_directive (FILE *f, location_t location,
 		      bool dumpfile = false, bool fnargs = false,
@@ -275,16 +446,7 @@ output_line_directive (FILE *f, location_t location,
   if (dumpfile)
     {
       /* When writing to a dumpfile only dump the filename.  */
-      const char *file = strrchr (loc.file, DIR_SEPARATOR);
-#if defined(DIR_SEPARATOR_2)
-      const char *pos2 = strrchr (loc.file, DIR_SEPARATOR_2);
-      if (pos2 && (!file || (pos2 > file)))
-	file = pos2;
-#endif
-      if (!file)
-	file = loc.file;
-      else
-	++file;
+      const char *file = file_basename (loc.file);
 
       if (fnargs)
 	{
@@ -1772,9 +1934,12 @@ public:
   unsigned num_leafs;
   unsigned total_size;
   unsigned max_level;
+  /* The number of times the patterns below were tried according to the
+     pattern profile.  */
+  uint64_t hotness;
 
   dt_node (enum dt_type type_, dt_node *parent_)
-    : type (type_), level (0), parent (parent_), kids (vNULL) {}
+    : type (type_), level (0), parent (parent_), kids (vNULL), hotness (0) {}
 
   dt_node *append_node (dt_node *);
   dt_node *append_op (operand *, dt_node *parent, unsigned pos);
@@ -2072,6 +2237,7 @@ dt_node::analyze (sinfo_map_t &map)
   num_leafs = 0;
   total_size = 1;
   max_level = level;
+  hotness = 0;
 
   if (type == DT_SIMPLIFY)
     {
@@ -2090,6 +2256,7 @@ dt_node::analyze (sinfo_map_t &map)
 	si->cnt++;
       s->info = si;
       num_leafs = 1;
+      hotness = pattern_profile_attempts (s->s->match->location);
       return;
     }
 
@@ -2099,6 +2266,7 @@ dt_node::analyze (sinfo_map_t &map)
       num_leafs += kids[i]->num_leafs;
       total_size += kids[i]->total_size;
       max_level = MAX (max_level, kids[i]->max_level);
+      hotness += kids[i]->hotness;
     }
 }
 
@@ -3098,6 +3266,32 @@ fns_cmp (const void *p1, const void *p2)
   return strcmp (b1->id, b2->id);
 }
 
+/* Comparison function for sorting decision tree nodes hottest first.  */
+
+static int
+hotness_cmp (const void *p1, const void *p2, void *)
+{
+  const dt_node *n1 = *(const dt_node *const *) p1;
+  const dt_node *n2 = *(const dt_node *const *) p2;
+  if (n1->hotness > n2->hotness)
+    return -1;
+  if (n1->hotness < n2->hotness)
+    return 1;
+  return 0;
+}
+
+/* Order the expression kids dispatched by a switch on their code so that
+   the hottest cases according to the pattern profile come first.  The
+   cases are disjoint, so unlike the order of predicates and leafs this
+   does not change which pattern applies.  */
+
+static void
+sort_exprs_by_hotness (vec<dt_operand *> &exprs)
+{
+  if (pattern_profile)
+    exprs.stablesort (hotness_cmp, NULL);
+}
+
 /* Generate matching code for the children of the decision tree node.  */
 
 void
@@ -3173,6 +3367,8 @@ dt_node::gen_kids (FILE *f, int indent, bool gimple, int depth)
 	     for what we have collected sofar.  */
 	  fns.qsort (fns_cmp);
 	  generic_fns.qsort (fns_cmp);
+	  sort_exprs_by_hotness (gimple_exprs);
+	  sort_exprs_by_hotness (generic_exprs);
 	  gen_kids_1 (f, indent, gimple, depth, gimple_exprs, generic_exprs,
 		      fns, generic_fns, preds, others);
 	  /* And output the true operand itself.  */
@@ -3191,6 +3387,8 @@ dt_node::gen_kids (FILE *f, int indent, bool gimple, int depth)
   /* Generate code for the remains.  */
   fns.qsort (fns_cmp);
   generic_fns.qsort (fns_cmp);
+  sort_exprs_by_hotness (gimple_exprs);
+  sort_exprs_by_hotness (generic_exprs);
   gen_kids_1 (f, indent, gimple, depth, gimple_exprs, generic_exprs,
 	      fns, generic_fns, preds, others);
 }
@@ -3489,6 +3687,10 @@ static void
 emit_logging_call (FILE *f, int indent, class simplify *s, operand *result,
 				  bool gimple)
 {
+  if (instrument_patterns)
+    fprintf_indent (f, indent, "%s_match_counts[%u].successes++;\n",
+		    gimple ? "gimple" : "generic",
+		    pattern_count_id (s->match->location));
   fprintf_indent (f, indent, "if (UNLIKELY (debug_dump)) "
 	   "%s_dump_logs (", gimple ? "gimple" : "generic");
   output_line_directive (f,
@@ -3867,6 +4069,10 @@ dt_simplify::gen (FILE *f, int indent, bool gimple, int depth ATTRIBUTE_UNUSED)
   indent += 2;
   output_line_directive (f,
 			 s->result ? s->result->location : s->match->location);
+  if (instrument_patterns)
+    fprintf_indent (f, indent, "%s_match_counts[%u].attempts++;\n",
+		    gimple ? "gimple" : "generic",
+		    pattern_count_id (s->match->location));
   if (s->capture_max >= 0)
     {
       char opname[20];
@@ -4032,13 +4238,26 @@ decision_tree::gen (vec <FILE *> &files, bool gimple)
 	   gimple ? "GIMPLE" : "GENERIC", 
 	   root->num_leafs, root->max_level, root->total_size);
 
+  /* With a pattern profile emit the split-out functions and the per-code
+     entries hottest first, so the hot code ends up together.  */
+  auto_vec<dt_node *> infos;
+  for (sinfo_map_t::iterator iter = si.begin ();
+       iter != si.end (); ++iter)
+    infos.safe_push ((*iter).second->s);
+  auto_vec<dt_node *> entries;
+  entries.safe_splice (root->kids);
+  if (pattern_profile)
+    {
+      infos.stablesort (hotness_cmp, NULL);
+      entries.stablesort (hotness_cmp, NULL);
+    }
+
   /* First split out the transform part of equal leafs.  */
   unsigned rcnt = 0;
   unsigned fcnt = 1;
-  for (sinfo_map_t::iterator iter = si.begin ();
-       iter != si.end (); ++iter)
+  for (dt_node *n : infos)
     {
-      sinfo *s = (*iter).second;
+      sinfo *s = as_a <dt_simplify *> (n)->info;
       /* Do not split out single uses.  */
       if (s->cnt <= 1)
 	continue;
@@ -4067,7 +4286,7 @@ decision_tree::gen (vec <FILE *> &files, bool gimple)
 	{
 	  fp_decl (f, "\ntree\n"
 		   "%s (location_t ARG_UNUSED (loc), const tree ARG_UNUSED (type),\n",
-		   (*iter).second->fname);
+		   s->fname);
 	  for (unsigned i = 0;
 	       i < as_a <expr *>(s->s->s->match)->ops.length (); ++i)
 	    fp_decl (f, " tree ARG_UNUSED (_p%d),", i);
@@ -4103,9 +4322,9 @@ decision_tree::gen (vec <FILE *> &files, bool gimple)
       bool has_kids_p = false;
 
       /* First generate split-out functions.  */
-      for (unsigned j = 0; j < root->kids.length (); j++)
+      for (unsigned j = 0; j < entries.length (); j++)
 	{
-	  dt_operand *dop = static_cast<dt_operand *>(root->kids[j]);
+	  dt_operand *dop = static_cast<dt_operand *>(entries[j]);
 	  expr *e = static_cast<expr *>(dop->op);
 	  if (e->ops.length () != n
 	      /* Builtin simplifications are somewhat premature on
@@ -5432,7 +5651,12 @@ usage ()
 {
   const char *usage = "Usage:\n"
     " %s [--gimple|--generic] [-v[v]] <input>\n"
-    " %s [options] [--include=FILE] --header=FILE <input> <output>...\n";
+    " %s [options] [--include=FILE] --header=FILE <input> <output>...\n"
+    "Options:\n"
+    " --instrument    count pattern attempts and successes and append them\n"
+    "                 to $GCC_MATCH_PROFILE at exit\n"
+    " --profile=FILE  emit hot patterns first according to the counts\n"
+    "                 in FILE\n";
   fprintf (stderr, usage, progname, progname);
 }
 
@@ -5461,6 +5685,7 @@ main (int argc, char **argv)
   bool gimple = true;
   char *s_header_file = NULL;
   char *s_include_file = NULL;
+  char *s_profile_file = NULL;
   auto_vec <char *> files;
   char *input = NULL;
   int last_file = argc - 1;
@@ -5474,6 +5699,10 @@ main (int argc, char **argv)
 	s_header_file = &argv[i][9];
       else if (strncmp (argv[i], "--include=", 10) == 0)
 	s_include_file = &argv[i][10];
+      else if (strcmp (argv[i], "--instrument") == 0)
+	instrument_patterns = true;
+      else if (strncmp (argv[i], "--profile=", 10) == 0)
+	s_profile_file = &argv[i][10];
       else if (strcmp (argv[i], "-v") == 0)
 	verbose = 1;
       else if (strcmp (argv[i], "-vv") == 0)
@@ -5500,6 +5729,9 @@ main (int argc, char **argv)
   /* Input file is the last in the reverse list.  */
   input = files.pop ();
 
+  if (s_profile_file)
+    read_pattern_profile (s_profile_file, gimple);
+
   line_table = XCNEW (class line_maps);
   linemap_init (line_table, 0);
   line_table->m_reallocator = xrealloc;
@@ -5612,6 +5844,7 @@ main (int argc, char **argv)
   dt.gen (parts, gimple);
 
   define_dump_logs (gimple, choose_output (parts));
+  define_match_counts (gimple, choose_output (parts));
 
   for (FILE *f : parts)
     {
@@ -1306,6 +1306,39 @@ report_heap_memory_use ()
 #endif
 }
 
+/* Report the memory in use at the end of compilation phase PHASE: the
+   GGC memory allocated and mapped, the heap if that is known, and the
+   peak resident set size of the process so far.  The peak only grows
+   in the phases that raise it, which shows where it is reached.  */
+
+void
+report_phase_memory_use (const char *phase)
+{
+  size_t allocated, mapped;
+
+  ggc_memory_usage (&allocated, &mapped);
+  fprintf (stderr, "Memory after %s: GGC " PRsa (0) " allocated, "
+	   PRsa (0) " mapped", phase, SIZE_AMOUNT (allocated),
+	   SIZE_AMOUNT (mapped));
+#if defined(HAVE_MALLINFO) || defined(HAVE_MALLINFO2)
+  fprintf (stderr, ", heap " PRsa (0), SIZE_AMOUNT (MALLINFO_FN ().arena));
+#endif
+#if defined HAVE_GETRUSAGE && defined RUSAGE_SELF
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    {
+      uint64_t maxrss = usage.ru_maxrss;
+#ifndef __APPLE__
+      /* ru_maxrss is in kilobytes except on Darwin, where it is in
+	 bytes.  */
+      maxrss *= 1024;
+#endif
+      fprintf (stderr, ", peak RSS " PRsa (0), SIZE_AMOUNT (maxrss));
+    }
+#endif
+  fputc ('\n', stderr);
+}
+
 /* Forcibly clear all GTY roots.  */
 
 void
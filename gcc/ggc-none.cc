@@ -77,3 +77,9 @@ void
 ggc_trim (void)
 {
 }
+
+void
+ggc_memory_usage (size_t *allocated, size_t *mapped)
+{
+  *allocated = *mapped = 0;
+}
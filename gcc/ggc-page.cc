@@ -2266,6 +2266,16 @@ ggc_trim ()
   timevar_pop (TV_GC);
 }
 
+/* Store the number of bytes of GGC memory allocated in *ALLOCATED, and
+   the number of bytes mapped from the system for it in *MAPPED.  */
+
+void
+ggc_memory_usage (size_t *allocated, size_t *mapped)
+{
+  *allocated = G.allocated;
+  *mapped = G.bytes_mapped;
+}
+
 /* Assume that all GGC memory is reachable and grow the limits for next
    collection.  With checking, trigger GGC so -Q compilation outputs how much
    of memory really is reachable.  */
@@ -301,6 +301,13 @@ extern void init_ggc_heuristics (void);
 /* Report current heap memory use to stderr.  */
 extern void report_heap_memory_use (void);
 
+/* Report memory use at the end of a compilation phase to stderr.  */
+extern void report_phase_memory_use (const char *);
+
+/* Store the number of bytes of GGC memory allocated and mapped from the
+   system.  */
+extern void ggc_memory_usage (size_t *, size_t *);
+
 #define ggc_alloc_rtvec_sized(NELT)				\
   (rtvec_def *) ggc_internal_alloc (sizeof (struct rtvec_def)		\
 		       + ((NELT) - 1) * sizeof (rtx))		\
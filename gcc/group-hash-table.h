@@ -0,0 +1,854 @@
+/* A hash table probing groups of control bytes.
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+
+/* This file implements group_hash_table, an alternative to hash_table
+   for tables on hot paths.  It uses the same descriptor types and has the
+   same interface, so a table can be switched over by changing its type;
+   see hash-table.h for how to write a descriptor.  The descriptor's
+   is_deleted and mark_deleted functions are not used.
+
+   hash_table keeps a prime number of slots and probes them by double
+   hashing, which costs a division and a potential cache miss for every
+   slot visited.  group_hash_table instead keeps a power of two number of
+   slots and one control byte per slot.  A control byte is either EMPTY,
+   DELETED or holds seven bits of the hash value of the element in the
+   slot.  A lookup loads a group of consecutive control bytes and compares
+   all of them against the hash bits at once, with SSE2 where available
+   and with word-sized bit manipulation otherwise.  The descriptor's
+   equal function is only called for the slots whose hash bits match,
+   and a lookup ends at the first group that contains an EMPTY byte.
+   Groups are probed quadratically.
+
+   The control bytes are stored in the same allocation as the slots,
+   after the last slot, followed by a copy of the first group's control
+   bytes so that a group can be loaded starting at any slot.  Keeping a
+   single allocation means that GC and PCH see the table as one object,
+   like they see hash_table.
+
+   Vacant slots always hold an empty element, so as with hash_table a
+   failed find_with_hash returns a reference to an empty element.  */
+
+#ifndef GCC_GROUP_HASH_TABLE_H
+#define GCC_GROUP_HASH_TABLE_H
+
+#include "hash-table.h"
+
+/* A group of control bytes, loaded from consecutive slots.  The MATCH,
+   EMPTY and EMPTY_OR_DELETED functions return masks with the bits for
+   the selected control bytes set; the index of the control byte is the
+   bit position shifted right by LANE_SHIFT.  */
+
+#if GCC_VERSION >= 4005 && defined (__SSE2__)
+
+struct hash_table_group
+{
+  typedef char v16qi __attribute__ ((__vector_size__ (16)));
+  typedef unsigned int mask_type;
+
+  static const unsigned width = 16;
+  static const unsigned lane_shift = 0;
+
+  explicit hash_table_group (const unsigned char *ctrl)
+  {
+    memcpy (&m_ctrl, ctrl, sizeof (m_ctrl));
+  }
+
+  /* Return the control bytes equal to H.  */
+  mask_type match (unsigned char h) const
+  {
+    char c = h;
+    v16qi splat = { c, c, c, c, c, c, c, c, c, c, c, c, c, c, c, c };
+    v16qi t = m_ctrl == splat;
+    return __builtin_ia32_pmovmskb128 (t);
+  }
+
+  /* Return the EMPTY control bytes.  */
+  mask_type empty () const { return match (0x80); }
+
+  /* Return the control bytes that do not denote an element, which are
+     exactly those with the sign bit set.  */
+  mask_type empty_or_deleted () const
+  {
+    return __builtin_ia32_pmovmskb128 (m_ctrl);
+  }
+
+  v16qi m_ctrl;
+};
+
+#else
+
+struct hash_table_group
+{
+  typedef uint64_t mask_type;
+
+  static const unsigned width = 8;
+  static const unsigned lane_shift = 3;
+
+  explicit hash_table_group (const unsigned char *ctrl)
+  {
+    /* Byte-wise so the lane order does not depend on endianness; this
+       is still a single load on little-endian hosts.  */
+    m_ctrl = 0;
+    for (unsigned i = 0; i < width; i++)
+      m_ctrl |= (uint64_t) ctrl[i] << (i * 8);
+  }
+
+  /* Return the control bytes equal to H.  This may also report bytes
+     following a true match, but never bytes that do not denote an
+     element; callers compare the elements anyway.  */
+  mask_type match (unsigned char h) const
+  {
+    uint64_t x = m_ctrl ^ (lsbs * h);
+    return (x - lsbs) & ~x & msbs;
+  }
+
+  /* Return the EMPTY control bytes, the ones whose bit 1 is clear
+     among those with the sign bit set.  */
+  mask_type empty () const { return m_ctrl & (~m_ctrl << 6) & msbs; }
+
+  /* Return the control bytes that do not denote an element.  */
+  mask_type empty_or_deleted () const { return m_ctrl & msbs; }
+
+  static const uint64_t lsbs = HOST_WIDE_INT_UC (0x0101010101010101);
+  static const uint64_t msbs = HOST_WIDE_INT_UC (0x8080808080808080);
+
+  uint64_t m_ctrl;
+};
+
+#endif
+
+template <typename Descriptor,
+	  template<typename Type> class Allocator = xcallocator>
+class group_hash_table
+{
+  typedef typename Descriptor::value_type value_type;
+  typedef typename Descriptor::compare_type compare_type;
+  typedef hash_table_group group;
+
+public:
+  explicit group_hash_table (size_t, bool ggc = false,
+			     bool sanitize_eq_and_hash = true,
+			     bool gather_mem_stats = GATHER_STATISTICS,
+			     mem_alloc_origin origin = HASH_TABLE_ORIGIN
+			     CXX_MEM_STAT_INFO);
+  ~group_hash_table ();
+
+  /* Create a group_hash_table in gc memory.  */
+  static group_hash_table *
+  create_ggc (size_t n, bool sanitize_eq_and_hash = true CXX_MEM_STAT_INFO)
+  {
+    group_hash_table *table = ggc_alloc<group_hash_table> ();
+    new (table) group_hash_table (n, true, sanitize_eq_and_hash,
+				  GATHER_STATISTICS, HASH_TABLE_ORIGIN
+				  PASS_MEM_STAT);
+    return table;
+  }
+
+  /* Current size (in entries) of the hash table.  */
+  size_t size () const { return m_size; }
+
+  /* Return the current number of elements in this hash table. */
+  size_t elements () const { return m_n_elements - m_n_deleted; }
+
+  /* Return the current number of elements in this hash table. */
+  size_t elements_with_deleted () const { return m_n_elements; }
+
+  /* This function clears all entries in this hash table.  */
+  void empty () { if (elements ()) empty_slow (); }
+
+  /* Return true when there are no elements in this hash table.  */
+  bool is_empty () const { return elements () == 0; }
+
+  /* These functions behave like their hash_table counterparts.  */
+  void clear_slot (value_type *);
+  value_type &find_with_hash (const compare_type &, hashval_t);
+  value_type &find (const value_type &value)
+    {
+      return find_with_hash (value, Descriptor::hash (value));
+    }
+  value_type *find_slot (const value_type &value, insert_option insert)
+    {
+      return find_slot_with_hash (value, Descriptor::hash (value), insert);
+    }
+  value_type *find_slot_with_hash (const compare_type &comparable,
+				   hashval_t hash, enum insert_option insert);
+  void remove_elt_with_hash (const compare_type &, hashval_t);
+  void remove_elt (const value_type &value)
+    {
+      remove_elt_with_hash (value, Descriptor::hash (value));
+    }
+  template <typename Argument,
+	    int (*Callback) (value_type *slot, Argument argument)>
+  void traverse_noresize (Argument argument);
+  template <typename Argument,
+	    int (*Callback) (value_type *slot, Argument argument)>
+  void traverse (Argument argument);
+
+  class iterator
+  {
+  public:
+    iterator () : m_slot (NULL), m_limit (NULL), m_ctrl (NULL) {}
+
+    iterator (value_type *slot, value_type *limit,
+	      const unsigned char *ctrl) :
+      m_slot (slot), m_limit (limit), m_ctrl (ctrl) {}
+
+    inline value_type &operator * () { return *m_slot; }
+    void slide ();
+    inline iterator &operator ++ ();
+    bool operator != (const iterator &other) const
+      {
+	return m_slot != other.m_slot || m_limit != other.m_limit;
+      }
+
+  private:
+    value_type *m_slot;
+    value_type *m_limit;
+    /* The control byte of M_SLOT.  */
+    const unsigned char *m_ctrl;
+  };
+
+  iterator begin () const
+    {
+      check_complete_insertion ();
+      iterator iter (m_entries, m_entries + m_size, ctrl ());
+      iter.slide ();
+      return iter;
+    }
+
+  iterator end () const { return iterator (); }
+
+  double collisions () const
+    {
+      return m_searches ? static_cast <double> (m_collisions) / m_searches : 0;
+    }
+
+private:
+  void operator= (group_hash_table&);
+  group_hash_table (const group_hash_table &);
+
+  template<typename T> friend void gt_ggc_mx (group_hash_table<T> *);
+  template<typename T> friend void gt_pch_nx (group_hash_table<T> *);
+  template<typename T> friend void
+    group_hashtab_entry_note_pointers (void *, void *, gt_pointer_operator,
+				       void *);
+  template<typename T> friend void gt_pch_nx (group_hash_table<T> *,
+					      gt_pointer_operator, void *);
+  template<typename T> friend void gt_cleare_cache (group_hash_table<T> *);
+
+  /* Control byte values.  Control bytes of slots holding an element
+     are the low seven bits of the mixed hash value.  */
+  static const unsigned char ctrl_empty = 0x80;
+  static const unsigned char ctrl_deleted = 0xfe;
+
+  static bool full_p (unsigned char c) { return c < 0x80; }
+
+  /* The control bytes, following the M_SIZE slots.  */
+  unsigned char *ctrl () const
+  {
+    return reinterpret_cast<unsigned char *> (m_entries + m_size);
+  }
+
+  /* The number of value_type sized units needed for a table of SIZE
+     slots, including the control bytes and the copy of the first
+     group.  */
+  static size_t alloc_units (size_t size)
+  {
+    return size + CEIL (size + group::width, sizeof (value_type));
+  }
+
+  /* Return the smallest valid table size for N slots.  */
+  static size_t size_for (size_t n)
+  {
+    size_t size = group::width;
+    while (size < n)
+      size *= 2;
+    return size;
+  }
+
+  /* Return the slot at which probing for HASH starts and store the
+     control byte of HASH to *H.  The hash value is mixed first, since
+     many descriptors hash to small or aligned integers; the slot and
+     the control byte are taken from the well mixed upper bits.  */
+  size_t probe_start (hashval_t hash, unsigned char *h) const
+  {
+    uint64_t m = (uint64_t) hash * HOST_WIDE_INT_UC (0x9e3779b97f4a7c15);
+    *h = (m >> (64 - 7 - m_log2_size)) & 0x7f;
+    return m >> (64 - m_log2_size);
+  }
+
+  static size_t lane (typename group::mask_type mask)
+  {
+    return ctz_hwi (mask) >> group::lane_shift;
+  }
+
+  /* Set the control byte of slot I to C.  */
+  void set_ctrl (size_t i, unsigned char c)
+  {
+    unsigned char *ctrl = this->ctrl ();
+    ctrl[i] = c;
+    if (i < group::width)
+      ctrl[m_size + i] = c;
+  }
+
+  void empty_slow ();
+  value_type *alloc_entries (size_t n CXX_MEM_STAT_INFO) const;
+  void free_entries (value_type *, size_t, bool = false);
+  size_t find_empty_slot_for_expand (hashval_t);
+  void verify (const compare_type &comparable, hashval_t hash);
+  bool too_empty_p (size_t elts) { return elts * 8 < m_size && m_size > 32; }
+  void expand ();
+
+  static bool is_empty (value_type &v) { return Descriptor::is_empty (v); }
+  static void mark_empty (value_type &v) { Descriptor::mark_empty (v); }
+
+public:
+  void check_complete_insertion () const
+  {
+#if CHECKING_P
+    if (!m_inserting_slot)
+      return;
+
+    gcc_checking_assert (m_inserting_slot >= &m_entries[0]
+			 && m_inserting_slot < &m_entries[m_size]);
+
+    if (!is_empty (*m_inserting_slot))
+      m_inserting_slot = NULL;
+    else
+      gcc_unreachable ();
+#endif
+  }
+
+private:
+  value_type *check_insert_slot (value_type *ret)
+  {
+#if CHECKING_P
+    gcc_checking_assert (is_empty (*ret));
+    m_inserting_slot = ret;
+#endif
+    return ret;
+  }
+
+#if CHECKING_P
+  mutable value_type *m_inserting_slot;
+#endif
+
+  /* The slots, followed by the control bytes.  */
+  value_type *m_entries;
+
+  /* The number of slots, a power of two.  */
+  size_t m_size;
+
+  /* Current number of elements including also deleted elements.  */
+  size_t m_n_elements;
+
+  /* Current number of deleted elements in the table.  */
+  size_t m_n_deleted;
+
+  /* The number of lookups and the number of additional groups they
+     probed, for collisions.  */
+  unsigned int m_searches;
+  unsigned int m_collisions;
+
+  /* log2 of M_SIZE.  */
+  unsigned int m_log2_size;
+
+  /* if m_entries is stored in ggc memory.  */
+  bool m_ggc;
+
+  /* True if the table should be sanitized for equal and hash functions.  */
+  bool m_sanitize_eq_and_hash;
+
+  /* If we should gather memory statistics for the table.  */
+#if GATHER_STATISTICS
+  bool m_gather_mem_stats;
+#else
+  static const bool m_gather_mem_stats = false;
+#endif
+};
+
+template<typename Descriptor, template<typename Type> class Allocator>
+group_hash_table<Descriptor, Allocator>::group_hash_table
+  (size_t size, bool ggc, bool sanitize_eq_and_hash,
+   bool gather_mem_stats ATTRIBUTE_UNUSED, mem_alloc_origin origin
+   MEM_STAT_DECL) :
+#if CHECKING_P
+  m_inserting_slot (0),
+#endif
+  m_n_elements (0), m_n_deleted (0), m_searches (0), m_collisions (0),
+  m_ggc (ggc), m_sanitize_eq_and_hash (sanitize_eq_and_hash)
+#if GATHER_STATISTICS
+  , m_gather_mem_stats (gather_mem_stats)
+#endif
+{
+  if (m_gather_mem_stats)
+    hash_table_usage ().register_descriptor (this, origin, ggc
+					     FINAL_PASS_MEM_STAT);
+
+  m_size = size_for (size);
+  m_log2_size = exact_log2 (m_size);
+  m_entries = alloc_entries (m_size PASS_MEM_STAT);
+}
+
+template<typename Descriptor, template<typename Type> class Allocator>
+group_hash_table<Descriptor, Allocator>::~group_hash_table ()
+{
+  check_complete_insertion ();
+
+  const unsigned char *ctrl = this->ctrl ();
+  for (size_t i = 0; i < m_size; i++)
+    if (full_p (ctrl[i]))
+      Descriptor::remove (m_entries[i]);
+
+  free_entries (m_entries, m_size, true);
+}
+
+/* Return an array for N slots with all slots empty.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+inline typename group_hash_table<Descriptor, Allocator>::value_type *
+group_hash_table<Descriptor, Allocator>::alloc_entries (size_t n
+							MEM_STAT_DECL) const
+{
+  value_type *nentries;
+  size_t units = alloc_units (n);
+
+  if (m_gather_mem_stats)
+    hash_table_usage ().register_instance_overhead (sizeof (value_type)
+						    * units, this);
+
+  if (!m_ggc)
+    nentries = Allocator <value_type> ::data_alloc (units);
+  else
+    nentries = ::ggc_cleared_vec_alloc<value_type> (units PASS_MEM_STAT);
+
+  gcc_assert (nentries != NULL);
+  if (!Descriptor::empty_zero_p)
+    for (size_t i = 0; i < n; i++)
+      mark_empty (nentries[i]);
+  memset (reinterpret_cast<unsigned char *> (nentries + n), ctrl_empty,
+	  n + group::width);
+
+  return nentries;
+}
+
+/* Free the array ENTRIES of N slots.  FINAL is true when the table
+   itself goes away.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+inline void
+group_hash_table<Descriptor, Allocator>::free_entries (value_type *entries,
+						       size_t n, bool final)
+{
+  if (!m_ggc)
+    Allocator <value_type> ::data_free (entries);
+  else
+    ggc_free (entries);
+  if (m_gather_mem_stats)
+    hash_table_usage ().release_instance_overhead (this, sizeof (value_type)
+						   * alloc_units (n), final);
+}
+
+/* Return an empty slot for an element with HASH, setting its control
+   byte.  Like hash_table::find_empty_slot_for_expand this assumes the
+   table has no deleted slots.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+size_t
+group_hash_table<Descriptor, Allocator>::find_empty_slot_for_expand
+  (hashval_t hash)
+{
+  unsigned char h;
+  size_t mask = m_size - 1;
+  size_t pos = probe_start (hash, &h);
+  for (size_t step = group::width; ; step += group::width)
+    {
+      group g (ctrl () + pos);
+      if (typename group::mask_type empty = g.empty ())
+	{
+	  size_t i = (pos + lane (empty)) & mask;
+	  set_ctrl (i, h);
+	  return i;
+	}
+      pos = (pos + step) & mask;
+    }
+}
+
+/* Rehash the table into a table about half full, or into one of the
+   same size if that would be the case already once the deleted slots
+   are dropped.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+void
+group_hash_table<Descriptor, Allocator>::expand ()
+{
+  check_complete_insertion ();
+
+  value_type *oentries = m_entries;
+  const unsigned char *octrl = ctrl ();
+  size_t osize = m_size;
+  size_t elts = elements ();
+
+  size_t nsize = osize;
+  if (elts * 2 > osize || too_empty_p (elts))
+    nsize = size_for (elts * 2);
+
+  m_entries = alloc_entries (nsize);
+  m_size = nsize;
+  m_log2_size = exact_log2 (nsize);
+  m_n_elements -= m_n_deleted;
+  m_n_deleted = 0;
+
+  for (size_t i = 0; i < osize; i++)
+    if (full_p (octrl[i]))
+      {
+	value_type &x = oentries[i];
+	size_t j = find_empty_slot_for_expand (Descriptor::hash (x));
+	new ((void*) (m_entries + j)) value_type (std::move (x));
+	x.~value_type ();
+      }
+
+  free_entries (oentries, osize);
+}
+
+/* Implements empty() in cases where it isn't a no-op.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+void
+group_hash_table<Descriptor, Allocator>::empty_slow ()
+{
+  check_complete_insertion ();
+
+  size_t size = m_size;
+  const unsigned char *ctrl = this->ctrl ();
+  for (size_t i = 0; i < size; i++)
+    if (full_p (ctrl[i]))
+      Descriptor::remove (m_entries[i]);
+
+  /* Instead of clearing megabyte, downsize the table.  */
+  size_t nsize = size;
+  if (size > 1024*1024 / sizeof (value_type))
+    nsize = size_for (1024 / sizeof (value_type));
+  else if (too_empty_p (m_n_elements))
+    nsize = size_for (m_n_elements * 2);
+
+  if (nsize != size)
+    {
+      free_entries (m_entries, size);
+      m_entries = alloc_entries (nsize);
+      m_size = nsize;
+      m_log2_size = exact_log2 (nsize);
+    }
+  else
+    {
+      if (Descriptor::empty_zero_p)
+	memset ((void *) m_entries, 0, size * sizeof (value_type));
+      else
+	for (size_t i = 0; i < size; i++)
+	  mark_empty (m_entries[i]);
+      memset (this->ctrl (), ctrl_empty, size + group::width);
+    }
+
+  m_n_deleted = 0;
+  m_n_elements = 0;
+}
+
+/* This function clears a specified SLOT in a hash table.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+void
+group_hash_table<Descriptor, Allocator>::clear_slot (value_type *slot)
+{
+  check_complete_insertion ();
+
+  size_t i = slot - m_entries;
+  gcc_checking_assert (i < m_size && full_p (ctrl ()[i]));
+
+  Descriptor::remove (*slot);
+
+  mark_empty (*slot);
+  set_ctrl (i, ctrl_deleted);
+  m_n_deleted++;
+}
+
+/* Return the element equal to COMPARABLE with the given HASH value, or
+   an empty element if there is none.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+typename group_hash_table<Descriptor, Allocator>::value_type &
+group_hash_table<Descriptor, Allocator>
+::find_with_hash (const compare_type &comparable, hashval_t hash)
+{
+  m_searches++;
+
+  check_complete_insertion ();
+
+#if CHECKING_P
+  if (m_sanitize_eq_and_hash)
+    verify (comparable, hash);
+#endif
+
+  unsigned char h;
+  size_t mask = m_size - 1;
+  size_t pos = probe_start (hash, &h);
+  const unsigned char *ctrl = this->ctrl ();
+  for (size_t step = group::width; ; step += group::width)
+    {
+      group g (ctrl + pos);
+      for (typename group::mask_type m = g.match (h); m; m &= m - 1)
+	{
+	  value_type &entry = m_entries[(pos + lane (m)) & mask];
+	  if (Descriptor::equal (entry, comparable))
+	    return entry;
+	}
+      if (typename group::mask_type empty = g.empty ())
+	return m_entries[(pos + lane (empty)) & mask];
+      m_collisions++;
+      pos = (pos + step) & mask;
+    }
+}
+
+/* Return the slot of the element equal to COMPARABLE with the given
+   HASH value.  If there is none, return NULL when INSERT is NO_INSERT,
+   and otherwise claim an empty slot the caller must write the new
+   element into.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+typename group_hash_table<Descriptor, Allocator>::value_type *
+group_hash_table<Descriptor, Allocator>
+::find_slot_with_hash (const compare_type &comparable, hashval_t hash,
+		       enum insert_option insert)
+{
+  /* Keep at most 7/8 of the slots used, counting deleted ones, so every
+     probe sequence ends at an EMPTY control byte.  */
+  if (insert == INSERT && (m_n_elements + 1) * 8 > m_size * 7)
+    expand ();
+  else
+    check_complete_insertion ();
+
+#if CHECKING_P
+  if (m_sanitize_eq_and_hash)
+    verify (comparable, hash);
+#endif
+
+  m_searches++;
+  unsigned char h;
+  size_t mask = m_size - 1;
+  size_t pos = probe_start (hash, &h);
+  const unsigned char *ctrl = this->ctrl ();
+  size_t free_slot = m_size;
+  for (size_t step = group::width; ; step += group::width)
+    {
+      group g (ctrl + pos);
+      for (typename group::mask_type m = g.match (h); m; m &= m - 1)
+	{
+	  size_t i = (pos + lane (m)) & mask;
+	  if (Descriptor::equal (m_entries[i], comparable))
+	    return &m_entries[i];
+	}
+      if (free_slot == m_size)
+	if (typename group::mask_type m = g.empty_or_deleted ())
+	  free_slot = (pos + lane (m)) & mask;
+      if (g.empty ())
+	break;
+      m_collisions++;
+      pos = (pos + step) & mask;
+    }
+
+  if (insert == NO_INSERT)
+    return NULL;
+
+  if (ctrl[free_slot] == ctrl_deleted)
+    m_n_deleted--;
+  else
+    m_n_elements++;
+  set_ctrl (free_slot, h);
+  return check_insert_slot (&m_entries[free_slot]);
+}
+
+/* Verify that all existing elements in the hash table which are
+   equal to COMPARABLE have an equal HASH value provided as argument.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+void
+group_hash_table<Descriptor, Allocator>
+::verify (const compare_type &comparable, hashval_t hash)
+{
+  const unsigned char *ctrl = this->ctrl ();
+  for (size_t i = 0; i < MIN (hash_table_sanitize_eq_limit, m_size); i++)
+    if (full_p (ctrl[i])
+	&& hash != Descriptor::hash (m_entries[i])
+	&& Descriptor::equal (m_entries[i], comparable))
+      hashtab_chk_error ();
+}
+
+/* This function deletes an element with the given COMPARABLE value
+   from hash table starting with the given HASH.  If there is no
+   matching element in the hash table, this function does nothing. */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+void
+group_hash_table<Descriptor, Allocator>
+::remove_elt_with_hash (const compare_type &comparable, hashval_t hash)
+{
+  value_type *slot = find_slot_with_hash (comparable, hash, NO_INSERT);
+  if (slot)
+    clear_slot (slot);
+}
+
+/* This function scans over the entire hash table calling CALLBACK for
+   each live entry.  If CALLBACK returns false, the iteration stops.
+   ARGUMENT is passed as CALLBACK's second argument. */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Argument,
+	 int (*Callback)
+	 (typename group_hash_table<Descriptor, Allocator>::value_type *slot,
+	 Argument argument)>
+void
+group_hash_table<Descriptor, Allocator>::traverse_noresize (Argument argument)
+{
+  check_complete_insertion ();
+
+  const unsigned char *ctrl = this->ctrl ();
+  for (size_t i = 0; i < m_size; i++)
+    if (full_p (ctrl[i]))
+      if (! Callback (&m_entries[i], argument))
+	break;
+}
+
+/* Like traverse_noresize, but does resize the table when it is too empty
+   to improve effectivity of subsequent calls.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+template<typename Argument,
+	 int (*Callback)
+	 (typename group_hash_table<Descriptor, Allocator>::value_type *slot,
+	 Argument argument)>
+void
+group_hash_table<Descriptor, Allocator>::traverse (Argument argument)
+{
+  if (too_empty_p (elements ()))
+    expand ();
+
+  traverse_noresize <Argument, Callback> (argument);
+}
+
+/* Slide down the iterator slots until an active entry is found.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+void
+group_hash_table<Descriptor, Allocator>::iterator::slide ()
+{
+  for ( ; m_slot < m_limit; ++m_slot, ++m_ctrl)
+    if (full_p (*m_ctrl))
+      return;
+  m_slot = NULL;
+  m_limit = NULL;
+  m_ctrl = NULL;
+}
+
+/* Bump the iterator.  */
+
+template<typename Descriptor, template<typename Type> class Allocator>
+inline typename group_hash_table<Descriptor, Allocator>::iterator &
+group_hash_table<Descriptor, Allocator>::iterator::operator ++ ()
+{
+  ++m_slot;
+  ++m_ctrl;
+  slide ();
+  return *this;
+}
+
+/* ggc walking routines.  */
+
+template<typename E>
+inline void
+gt_ggc_mx (group_hash_table<E> *h)
+{
+  typedef group_hash_table<E> table;
+
+  if (!ggc_test_and_set_mark (h->m_entries))
+    return;
+
+  const unsigned char *ctrl = h->ctrl ();
+  for (size_t i = 0; i < h->m_size; i++)
+    if (table::full_p (ctrl[i]))
+      /* Use ggc_maybe_mx so we don't mark right away for cache tables;
+	 we'll mark in gt_cleare_cache if appropriate.  */
+      E::ggc_maybe_mx (h->m_entries[i]);
+}
+
+template<typename D>
+inline void
+group_hashtab_entry_note_pointers (void *obj, void *h, gt_pointer_operator op,
+				   void *cookie)
+{
+  typedef group_hash_table<D> table;
+  table *map = static_cast<table *> (h);
+  gcc_checking_assert (map->m_entries == obj);
+  const unsigned char *ctrl = map->ctrl ();
+  for (size_t i = 0; i < map->m_size; i++)
+    if (table::full_p (ctrl[i]))
+      D::pch_nx (map->m_entries[i], op, cookie);
+}
+
+template<typename D>
+void
+gt_pch_nx (group_hash_table<D> *h)
+{
+  typedef group_hash_table<D> table;
+  h->check_complete_insertion ();
+  bool success
+    = gt_pch_note_object (h->m_entries, h,
+			  group_hashtab_entry_note_pointers<D>);
+  gcc_checking_assert (success);
+  const unsigned char *ctrl = h->ctrl ();
+  for (size_t i = 0; i < h->m_size; i++)
+    if (table::full_p (ctrl[i]))
+      D::pch_nx (h->m_entries[i]);
+}
+
+template<typename D>
+inline void
+gt_pch_nx (group_hash_table<D> *h, gt_pointer_operator op, void *cookie)
+{
+  op (&h->m_entries, NULL, cookie);
+}
+
+template<typename H>
+inline void
+gt_cleare_cache (group_hash_table<H> *h)
+{
+  typedef group_hash_table<H> table;
+  if (!h)
+    return;
+
+  for (typename table::iterator iter = h->begin (); iter != h->end (); ++iter)
+    {
+      int res = H::keep_cache_entry (*iter);
+      if (res == 0)
+	h->clear_slot (&*iter);
+      else if (res != -1)
+	H::ggc_mx (*iter);
+    }
+}
+
+#endif /* GCC_GROUP_HASH_TABLE_H */
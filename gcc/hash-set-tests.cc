@@ -23,6 +23,7 @@ along with GCC; see the file COPYING3.  If not see
 #include "tm.h"
 #include "opts.h"
 #include "hash-set.h"
+#include "group-hash-table.h"
 #include "selftest.h"
 
 #if CHECKING_P
@@ -290,6 +291,113 @@ test_set_of_type_with_ctor_and_dtor ()
   ASSERT_TRUE (val_t::ndefault + val_t::ncopy == val_t::ndtor);
 }
 
+/* Descriptor for integers other than 0 and 1 with many hash collisions.  */
+
+struct colliding_int_hash : int_hash <int, 0, 1>
+{
+  static hashval_t hash (int i) { return i % 61; }
+};
+
+static int
+sum_elements (int *slot, int *sum)
+{
+  *sum += *slot;
+  return 1;
+}
+
+/* Run the same random sequence of insertions, lookups and removals on a
+   group_hash_table and on a hash_table and verify that they agree.  */
+
+static void
+test_group_hash_table ()
+{
+  group_hash_table<colliding_int_hash> g (4);
+  hash_table<colliding_int_hash> h (4);
+  unsigned int x = 1;
+
+  for (unsigned int i = 0; i < 20000; i++)
+    {
+      x = x * 1103515245 + 12345;
+      int k = 2 + (x >> 8) % 3000;
+      hashval_t hash = colliding_int_hash::hash (k);
+      switch ((x >> 4) % 3)
+	{
+	case 0:
+	  {
+	    int *gslot = g.find_slot_with_hash (k, hash, INSERT);
+	    int *hslot = h.find_slot_with_hash (k, hash, INSERT);
+	    ASSERT_EQ (*hslot, *gslot);
+	    *gslot = *hslot = k;
+	    break;
+	  }
+	case 1:
+	  ASSERT_EQ (h.find_with_hash (k, hash), g.find_with_hash (k, hash));
+	  break;
+	case 2:
+	  g.remove_elt_with_hash (k, hash);
+	  h.remove_elt_with_hash (k, hash);
+	  break;
+	}
+      ASSERT_EQ (h.elements (), g.elements ());
+    }
+
+  int gsum = 0, hsum = 0;
+  size_t n = 0;
+  for (group_hash_table<colliding_int_hash>::iterator it = g.begin ();
+       it != g.end (); ++it, ++n)
+    gsum += *it;
+  h.traverse_noresize <int *, sum_elements> (&hsum);
+  ASSERT_EQ (h.elements (), n);
+  ASSERT_EQ (hsum, gsum);
+  gsum = 0;
+  g.traverse <int *, sum_elements> (&gsum);
+  ASSERT_EQ (hsum, gsum);
+
+  g.empty ();
+  ASSERT_EQ (0, g.elements ());
+  ASSERT_EQ (0, g.find_with_hash (5, colliding_int_hash::hash (5)));
+  ASSERT_EQ (NULL, g.find_slot_with_hash (5, colliding_int_hash::hash (5),
+					  NO_INSERT));
+  for (group_hash_table<colliding_int_hash>::iterator it = g.begin ();
+       it != g.end (); ++it)
+    ASSERT_EQ (true, false);
+}
+
+/* Descriptor for integers hashed like scattered string hashes.  */
+
+struct scattered_int_hash : int_hash <int, 0, 1>
+{
+  static hashval_t hash (int i) { return (hashval_t) i * 0x9e3779b1; }
+};
+
+/* Insert N keys hashed by HASHER into a hash_table and a group_hash_table,
+   then look up each of them and as many absent keys, and verify that both
+   tables find exactly the keys present.  */
+
+template<typename Hasher>
+static void
+test_group_hash_table_lookups (unsigned n)
+{
+  hash_table<Hasher> h (n);
+  group_hash_table<Hasher> g (n);
+
+  for (unsigned i = 0; i < n; i++)
+    {
+      int k = 2 + i;
+      *h.find_slot_with_hash (k, Hasher::hash (k), INSERT) = k;
+      *g.find_slot_with_hash (k, Hasher::hash (k), INSERT) = k;
+    }
+  ASSERT_EQ (n, h.elements ());
+  ASSERT_EQ (n, g.elements ());
+  for (unsigned i = 0; i < 2 * n; i++)
+    {
+      int k = 2 + i;
+      int expected = i < n ? k : 0;
+      ASSERT_EQ (expected, h.find_with_hash (k, Hasher::hash (k)));
+      ASSERT_EQ (expected, g.find_with_hash (k, Hasher::hash (k)));
+    }
+}
+
 /* Run all of the selftests within this file.  */
 
 void
@@ -297,6 +405,9 @@ hash_set_tests_cc_tests ()
 {
   test_set_of_strings ();
   test_set_of_type_with_ctor_and_dtor ();
+  test_group_hash_table ();
+  test_group_hash_table_lookups<scattered_int_hash> (1000);
+  test_group_hash_table_lookups<int_hash <int, 0, 1> > (1000);
 }
 
 } // namespace selftest
@@ -266,11 +266,16 @@ remove_duplicates (cpp_reader *pfile, struct cpp_dir *head,
 	    cpp_errno (pfile, CPP_DL_ERROR, cur->name);
 	  else
 	    {
-	      /* If -Wmissing-include-dirs is given, warn.  */
 	      cpp_options *opts = cpp_get_options (pfile);
+	      int err = errno;
+
+	      /* If -Wmissing-include-dirs is given, warn.  */
 	      if (opts->warn_missing_include_dirs && cur->user_supplied_p)
 		cpp_warning (pfile, CPP_W_MISSING_INCLUDE_DIRS, "%s: %s",
-			     cur->name, xstrerror (errno));
+			     cur->name, xstrerror (err));
+	      /* For -fdepfile-digests, creating it may change the output.  */
+	      if (err == ENOENT)
+		cpp_add_nonexistent_dir (pfile, cur->name);
 	      reason = REASON_NOENT;
 	    }
 	}
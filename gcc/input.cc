@@ -1230,6 +1230,10 @@ dump_line_table_statistics (void)
   if (s.num_expanded_macros != 0)
     fprintf (stderr, "Average number of tokens per macro expansion:  %5ld\n",
              s.num_macro_tokens / s.num_expanded_macros);
+  fprintf (stderr, "Number of macro expansion buffers:             %5ld\n",
+           s.num_macro_buffs);
+  fprintf (stderr, "Number of macro expansion buffers allocated:   %5ld\n",
+           s.num_macro_buff_allocs);
   fprintf (stderr,
            "\nLine Table allocations during the "
 	   "compilation process\n");
@@ -2179,6 +2183,57 @@ test_accessing_ordinary_linemaps (const line_table_case &case_)
   ASSERT_EQ (loc_d, src_range.m_finish);
 }
 
+/* Verify that looking up locations from many maps finds the right maps,
+   both in an order that defeats the lookup cache and in the interleaved
+   order it is meant for.  */
+
+static void
+test_lookup_many_linemaps (const line_table_case &case_)
+{
+  line_table_test ltt (case_);
+  const unsigned num_maps = 300;
+  auto_vec<location_t> locs;
+  /* The start locations of the maps of LOCS; the maps themselves move
+     as more are added.  */
+  auto_vec<location_t> starts;
+
+  linemap_add (line_table, LC_ENTER, false, "foo.c", 0);
+  for (unsigned i = 0; i < num_maps; i++)
+    {
+      linemap_add (line_table, LC_ENTER, false, "bar.h", 0);
+      linemap_line_start (line_table, i + 1, 100);
+      location_t loc = linemap_position_for_column (line_table, 5);
+      locs.safe_push (loc);
+      starts.safe_push (MAP_START_LOCATION (linemap_lookup (line_table,
+							    loc)));
+
+      const line_map_macro *macro_map
+	= linemap_enter_macro (line_table, NULL, loc, 3);
+      ASSERT_NE (macro_map, NULL);
+      locs.safe_push (MAP_START_LOCATION (macro_map) + 2);
+      starts.safe_push (MAP_START_LOCATION (macro_map));
+      linemap_add (line_table, LC_LEAVE, false, NULL, 0);
+    }
+  linemap_add (line_table, LC_LEAVE, false, NULL, 0);
+
+  for (unsigned i = 0; i < locs.length (); i++)
+    {
+      unsigned ix = (i * 37) % locs.length ();
+      ASSERT_EQ (starts[ix],
+		 MAP_START_LOCATION (linemap_lookup (line_table, locs[ix])));
+    }
+
+  /* Two interleaved in-order streams, one from the start and one from
+     the middle, as debug output and diagnostics do.  */
+  unsigned n = locs.length ();
+  for (unsigned i = 0; i < n; i++)
+    {
+      unsigned ix = (i & 1) ? n / 2 + i / 2 : i / 2;
+      ASSERT_EQ (starts[ix],
+		 MAP_START_LOCATION (linemap_lookup (line_table, locs[ix])));
+    }
+}
+
 /* Verify various properties of UNKNOWN_LOCATION.  */
 
 static void
@@ -3845,6 +3900,92 @@ test_lexer_char_constants (const line_table_case &case_)
   ASSERT_EQ (tok->type, CPP_CHAR);
   ASSERT_TOKEN_AS_TEXT_EQ (test.m_parser, tok, "'abc'");
 }
+
+/* Test of skipping a conditional block, which is scanned for lines
+   starting with '#' without lexing most of it.  */
+
+static void
+test_lexer_skipped_block (const line_table_case &case_)
+{
+  const char *content = ("#if 0\n"
+			 "int x = f (\"#\", '\"', \"/*\");\n"
+			 "x /* comment */ # error not a directive\n"
+			 "  /* comment\n"
+			 "#error in a comment\n"
+			 "*/ # error after a comment\n"
+			 "R\"delim(\n"
+			 "#error in a raw string\n"
+			 ")delim\"\n"
+			 "x \\\n"
+			 "# error after an escaped newline\n"
+			 "don't\n"
+			 "  /**/ %: else\n"
+			 "found\n"
+			 "#endif\n");
+  lexer_diagnostic_sink diagnostics;
+  lexer_test test (case_, content, &diagnostics);
+
+  const cpp_token *tok = test.get_token ();
+  ASSERT_EQ (tok->type, CPP_NAME);
+  ASSERT_TOKEN_AS_TEXT_EQ (test.m_parser, tok, "found");
+  ASSERT_TOKEN_LOC_EQ (tok, test.m_tempfile.get_filename (), 14, 1, 5);
+
+  /* We expect just "missing terminating ' character".  */
+  ASSERT_EQ (1, diagnostics.m_diagnostics.length ());
+}
+
+/* Verify that a block skipped by #if 0 that mixes code, comments with
+   '#' in them, string and character literals, nested conditionals and
+   directives is skipped as a whole, and that the token after it gets
+   the right location.  */
+
+static void
+test_lexer_skipped_block_mixed (const line_table_case &case_)
+{
+  const unsigned num_lines = 60;
+  struct obstack content;
+  obstack_init (&content);
+  obstack_grow (&content, "#if 0\n", strlen ("#if 0\n"));
+  for (unsigned i = 0; i < num_lines; i++)
+    {
+      char *text;
+      switch (i % 6)
+	{
+	case 0:
+	  text = xasprintf ("static int f%u (int x, const char *s);\n", i);
+	  break;
+	case 1:
+	  text = xasprintf ("  /* Return X times %u.  */\n", i);
+	  break;
+	case 2:
+	  text = xasprintf ("  return g (\"%%d: #%u\", '#') + x * %u;"
+			    " // #endif\n", i, i);
+	  break;
+	case 3:
+	  text = xasprintf ("#define M%u(x) ((x) + %u)\n", i, i);
+	  break;
+	case 4:
+	  text = xasprintf ("#ifdef M%u\n", i - 1);
+	  break;
+	default:
+	  text = xstrdup ("#endif\n");
+	  break;
+	}
+      obstack_grow (&content, text, strlen (text));
+      free (text);
+    }
+  obstack_grow0 (&content, "#endif\nfound\n", strlen ("#endif\nfound\n"));
+
+  lexer_test test (case_, (const char *) obstack_finish (&content), NULL);
+  obstack_free (&content, NULL);
+
+  const cpp_token *tok = test.get_token ();
+  ASSERT_EQ (tok->type, CPP_NAME);
+  ASSERT_TOKEN_AS_TEXT_EQ (test.m_parser, tok, "found");
+  ASSERT_TOKEN_LOC_EQ (tok, test.m_tempfile.get_filename (), num_lines + 3,
+		       1, 5);
+}
+
 /* A table of interesting location_t values, giving one axis of our test
    matrix.  */
 
@@ -4156,6 +4297,7 @@ input_cc_tests ()
   for_each_line_table_case (test_make_location_nonpure_range_endpoints);
 
   for_each_line_table_case (test_accessing_ordinary_linemaps);
+  for_each_line_table_case (test_lookup_many_linemaps);
   for_each_line_table_case (test_lexer);
   for_each_line_table_case (test_lexer_string_locations_simple);
   for_each_line_table_case (test_lexer_string_locations_ebcdic);
@@ -4181,6 +4323,8 @@ input_cc_tests ()
   for_each_line_table_case (test_lexer_string_locations_raw_string_multiline);
   for_each_line_table_case (test_lexer_string_locations_raw_string_unterminated);
   for_each_line_table_case (test_lexer_char_constants);
+  for_each_line_table_case (test_lexer_skipped_block);
+  for_each_line_table_case (test_lexer_skipped_block_mixed);
 
   test_reading_source_line ();
 
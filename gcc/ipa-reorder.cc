@@ -0,0 +1,402 @@
+/* Profile-driven function ordering.
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+This file is part of GCC.
+
+GCC is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free
+Software Foundation; either version 3, or (at your option) any later
+version.
+
+GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with GCC; see the file COPYING3.  If not see
+<http://www.gnu.org/licenses/>.  */
+
+/* This pass implements -freorder-functions-algorithm=call-chain-clustering.
+   It orders the functions that the profile says are executed so that
+   callers and their hottest callees end up next to each other, using the
+   C3 algorithm described in "Optimizing Function Placement for
+   Large-Scale Data-Center Applications" by Ottoni and Maher (CGO 2017):
+
+     - Every executed function starts out in a cluster of its own.
+
+     - The functions are visited from the most to the least executed.
+       The cluster of each is appended to the cluster of its most
+       frequent caller, unless the result would be larger than a page or
+       the callee's cluster is much denser than the caller's.
+
+     - The clusters are output from the densest (executions per unit of
+       size) to the least dense.
+
+   The pass runs after inlining, as only the calls that remain matter
+   and the size summaries then account for the inlined bodies.  It
+   records the order in cgraph_node::text_sorted_order, which is
+   streamed to LTRANS and used both by the balanced LTO partitioning, so
+   that a cluster stays within a partition, and by expand_all_functions,
+   which outputs the functions in that order.  */
+
+#include "config.h"
+#include "system.h"
+#include "coretypes.h"
+#include "backend.h"
+#include "tree.h"
+#include "gimple.h"
+#include "tree-pass.h"
+#include "cgraph.h"
+#include "symbol-summary.h"
+#include "tree-vrp.h"
+#include "sreal.h"
+#include "ipa-cp.h"
+#include "ipa-prop.h"
+#include "ipa-fnsummary.h"
+
+namespace {
+
+/* A cluster of functions that are to be output next to each other.  */
+
+struct c3_cluster
+{
+  /* The functions of the cluster, in order.  */
+  vec<cgraph_node *> nodes;
+  /* The total estimated size and execution count of the functions.  */
+  HOST_WIDE_INT size;
+  gcov_type count;
+
+  /* The number of executions per unit of size.  */
+  double density () const { return (double) count / MAX (size, 1); }
+};
+
+/* What the pass knows about a function, pointed to by its aux field.  */
+
+struct c3_node
+{
+  /* The cluster the function is in, or NULL if it is never executed.  */
+  c3_cluster *cluster;
+  /* The estimated size of the function, and its offset in the layout
+     being measured.  */
+  HOST_WIDE_INT size;
+  HOST_WIDE_INT offset;
+  /* The caller that calls the function most often, and how often.  */
+  cgraph_node *best_caller;
+  gcov_type best_weight;
+};
+
+typedef pair_hash <nofree_ptr_hash <cgraph_node>,
+		   nofree_ptr_hash <cgraph_node> > node_pair_hash;
+
+/* The number of times each function calls each other, keyed by caller
+   and callee.  */
+typedef hash_map <node_pair_hash, gcov_type> call_weights;
+
+static inline c3_node *
+c3_info (cgraph_node *node)
+{
+  return (c3_node *) node->aux;
+}
+
+/* Add to WEIGHTS the calls made from the body of CALLER, which includes
+   the bodies of the functions inlined into NODE.  */
+
+static void
+collect_call_weights (cgraph_node *caller, cgraph_node *node,
+		      call_weights *weights)
+{
+  for (cgraph_edge *e = node->callees; e; e = e->next_callee)
+    {
+      if (!e->inline_failed)
+	{
+	  collect_call_weights (caller, e->callee, weights);
+	  continue;
+	}
+      cgraph_node *callee = e->callee->ultimate_alias_target ();
+      profile_count count = e->count.ipa ();
+      if (callee == caller || !callee->aux
+	  || !count.initialized_p () || !count.nonzero_p ())
+	continue;
+      bool existed;
+      gcov_type &weight = weights->get_or_insert (std::make_pair (caller,
+								  callee),
+						  &existed);
+      weight = (existed ? weight : 0) + count.to_gcov_type ();
+    }
+}
+
+/* Compare the execution counts of the functions at PA and PB, for
+   sorting the most executed first.  */
+
+static int
+node_count_cmp (const void *pa, const void *pb)
+{
+  cgraph_node *a = *(cgraph_node * const *) pa;
+  cgraph_node *b = *(cgraph_node * const *) pb;
+  gcov_type ca = a->count.ipa ().to_gcov_type ();
+  gcov_type cb = b->count.ipa ().to_gcov_type ();
+
+  if (ca != cb)
+    return ca > cb ? -1 : 1;
+  return a->order - b->order;
+}
+
+/* Compare the clusters at PA and PB, for sorting the densest first.  */
+
+static int
+cluster_density_cmp (const void *pa, const void *pb)
+{
+  const c3_cluster *a = *(const c3_cluster * const *) pa;
+  const c3_cluster *b = *(const c3_cluster * const *) pb;
+  double da = a->density ();
+  double db = b->density ();
+
+  if (da != db)
+    return da > db ? -1 : 1;
+  return a->nodes[0]->order - b->nodes[0]->order;
+}
+
+/* Compare the source order of the functions at PA and PB.  */
+
+static int
+node_order_cmp (const void *pa, const void *pb)
+{
+  cgraph_node *a = *(cgraph_node * const *) pa;
+  cgraph_node *b = *(cgraph_node * const *) pb;
+  return a->order - b->order;
+}
+
+/* Dump to F how the executed functions would be laid out in LAYOUT:
+   their total size, the number of pages of PAGE_SIZE they touch, and
+   how many of the calls in WEIGHTS stay within a page.  */
+
+static void
+dump_layout (FILE *f, const char *what, vec<cgraph_node *> layout,
+	     call_weights *weights, HOST_WIDE_INT page_size)
+{
+  HOST_WIDE_INT offset = 0, hot_size = 0, pages = 0;
+  HOST_WIDE_INT last_page = -1;
+
+  for (cgraph_node *node : layout)
+    {
+      c3_node *info = c3_info (node);
+      info->offset = offset;
+      if (info->cluster && info->size)
+	{
+	  HOST_WIDE_INT first = offset / page_size;
+	  HOST_WIDE_INT last = (offset + info->size - 1) / page_size;
+	  pages += last - MAX (first, last_page + 1) + 1;
+	  last_page = last;
+	  hot_size += info->size;
+	}
+      offset += info->size;
+    }
+
+  gcov_type total = 0, local = 0;
+  for (auto it = weights->begin (); it != weights->end (); ++it)
+    {
+      c3_node *caller = c3_info ((*it).first.first);
+      c3_node *callee = c3_info ((*it).first.second);
+      total += (*it).second;
+      if (caller->offset / page_size == callee->offset / page_size)
+	local += (*it).second;
+    }
+
+  fprintf (f, "%s: hot text size %" PRId64 ", spread over %" PRId64
+	   " pages; %.1f%% of calls within a page\n",
+	   what, (int64_t) hot_size, (int64_t) pages,
+	   total ? 100.0 * local / total : 0.0);
+}
+
+/* Order the executed functions with the C3 algorithm.  */
+
+static unsigned int
+ipa_reorder (void)
+{
+  HOST_WIDE_INT page_size = param_reorder_functions_page_size;
+  auto_vec<cgraph_node *> candidates;
+  auto_vec<cgraph_node *> hot;
+  cgraph_node *node;
+
+  FOR_EACH_DEFINED_FUNCTION (node)
+    {
+      if (node->alias || node->thunk || node->inlined_to
+	  || node->no_reorder || !node->has_gimple_body_p ()
+	  || !opt_for_fn (node->decl, flag_reorder_functions))
+	continue;
+
+      c3_node *info = XCNEW (c3_node);
+      ipa_size_summary *s = ipa_size_summaries
+			    ? ipa_size_summaries->get (node) : NULL;
+      info->size = s ? s->size : 1;
+      node->aux = info;
+      candidates.safe_push (node);
+
+      profile_count count = node->count.ipa ();
+      if (count.initialized_p () && count.nonzero_p ())
+	{
+	  info->cluster = XCNEW (c3_cluster);
+	  info->cluster->nodes.safe_push (node);
+	  info->cluster->size = info->size;
+	  info->cluster->count = count.to_gcov_type ();
+	  hot.safe_push (node);
+	}
+    }
+
+  call_weights weights;
+  if (hot.length ())
+    {
+      for (cgraph_node *caller : candidates)
+	collect_call_weights (caller, caller, &weights);
+
+      /* The hash map is walked in an order that depends on addresses;
+	 break ties on the source order of the callers so that the
+	 layout does not.  */
+      for (auto it = weights.begin (); it != weights.end (); ++it)
+	{
+	  c3_node *callee = c3_info ((*it).first.second);
+	  if ((*it).second > callee->best_weight
+	      || ((*it).second == callee->best_weight
+		  && (*it).first.first->order < callee->best_caller->order))
+	    {
+	      callee->best_caller = (*it).first.first;
+	      callee->best_weight = (*it).second;
+	    }
+	}
+
+      hot.qsort (node_count_cmp);
+      for (cgraph_node *callee : hot)
+	{
+	  c3_node *info = c3_info (callee);
+	  c3_cluster *cluster = info->cluster;
+	  if (!info->best_caller || !c3_info (info->best_caller)->cluster)
+	    continue;
+	  c3_cluster *caller_cluster = c3_info (info->best_caller)->cluster;
+	  if (caller_cluster == cluster
+	      || caller_cluster->size + cluster->size > page_size
+	      || caller_cluster->density () * 8 < cluster->density ())
+	    continue;
+
+	  for (cgraph_node *n : cluster->nodes)
+	    {
+	      c3_info (n)->cluster = caller_cluster;
+	      caller_cluster->nodes.safe_push (n);
+	    }
+	  caller_cluster->size += cluster->size;
+	  caller_cluster->count += cluster->count;
+	  cluster->nodes.release ();
+	  free (cluster);
+	}
+    }
+
+  /* Collect the clusters that remain, and output them densest first.  */
+  auto_vec<c3_cluster *> clusters;
+  for (cgraph_node *n : hot)
+    {
+      c3_cluster *cluster = c3_info (n)->cluster;
+      if (cluster->nodes[0] == n)
+	clusters.safe_push (cluster);
+    }
+  clusters.qsort (cluster_density_cmp);
+
+  auto_vec<cgraph_node *> layout;
+  int order = 0;
+  for (c3_cluster *cluster : clusters)
+    {
+      if (dump_file)
+	fprintf (dump_file, "Cluster of %u functions, size %" PRId64
+		 ", count %" PRId64 ", density %.2f:\n",
+		 cluster->nodes.length (), (int64_t) cluster->size,
+		 (int64_t) cluster->count, cluster->density ());
+      for (cgraph_node *n : cluster->nodes)
+	{
+	  n->text_sorted_order = ++order;
+	  layout.safe_push (n);
+	  if (dump_file)
+	    fprintf (dump_file, "  %s\n", n->dump_asm_name ());
+	}
+    }
+
+  if (dump_file)
+    {
+      fprintf (dump_file, "\n%u executed functions of %u ordered in %u "
+	       "clusters\n", hot.length (), candidates.length (),
+	       clusters.length ());
+
+      /* Compare with the source order, which is what the functions would
+	 be output in otherwise, give or take the call graph order.  */
+      auto_vec<cgraph_node *> source_layout;
+      source_layout.safe_splice (candidates);
+      source_layout.qsort (node_order_cmp);
+      dump_layout (dump_file, "Source order", source_layout, &weights,
+		   page_size);
+
+      for (cgraph_node *n : candidates)
+	if (!c3_info (n)->cluster)
+	  layout.safe_push (n);
+      dump_layout (dump_file, "Call chain clustering order", layout,
+		   &weights, page_size);
+    }
+
+  for (c3_cluster *cluster : clusters)
+    {
+      cluster->nodes.release ();
+      free (cluster);
+    }
+  for (cgraph_node *n : candidates)
+    {
+      free (n->aux);
+      n->aux = NULL;
+    }
+
+  return 0;
+}
+
+const pass_data pass_data_ipa_reorder =
+{
+  IPA_PASS, /* type */
+  "reorder", /* name */
+  OPTGROUP_NONE, /* optinfo_flags */
+  TV_IPA_REORDER, /* tv_id */
+  0, /* properties_required */
+  0, /* properties_provided */
+  0, /* properties_destroyed */
+  0, /* todo_flags_start */
+  0, /* todo_flags_finish */
+};
+
+class pass_ipa_reorder : public ipa_opt_pass_d
+{
+public:
+  pass_ipa_reorder (gcc::context *ctxt)
+    : ipa_opt_pass_d (pass_data_ipa_reorder, ctxt,
+		      NULL, /* generate_summary */
+		      NULL, /* write_summary */
+		      NULL, /* read_summary */
+		      NULL, /* write_optimization_summary */
+		      NULL, /* read_optimization_summary */
+		      NULL, /* stmt_fixup */
+		      0, /* function_transform_todo_flags_start */
+		      NULL, /* function_transform */
+		      NULL) /* variable_transform */
+  {}
+
+  /* opt_pass methods: */
+  bool gate (function *) final override
+  {
+    return (flag_reorder_functions
+	    && flag_reorder_functions_algorithm
+	       == REORDER_FUNCTIONS_ALGORITHM_CALL_CHAIN_CLUSTERING);
+  }
+  unsigned int execute (function *) final override { return ipa_reorder (); }
+
+}; // class pass_ipa_reorder
+
+} // anon namespace
+
+ipa_opt_pass_d *
+make_pass_ipa_reorder (gcc::context *ctxt)
+{
+  return new pass_ipa_reorder (ctxt);
+}
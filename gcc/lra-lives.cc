@@ -1346,6 +1346,7 @@ lra_create_live_ranges_1 (bool all_p, bool dead_insn_p)
   bool bb_live_change_p, have_referenced_pseudos = false;
 
   timevar_push (TV_LRA_CREATE_LIVE_RANGES);
+  statistics_counter_event (cfun, "LRA live range builds", 1);
 
   complete_info_p = all_p;
   if (lra_dump_file != NULL)
@@ -1496,6 +1497,7 @@ lra_create_live_ranges (bool all_p, bool dead_insn_p)
      improvement in rare cases could be possible on this sub-pass if
      we do dead insn elimination again (still the improvement may
      happen later).  */
+  statistics_counter_event (cfun, "LRA live range recalculations", 1);
   lra_clear_live_ranges ();
   bool res = lra_create_live_ranges_1 (all_p, false);
   lra_assert (! res);
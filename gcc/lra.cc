@@ -2316,6 +2316,18 @@ bitmap_head lra_subreg_reload_pseudos;
 /* File used for output of LRA debug information.  */
 FILE *lra_dump_file;
 
+/* The number of times LRA needed live ranges and used the ones it had
+   built, which were still valid.  */
+static int live_ranges_reused;
+
+/* Record that the live ranges built earlier are used again.  */
+static void
+note_live_ranges_reused (void)
+{
+  live_ranges_reused++;
+  statistics_counter_event (cfun, "LRA live range reuses", 1);
+}
+
 /* How verbose should be the debug information. */
 int lra_verbose;
 
@@ -2386,6 +2398,7 @@ lra (FILE *f, int verbose)
   lra_in_progress = true;
 
   lra_live_range_iter = lra_coalesce_iter = lra_constraint_iter = 0;
+  live_ranges_reused = 0;
   lra_assignment_iter = lra_assignment_iter_after_spill = 0;
   lra_inheritance_iter = lra_undo_inheritance_iter = 0;
   lra_rematerialization_iter = 0;
@@ -2501,6 +2514,8 @@ lra (FILE *f, int verbose)
 			  lra_create_live_ranges (true, true);
 			  live_p = true;
 			}
+		      else
+			note_live_ranges_reused ();
 		      if (lra_coalesce ())
 			live_p = false;
 		    }
@@ -2526,6 +2541,8 @@ lra (FILE *f, int verbose)
 	    lra_create_live_ranges (true, true);
 	    live_p = true;
 	  }
+	  else
+	    note_live_ranges_reused ();
 	}
       /* Don't clear optional reloads bitmap until all constraints are
 	 satisfied as we need to differ them from regular reloads.  */
@@ -2540,6 +2557,8 @@ lra (FILE *f, int verbose)
 	  lra_create_live_ranges (lra_reg_spill_p, true);
 	  live_p = true;
 	}
+      else
+	note_live_ranges_reused ();
       /* We should check necessity for spilling here as the above live
 	 range pass can remove spilled pseudos.  */
       if (! lra_need_for_spills_p ())
@@ -2578,6 +2597,10 @@ lra (FILE *f, int verbose)
   lra_in_progress = false;
   if (live_p)
     lra_clear_live_ranges ();
+  if (lra_dump_file != NULL)
+    fprintf (lra_dump_file,
+	     "Live ranges were built %d times and reused %d times\n",
+	     lra_live_range_iter, live_ranges_reused);
   lra_live_ranges_finish ();
   lra_constraints_finish ();
   finish_reg_info ();
@@ -2900,6 +2900,9 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
 
   timevar_pop (TV_IPA_LTO_CGRAPH_IO);
 
+  if (flag_wpa && mem_report_wpa)
+    report_phase_memory_use ("reading");
+
   if (!quiet_flag)
     fprintf (stderr, "\nMerging declarations:");
 
@@ -3004,6 +3007,9 @@ read_cgraph_and_symbols (unsigned nfiles, const char **fnames)
 
   ggc_free (all_file_decl_data);
   all_file_decl_data = NULL;
+
+  if (flag_wpa && mem_report_wpa)
+    report_phase_memory_use ("merging");
 }
 
 
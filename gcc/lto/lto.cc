@@ -528,6 +528,9 @@ do_whole_program_analysis (void)
   if (seen_error ())
     return;
 
+  if (mem_report_wpa)
+    report_phase_memory_use ("IPA");
+
   /* We are about to launch the final LTRANS phase, stop the WPA timer.  */
   timevar_pop (TV_WHOPR_WPA);
 
@@ -578,6 +581,9 @@ do_whole_program_analysis (void)
   dump_file = NULL;
   timevar_pop (TV_WHOPR_PARTITIONING);
 
+  if (mem_report_wpa)
+    report_phase_memory_use ("partitioning");
+
   timevar_stop (TV_PHASE_OPT_GEN);
 
   /* Collect a last time - in lto_wpa_write_files we may end up forking
@@ -596,6 +602,9 @@ do_whole_program_analysis (void)
     fprintf (stderr, "\n");
   timevar_stop (TV_PHASE_STREAM_OUT);
 
+  if (mem_report_wpa)
+    report_phase_memory_use ("streaming out");
+
   if (post_ipa_mem_report)
     dump_memory_report ("Memory consumption after IPA");
 
@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2024 Free Software Foundation, Inc.
+#
+# Script to merge the optimization records of a whole build.
+#
+# This file is part of GCC.
+#
+# GCC is free software; you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free
+# Software Foundation; either version 3, or (at your option) any later
+# version.
+#
+# GCC is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or
+# FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+# for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GCC; see the file COPYING3.  If not see
+# <http://www.gnu.org/licenses/>.  */
+
+DESCRIPTION = """
+Reads the SRCFILE.opt-record.json.gz files written by
+-fsave-optimization-record and the SRCFILE.opt-record.jsonl.gz files
+written by -fsave-optimization-record=jsonl, and merges the records
+that are the same in several translation units, as those of inline
+functions in headers are.  The records are read one at a time from
+JSON Lines files, so only the merged records are held in memory.
+
+The merged records are written in JSON Lines format, one per line,
+with the pass given by name and "count" giving the number of times
+the record was seen.  With --summary, a table of the number of
+records of each kind for each pass is printed instead.
+
+Usage:
+  merge-opt-records.py [-o merged.jsonl.gz] [--summary] FILE-OR-DIR...
+
+To run unit tests:
+  merge-opt-records.py --unit-test
+"""
+
+import argparse
+import gzip
+import json
+import os
+import sys
+import unittest
+
+SUFFIXES = ('.opt-record.json.gz', '.opt-record.jsonl.gz')
+
+
+def pass_names(passes, names=None):
+    """
+    Return a dict mapping the ids of PASSES, and of their children, to
+    their names.  The ids are only meaningful within one file.
+    """
+    if names is None:
+        names = {}
+    for p in passes:
+        names[p['id']] = p['name']
+        if 'children' in p:
+            pass_names(p['children'], names)
+    return names
+
+
+def flatten(records):
+    """
+    Yield the records of an in-memory format file, with the records
+    nested within a scope following it.
+    """
+    for r in records:
+        children = r.pop('children', None)
+        yield r
+        if children:
+            yield from flatten(children)
+
+
+def read_records(path):
+    """
+    Yield the records in the file at PATH, with their 'pass' replaced
+    by the name of the pass.
+    """
+    with gzip.open(path, 'rt', encoding='utf-8') as f:
+        if path.endswith('.jsonl.gz'):
+            f.readline()
+            names = pass_names(json.loads(f.readline()))
+            records = (json.loads(line) for line in f if line.strip())
+        else:
+            _, passes, nested = json.load(f)
+            names = pass_names(passes)
+            records = flatten(nested)
+        for r in records:
+            if 'pass' in r:
+                r['pass'] = names.get(r['pass'], r['pass'])
+            yield r
+
+
+def message_text(record):
+    """
+    Return the text of the message of RECORD.
+    """
+    text = []
+    for item in record.get('message', []):
+        if isinstance(item, str):
+            text.append(item)
+        else:
+            for key in ('expr', 'stmt', 'symtab_node'):
+                if key in item:
+                    text.append(item[key])
+    return ''.join(text)
+
+
+def record_key(record):
+    """
+    Return the key under which RECORD is merged with the same record
+    from other translation units.
+    """
+    loc = record.get('location', {})
+    return (record.get('kind'), record.get('pass'), record.get('function'),
+            loc.get('file'), loc.get('line'), loc.get('column'),
+            message_text(record))
+
+
+class Merger:
+    def __init__(self):
+        self.records = {}
+        self.num_read = 0
+
+    def add(self, record):
+        self.num_read += 1
+        key = record_key(record)
+        merged = self.records.get(key)
+        if merged is None:
+            # Ids only mean something within a file.
+            record.pop('id', None)
+            record.pop('parent', None)
+            record['count'] = 1
+            self.records[key] = record
+        else:
+            merged['count'] += 1
+
+    def add_file(self, path):
+        for r in read_records(path):
+            self.add(r)
+
+    def summary(self):
+        """
+        Return a sorted list of (pass, kind, merged, count) tuples.
+        """
+        table = {}
+        for r in self.records.values():
+            key = (r.get('pass', ''), r.get('kind', ''))
+            merged, count = table.get(key, (0, 0))
+            table[key] = (merged + 1, count + r['count'])
+        return sorted((k[0], k[1], v[0], v[1]) for k, v in table.items())
+
+
+def find_files(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for root, dirs, files in os.walk(path):
+                for f in sorted(files):
+                    if f.endswith(SUFFIXES):
+                        yield os.path.join(root, f)
+        else:
+            yield path
+
+
+def main(args):
+    merger = Merger()
+    num_files = 0
+    for path in find_files(args.files):
+        merger.add_file(path)
+        num_files += 1
+
+    if args.summary:
+        print('%-24s %-10s %10s %10s' % ('pass', 'kind', 'merged', 'records'))
+        for row in merger.summary():
+            print('%-24s %-10s %10d %10d' % row)
+        print('%d records in %d files merged into %d'
+              % (merger.num_read, num_files, len(merger.records)))
+        return
+
+    if args.output is None:
+        out = sys.stdout
+    elif args.output.endswith('.gz'):
+        out = gzip.open(args.output, 'wt', encoding='utf-8')
+    else:
+        out = open(args.output, 'w', encoding='utf-8')
+    for r in merger.records.values():
+        out.write(json.dumps(r) + '\n')
+    if out is not sys.stdout:
+        out.close()
+
+
+class TestMerging(unittest.TestCase):
+    def test_pass_names(self):
+        passes = [{'id': '0x1', 'name': 'vect',
+                   'children': [{'id': '0x2', 'name': 'slp'}]}]
+        self.assertEqual(pass_names(passes), {'0x1': 'vect', '0x2': 'slp'})
+
+    def test_flatten(self):
+        nested = [{'kind': 'scope', 'children': [{'kind': 'note'}]},
+                  {'kind': 'success'}]
+        self.assertEqual([r['kind'] for r in flatten(nested)],
+                         ['scope', 'note', 'success'])
+
+    def test_message_text(self):
+        record = {'message': ['loop vectorized using ', {'expr': '16'},
+                              ' byte vectors']}
+        self.assertEqual(message_text(record),
+                         'loop vectorized using 16 byte vectors')
+
+    def test_merge(self):
+        merger = Merger()
+        record = {'kind': 'failure', 'pass': 'vect', 'id': 3,
+                  'location': {'file': 'a.h', 'line': 10, 'column': 3},
+                  'message': ['couldn\'t vectorize loop']}
+        merger.add(dict(record))
+        merger.add(dict(record, id=7))
+        merger.add(dict(record, kind='note'))
+        self.assertEqual(merger.num_read, 3)
+        self.assertEqual(len(merger.records), 2)
+        self.assertEqual(merger.summary(),
+                         [('vect', 'failure', 1, 2), ('vect', 'note', 1, 1)])
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=DESCRIPTION,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('files', nargs='*')
+    parser.add_argument('-o', '--output')
+    parser.add_argument('--summary', action='store_true')
+    parser.add_argument('--unit-test', action='store_true')
+    args = parser.parse_args()
+
+    if args.unit_test:
+        unittest.main(argv=[sys.argv[0], '-v'])
+    else:
+        main(args)
@@ -38,6 +38,8 @@ along with GCC; see the file COPYING3.  If not see
 #include "gimple-walk.h"
 #include "tree-inline.h"
 #include "intl.h"
+#include "cfgloop.h"
+#include "predict.h"
 
 /* Walker callback that replaces all FUNCTION_DECL of a function that's
    going to be versioned.  */
@@ -548,3 +550,141 @@ make_pass_target_clone (gcc::context *ctxt)
 {
   return new pass_target_clone (ctxt);
 }
+
+/* Return true if NODE should be cloned for -fauto-target-clones: it is
+   a function defined here, not already versioned, that the profile
+   says contains a hot loop.  */
+
+static bool
+auto_target_clone_p (cgraph_node *node)
+{
+  if (!node->definition
+      || node->alias
+      || node->thunk
+      || node->inlined_to
+      || DECL_EXTERNAL (node->decl)
+      || node->get_comdat_group ()
+      || DECL_FUNCTION_VERSIONED (node->decl)
+      || (DECL_NAME (node->decl) && MAIN_NAME_P (DECL_NAME (node->decl)))
+      || lookup_attribute ("target", DECL_ATTRIBUTES (node->decl))
+      || lookup_attribute ("target_clones", DECL_ATTRIBUTES (node->decl))
+      || lookup_attribute ("target_version", DECL_ATTRIBUTES (node->decl))
+      || !tree_versionable_function_p (node->decl))
+    return false;
+
+  /* Only profile feedback says what is hot well enough to be worth the
+     indirect call through the dispatcher.  */
+  profile_count count = node->count.ipa ();
+  if (!count.initialized_p () || !count.nonzero_p ())
+    return false;
+
+  function *fun = DECL_STRUCT_FUNCTION (node->decl);
+  if (!fun || !loops_for_fn (fun))
+    return false;
+
+  for (auto loop : loops_list (fun, 0))
+    {
+      profile_count header_count = loop->header->count.ipa ();
+      if (header_count.initialized_p ()
+	  && header_count.nonzero_p ()
+	  && maybe_hot_count_p (fun, header_count))
+	return true;
+    }
+  return false;
+}
+
+/* Clone the functions with hot loops for the targets given by
+   -fauto-target-clones, as if they had the target_clones attribute.
+   The targets were checked by check_auto_target_clones in toplev.cc.  */
+
+static unsigned int
+ipa_auto_target_clone (void)
+{
+  struct cgraph_node *node;
+  auto_vec<cgraph_node *> candidates;
+
+  FOR_EACH_DEFINED_FUNCTION (node)
+    if (auto_target_clone_p (node))
+      candidates.safe_push (node);
+
+  if (candidates.is_empty ())
+    return 0;
+
+  char *targets = concat ("default,", flag_auto_target_clones, NULL);
+  tree arglist = build_tree_list (NULL_TREE,
+				  build_string (strlen (targets), targets));
+  free (targets);
+
+  auto_vec<cgraph_node *> to_dispatch;
+  for (unsigned i = 0; i < candidates.length (); i++)
+    {
+      node = candidates[i];
+      if (dump_file)
+	fprintf (dump_file, "Cloning %s for %s\n", node->dump_name (),
+		 flag_auto_target_clones);
+      DECL_ATTRIBUTES (node->decl)
+	= tree_cons (get_identifier ("target_clones"), arglist,
+		     DECL_ATTRIBUTES (node->decl));
+      /* As for the attribute, each version keeps the full profile of
+	 the function: whichever the dispatcher picks runs all of it.  */
+      if (expand_target_clones (node, true))
+	to_dispatch.safe_push (node);
+    }
+
+  for (unsigned i = 0; i < to_dispatch.length (); i++)
+    create_dispatcher_calls (to_dispatch[i]);
+
+  FOR_EACH_FUNCTION (node)
+    redirect_to_specific_clone (node);
+
+  return 0;
+}
+
+namespace {
+
+const pass_data pass_data_auto_target_clone =
+{
+  SIMPLE_IPA_PASS,		/* type */
+  "autotargetclone",		/* name */
+  OPTGROUP_NONE,		/* optinfo_flags */
+  TV_NONE,			/* tv_id */
+  ( PROP_ssa | PROP_cfg ),	/* properties_required */
+  0,				/* properties_provided */
+  0,				/* properties_destroyed */
+  0,				/* todo_flags_start */
+  TODO_update_ssa		/* todo_flags_finish */
+};
+
+class pass_auto_target_clone : public simple_ipa_opt_pass
+{
+public:
+  pass_auto_target_clone (gcc::context *ctxt)
+    : simple_ipa_opt_pass (pass_data_auto_target_clone, ctxt)
+  {}
+
+  /* opt_pass methods: */
+  bool gate (function *) final override;
+  unsigned int execute (function *) final override
+  {
+    return ipa_auto_target_clone ();
+  }
+};
+
+bool
+pass_auto_target_clone::gate (function *)
+{
+  /* The functions are cloned only where the target can dispatch to the
+     clones; unlike for the attribute, that is not an error.  */
+  return (flag_auto_target_clones
+	  && !seen_error ()
+	  && targetm.has_ifunc_p ()
+	  && targetm.get_function_versions_dispatcher);
+}
+
+} // anon namespace
+
+simple_ipa_opt_pass *
+make_pass_auto_target_clone (gcc::context *ctxt)
+{
+  return new pass_auto_target_clone (ctxt);
+}
@@ -51,13 +51,64 @@ along with GCC; see the file COPYING3.  If not see
    in-memory JSON representation.  */
 
 optrecord_json_writer::optrecord_json_writer ()
-  : m_root_tuple (NULL), m_scopes ()
+  : m_root_tuple (NULL), m_scopes (), m_outfile (NULL), m_filename (NULL),
+    m_write_failed (false), m_scope_ids (), m_num_scopes (0)
 {
   m_root_tuple = new json::array ();
+  m_root_tuple->append (metadata_to_json ());
+  m_root_tuple->append (passes_to_json ());
 
+  json::array *records = new json::array ();
+  m_root_tuple->append (records);
+
+  m_scopes.safe_push (records);
+}
+
+/* optrecord_json_writer's ctor for streaming the records to FILENAME
+   in JSON Lines format.  Write out the metadata and the passes.  */
+
+optrecord_json_writer::optrecord_json_writer (const char *filename)
+  : m_root_tuple (NULL), m_scopes (), m_outfile (NULL),
+    m_filename (xstrdup (filename)), m_write_failed (false), m_scope_ids (),
+    m_num_scopes (0)
+{
+  m_outfile = gzopen (m_filename, "w");
+  if (m_outfile == NULL)
+    {
+      error_at (UNKNOWN_LOCATION,
+		"cannot open file %qs for writing optimization records",
+		m_filename);
+      return;
+    }
+
+  json::object *metadata = metadata_to_json ();
+  stream_value (metadata);
+  delete metadata;
+
+  json::array *passes = passes_to_json ();
+  stream_value (passes);
+  delete passes;
+}
+
+/* optrecord_json_writer's dtor.
+   Delete the in-memory JSON representation.  */
+
+optrecord_json_writer::~optrecord_json_writer ()
+{
+  delete m_root_tuple;
+  if (m_outfile)
+    gzclose (m_outfile);
+  free (m_filename);
+}
+
+/* Create the JSON object describing the compiler that goes first in
+   the output.  */
+
+json::object *
+optrecord_json_writer::metadata_to_json ()
+{
   /* Populate with metadata; compare with toplev.cc: print_version.  */
   json::object *metadata = new json::object ();
-  m_root_tuple->append (metadata);
   metadata->set_string ("format", "1");
   json::object *generator = new json::object ();
   metadata->set ("generator", generator);
@@ -72,8 +123,16 @@ optrecord_json_writer::optrecord_json_writer ()
 
   /* TODO: capture "any plugins?" flag (or the plugins themselves).  */
 
+  return metadata;
+}
+
+/* Create the JSON array describing all of the passes, which the records
+   refer to.  */
+
+json::array *
+optrecord_json_writer::passes_to_json ()
+{
   json::array *passes = new json::array ();
-  m_root_tuple->append (passes);
 
   /* Call add_pass_list for all of the pass lists.  */
   {
@@ -83,25 +142,47 @@ optrecord_json_writer::optrecord_json_writer ()
 #undef DEF_PASS_LIST
   }
 
-  json::array *records = new json::array ();
-  m_root_tuple->append (records);
-
-  m_scopes.safe_push (records);
+  return passes;
 }
 
-/* optrecord_json_writer's ctor.
-   Delete the in-memory JSON representation.  */
+/* Write VALUE to the output file as a line of its own.  */
 
-optrecord_json_writer::~optrecord_json_writer ()
+void
+optrecord_json_writer::stream_value (const json::value *value)
 {
-  delete m_root_tuple;
+  if (m_write_failed)
+    return;
+
+  pretty_printer pp;
+  value->print (&pp, false);
+  pp_newline (&pp);
+  if (gzputs (m_outfile, pp_formatted_text (&pp)) <= 0)
+    m_write_failed = true;
 }
 
-/* Choose an appropriate filename, and write the saved records to it.  */
+/* Choose an appropriate filename, and write the saved records to it.
+   When streaming, finish writing the records instead.  */
 
 void
-optrecord_json_writer::write () const
+optrecord_json_writer::write ()
 {
+  if (m_filename)
+    {
+      if (!m_outfile)
+	return;
+
+      int tmp;
+      if (m_write_failed)
+	error_at (UNKNOWN_LOCATION,
+		  "error writing optimization records to %qs: %s",
+		  m_filename, gzerror (m_outfile, &tmp));
+      if (gzclose (m_outfile) != Z_OK && !m_write_failed)
+	error_at (UNKNOWN_LOCATION, "error closing optimization records %qs",
+		  m_filename);
+      m_outfile = NULL;
+      return;
+    }
+
   pretty_printer pp;
   m_root_tuple->print (&pp, false);
 
@@ -139,25 +220,47 @@ void
 optrecord_json_writer::add_record (const optinfo *optinfo)
 {
   json::object *obj = optinfo_to_json (optinfo);
+  bool scope_p = optinfo->get_kind () == OPTINFO_KIND_SCOPE;
+
+  /* When streaming, the records within a scope refer to it by its id
+     instead of being nested within it.  */
+  if (m_filename && scope_p)
+    obj->set_integer ("id", ++m_num_scopes);
 
   add_record (obj);
 
   /* Potentially push the scope.  */
-  if (optinfo->get_kind () == OPTINFO_KIND_SCOPE)
+  if (scope_p)
     {
-      json::array *children = new json::array ();
-      obj->set ("children", children);
-      m_scopes.safe_push (children);
+      if (m_filename)
+	m_scope_ids.safe_push (m_num_scopes);
+      else
+	{
+	  json::array *children = new json::array ();
+	  obj->set ("children", children);
+	  m_scopes.safe_push (children);
+	}
     }
 }
 
 /* Private methods of optrecord_json_writer.  */
 
-/* Add record OBJ to the innermost scope.  */
+/* Add record OBJ to the innermost scope.  When streaming, write it out
+   and delete it.  */
 
 void
 optrecord_json_writer::add_record (json::object *obj)
 {
+  if (m_filename)
+    {
+      if (m_scope_ids.length () > 0)
+	obj->set_integer ("parent", m_scope_ids.last ());
+      if (m_outfile)
+	stream_value (obj);
+      delete obj;
+      return;
+    }
+
   /* Add to innermost scope.  */
   gcc_assert (m_scopes.length () > 0);
   m_scopes[m_scopes.length () - 1]->append (obj);
@@ -168,6 +271,13 @@ optrecord_json_writer::add_record (json::object *obj)
 void
 optrecord_json_writer::pop_scope ()
 {
+  if (m_filename)
+    {
+      gcc_assert (m_scope_ids.length () > 0);
+      m_scope_ids.pop ();
+      return;
+    }
+
   m_scopes.pop ();
 
   /* We should never pop the top-level records array.  */
@@ -475,12 +585,56 @@ test_building_json_from_dump_calls ()
   delete json_obj;
 }
 
+/* Verify that streamed optimization records are written one per line
+   after the metadata and the passes.  */
+
+static void
+test_streaming_json_lines ()
+{
+  temp_dump_context tmp (true, true, MSG_NOTE);
+  dump_user_location_t loc;
+  dump_printf_loc (MSG_NOTE, loc, "test of tree: ");
+  dump_generic_expr (MSG_NOTE, TDF_SLIM, integer_zero_node);
+  optinfo *info = tmp.get_pending_optinfo ();
+  ASSERT_TRUE (info != NULL);
+
+  named_temp_file tmp_file (".opt-record.jsonl.gz");
+  {
+    optrecord_json_writer writer (tmp_file.get_filename ());
+    writer.add_record (info);
+    writer.add_record (info);
+    writer.write ();
+  }
+
+  gzFile infile = gzopen (tmp_file.get_filename (), "r");
+  ASSERT_TRUE (infile != NULL);
+  auto_vec<char> buf;
+  char chunk[4096];
+  int n;
+  while ((n = gzread (infile, chunk, sizeof chunk)) > 0)
+    for (int i = 0; i < n; i++)
+      buf.safe_push (chunk[i]);
+  gzclose (infile);
+  buf.safe_push ('\0');
+
+  const char *text = buf.address ();
+  unsigned lines = 0;
+  for (const char *p = text; *p; p++)
+    if (*p == '\n')
+      lines++;
+  ASSERT_EQ (lines, 4);
+  ASSERT_STR_STARTSWITH (text, "{\"format\": \"1\"");
+  ASSERT_STR_CONTAINS (text,
+		       "\"message\": [\"test of tree: \", {\"expr\": \"0\"}]");
+}
+
 /* Run all of the selftests within this file.  */
 
 void
 optinfo_emit_json_cc_tests ()
 {
   test_building_json_from_dump_calls ();
+  test_streaming_json_lines ();
 }
 
 } // namespace selftest
@@ -25,14 +25,23 @@ along with GCC; see the file COPYING3.  If not see
 
 class optinfo;
 
-/* A class for writing out optimization records in JSON format.  */
+/* A class for writing out optimization records in JSON format.
+
+   By default the records are built up in memory and written out as a
+   single JSON document when the compiler exits.  Given a filename, the
+   writer instead streams them out in JSON Lines format as they are
+   made: the metadata and the passes come first, each on a line of its
+   own, and then one line per record.  Rather than nesting records
+   within their scope, a streamed scope record has an "id", and the
+   records within it refer to it with "parent".  */
 
 class optrecord_json_writer
 {
 public:
   optrecord_json_writer ();
+  explicit optrecord_json_writer (const char *filename);
   ~optrecord_json_writer ();
-  void write () const;
+  void write ();
   void add_record (const optinfo *optinfo);
   void pop_scope ();
 
@@ -47,14 +56,27 @@ public:
   void add_pass_list (json::array *arr, opt_pass *pass);
 
  private:
-  /* The root value for the JSON file.
-     Currently the JSON values are stored in memory, and flushed when the
-     compiler exits.  It would probably be better to simply write out
-     the JSON as we go.  */
+  json::object *metadata_to_json ();
+  json::array *passes_to_json ();
+  void stream_value (const json::value *value);
+
+  /* The root value for the JSON file, when the JSON values are stored
+     in memory and flushed when the compiler exits.  */
   json::array *m_root_tuple;
 
   /* The currently open scopes, for expressing nested optimization records.  */
   auto_vec<json::array *> m_scopes;
+
+  /* When streaming, the file being written, its name, and whether
+     writing to it has failed.  */
+  struct gzFile_s *m_outfile;
+  char *m_filename;
+  bool m_write_failed;
+
+  /* When streaming, the ids of the currently open scopes, and the
+     number of scopes seen so far.  */
+  auto_vec<unsigned> m_scope_ids;
+  unsigned m_num_scopes;
 };
 
 #endif /* #ifndef GCC_OPTINFO_EMIT_JSON_H */
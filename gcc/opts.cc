@@ -2929,6 +2929,12 @@ common_handle_option (struct gcc_options *opts,
       }
       break;
 
+    case OPT_fsave_optimization_record_:
+      /* The format is recorded by the option machinery; choosing one
+	 also asks for the records.  */
+      opts->x_flag_save_optimization_record = 1;
+      break;
+
     case OPT_fdiagnostics_show_location_:
       diagnostic_prefixing_rule (dc) = (diagnostic_prefixing_rule_t) value;
       break;
@@ -1192,6 +1192,7 @@ branch_prob (bool thunk)
   histogram_values values = histogram_values ();
   unsigned cfg_checksum, lineno_checksum;
   bool output_to_file;
+  bool shard_edges = false;
 
   total_num_times_called++;
 
@@ -1591,6 +1592,10 @@ branch_prob (bool thunk)
 
       if (flag_profile_values)
 	instrument_values (values);
+
+      /* A function without edge counters has no shard.  */
+      shard_edges = (flag_profile_update == PROFILE_UPDATE_SHARDED
+		     && num_instrumented);
     }
 
   free_aux_for_edges ();
@@ -1600,6 +1605,11 @@ branch_prob (bool thunk)
   /* Commit changes done by instrumentation.  */
   gsi_commit_edge_inserts ();
 
+  /* The edge profilers increment the counters the shard registration
+     selects on entry, which must dominate them.  */
+  if (shard_edges)
+    gimple_gen_shard_register (num_instrumented);
+
   coverage_end_function (lineno_checksum, cfg_checksum);
   if (flag_branch_probabilities
       && (profile_status_for_fn (cfun) == PROFILE_READ))
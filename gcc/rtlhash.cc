@@ -110,4 +110,174 @@ add_rtx (const_rtx x, hash &hstate)
       }
 }
 
+/* Add word W to both HSTATE and WORDS.  */
+
+static inline void
+add_shape_word (HOST_WIDE_INT w, hash &hstate, vec<HOST_WIDE_INT> *words)
+{
+  hstate.add_hwi (w);
+  words->safe_push (w);
+}
+
+/* Hash the shape of rtx X into HSTATE and also record it word by word in
+   WORDS, so that callers can tell collisions apart.  Unlike add_rtx, the
+   rtx flags, the memory attributes, the targets of labels and the values
+   of all constants are part of the shape, since predicates can test
+   them.  Pseudo
+   registers are abstracted: the Nth distinct pseudo seen is recorded as
+   FIRST_PSEUDO_REGISTER + N, and PSEUDOS receives their numbers in that
+   order so that the caller can add anything else it cares about.  */
+
+void
+add_rtx_shape (const_rtx x, hash &hstate, vec<HOST_WIDE_INT> *words,
+	       vec<unsigned int> *pseudos)
+{
+  enum rtx_code code;
+  unsigned int i, j;
+  const char *fmt;
+
+  if (x == NULL_RTX)
+    {
+      add_shape_word (-1, hstate, words);
+      return;
+    }
+  code = GET_CODE (x);
+  add_shape_word ((HOST_WIDE_INT) code
+		  | ((HOST_WIDE_INT) GET_MODE (x) << 16)
+		  | ((HOST_WIDE_INT) x->volatil << 32)
+		  | ((HOST_WIDE_INT) x->unchanging << 33)
+		  | ((HOST_WIDE_INT) x->in_struct << 34)
+		  | ((HOST_WIDE_INT) x->jump << 35)
+		  | ((HOST_WIDE_INT) x->call << 36)
+		  | ((HOST_WIDE_INT) x->frame_related << 37)
+		  | ((HOST_WIDE_INT) x->return_val << 38),
+		  hstate, words);
+  switch (code)
+    {
+    case REG:
+      if (HARD_REGISTER_P (x))
+	add_shape_word (REGNO (x), hstate, words);
+      else
+	{
+	  for (i = 0; i < pseudos->length (); i++)
+	    if ((*pseudos)[i] == REGNO (x))
+	      break;
+	  if (i == pseudos->length ())
+	    pseudos->safe_push (REGNO (x));
+	  add_shape_word (FIRST_PSEUDO_REGISTER + i, hstate, words);
+	}
+      return;
+    case CONST_INT:
+      add_shape_word (INTVAL (x), hstate, words);
+      return;
+    case CONST_WIDE_INT:
+      add_shape_word (CONST_WIDE_INT_NUNITS (x), hstate, words);
+      for (i = 0; i < (unsigned) CONST_WIDE_INT_NUNITS (x); i++)
+	add_shape_word (CONST_WIDE_INT_ELT (x, i), hstate, words);
+      return;
+    case CONST_DOUBLE:
+      if (CONST_DOUBLE_AS_INT_P (x))
+	{
+	  add_shape_word (CONST_DOUBLE_LOW (x), hstate, words);
+	  add_shape_word (CONST_DOUBLE_HIGH (x), hstate, words);
+	}
+      else
+	{
+	  /* Record every field separately; folding them together could
+	     make two different values look alike.  */
+	  const REAL_VALUE_TYPE *r = CONST_DOUBLE_REAL_VALUE (x);
+	  add_shape_word (r->cl | (r->decimal << 2) | (r->sign << 3)
+			  | (r->signalling << 4) | (r->canonical << 5),
+			  hstate, words);
+	  add_shape_word (r->uexp, hstate, words);
+	  for (i = 0; i < SIGSZ; i++)
+	    add_shape_word (r->sig[i], hstate, words);
+	}
+      return;
+    case CONST_FIXED:
+      add_shape_word (CONST_FIXED_VALUE_LOW (x), hstate, words);
+      add_shape_word (CONST_FIXED_VALUE_HIGH (x), hstate, words);
+      return;
+    case CONST_POLY_INT:
+      /* The coefficients are not operands, so the loop below would
+	 miss them.  */
+      {
+	poly_wide_int value = const_poly_int_value (x);
+	for (i = 0; i < NUM_POLY_INT_COEFFS; i++)
+	  {
+	    add_shape_word (value.coeffs[i].get_len (), hstate, words);
+	    for (j = 0; j < value.coeffs[i].get_len (); j++)
+	      add_shape_word (value.coeffs[i].elt (j), hstate, words);
+	  }
+      }
+      return;
+    case SYMBOL_REF:
+      /* Symbol names are shared strings, so their address identifies
+	 them for as long as the caller keeps WORDS.  */
+      add_shape_word ((HOST_WIDE_INT) (uintptr_t) XSTR (x, 0), hstate, words);
+      add_shape_word (SYMBOL_REF_FLAGS (x), hstate, words);
+      return;
+    case MEM:
+      /* Like symbol names, MEM_EXPRs are identified by their address.  */
+      add_shape_word (MEM_ALIGN (x), hstate, words);
+      add_shape_word (MEM_ADDR_SPACE (x), hstate, words);
+      add_shape_word (MEM_ALIAS_SET (x), hstate, words);
+      add_shape_word ((HOST_WIDE_INT) (uintptr_t) MEM_EXPR (x),
+		      hstate, words);
+      add_shape_word (MEM_OFFSET_KNOWN_P (x), hstate, words);
+      if (MEM_OFFSET_KNOWN_P (x))
+	for (i = 0; i < NUM_POLY_INT_COEFFS; i++)
+	  add_shape_word (MEM_OFFSET (x).coeffs[i], hstate, words);
+      add_shape_word (MEM_SIZE_KNOWN_P (x), hstate, words);
+      if (MEM_SIZE_KNOWN_P (x))
+	for (i = 0; i < NUM_POLY_INT_COEFFS; i++)
+	  add_shape_word (MEM_SIZE (x).coeffs[i], hstate, words);
+      break;
+    case LABEL_REF:
+      add_shape_word (INSN_UID (label_ref_label (x)), hstate, words);
+      return;
+    case DEBUG_EXPR:
+    case VALUE:
+    case SCRATCH:
+    case DEBUG_IMPLICIT_PTR:
+    case DEBUG_PARAMETER_REF:
+      return;
+    default:
+      break;
+    }
+
+  fmt = GET_RTX_FORMAT (code);
+  for (i = GET_RTX_LENGTH (code); i-- > 0;)
+    switch (fmt[i])
+      {
+      case 'w':
+	add_shape_word (XWINT (x, i), hstate, words);
+	break;
+      case 'n':
+      case 'i':
+	add_shape_word (XINT (x, i), hstate, words);
+	break;
+      case 'p':
+	for (j = 0; j < NUM_POLY_INT_COEFFS; j++)
+	  add_shape_word (SUBREG_BYTE (x).coeffs[j], hstate, words);
+	break;
+      case 'V':
+      case 'E':
+	add_shape_word (XVECLEN (x, i), hstate, words);
+	for (j = 0; j < (unsigned) XVECLEN (x, i); j++)
+	  add_rtx_shape (XVECEXP (x, i, j), hstate, words, pseudos);
+	break;
+      case 'e':
+	add_rtx_shape (XEXP (x, i), hstate, words, pseudos);
+	break;
+      case 'S':
+      case 's':
+	add_shape_word ((HOST_WIDE_INT) (uintptr_t) XSTR (x, i),
+			hstate, words);
+	break;
+      default:
+	break;
+      }
+}
+
 }
@@ -25,6 +25,8 @@ namespace inchash
 {
 
 extern void add_rtx (const_rtx, hash &);
+extern void add_rtx_shape (const_rtx, hash &, vec<HOST_WIDE_INT> *,
+			   vec<unsigned int> *);
 
 }
 
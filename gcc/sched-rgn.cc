@@ -3108,6 +3108,11 @@ save_state_for_fallthru_edge (basic_block last_bb, state_t state)
   }
 }
 
+/* The region that took the longest to schedule in the current function,
+   and the time it took in microseconds, for the dump.  */
+static int slowest_region;
+static long slowest_region_time;
+
 /* Schedule a region.  A region is either an inner loop, a loop-free
    subroutine, or a single basic block.  Each bb in the region is
    scheduled after its flow predecessors.  */
@@ -3117,9 +3122,14 @@ schedule_region (int rgn)
 {
   int bb;
   int sched_rgn_n_insns = 0;
+  long start_time = 0;
+  long deps_time = 0;
 
   rgn_n_insns = 0;
 
+  if (sched_verbose >= 2)
+    start_time = get_run_time ();
+
   /* Do not support register pressure sensitive scheduling for the new regions
      as we don't update the liveness info for them.  */
   if (sched_pressure != SCHED_PRESSURE_NONE
@@ -3138,6 +3148,9 @@ schedule_region (int rgn)
 
   sched_rgn_compute_dependencies (rgn);
 
+  if (sched_verbose >= 2)
+    deps_time = get_run_time ();
+
   sched_rgn_local_init (rgn);
 
   /* Set priorities.  */
@@ -3225,6 +3238,22 @@ schedule_region (int rgn)
 
   gcc_assert (haifa_recovery_bb_ever_added_p
 	      || deps_pools_are_empty_p ());
+
+  if (sched_verbose >= 2)
+    {
+      long end_time = get_run_time ();
+
+      fprintf (sched_dump,
+	       ";; Region %d: %d blocks, %d insns, %ld usec dependencies, "
+	       "%ld usec scheduling\n",
+	       rgn, current_nr_blocks, sched_rgn_n_insns,
+	       deps_time - start_time, end_time - deps_time);
+      if (end_time - start_time > slowest_region_time)
+	{
+	  slowest_region = rgn;
+	  slowest_region_time = end_time - start_time;
+	}
+    }
 }
 
 /* Initialize data structures for region scheduling.  */
@@ -3519,11 +3548,18 @@ schedule_insns (void)
 
   bitmap_initialize (&not_in_df, &bitmap_default_obstack);
 
+  slowest_region = -1;
+  slowest_region_time = -1;
+
   /* Schedule every region in the subroutine.  */
   for (rgn = 0; rgn < nr_regions; rgn++)
     if (dbg_cnt (sched_region))
       schedule_region (rgn);
 
+  if (sched_verbose >= 2 && slowest_region >= 0)
+    fprintf (sched_dump, ";; Slowest region: %d, %ld usec\n",
+	     slowest_region, slowest_region_time);
+
   /* Clean up.  */
   sched_rgn_finish ();
   bitmap_release (&not_in_df);
@@ -0,0 +1,36 @@
+/* -fauto-target-clones clones the functions whose loops the profile
+   shows to be hot, and leaves the others alone.  */
+/* { dg-do run { target { i?86-*-* x86_64-*-* } } } */
+/* { dg-require-ifunc "" } */
+/* { dg-options "-O2 -fauto-target-clones=avx2 -fdump-ipa-autotargetclone" } */
+
+int a[1024];
+volatile int run_cold;
+
+__attribute__ ((noinline, noclone)) void
+hot (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i] = a[i] * 3 + 1;
+}
+
+__attribute__ ((noinline, noclone)) void
+cold (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i]--;
+}
+
+int
+main (void)
+{
+  for (int i = 0; i < 1000; i++)
+    hot ();
+  if (run_cold)
+    cold ();
+  return 0;
+}
+
+/* { dg-final-use-not-autofdo { scan-ipa-dump "Cloning hot/\[0-9\]+ for avx2" "autotargetclone" } } */
+/* { dg-final-use-not-autofdo { scan-ipa-dump-not "Cloning cold" "autotargetclone" } } */
+/* { dg-final-use-not-autofdo { scan-ipa-dump-not "Cloning main" "autotargetclone" } } */
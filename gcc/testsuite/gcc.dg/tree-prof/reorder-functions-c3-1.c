@@ -0,0 +1,42 @@
+/* Check the clusters that -freorder-functions-algorithm=call-chain-clustering
+   forms: a callee joins the cluster of its most frequent caller, the
+   first one in the source if two call it equally often, and a cluster
+   much denser than that of its caller stays on its own.  */
+/* { dg-options "-O2 -fno-ipa-icf -freorder-functions-algorithm=call-chain-clustering -fdump-ipa-reorder" } */
+
+volatile int v;
+
+__attribute__ ((noinline, noclone)) static void
+leaf (void)
+{
+  v++;
+}
+
+__attribute__ ((noinline, noclone)) static void
+caller_a (void)
+{
+  leaf ();
+  v += 2;
+}
+
+__attribute__ ((noinline, noclone)) static void
+caller_b (void)
+{
+  leaf ();
+  v += 3;
+}
+
+int
+main (void)
+{
+  for (int i = 0; i < 1000; i++)
+    {
+      caller_a ();
+      caller_b ();
+    }
+  return 0;
+}
+
+/* { dg-final-use-not-autofdo { scan-ipa-dump "Cluster of 2 functions\[^\n\]*\n  caller_a\[^\n\]*\n  leaf" "reorder" } } */
+/* { dg-final-use-not-autofdo { scan-ipa-dump "Cluster of 1 functions\[^\n\]*\n  caller_b" "reorder" } } */
+/* { dg-final-use-not-autofdo { scan-ipa-dump "Cluster of 1 functions\[^\n\]*\n  main" "reorder" } } */
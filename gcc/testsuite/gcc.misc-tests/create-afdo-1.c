@@ -0,0 +1,33 @@
+/* The source of create-afdo-1.s, which create-afdo.exp links at a fixed
+   address so that the samples in create-afdo-1.perf stay valid.  It was
+   generated with "gcc -O2 -g -fno-reorder-functions
+   -fno-asynchronous-unwind-tables -fno-ident -fdebug-prefix-map=$PWD=.
+   -S create-afdo-1.c"; the addresses in create-afdo-1.perf have to be
+   updated if it is generated again.  */
+
+static inline int
+sq (int x)
+{
+  return x * x;
+}
+
+int __attribute__ ((noinline))
+neg (int x)
+{
+  return -x;
+}
+
+int __attribute__ ((noinline))
+work (int n)
+{
+  int s = 0;
+  for (int i = 0; i < n; i++)
+    s += (i & 1) ? sq (i) : neg (i);
+  return s;
+}
+
+int
+main (void)
+{
+  return work (1000) & 1;
+}
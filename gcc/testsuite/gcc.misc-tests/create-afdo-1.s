@@ -0,0 +1,677 @@
+	.file	"create-afdo-1.c"
+	.text
+.Ltext0:
+	.cfi_sections	.debug_frame
+	.file 0 "." "create-afdo-1.c"
+	.p2align 4
+	.globl	neg
+	.type	neg, @function
+neg:
+.LVL0:
+.LFB1:
+	.file 1 "create-afdo-1.c"
+	.loc 1 16 1 view -0
+	.cfi_startproc
+	.loc 1 17 3 view .LVU1
+	.loc 1 17 10 is_stmt 0 view .LVU2
+	movl	%edi, %eax
+	negl	%eax
+	.loc 1 18 1 view .LVU3
+	ret
+	.cfi_endproc
+.LFE1:
+	.size	neg, .-neg
+	.p2align 4
+	.globl	work
+	.type	work, @function
+work:
+.LVL1:
+.LFB2:
+	.loc 1 22 1 is_stmt 1 view -0
+	.cfi_startproc
+	.loc 1 23 3 view .LVU5
+	.loc 1 24 3 view .LVU6
+.LBB5:
+	.loc 1 24 8 view .LVU7
+	.loc 1 24 21 view .LVU8
+.LBE5:
+	.loc 1 22 1 is_stmt 0 view .LVU9
+	movl	%edi, %esi
+.LBB8:
+	.loc 1 24 21 view .LVU10
+	testl	%edi, %edi
+	jle	.L8
+	.loc 1 24 12 view .LVU11
+	xorl	%edx, %edx
+.LBE8:
+	.loc 1 23 7 view .LVU12
+	xorl	%ecx, %ecx
+	jmp	.L7
+.LVL2:
+	.p2align 4,,10
+	.p2align 3
+.L10:
+.LBB9:
+.LBB6:
+.LBI6:
+	.loc 1 9 1 is_stmt 1 view .LVU13
+.LBB7:
+	.loc 1 11 3 view .LVU14
+	.loc 1 11 12 is_stmt 0 view .LVU15
+	movl	%edx, %eax
+	imull	%edx, %eax
+.LVL3:
+	.loc 1 11 12 view .LVU16
+.LBE7:
+.LBE6:
+	.loc 1 24 27 view .LVU17
+	addl	$1, %edx
+.LVL4:
+	.loc 1 25 7 view .LVU18
+	addl	%eax, %ecx
+.LVL5:
+	.loc 1 24 27 is_stmt 1 view .LVU19
+	.loc 1 24 21 view .LVU20
+	cmpl	%edx, %esi
+	je	.L3
+.LVL6:
+.L7:
+	.loc 1 25 5 view .LVU21
+	.loc 1 25 27 is_stmt 0 view .LVU22
+	testb	$1, %dl
+	jne	.L10
+	.loc 1 25 29 discriminator 2 view .LVU23
+	movl	%edx, %edi
+	.loc 1 24 27 discriminator 2 view .LVU24
+	addl	$1, %edx
+.LVL7:
+	.loc 1 25 29 discriminator 2 view .LVU25
+	call	neg
+.LVL8:
+	.loc 1 25 7 discriminator 2 view .LVU26
+	addl	%eax, %ecx
+.LVL9:
+	.loc 1 24 27 is_stmt 1 discriminator 2 view .LVU27
+	.loc 1 24 21 discriminator 2 view .LVU28
+	cmpl	%edx, %esi
+	jne	.L7
+.L3:
+	.loc 1 24 21 is_stmt 0 discriminator 2 view .LVU29
+.LBE9:
+	.loc 1 27 1 view .LVU30
+	movl	%ecx, %eax
+	ret
+.LVL10:
+	.p2align 4,,10
+	.p2align 3
+.L8:
+	.loc 1 23 7 view .LVU31
+	xorl	%ecx, %ecx
+	.loc 1 26 3 is_stmt 1 view .LVU32
+	.loc 1 27 1 is_stmt 0 view .LVU33
+	movl	%ecx, %eax
+	ret
+	.cfi_endproc
+.LFE2:
+	.size	work, .-work
+	.p2align 4
+	.globl	main
+	.type	main, @function
+main:
+.LFB3:
+	.loc 1 31 1 is_stmt 1 view -0
+	.cfi_startproc
+	.loc 1 32 3 view .LVU35
+	.loc 1 32 10 is_stmt 0 view .LVU36
+	movl	$1000, %edi
+	call	work
+.LVL11:
+	.loc 1 32 22 view .LVU37
+	andl	$1, %eax
+	.loc 1 33 1 view .LVU38
+	ret
+	.cfi_endproc
+.LFE3:
+	.size	main, .-main
+.Letext0:
+	.section	.debug_info,"",@progbits
+.Ldebug_info0:
+	.long	0x150
+	.value	0x5
+	.byte	0x1
+	.byte	0x8
+	.long	.Ldebug_abbrev0
+	.uleb128 0x5
+	.long	.LASF4
+	.byte	0x1d
+	.long	.LASF0
+	.long	.LASF1
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.long	.Ldebug_line0
+	.uleb128 0x1
+	.long	.LASF2
+	.byte	0x1e
+	.long	0x64
+	.quad	.LFB3
+	.quad	.LFE3-.LFB3
+	.uleb128 0x1
+	.byte	0x9c
+	.long	0x64
+	.uleb128 0x2
+	.quad	.LVL11
+	.long	0x6b
+	.uleb128 0x3
+	.uleb128 0x1
+	.byte	0x55
+	.uleb128 0x3
+	.byte	0xa
+	.value	0x3e8
+	.byte	0
+	.byte	0
+	.uleb128 0x6
+	.byte	0x4
+	.byte	0x5
+	.string	"int"
+	.uleb128 0x1
+	.long	.LASF3
+	.byte	0x15
+	.long	0x64
+	.quad	.LFB2
+	.quad	.LFE2-.LFB2
+	.uleb128 0x1
+	.byte	0x9c
+	.long	0x10d
+	.uleb128 0x7
+	.string	"n"
+	.byte	0x1
+	.byte	0x15
+	.byte	0xb
+	.long	0x64
+	.long	.LLST0
+	.long	.LVUS0
+	.uleb128 0x4
+	.string	"s"
+	.byte	0x17
+	.byte	0x7
+	.long	0x64
+	.long	.LLST1
+	.long	.LVUS1
+	.uleb128 0x8
+	.long	.LLRL2
+	.uleb128 0x4
+	.string	"i"
+	.byte	0x18
+	.byte	0xc
+	.long	0x64
+	.long	.LLST3
+	.long	.LVUS3
+	.uleb128 0x9
+	.long	0x13c
+	.quad	.LBI6
+	.byte	.LVU13
+	.quad	.LBB6
+	.quad	.LBE6-.LBB6
+	.byte	0x1
+	.byte	0x19
+	.byte	0x14
+	.long	0xf7
+	.uleb128 0xa
+	.long	0x148
+	.long	.LLST4
+	.long	.LVUS4
+	.byte	0
+	.uleb128 0x2
+	.quad	.LVL8
+	.long	0x10d
+	.uleb128 0x3
+	.uleb128 0x1
+	.byte	0x55
+	.uleb128 0x2
+	.byte	0x75
+	.sleb128 0
+	.byte	0
+	.byte	0
+	.byte	0
+	.uleb128 0xb
+	.string	"neg"
+	.byte	0x1
+	.byte	0xf
+	.byte	0x1
+	.long	0x64
+	.quad	.LFB1
+	.quad	.LFE1-.LFB1
+	.uleb128 0x1
+	.byte	0x9c
+	.long	0x13c
+	.uleb128 0xc
+	.string	"x"
+	.byte	0x1
+	.byte	0xf
+	.byte	0xa
+	.long	0x64
+	.uleb128 0x1
+	.byte	0x55
+	.byte	0
+	.uleb128 0xd
+	.string	"sq"
+	.byte	0x1
+	.byte	0x9
+	.byte	0x1
+	.long	0x64
+	.byte	0x3
+	.uleb128 0xe
+	.string	"x"
+	.byte	0x1
+	.byte	0x9
+	.byte	0x9
+	.long	0x64
+	.byte	0
+	.byte	0
+	.section	.debug_abbrev,"",@progbits
+.Ldebug_abbrev0:
+	.uleb128 0x1
+	.uleb128 0x2e
+	.byte	0x1
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3a
+	.uleb128 0x21
+	.sleb128 1
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0x21
+	.sleb128 1
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x40
+	.uleb128 0x18
+	.uleb128 0x7a
+	.uleb128 0x19
+	.uleb128 0x1
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0x2
+	.uleb128 0x48
+	.byte	0x1
+	.uleb128 0x7d
+	.uleb128 0x1
+	.uleb128 0x7f
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x49
+	.byte	0
+	.uleb128 0x2
+	.uleb128 0x18
+	.uleb128 0x7e
+	.uleb128 0x18
+	.byte	0
+	.byte	0
+	.uleb128 0x4
+	.uleb128 0x34
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0x21
+	.sleb128 1
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x17
+	.uleb128 0x2137
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0x5
+	.uleb128 0x11
+	.byte	0x1
+	.uleb128 0x25
+	.uleb128 0xe
+	.uleb128 0x13
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x1f
+	.uleb128 0x1b
+	.uleb128 0x1f
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x10
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0x6
+	.uleb128 0x24
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x8
+	.byte	0
+	.byte	0
+	.uleb128 0x7
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x17
+	.uleb128 0x2137
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0x8
+	.uleb128 0xb
+	.byte	0x1
+	.uleb128 0x55
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0x9
+	.uleb128 0x1d
+	.byte	0x1
+	.uleb128 0x31
+	.uleb128 0x13
+	.uleb128 0x52
+	.uleb128 0x1
+	.uleb128 0x2138
+	.uleb128 0xb
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x58
+	.uleb128 0xb
+	.uleb128 0x59
+	.uleb128 0xb
+	.uleb128 0x57
+	.uleb128 0xb
+	.uleb128 0x1
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0xa
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x31
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x17
+	.uleb128 0x2137
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0x2e
+	.byte	0x1
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x40
+	.uleb128 0x18
+	.uleb128 0x7a
+	.uleb128 0x19
+	.uleb128 0x1
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0xc
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x2
+	.uleb128 0x18
+	.byte	0
+	.byte	0
+	.uleb128 0xd
+	.uleb128 0x2e
+	.byte	0x1
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x20
+	.uleb128 0xb
+	.byte	0
+	.byte	0
+	.uleb128 0xe
+	.uleb128 0x5
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x8
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.byte	0
+	.section	.debug_loclists,"",@progbits
+	.long	.Ldebug_loc3-.Ldebug_loc2
+.Ldebug_loc2:
+	.value	0x5
+	.byte	0x8
+	.byte	0
+	.long	0
+.Ldebug_loc0:
+.LVUS0:
+	.uleb128 0
+	.uleb128 .LVU13
+	.uleb128 .LVU13
+	.uleb128 0
+.LLST0:
+	.byte	0x4
+	.uleb128 .LVL1-.Ltext0
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 0x1
+	.byte	0x55
+	.byte	0x4
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 .LFE2-.Ltext0
+	.uleb128 0x1
+	.byte	0x54
+	.byte	0
+.LVUS1:
+	.uleb128 .LVU6
+	.uleb128 .LVU13
+	.uleb128 .LVU13
+	.uleb128 .LVU31
+	.uleb128 .LVU31
+	.uleb128 0
+.LLST1:
+	.byte	0x4
+	.uleb128 .LVL1-.Ltext0
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 0x2
+	.byte	0x30
+	.byte	0x9f
+	.byte	0x4
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 .LVL10-.Ltext0
+	.uleb128 0x1
+	.byte	0x52
+	.byte	0x4
+	.uleb128 .LVL10-.Ltext0
+	.uleb128 .LFE2-.Ltext0
+	.uleb128 0x2
+	.byte	0x30
+	.byte	0x9f
+	.byte	0
+.LVUS3:
+	.uleb128 .LVU8
+	.uleb128 .LVU13
+	.uleb128 .LVU13
+	.uleb128 .LVU18
+	.uleb128 .LVU18
+	.uleb128 .LVU20
+	.uleb128 .LVU20
+	.uleb128 .LVU25
+	.uleb128 .LVU25
+	.uleb128 .LVU28
+	.uleb128 .LVU28
+	.uleb128 .LVU31
+	.uleb128 .LVU31
+	.uleb128 0
+.LLST3:
+	.byte	0x4
+	.uleb128 .LVL1-.Ltext0
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 0x2
+	.byte	0x30
+	.byte	0x9f
+	.byte	0x4
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 .LVL4-.Ltext0
+	.uleb128 0x1
+	.byte	0x51
+	.byte	0x4
+	.uleb128 .LVL4-.Ltext0
+	.uleb128 .LVL5-.Ltext0
+	.uleb128 0x3
+	.byte	0x71
+	.sleb128 -1
+	.byte	0x9f
+	.byte	0x4
+	.uleb128 .LVL5-.Ltext0
+	.uleb128 .LVL7-.Ltext0
+	.uleb128 0x1
+	.byte	0x51
+	.byte	0x4
+	.uleb128 .LVL7-.Ltext0
+	.uleb128 .LVL9-.Ltext0
+	.uleb128 0x1
+	.byte	0x55
+	.byte	0x4
+	.uleb128 .LVL9-.Ltext0
+	.uleb128 .LVL10-.Ltext0
+	.uleb128 0x1
+	.byte	0x51
+	.byte	0x4
+	.uleb128 .LVL10-.Ltext0
+	.uleb128 .LFE2-.Ltext0
+	.uleb128 0x2
+	.byte	0x30
+	.byte	0x9f
+	.byte	0
+.LVUS4:
+	.uleb128 .LVU13
+	.uleb128 .LVU16
+.LLST4:
+	.byte	0x4
+	.uleb128 .LVL2-.Ltext0
+	.uleb128 .LVL3-.Ltext0
+	.uleb128 0x1
+	.byte	0x51
+	.byte	0
+.Ldebug_loc3:
+	.section	.debug_aranges,"",@progbits
+	.long	0x2c
+	.value	0x2
+	.long	.Ldebug_info0
+	.byte	0x8
+	.byte	0
+	.value	0
+	.value	0
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.quad	0
+	.quad	0
+	.section	.debug_rnglists,"",@progbits
+.Ldebug_ranges0:
+	.long	.Ldebug_ranges3-.Ldebug_ranges2
+.Ldebug_ranges2:
+	.value	0x5
+	.byte	0x8
+	.byte	0
+	.long	0
+.LLRL2:
+	.byte	0x4
+	.uleb128 .LBB5-.Ltext0
+	.uleb128 .LBE5-.Ltext0
+	.byte	0x4
+	.uleb128 .LBB8-.Ltext0
+	.uleb128 .LBE8-.Ltext0
+	.byte	0x4
+	.uleb128 .LBB9-.Ltext0
+	.uleb128 .LBE9-.Ltext0
+	.byte	0
+.Ldebug_ranges3:
+	.section	.debug_line,"",@progbits
+.Ldebug_line0:
+	.section	.debug_str,"MS",@progbits,1
+.LASF3:
+	.string	"work"
+.LASF2:
+	.string	"main"
+.LASF4:
+	.string	"GNU C17 12.2.0 -mtune=generic -march=x86-64 -g -O2 -fno-reorder-functions -fno-asynchronous-unwind-tables -fno-ident"
+	.section	.debug_line_str,"MS",@progbits,1
+.LASF0:
+	.string	"create-afdo-1.c"
+.LASF1:
+	.string	"."
+	.section	.note.GNU-stack,"",@progbits
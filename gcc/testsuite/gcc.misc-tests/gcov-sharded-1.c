@@ -0,0 +1,52 @@
+/* Test that -fprofile-update=sharded counts exactly what several threads
+   execute, including a function without edge counters.  */
+
+/* { dg-options "-fprofile-arcs -ftest-coverage -fprofile-update=sharded -pthread" } */
+/* { dg-do run { target native } } */
+/* { dg-require-effective-target pthread } */
+/* { dg-require-effective-target tls_native } */
+
+#include <pthread.h>
+
+#define NTHREADS 8
+#define ITERATIONS 10000
+
+int total;
+
+__attribute__ ((noinline)) void
+nothing (void)
+{
+}
+
+__attribute__ ((noinline)) void
+count (int i)
+{
+  if (i & 1)
+    __atomic_fetch_add (&total, 1, __ATOMIC_RELAXED);	/* count(40000) */
+  else
+    __atomic_fetch_add (&total, 2, __ATOMIC_RELAXED);	/* count(40000) */
+}
+
+void *
+worker (void *arg)
+{
+  for (int i = 0; i < ITERATIONS; i++)
+    count (i);
+  nothing ();				/* count(8) */
+  return arg;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, worker, NULL);
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  return total != NTHREADS * ITERATIONS / 2 * 3;
+}
+
+/* { dg-final { run-gcov gcov-sharded-1.c } } */
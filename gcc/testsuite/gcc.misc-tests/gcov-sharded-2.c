@@ -0,0 +1,55 @@
+/* Test that with -fprofile-update=sharded what a thread executes after
+   libgcov folded its shards at thread exit is still counted.  */
+
+/* { dg-options "-fprofile-arcs -ftest-coverage -fprofile-update=sharded -pthread" } */
+/* { dg-do run { target native } } */
+/* { dg-require-effective-target pthread } */
+/* { dg-require-effective-target tls_native } */
+
+#include <pthread.h>
+
+#define NTHREADS 4
+
+pthread_key_t key;
+int total;
+
+__attribute__ ((noinline)) void
+count (void)
+{
+  __atomic_fetch_add (&total, 1, __ATOMIC_RELAXED);	/* count(13) */
+}
+
+/* The key is created after libgcov's, so its destructor runs after the
+   shards of the thread were folded.  */
+
+void
+destroy (void *arg)
+{
+  count ();
+  count ();
+}
+
+void *
+worker (void *arg)
+{
+  count ();
+  pthread_setspecific (key, arg);
+  return arg;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+
+  count ();
+  pthread_key_create (&key, destroy);
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, worker, &threads[i]);
+  for (int i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  return total != 3 * NTHREADS + 1;
+}
+
+/* { dg-final { run-gcov gcov-sharded-2.c } } */
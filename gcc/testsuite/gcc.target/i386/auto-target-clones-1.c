@@ -0,0 +1,23 @@
+/* The targets of -fauto-target-clones= are checked once, without a
+   location, rather than for each function that would be cloned.  */
+/* { dg-do compile } */
+/* { dg-require-ifunc "" } */
+/* { dg-options "-O2 -fauto-target-clones=default,foo,arch=x86-64-v3" } */
+/* { dg-error "'default' cannot be given in '-fauto-target-clones='" "" { target *-*-* } 0 } */
+/* { dg-error "argument 'foo' is unknown" "" { target *-*-* } 0 } */
+
+int a[1024];
+
+void
+f (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i]++;
+}
+
+void
+g (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i]--;
+}
@@ -0,0 +1,22 @@
+/* An empty entry in -fauto-target-clones= is diagnosed once, however
+   many functions the option applies to.  */
+/* { dg-do compile } */
+/* { dg-require-ifunc "" } */
+/* { dg-options "-O2 -fauto-target-clones=avx2,,arch=x86-64-v3" } */
+/* { dg-error "empty target in '-fauto-target-clones='" "" { target *-*-* } 0 } */
+
+int a[1024];
+
+void
+f (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i]++;
+}
+
+void
+g (void)
+{
+  for (int i = 0; i < 1024; i++)
+    a[i]--;
+}
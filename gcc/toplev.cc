@@ -1819,6 +1819,65 @@ initialize_rtl (void)
     }
 }
 
+/* Check the targets of -fauto-target-clones= once, rather than for each
+   function cloned for them, and clear the option if any is invalid.  */
+
+static void
+check_auto_target_clones (void)
+{
+  if (!flag_auto_target_clones
+      || !targetm.has_ifunc_p ()
+      || !targetm.get_function_versions_dispatcher)
+    return;
+
+  tree fndecl = build_decl (UNKNOWN_LOCATION, FUNCTION_DECL,
+			    get_identifier ("auto_target_clones"),
+			    build_function_type_list (void_type_node,
+						      NULL_TREE));
+  char *targets = xstrdup (flag_auto_target_clones);
+  location_t saved_loc = input_location;
+  bool valid = true;
+
+  input_location = UNKNOWN_LOCATION;
+  for (char *target = targets, *next; target; target = next)
+    {
+      next = strchr (target, ',');
+      if (next)
+	*next++ = '\0';
+
+      if (!*target)
+	{
+	  error ("empty target in %<-fauto-target-clones=%>");
+	  valid = false;
+	  continue;
+	}
+      if (strcmp (target, "default") == 0)
+	{
+	  error ("%<default%> cannot be given in %<-fauto-target-clones=%>, "
+		 "as the original function is the default version");
+	  valid = false;
+	  continue;
+	}
+
+      DECL_FUNCTION_SPECIFIC_TARGET (fndecl) = NULL_TREE;
+      DECL_FUNCTION_SPECIFIC_OPTIMIZATION (fndecl) = NULL_TREE;
+      tree args = build_tree_list (NULL_TREE,
+				   build_string (strlen (target) + 1, target));
+      if (TARGET_HAS_FMV_TARGET_ATTRIBUTE
+	  ? !targetm.target_option.valid_attribute_p (fndecl,
+						      get_identifier ("target"),
+						      args, 1)
+	  : !targetm.target_option.valid_version_attribute_p
+	       (fndecl, get_identifier ("target_version"), args, 0))
+	valid = false;
+    }
+  input_location = saved_loc;
+  free (targets);
+
+  if (!valid)
+    flag_auto_target_clones = NULL;
+}
+
 /* Language-dependent initialization.  Returns nonzero on success.  */
 static int
 lang_dependent_init (const char *name)
@@ -1878,6 +1937,8 @@ lang_dependent_init (const char *name)
   /* Do the target-specific parts of the initialization.  */
   lang_dependent_init_target ();
 
+  check_auto_target_clones ();
+
   if (!flag_wpa)
     {
       /* If dbx symbol table desired, initialize writing it and output the
@@ -2088,7 +2149,17 @@ do_compile ()
 
       if (flag_save_optimization_record)
 	{
-	  dump_context::get ().set_json_writer (new optrecord_json_writer ());
+	  optrecord_json_writer *writer;
+	  if (flag_save_optimization_record_format == OPTRECORD_FORMAT_JSONL)
+	    {
+	      char *filename = concat (dump_base_name, ".opt-record.jsonl.gz",
+				       NULL);
+	      writer = new optrecord_json_writer (filename);
+	      free (filename);
+	    }
+	  else
+	    writer = new optrecord_json_writer ();
+	  dump_context::get ().set_json_writer (writer);
 	}
 
       /* This must be run always, because it is needed to compute the FP
@@ -67,6 +67,10 @@ static GTY(()) tree tree_topn_values_profiler_fn;
 static GTY(()) tree tree_indirect_call_profiler_fn;
 static GTY(()) tree tree_average_profiler_fn;
 static GTY(()) tree tree_ior_profiler_fn;
+static GTY(()) tree tree_shard_register_fn;
+/* Pointer to the edge counters the current function increments with
+   -fprofile-update=sharded, defined by gimple_gen_shard_register.  */
+static GTY(()) tree shard_base;
 static GTY(()) tree tree_time_profiler_counter;
 
 
@@ -99,7 +103,11 @@ static GTY(()) tree ic_tuple_callee_field;
 
    If the target does not support atomic operations in hardware, however,  it
    supports libatomic, then all updates are carried out by libatomic calls
-   (COUNTER_UPDATE_ATOMIC_BUILTIN).  */
+   (COUNTER_UPDATE_ATOMIC_BUILTIN).
+
+   With -fprofile-update=sharded the edge counters are incremented without
+   atomic operations in a thread-local shard, and the other counters are
+   updated as with -fprofile-update=atomic.  */
 enum counter_update_method {
   COUNTER_UPDATE_SINGLE_THREAD,
   COUNTER_UPDATE_ATOMIC_BUILTIN,
@@ -109,6 +117,18 @@ enum counter_update_method {
 
 static counter_update_method counter_update = COUNTER_UPDATE_SINGLE_THREAD;
 
+/* Return true if the counters that are not sharded should be updated
+   atomically.  */
+
+static inline bool
+atomic_counter_update_p (void)
+{
+  return (flag_profile_update == PROFILE_UPDATE_ATOMIC
+	  || (flag_profile_update == PROFILE_UPDATE_SHARDED
+	      && (counter_update == COUNTER_UPDATE_ATOMIC_BUILTIN
+		  || counter_update == COUNTER_UPDATE_ATOMIC_SPLIT)));
+}
+
 /* These functions support measuring modified conditition/decision coverage
    (MC/DC).  MC/DC requires all of the below during testing:
 
@@ -1108,7 +1128,7 @@ instrument_decisions (array_slice<basic_block> expr, size_t condno,
     gcc_assert (xi == bitmap_count_bits (core));
 
     const tree relaxed = build_int_cst (integer_type_node, MEMMODEL_RELAXED);
-    const bool atomic = flag_profile_update == PROFILE_UPDATE_ATOMIC;
+    const bool atomic = atomic_counter_update_p ();
     const tree atomic_ior = builtin_decl_explicit
 	(TYPE_PRECISION (gcov_type_node) > 32
 	 ? BUILT_IN_ATOMIC_FETCH_OR_8
@@ -1227,8 +1247,7 @@ gimple_init_gcov_profiler (void)
 
   if (!gcov_type_node)
     {
-      const char *fn_suffix
-	= flag_profile_update == PROFILE_UPDATE_ATOMIC ? "_atomic" : "";
+      const char *fn_suffix = atomic_counter_update_p () ? "_atomic" : "";
 
       gcov_type_node = get_gcov_type ();
       gcov_type_ptr = build_pointer_type (gcov_type_node);
@@ -1324,6 +1343,18 @@ gimple_init_gcov_profiler (void)
 	= tree_cons (get_identifier ("leaf"), NULL,
 		     DECL_ATTRIBUTES (tree_ior_profiler_fn));
 
+      /* gcov_type * (*) (gcov_type *, gcov_type *, unsigned)  */
+      tree shard_register_fn_type
+	      = build_function_type_list (gcov_type_ptr,
+					  gcov_type_ptr, gcov_type_ptr,
+					  unsigned_type_node, NULL_TREE);
+      tree_shard_register_fn
+	= build_fn_decl ("__gcov_shard_register", shard_register_fn_type);
+      TREE_NOTHROW (tree_shard_register_fn) = 1;
+      DECL_ATTRIBUTES (tree_shard_register_fn)
+	= tree_cons (get_identifier ("leaf"), NULL,
+		     DECL_ATTRIBUTES (tree_shard_register_fn));
+
       /* LTO streamer needs assembler names.  Because we create these decls
          late, we need to initialize them by hand.  */
       DECL_ASSEMBLER_NAME (tree_interval_profiler_fn);
@@ -1332,6 +1363,7 @@ gimple_init_gcov_profiler (void)
       DECL_ASSEMBLER_NAME (tree_indirect_call_profiler_fn);
       DECL_ASSEMBLER_NAME (tree_average_profiler_fn);
       DECL_ASSEMBLER_NAME (tree_ior_profiler_fn);
+      DECL_ASSEMBLER_NAME (tree_shard_register_fn);
     }
 }
 
@@ -1361,19 +1393,22 @@ gen_assign_counter_update (gimple_stmt_iterator *gsi, gcall *call, tree func,
 
 /* Output instructions as GIMPLE trees to increment the COUNTER.  If RESULT is
    not null, then assign the updated counter value to RESULT.  Insert the
-   instructions to GSI.  Use NAME for temporary values.  */
+   instructions to GSI.  Use NAME for temporary values.  If LOCAL_P, the
+   COUNTER is only accessed by the current thread and needs no atomic
+   update.  */
 
 static inline void
 gen_counter_update (gimple_stmt_iterator *gsi, tree counter, tree result,
-		    const char *name)
+		    const char *name, bool local_p = false)
 {
   tree type = gcov_type_node;
   tree addr = build_fold_addr_expr (counter);
   tree one = build_int_cst (type, 1);
   tree relaxed = build_int_cst (integer_type_node, MEMMODEL_RELAXED);
 
-  if (counter_update == COUNTER_UPDATE_ATOMIC_BUILTIN
-      || (result && counter_update == COUNTER_UPDATE_ATOMIC_SPLIT))
+  if (!local_p
+      && (counter_update == COUNTER_UPDATE_ATOMIC_BUILTIN
+	  || (result && counter_update == COUNTER_UPDATE_ATOMIC_SPLIT)))
     {
       /* __atomic_fetch_add (&counter, 1, MEMMODEL_RELAXED); */
       tree f = builtin_decl_explicit (TYPE_PRECISION (type) > 32
@@ -1382,8 +1417,10 @@ gen_counter_update (gimple_stmt_iterator *gsi, tree counter, tree result,
       gcall *call = gimple_build_call (f, 3, addr, one, relaxed);
       gen_assign_counter_update (gsi, call, f, result, name);
     }
-  else if (!result && (counter_update == COUNTER_UPDATE_ATOMIC_SPLIT
-		       || counter_update == COUNTER_UPDATE_ATOMIC_PARTIAL))
+  else if (!local_p
+	   && !result
+	   && (counter_update == COUNTER_UPDATE_ATOMIC_SPLIT
+	       || counter_update == COUNTER_UPDATE_ATOMIC_PARTIAL))
     {
       /* low = __atomic_add_fetch_4 (addr, 1, MEMMODEL_RELAXED);
 	 high_inc = low == 0 ? 1 : 0;
@@ -1439,10 +1476,85 @@ void
 gimple_gen_edge_profiler (int edgeno, edge e)
 {
   gimple_stmt_iterator gsi = gsi_last (PENDING_STMT (e));
+  if (flag_profile_update == PROFILE_UPDATE_SHARDED)
+    {
+      if (!shard_base)
+	shard_base = make_temp_ssa_name (build_pointer_type (gcov_type_node),
+					 NULL, "PROF_shard");
+      tree offset
+	= build_int_cst (TREE_TYPE (shard_base),
+			 edgeno * tree_to_uhwi (TYPE_SIZE_UNIT (gcov_type_node)));
+      tree counter = build2 (MEM_REF, gcov_type_node, shard_base, offset);
+      gen_counter_update (&gsi, counter, NULL_TREE, "PROF_edge_counter",
+			  true);
+      return;
+    }
   tree counter = tree_coverage_counter_ref (GCOV_COUNTER_ARCS, edgeno);
   gen_counter_update (&gsi, counter, NULL_TREE, "PROF_edge_counter");
 }
 
+/* Output instructions as GIMPLE trees at the beginning of the function
+   to register the thread-local shard of its N edge counters with libgcov
+   the first time the current thread executes it, and to define the
+   pointer to the counters the edge profilers increment.  That is the
+   shard, unless libgcov falls back to the shared counters, so this must
+   be called once the edge profilers were committed.  */
+
+void
+gimple_gen_shard_register (unsigned n)
+{
+  basic_block entry = ENTRY_BLOCK_PTR_FOR_FN (cfun);
+  basic_block cond_bb = split_edge (single_succ_edge (entry));
+  basic_block update_bb = split_edge (single_succ_edge (cond_bb));
+
+  /* We need to do an extra split in order to not create an input
+     for a possible PHI node.  */
+  split_edge (single_succ_edge (update_bb));
+
+  edge true_edge = single_succ_edge (cond_bb);
+  true_edge->flags = EDGE_TRUE_VALUE;
+  true_edge->probability = profile_probability::very_unlikely ();
+  edge e
+    = make_edge (cond_bb, single_succ_edge (update_bb)->dest, EDGE_FALSE_VALUE);
+  e->probability = true_edge->probability.invert ();
+
+  /* Emit: base_1 = &shard[0]; if (shard[N] == 0).  */
+  gimple_stmt_iterator gsi = gsi_start_bb (cond_bb);
+  tree shard_addr
+    = force_gimple_operand_gsi (&gsi,
+				build_fold_addr_expr
+				  (tree_coverage_shard_ref (0)),
+				true, NULL_TREE, true, GSI_SAME_STMT);
+  tree ref = force_gimple_operand_gsi (&gsi, tree_coverage_shard_ref (n),
+				       true, NULL_TREE, true, GSI_SAME_STMT);
+  gcond *cond = gimple_build_cond (EQ_EXPR, ref,
+				   build_int_cst (gcov_type_node, 0),
+				   NULL, NULL);
+  gsi_insert_before (&gsi, cond, GSI_NEW_STMT);
+
+  /* Emit: base_2 = __gcov_shard_register (&counters[0], &shard[0], N).  */
+  gsi = gsi_after_labels (update_bb);
+  tree counters
+    = force_gimple_operand_gsi (&gsi,
+				tree_coverage_counter_addr (GCOV_COUNTER_ARCS,
+							    0),
+				true, NULL_TREE, true, GSI_SAME_STMT);
+  gcall *call = gimple_build_call (tree_shard_register_fn, 3, counters,
+				   shard_addr,
+				   build_int_cst (unsigned_type_node, n));
+  tree registered = make_temp_ssa_name (TREE_TYPE (shard_base), NULL,
+					"PROF_shard");
+  gimple_call_set_lhs (call, registered);
+  gsi_insert_before (&gsi, call, GSI_SAME_STMT);
+
+  /* Emit: base = PHI <base_1, base_2>.  */
+  gphi *phi = create_phi_node (shard_base, single_succ (update_bb));
+  add_phi_arg (phi, shard_addr, e, UNKNOWN_LOCATION);
+  add_phi_arg (phi, registered, single_succ_edge (update_bb),
+	       UNKNOWN_LOCATION);
+  shard_base = NULL_TREE;
+}
+
 /* Emits code to get VALUE to instrument at GSI, and returns the
    variable containing the value.  */
 
@@ -1847,6 +1959,17 @@ tree_profiling (void)
 	can_support_atomic = have_atomic_8;
     }
 
+  /* Sharded counters need native TLS, and the shard of a function is
+     registered by code run on its entry, which the functions of a profile
+     info section are not expected to run.  */
+  if (flag_profile_update == PROFILE_UPDATE_SHARDED
+      && (!targetm.have_tls || profile_info_section))
+    {
+      warning (0, "target does not support sharded profile update, "
+	       "prefer-atomic mode is selected");
+      flag_profile_update = PROFILE_UPDATE_PREFER_ATOMIC;
+    }
+
   if (flag_profile_update != PROFILE_UPDATE_SINGLE && needs_split)
     counter_update = COUNTER_UPDATE_ATOMIC_PARTIAL;
 
@@ -1861,7 +1984,8 @@ tree_profiling (void)
     flag_profile_update
       = can_support_atomic ? PROFILE_UPDATE_ATOMIC : PROFILE_UPDATE_SINGLE;
 
-  if (flag_profile_update == PROFILE_UPDATE_ATOMIC)
+  if (flag_profile_update == PROFILE_UPDATE_ATOMIC
+      || (flag_profile_update == PROFILE_UPDATE_SHARDED && can_support_atomic))
     {
       if (needs_split)
 	counter_update = COUNTER_UPDATE_ATOMIC_SPLIT;
@@ -2276,6 +2276,16 @@ vect_analyze_loop_costing (loop_vec_info loop_vinfo,
 	dump_printf_loc (MSG_MISSED_OPTIMIZATION, vect_location,
 			 "not vectorized: iteration count smaller than "
 			 "vectorization factor.\n");
+      /* Let vect_analyze_loop skip the bigger modes for the main loop.  */
+      vec_info_shared *shared = loop_vinfo->shared;
+      if (!LOOP_VINFO_EPILOGUE_P (loop_vinfo)
+	  && loop_vinfo->suggested_unroll_factor == 1
+	  && VECTOR_MODE_P (loop_vinfo->vector_mode)
+	  && (known_eq (shared->too_few_iters_mode_size, 0U)
+	      || known_lt (GET_MODE_SIZE (loop_vinfo->vector_mode),
+			   shared->too_few_iters_mode_size)))
+	shared->too_few_iters_mode_size
+	  = GET_MODE_SIZE (loop_vinfo->vector_mode);
       return 0;
     }
 
@@ -3479,6 +3489,7 @@ vect_analyze_loop_1 (class loop *loop, vec_info_shared *shared,
   bool slp_done_for_suggested_uf = false;
 
   /* Run the main analysis.  */
+  shared->n_mode_analyses++;
   opt_result res = vect_analyze_loop_2 (loop_vinfo, fatal,
 					&suggested_unroll_factor,
 					slp_done_for_suggested_uf);
@@ -3500,6 +3511,7 @@ vect_analyze_loop_1 (class loop *loop, vec_info_shared *shared,
 	= vect_create_loop_vinfo (loop, shared, loop_form_info, main_loop_vinfo);
       unroll_vinfo->vector_mode = vector_mode;
       unroll_vinfo->suggested_unroll_factor = suggested_unroll_factor;
+      shared->n_mode_analyses++;
       opt_result new_res = vect_analyze_loop_2 (unroll_vinfo, fatal, NULL,
 						slp_done_for_suggested_uf);
       if (new_res)
@@ -3526,6 +3538,7 @@ vect_analyze_loop_1 (class loop *loop, vec_info_shared *shared,
 			 "***** The result for vector mode %s would"
 			 " be the same\n",
 			 GET_MODE_NAME (vector_modes[mode_i + 1]));
+      shared->n_modes_skipped++;
       mode_i += 1;
     }
   if (mode_i + 1 < vector_modes.length ()
@@ -3543,6 +3556,7 @@ vect_analyze_loop_1 (class loop *loop, vec_info_shared *shared,
 			 " repeat the analysis for %s\n",
 			 GET_MODE_NAME (vector_modes[mode_i + 1]),
 			 GET_MODE_NAME (autodetected_vector_mode));
+      shared->n_modes_skipped++;
       mode_i += 1;
     }
   mode_i++;
@@ -3621,16 +3635,41 @@ vect_analyze_loop (class loop *loop, vec_info_shared *shared)
 
   /* Keep track of the VF for each mode.  Initialize all to 0 which indicates
      a mode has not been analyzed.  */
-  auto_vec<poly_uint64, 8> cached_vf_per_mode;
+  auto_vec<poly_uint64, 8> &cached_vf_per_mode = shared->mode_vfs;
+  cached_vf_per_mode.truncate (0);
   for (unsigned i = 0; i < vector_modes.length (); ++i)
     cached_vf_per_mode.safe_push (0);
 
+  bool supports_partial_vectors =
+    partial_vectors_supported_p () && param_vect_partial_vector_usage != 0;
+
   /* First determine the main loop vectorization mode, either the first
      one that works, starting with auto-detecting the vector mode and then
      following the targets order of preference, or the one with the
      lowest cost if pick_lowest_cost_p.  */
   while (1)
     {
+      /* A mode cannot give enough iterations for the main loop if a
+	 smaller one did not, unless partial vectors can be used.  */
+      if (!supports_partial_vectors
+	  && VECTOR_MODE_P (vector_modes[mode_i])
+	  && maybe_ne (shared->too_few_iters_mode_size, 0U)
+	  && known_ge (GET_MODE_SIZE (vector_modes[mode_i]),
+		       shared->too_few_iters_mode_size))
+	{
+	  if (dump_enabled_p ())
+	    dump_printf_loc (MSG_NOTE, vect_location,
+			     "***** Skipping vector mode %s, which would"
+			     " need more iterations than the loop has\n",
+			     GET_MODE_NAME (vector_modes[mode_i]));
+	  cached_vf_per_mode[mode_i] = -1;
+	  shared->n_modes_pruned++;
+	  mode_i++;
+	  if (mode_i == vector_modes.length ())
+	    break;
+	  continue;
+	}
+
       bool fatal;
       unsigned int last_mode_i = mode_i;
       /* Set cached VF to -1 prior to analysis, which indicates a mode has
@@ -3726,8 +3765,6 @@ vect_analyze_loop (class loop *loop, vec_info_shared *shared)
   vector_modes[0] = autodetected_vector_mode;
   mode_i = 0;
 
-  bool supports_partial_vectors =
-    partial_vectors_supported_p () && param_vect_partial_vector_usage != 0;
   poly_uint64 first_vinfo_vf = LOOP_VINFO_VECT_FACTOR (first_loop_vinfo);
 
   while (1)
@@ -3739,6 +3776,7 @@ vect_analyze_loop (class loop *loop, vec_info_shared *shared)
       if (!supports_partial_vectors
 	  && maybe_ge (cached_vf_per_mode[mode_i], first_vinfo_vf))
 	{
+	  shared->n_modes_pruned++;
 	  mode_i++;
 	  if (mode_i == vector_modes.length ())
 	    break;
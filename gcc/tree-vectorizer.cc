@@ -480,7 +480,11 @@ vec_info_shared::vec_info_shared ()
   : n_stmts (0),
     datarefs (vNULL),
     datarefs_copy (vNULL),
-    ddrs (vNULL)
+    ddrs (vNULL),
+    too_few_iters_mode_size (0),
+    n_mode_analyses (0),
+    n_modes_skipped (0),
+    n_modes_pruned (0)
 {
 }
 
@@ -1066,6 +1070,18 @@ try_vectorize_loop_1 (hash_table<simduid_to_vf> *&simduid_to_vf_htab,
   opt_loop_vec_info loop_vinfo = vect_analyze_loop (loop, &shared);
   loop->aux = loop_vinfo;
 
+  statistics_counter_event (fun, "Loop vector mode analyses",
+			    shared.n_mode_analyses);
+  statistics_counter_event (fun, "Loop vector modes skipped",
+			    shared.n_modes_skipped);
+  statistics_counter_event (fun, "Loop vector modes pruned",
+			    shared.n_modes_pruned);
+  if (dump_enabled_p () && shared.n_mode_analyses)
+    dump_printf_loc (MSG_NOTE, vect_location,
+		     "%u vector mode analyses, %u modes skipped as repeated,"
+		     " %u modes pruned\n", shared.n_mode_analyses,
+		     shared.n_modes_skipped, shared.n_modes_pruned);
+
   if (!loop_vinfo)
     if (dump_enabled_p ())
       if (opt_problem *problem = loop_vinfo.get_problem ())
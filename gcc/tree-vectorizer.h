@@ -442,6 +442,23 @@ public:
   /* All data dependences.  Freed by free_dependence_relations, so not
      an auto_vec.  */
   vec<ddr_p> ddrs;
+
+  /* The vectorization factor found for the main loop with each of the
+     vector modes vect_analyze_loop tries, in its order: 0 if the mode has
+     not been analyzed and -1 if the analysis failed.  */
+  auto_vec<poly_uint64, 8> mode_vfs;
+
+  /* The size of the smallest vector mode with which the main loop has
+     fewer iterations than the vectorization factor, or 0.  Bigger modes
+     cannot do better unless partial vectors are used.  */
+  poly_uint64 too_few_iters_mode_size;
+
+  /* The number of analyses of the loop for a vector mode, and of the
+     modes that were not analyzed because the result would have been the
+     same as for another mode or could not have been used.  */
+  unsigned n_mode_analyses;
+  unsigned n_modes_skipped;
+  unsigned n_modes_pruned;
 };
 
 /* Vectorizer state common between loop and basic-block vectorization.  */
@@ -97,6 +97,7 @@ bool get_nth_most_common_value (gimple *stmt, const char *counter_type,
 /* In tree-profile.cc.  */
 extern void gimple_init_gcov_profiler (void);
 extern void gimple_gen_edge_profiler (int, edge);
+extern void gimple_gen_shard_register (unsigned);
 extern void gimple_gen_interval_profiler (histogram_value, unsigned);
 extern void gimple_gen_pow2_profiler (histogram_value, unsigned);
 extern void gimple_gen_topn_values_profiler (histogram_value, unsigned);
@@ -534,6 +534,9 @@ struct shared_hash
   /* Reference count.  */
   int refcount;
 
+  /* Size of the hash table last accounted for in shared_htab_size.  */
+  int accounted_size;
+
   /* Actual hash table.  */
   variable_table_type *htab;
 };
@@ -577,6 +580,8 @@ struct variable_tracking_info
   /* Has the block been flooded in VTA?  */
   bool flooded;
 
+  /* Has the OUT set been released after the dataflow converged?  */
+  bool out_released;
 };
 
 /* Alloc pool for struct attrs_def.  */
@@ -616,6 +621,10 @@ static variable_table_type *dropped_values;
 /* Empty shared hashtable.  */
 static shared_hash *empty_shared_hash;
 
+/* Total size of the hash tables accounted for by shared_hash_account
+   during vt_find_locations.  */
+static int shared_htab_size;
+
 /* Scratch register bitmap used by cselib_expand_value_rtx.  */
 static bitmap scratch_regs = NULL;
 
@@ -1615,12 +1624,27 @@ shared_hash_unshare (shared_hash *vars)
   shared_hash *new_vars = new shared_hash;
   gcc_assert (vars->refcount > 1);
   new_vars->refcount = 1;
+  new_vars->accounted_size = 0;
   new_vars->htab = new variable_table_type (vars->htab->elements () + 3);
   vars_copy (new_vars->htab, vars->htab);
   vars->refcount--;
   return new_vars;
 }
 
+/* Update the size of VARS' hash table accounted for in
+   shared_htab_size.  Each table is accounted for once however many
+   dataflow sets share it, and its size is withdrawn when it is
+   destroyed, so shared_htab_size is the total size of the live
+   tables.  */
+
+static inline void
+shared_hash_account (shared_hash *vars)
+{
+  int size = shared_hash_htab (vars)->size ();
+  shared_htab_size += size - vars->accounted_size;
+  vars->accounted_size = size;
+}
+
 /* Increment reference counter on VARS and return it.  */
 
 static inline shared_hash *
@@ -1639,6 +1663,7 @@ shared_hash_destroy (shared_hash *vars)
   gcc_checking_assert (vars->refcount > 0);
   if (--vars->refcount == 0)
     {
+      shared_htab_size -= vars->accounted_size;
       delete vars->htab;
       delete vars;
     }
@@ -4261,6 +4286,7 @@ dataflow_set_merge (dataflow_set *dst, dataflow_set *src2)
   shared_hash_destroy (dst->vars);
   dst->vars = new shared_hash;
   dst->vars->refcount = 1;
+  dst->vars->accounted_size = 0;
   dst->vars->htab = new variable_table_type (MAX (src1_elems, src2_elems));
 
   for (i = 0; i < FIRST_PSEUDO_REGISTER; i++)
@@ -7057,11 +7083,15 @@ vt_find_locations (void)
   edge e;
   int *bb_order;
   int *rc_order;
+  int *last_use;
+  int *release_order;
   int i;
   int htabsz = 0;
+  int htabpeak = 0;
   int htabmax = param_max_vartrack_size;
   bool success = true;
   unsigned int n_blocks_processed = 0;
+  unsigned int n_out_released = 0;
 
   timevar_push (TV_VAR_TRACKING_DATAFLOW);
   /* Compute reverse completion order of depth first search of the CFG
@@ -7077,6 +7107,40 @@ vt_find_locations (void)
   for (i = 0; i < n; i++)
     bb_order[rc_order[i]] = i;
 
+  /* HTABSZ is the total size of the live hash tables of the IN and OUT
+     sets, each table accounted for once.  The tables created before
+     the dataflow are all empty_shared_hash.  */
+  shared_htab_size = 0;
+
+  /* The OUT set of a block is only read when computing the IN sets of
+     its successors.  Once the region containing the last of them in RPO
+     has converged it is dead, so release it right away instead of
+     keeping the OUT sets of the whole function alive until
+     vt_emit_notes.  LAST_USE[I] is the RPO index of the last successor
+     of the block at RPO index I and RELEASE_ORDER the RPO indexes sorted
+     by LAST_USE, so each region can release its dead sets in time
+     linear in their number.  */
+  last_use = XNEWVEC (int, n);
+  release_order = XNEWVEC (int, n);
+  {
+    int *bucket = XCNEWVEC (int, n + 1);
+    for (i = 0; i < n; i++)
+      {
+	edge_iterator ei;
+	last_use[i] = i;
+	FOR_EACH_EDGE (e, ei, BASIC_BLOCK_FOR_FN (cfun, rc_order[i])->succs)
+	  if (e->dest != EXIT_BLOCK_PTR_FOR_FN (cfun))
+	    last_use[i] = MAX (last_use[i], bb_order[e->dest->index]);
+	bucket[last_use[i] + 1]++;
+      }
+    for (i = 0; i < n; i++)
+      bucket[i + 1] += bucket[i];
+    for (i = 0; i < n; i++)
+      release_order[bucket[last_use[i]]++] = i;
+    free (bucket);
+  }
+  int n_released = 0;
+
   in_worklist = sbitmap_alloc (last_basic_block_for_fn (cfun));
   in_pending = sbitmap_alloc (last_basic_block_for_fn (cfun));
   bitmap_clear (in_worklist);
@@ -7119,8 +7183,6 @@ vt_find_locations (void)
 
 	      if (VTI (bb)->in.vars)
 		{
-		  htabsz -= (shared_hash_htab (VTI (bb)->in.vars)->size ()
-			     + shared_hash_htab (VTI (bb)->out.vars)->size ());
 		  oldinsz = shared_hash_htab (VTI (bb)->in.vars)->elements ();
 		  oldoutsz = shared_hash_htab (VTI (bb)->out.vars)->elements ();
 		}
@@ -7184,8 +7246,10 @@ vt_find_locations (void)
 
 	      changed = compute_bb_dataflow (bb);
 	      n_blocks_processed++;
-	      htabsz += (shared_hash_htab (VTI (bb)->in.vars)->size ()
-			 + shared_hash_htab (VTI (bb)->out.vars)->size ());
+	      shared_hash_account (VTI (bb)->in.vars);
+	      shared_hash_account (VTI (bb)->out.vars);
+	      htabsz = shared_htab_size;
+	      htabpeak = MAX (htabpeak, htabsz);
 
 	      if (htabmax && htabsz > htabmax)
 		{
@@ -7252,11 +7316,30 @@ vt_find_locations (void)
 		}
 	    }
 	}
+
+      /* The region has converged, release the OUT sets that no block
+	 still to be processed reads.  Their final contents have already
+	 been dumped above with detailed dumps.  */
+      while (success
+	     && n_released < n
+	     && last_use[release_order[n_released]] <= curr_end)
+	{
+	  basic_block rbb
+	    = BASIC_BLOCK_FOR_FN (cfun, rc_order[release_order[n_released++]]);
+	  dataflow_set_clear (&VTI (rbb)->out);
+	  VTI (rbb)->out_released = true;
+	  n_out_released++;
+	}
+      htabsz = shared_htab_size;
     }
-  while (curr_end != n - 1);
+  while (success && curr_end != n - 1);
 
   statistics_counter_event (cfun, "compute_bb_dataflow times",
 			    n_blocks_processed);
+  statistics_counter_event (cfun, "var-tracking OUT sets released early",
+			    n_out_released);
+  statistics_counter_event (cfun, "var-tracking peak hash table size",
+			    htabpeak);
 
   if (success && MAY_HAVE_DEBUG_BIND_INSNS)
     FOR_EACH_BB_FN (bb, cfun)
@@ -7264,6 +7347,8 @@ vt_find_locations (void)
 
   free (rc_order);
   free (bb_order);
+  free (last_use);
+  free (release_order);
   delete worklist;
   delete pending;
   sbitmap_free (in_worklist);
@@ -7392,8 +7477,13 @@ dump_dataflow_sets (void)
       fprintf (dump_file, "\nBasic block %d:\n", bb->index);
       fprintf (dump_file, "IN:\n");
       dump_dataflow_set (&VTI (bb)->in);
-      fprintf (dump_file, "OUT:\n");
-      dump_dataflow_set (&VTI (bb)->out);
+      if (VTI (bb)->out_released)
+	fprintf (dump_file, "OUT: released after the dataflow converged\n");
+      else
+	{
+	  fprintf (dump_file, "OUT:\n");
+	  dump_dataflow_set (&VTI (bb)->out);
+	}
     }
 }
 
@@ -10043,6 +10133,7 @@ vt_initialize (void)
 
   empty_shared_hash = shared_hash_pool.allocate ();
   empty_shared_hash->refcount = 1;
+  empty_shared_hash->accounted_size = 0;
   empty_shared_hash->htab = new variable_table_type (1);
   changed_variables = new variable_table_type (10);
 
@@ -146,6 +146,36 @@ cplus_demangle_v3_callback (const char *mangled, int options,
 extern char*
 cplus_demangle_v3 (const char *mangled, int options);
 
+/* Scratch storage for demangling many names with the V3 ABI entry
+   points below, which reuse it from one name to the next and remember
+   recent results.  A context must not be used by two threads at
+   once.  */
+struct demangle_context;
+
+extern struct demangle_context *
+cplus_demangle_context_new (void);
+
+extern void
+cplus_demangle_context_free (struct demangle_context *ctx);
+
+/* Like cplus_demangle_v3, but return a string that belongs to CTX and
+   is valid until the next call with CTX, instead of one allocated by
+   malloc.  */
+extern const char *
+cplus_demangle_v3_context (struct demangle_context *ctx,
+                           const char *mangled, int options);
+
+/* Callback typedef for cplus_demangle_v3_batch.  The arguments are the
+   index of the name, its demangled form or NULL, and an opaque value.
+   A non-zero return value stops the batch.  */
+typedef int (*demangle_batch_callbackref) (size_t, const char *, void *);
+
+extern int
+cplus_demangle_v3_batch (struct demangle_context *ctx,
+                         const char *const *mangled, size_t count,
+                         int options, demangle_batch_callbackref callback,
+                         void *opaque);
+
 extern int
 java_demangle_v3_callback (const char *mangled,
                            demangle_callbackref callback, void *opaque);
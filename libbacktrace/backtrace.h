@@ -173,6 +173,83 @@ extern int backtrace_pcinfo (struct backtrace_state *state, uintptr_t pc,
 			     backtrace_error_callback error_callback,
 			     void *data);
 
+/* Like backtrace_pcinfo, for each of the COUNT program counters in PCS
+   in turn.  This is cheaper than calling backtrace_pcinfo for each of
+   them.  If any call to CALLBACK returns a non-zero value, no further
+   PCs are looked up, and backtrace_pcinfo_batch returns that value;
+   otherwise it returns 0.  CALLBACK gets the PC being looked up, so
+   that the caller can match the frames to the PCs.  Like the other
+   functions, this may be called by several threads at once if the
+   state was created with THREADED non-zero.  */
+
+extern int backtrace_pcinfo_batch (struct backtrace_state *state,
+				   const uintptr_t *pcs, size_t count,
+				   backtrace_full_callback callback,
+				   backtrace_error_callback error_callback,
+				   void *data);
+
+/* The type of the callback argument to backtrace_pcinfo_detail.  This
+   is like backtrace_full_callback, with two more arguments.
+   DISCRIMINATOR is the DWARF discriminator of LINENO, which tells apart
+   the blocks of code on the same line, or 0 if there is none.
+   DECL_LINENO is the line on which FUNCTION is declared, or 0 if not
+   available.  */
+
+typedef int (*backtrace_detail_callback) (void *data, uintptr_t pc,
+					  const char *filename, int lineno,
+					  int discriminator,
+					  const char *function,
+					  int decl_lineno);
+
+/* Like backtrace_pcinfo, but also report the discriminator of each line
+   and the line on which each function is declared.  For an inlined
+   call, the discriminator is that of the call in its caller.  The index
+   loaded by backtrace_load_index does not record them, so this always
+   reads the debug info.  Only DWARF debug info provides them; with
+   other formats they are reported as 0.  */
+
+extern int backtrace_pcinfo_detail (struct backtrace_state *state,
+				    uintptr_t pc,
+				    backtrace_detail_callback callback,
+				    backtrace_error_callback error_callback,
+				    void *data);
+
+/* Write to FILENAME an index of the file/line information of the
+   executable, or more precisely of the first module for which DWARF
+   debug info was found, which is normally the executable.  The index
+   maps every address of the module to the frames that
+   backtrace_pcinfo reports for it, and can be loaded by
+   backtrace_load_index in a later run of the same executable.  Reading
+   all the debug info can take a long time for a large executable.
+   Returns 1 on success, 0 on error.  This function requires debug info
+   for the executable.  */
+
+extern int backtrace_write_index (struct backtrace_state *state,
+				  const char *filename,
+				  backtrace_error_callback error_callback,
+				  void *data);
+
+/* Load the index in FILENAME, written by backtrace_write_index, into
+   STATE.  The file is mapped into memory and is not otherwise parsed.
+   After this, backtrace_pcinfo, backtrace_pcinfo_batch and
+   backtrace_full use the index for the addresses it covers, and only
+   read the debug info for other addresses.  BASE_ADDRESS is the address
+   at which the module is loaded in this process: 0 for an executable
+   that is not position independent, and the dlpi_addr field that
+   dl_iterate_phdr reports for a position independent executable.
+   Passing (uintptr_t) -1 uses the base address that the module had when
+   the index was written.  The index is rejected unless the size and
+   modification time of the executable are the same as when it was
+   written.  Returns 1 on success, 0 on error.  If STATE was created
+   with THREADED zero, loading another index replaces the old one;
+   otherwise, as another thread may be using it, loading another index
+   is an error.  */
+
+extern int backtrace_load_index (struct backtrace_state *state,
+				 const char *filename, uintptr_t base_address,
+				 backtrace_error_callback error_callback,
+				 void *data);
+
 /* The type of the callback argument to backtrace_syminfo.  DATA and
    PC are the arguments passed to backtrace_syminfo.  SYMNAME is the
    name of the symbol for the corresponding code.  SYMVAL is the
@@ -34,6 +34,7 @@ POSSIBILITY OF SUCH DAMAGE.  */
    libbacktrace library.  */
 
 #include <assert.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -459,6 +460,384 @@ test5 (void)
   return failures;
 }
 
+/* Test backtrace_pcinfo_batch, and looking up PCs in an index written
+   by backtrace_write_index.  */
+
+static int test6 (void) __attribute__ ((noinline, noclone, unused));
+static int f42 (int) __attribute__ ((noinline, noclone));
+static int f43 (int, int) __attribute__ ((noinline, noclone));
+
+static int
+test6 (void)
+{
+  return f42 (__LINE__) + 1;
+}
+
+static int
+f42 (int f1line)
+{
+  return f43 (f1line, __LINE__) + 2;
+}
+
+/* Check the information that backtrace_pcinfo_batch returns in STATE
+   for the first three frames ADDRS of test6.  */
+
+static void
+check_batch (const char *name, void *st, const uintptr_t *addrs,
+	     int f1line, int f2line, int f3line, int *failed)
+{
+  struct info all[20];
+  struct bdata bdata;
+  int i;
+
+  bdata.all = &all[0];
+  bdata.index = 0;
+  bdata.max = 20;
+  bdata.failed = 0;
+
+  i = backtrace_pcinfo_batch (st, addrs, 3, callback_one, error_callback_one,
+			      &bdata);
+  if (i != 0)
+    {
+      fprintf (stderr,
+	       "%s: unexpected return value from backtrace_pcinfo_batch %d\n",
+	       name, i);
+      bdata.failed = 1;
+    }
+  if (!bdata.failed && bdata.index != 3)
+    {
+      fprintf (stderr,
+	       ("%s: wrong number of calls from backtrace_pcinfo_batch "
+		"got %u expected 3\n"),
+	       name, (unsigned int) bdata.index);
+      bdata.failed = 1;
+    }
+
+  check (name, 0, all, f3line, "f43", "btest.c", &bdata.failed);
+  check (name, 1, all, f2line, "f42", "btest.c", &bdata.failed);
+  check (name, 2, all, f1line, "test6", "btest.c", &bdata.failed);
+
+  if (bdata.failed)
+    *failed = 1;
+}
+
+/* An error callback that only records that it was called.  */
+
+static void
+error_callback_index (void *vdata, const char *msg ATTRIBUTE_UNUSED,
+		      int errnum ATTRIBUTE_UNUSED)
+{
+  *(int *) vdata = 1;
+}
+
+/* Change the modification time of the executable recorded in the index
+   in INDEX_FILE, which follows the magic, version, byte order, base
+   address and size of the executable in the header.  Returns 1 on
+   success, 0 on failure.  */
+
+static int
+change_index_mtime (const char *index_file)
+{
+  int descriptor;
+  int64_t mtime;
+  int ok;
+
+  descriptor = open (index_file, O_RDWR);
+  if (descriptor < 0)
+    return 0;
+  ok = (lseek (descriptor, 32, SEEK_SET) == 32
+	&& read (descriptor, &mtime, sizeof mtime) == sizeof mtime);
+  mtime ^= 1;
+  ok = (ok
+	&& lseek (descriptor, 32, SEEK_SET) == 32
+	&& write (descriptor, &mtime, sizeof mtime) == sizeof mtime);
+  close (descriptor);
+  return ok;
+}
+
+static int
+f43 (int f1line, int f2line)
+{
+  uintptr_t addrs[20];
+  struct sdata data;
+  int f3line;
+  int i;
+
+  data.addrs = &addrs[0];
+  data.index = 0;
+  data.max = 20;
+  data.failed = 0;
+
+  f3line = __LINE__ + 1;
+  i = backtrace_simple (state, 0, callback_two, error_callback_two, &data);
+
+  if (i != 0)
+    {
+      fprintf (stderr, "test6: unexpected return value %d\n", i);
+      data.failed = 1;
+    }
+
+  if (!data.failed)
+    check_batch ("test6", state, addrs, f1line, f2line, f3line,
+		 &data.failed);
+
+  printf ("%s: backtrace_pcinfo_batch\n", data.failed ? "FAIL" : "PASS");
+
+  if (data.failed)
+    ++failures;
+
+  if (!data.failed)
+    {
+      char index_file[64];
+      void *index_state;
+
+      snprintf (index_file, sizeof index_file, "btest-%ld.idx",
+		(long) getpid ());
+      if (!backtrace_write_index (state, index_file, error_callback_two,
+				  &data))
+	data.failed = 1;
+
+      /* The file name of this state does not exist; the index is
+	 checked against the executable that libbacktrace finds
+	 otherwise.  */
+      index_state = backtrace_create_state ("/nonexistent/btest",
+					    BACKTRACE_SUPPORTS_THREADS,
+					    error_callback_create, NULL);
+      if (!data.failed
+	  && !backtrace_load_index (index_state, index_file, (uintptr_t) -1,
+				    error_callback_two, &data))
+	data.failed = 1;
+
+      /* An index written for another version of the executable is
+	 rejected.  */
+      if (!data.failed)
+	{
+	  void *stale_state;
+	  int called;
+
+	  stale_state = backtrace_create_state (NULL,
+						BACKTRACE_SUPPORTS_THREADS,
+						error_callback_create, NULL);
+	  called = 0;
+	  if (!change_index_mtime (index_file)
+	      || backtrace_load_index (stale_state, index_file,
+				       (uintptr_t) -1, error_callback_index,
+				       &called)
+	      || !called)
+	    {
+	      fprintf (stderr, "test6: stale index not rejected\n");
+	      data.failed = 1;
+	    }
+	}
+      unlink (index_file);
+
+      if (!data.failed)
+	check_batch ("test6 index", index_state, addrs, f1line, f2line,
+		     f3line, &data.failed);
+
+      printf ("%s: backtrace_load_index\n", data.failed ? "FAIL" : "PASS");
+
+      if (data.failed)
+	++failures;
+    }
+
+  return failures;
+}
+
+/* Test backtrace_pcinfo_detail.  */
+
+/* The information that backtrace_pcinfo_detail reports for a frame.  */
+
+struct detail_info
+{
+  int lineno;
+  int discriminator;
+  char *function;
+  int decl_lineno;
+};
+
+/* Passed to callback_detail.  */
+
+struct detail_data
+{
+  struct detail_info *all;
+  size_t index;
+  size_t max;
+  int failed;
+};
+
+/* A backtrace_detail_callback that records the frame in the
+   detail_data at VDATA.  */
+
+static int
+callback_detail (void *vdata, uintptr_t pc ATTRIBUTE_UNUSED,
+		 const char *filename ATTRIBUTE_UNUSED, int lineno,
+		 int discriminator, const char *function, int decl_lineno)
+{
+  struct detail_data *data = (struct detail_data *) vdata;
+  struct detail_info *p;
+
+  if (data->index >= data->max)
+    {
+      fprintf (stderr, "callback_detail: callback called too many times\n");
+      data->failed = 1;
+      return 1;
+    }
+
+  p = &data->all[data->index];
+  p->lineno = lineno;
+  p->discriminator = discriminator;
+  if (function == NULL)
+    p->function = NULL;
+  else
+    {
+      p->function = strdup (function);
+      assert (p->function != NULL);
+    }
+  p->decl_lineno = decl_lineno;
+  ++data->index;
+
+  return 0;
+}
+
+static int test7 (void) __attribute__ ((noinline, noclone, unused));
+static int f62 (int) __attribute__ ((noinline, noclone));
+static int f64 (int) __attribute__ ((noinline, noclone));
+static inline int f65 (int) __attribute__ ((always_inline));
+
+/* The frames that f65 sees when f64 is called from each of the two
+   calls in f62, which are on the same line: f65 inlined into f64, f64,
+   and f62.  */
+
+static struct detail_info detail_frames[2][3];
+static struct detail_data detail_results[2];
+
+/* The lines of the declarations, and of the call to backtrace_simple in
+   f65.  */
+
+static int f65line;
+
+static const int f62_decl_line = __LINE__ + 2;
+static int
+f62 (int which)
+{
+  return (which ? f64 (which) : f64 (which)) + 1;
+}
+
+static const int f64_decl_line = __LINE__ + 2;
+static int
+f64 (int which)
+{
+  return f65 (which) + 2;
+}
+
+static const int f65_decl_line = __LINE__ + 2;
+static inline int
+f65 (int which)
+{
+  uintptr_t addrs[20];
+  struct sdata sdata;
+  struct detail_data *data;
+  int i;
+
+  sdata.addrs = &addrs[0];
+  sdata.index = 0;
+  sdata.max = 20;
+  sdata.failed = 0;
+
+  data = &detail_results[which];
+  data->all = &detail_frames[which][0];
+  data->index = 0;
+  data->max = 3;
+  data->failed = 0;
+
+  f65line = __LINE__ + 1;
+  i = backtrace_simple (state, 0, callback_two, error_callback_two, &sdata);
+  if (i != 0 || sdata.failed || sdata.index < 2)
+    {
+      fprintf (stderr, "test7: backtrace_simple failed\n");
+      data->failed = 1;
+      return 0;
+    }
+
+  for (i = 0; i < 2; ++i)
+    if (backtrace_pcinfo_detail (state, addrs[i], callback_detail,
+				 error_callback_one, data) != 0)
+      data->failed = 1;
+
+  return 0;
+}
+
+/* Check that frame INDEX of the frames ALL that f65 saw is at LINENO in
+   FUNCTION, declared at DECL_LINENO.  */
+
+static void
+check_detail (const struct detail_info *all, int index, int lineno,
+	      const char *function, int decl_lineno, int *failed)
+{
+  const struct detail_info *p = &all[index];
+
+  if (p->function == NULL || strcmp (p->function, function) != 0)
+    {
+      fprintf (stderr, "test7: [%d]: got function %s expected %s\n",
+	       index, p->function == NULL ? "NULL" : p->function, function);
+      *failed = 1;
+    }
+  else if (p->lineno != lineno || p->decl_lineno != decl_lineno)
+    {
+      fprintf (stderr,
+	       ("test7: [%d]: got line %d declared at %d "
+		"expected %d declared at %d\n"),
+	       index, p->lineno, p->decl_lineno, lineno, decl_lineno);
+      *failed = 1;
+    }
+}
+
+static int
+test7 (void)
+{
+  int failed;
+  int i;
+
+  f62 (0);
+  f62 (1);
+
+  failed = 0;
+  for (i = 0; i < 2 && !failed; ++i)
+    {
+      if (detail_results[i].failed || detail_results[i].index != 3)
+	{
+	  fprintf (stderr, "test7: got %u frames expected 3\n",
+		   (unsigned int) detail_results[i].index);
+	  failed = 1;
+	  break;
+	}
+      check_detail (detail_frames[i], 0, f65line, "f65", f65_decl_line,
+		    &failed);
+      check_detail (detail_frames[i], 1, f64_decl_line + 2, "f64",
+		    f64_decl_line, &failed);
+      check_detail (detail_frames[i], 2, f62_decl_line + 2, "f62",
+		    f62_decl_line, &failed);
+    }
+
+  /* The two calls in f62 are on the same line, in different blocks,
+     which the discriminators tell apart.  */
+  if (!failed
+      && detail_frames[0][2].discriminator == detail_frames[1][2].discriminator)
+    {
+      fprintf (stderr, "test7: the calls have the same discriminator %d\n",
+	       detail_frames[0][2].discriminator);
+      failed = 1;
+    }
+
+  printf ("%s: backtrace_pcinfo_detail\n", failed ? "FAIL" : "PASS");
+
+  if (failed)
+    ++failures;
+
+  return failures;
+}
+
 #define MIN_DESCRIPTOR 3
 #define MAX_DESCRIPTOR 10
 
@@ -509,6 +888,8 @@ main (int argc ATTRIBUTE_UNUSED, char **argv)
 #if BACKTRACE_SUPPORTS_DATA
   test5 ();
 #endif
+  test6 ();
+  test7 ();
 #endif
 
   check_open_files ();
@@ -234,6 +234,8 @@ struct line
   const char *filename;
   /* Line number.  */
   int lineno;
+  /* Discriminator of the line, or 0.  */
+  int discriminator;
   /* Index of the object in the original array read from the DWARF
      section, before it has been sorted.  The index makes it possible
      to use Quicksort and maintain stability.  */
@@ -263,6 +265,11 @@ struct function
   /* If this is an inlined function, the line number of the call
      site.  */
   int caller_lineno;
+  /* If this is an inlined function, the discriminator of the call
+     site.  */
+  int caller_discriminator;
+  /* The line number of the declaration, or 0.  */
+  int decl_lineno;
   /* Map PC ranges to inlined functions.  */
   struct function_addrs *function_addrs;
   size_t function_addrs_count;
@@ -2289,18 +2296,20 @@ build_address_map (struct backtrace_state *state, uintptr_t base_address,
 
 static int
 add_line (struct backtrace_state *state, struct dwarf_data *ddata,
-	  uintptr_t pc, const char *filename, int lineno,
+	  uintptr_t pc, const char *filename, int lineno, int discriminator,
 	  backtrace_error_callback error_callback, void *data,
 	  struct line_vector *vec)
 {
   struct line *ln;
 
-  /* If we are adding the same mapping, ignore it.  This can happen
-     when using discriminators.  */
+  /* If we are adding the same mapping, ignore it.  */
   if (vec->count > 0)
     {
       ln = (struct line *) vec->vec.base + (vec->count - 1);
-      if (pc == ln->pc && filename == ln->filename && lineno == ln->lineno)
+      if (pc == ln->pc
+	  && filename == ln->filename
+	  && lineno == ln->lineno
+	  && discriminator == ln->discriminator)
 	return 1;
     }
 
@@ -2316,6 +2325,7 @@ add_line (struct backtrace_state *state, struct dwarf_data *ddata,
 
   ln->filename = filename;
   ln->lineno = lineno;
+  ln->discriminator = discriminator;
   ln->idx = vec->count;
 
   ++vec->count;
@@ -2734,6 +2744,7 @@ read_line_program (struct backtrace_state *state, struct dwarf_data *ddata,
   const char *reset_filename;
   const char *filename;
   int lineno;
+  int discriminator;
 
   address = 0;
   op_index = 0;
@@ -2743,6 +2754,7 @@ read_line_program (struct backtrace_state *state, struct dwarf_data *ddata,
     reset_filename = "";
   filename = reset_filename;
   lineno = 1;
+  discriminator = 0;
   while (line_buf->left > 0)
     {
       unsigned int op;
@@ -2759,8 +2771,9 @@ read_line_program (struct backtrace_state *state, struct dwarf_data *ddata,
 		      / hdr->max_ops_per_insn);
 	  op_index = (op_index + advance) % hdr->max_ops_per_insn;
 	  lineno += hdr->line_base + (int) (op % hdr->line_range);
-	  add_line (state, ddata, address, filename, lineno,
+	  add_line (state, ddata, address, filename, lineno, discriminator,
 		    line_buf->error_callback, line_buf->data, vec);
+	  discriminator = 0;
 	}
       else if (op == DW_LNS_extended_op)
 	{
@@ -2778,6 +2791,7 @@ read_line_program (struct backtrace_state *state, struct dwarf_data *ddata,
 	      op_index = 0;
 	      filename = reset_filename;
 	      lineno = 1;
+	      discriminator = 0;
 	      break;
 	    case DW_LNE_set_address:
 	      address = read_address (line_buf, hdr->addrsize);
@@ -2833,8 +2847,7 @@ read_line_program (struct backtrace_state *state, struct dwarf_data *ddata,
 	      }
 	      break;
 	    case DW_LNE_set_discriminator:
-	      /* We don't care about discriminators.  */
-	      read_uleb128 (line_buf);
+	      discriminator = (int) read_uleb128 (line_buf);
 	      break;
 	    default:
 	      if (!advance (line_buf, len - 1))
@@ -2847,8 +2860,9 @@ read_line_program (struct backtrace_state *state, struct dwarf_data *ddata,
 	  switch (op)
 	    {
 	    case DW_LNS_copy:
-	      add_line (state, ddata, address, filename, lineno,
+	      add_line (state, ddata, address, filename, lineno, discriminator,
 			line_buf->error_callback, line_buf->data, vec);
+	      discriminator = 0;
 	      break;
 	    case DW_LNS_advance_pc:
 	      {
@@ -2988,6 +3002,7 @@ read_line_info (struct backtrace_state *state, struct dwarf_data *ddata,
   ln->pc = (uintptr_t) -1;
   ln->filename = NULL;
   ln->lineno = 0;
+  ln->discriminator = 0;
   ln->idx = 0;
 
   if (!backtrace_vector_release (state, &vec.vec, error_callback, data))
@@ -3011,15 +3026,16 @@ read_line_info (struct backtrace_state *state, struct dwarf_data *ddata,
 
 static const char *read_referenced_name (struct dwarf_data *, struct unit *,
 					 uint64_t, backtrace_error_callback,
-					 void *);
+					 void *, int *);
 
-/* Read the name of a function from a DIE referenced by ATTR with VAL.  */
+/* Read the name of a function from a DIE referenced by ATTR with VAL.
+   If *DECL_LINENO is 0, set it to the declaration line found there.  */
 
 static const char *
 read_referenced_name_from_attr (struct dwarf_data *ddata, struct unit *u,
 				struct attr *attr, struct attr_val *val,
 				backtrace_error_callback error_callback,
-				void *data)
+				void *data, int *decl_lineno)
 {
   switch (attr->name)
     {
@@ -3042,12 +3058,14 @@ read_referenced_name_from_attr (struct dwarf_data *ddata, struct unit *u,
 	return NULL;
 
       uint64_t offset = val->u.uint - unit->low_offset;
-      return read_referenced_name (ddata, unit, offset, error_callback, data);
+      return read_referenced_name (ddata, unit, offset, error_callback, data,
+				   decl_lineno);
     }
 
   if (val->encoding == ATTR_VAL_UINT
       || val->encoding == ATTR_VAL_REF_UNIT)
-    return read_referenced_name (ddata, u, val->u.uint, error_callback, data);
+    return read_referenced_name (ddata, u, val->u.uint, error_callback, data,
+				 decl_lineno);
 
   if (val->encoding == ATTR_VAL_REF_ALT_INFO)
     {
@@ -3059,7 +3077,7 @@ read_referenced_name_from_attr (struct dwarf_data *ddata, struct unit *u,
 
       uint64_t offset = val->u.uint - alt_unit->low_offset;
       return read_referenced_name (ddata->altlink, alt_unit, offset,
-				   error_callback, data);
+				   error_callback, data, decl_lineno);
     }
 
   return NULL;
@@ -3067,17 +3085,22 @@ read_referenced_name_from_attr (struct dwarf_data *ddata, struct unit *u,
 
 /* Read the name of a function from a DIE referenced by a
    DW_AT_abstract_origin or DW_AT_specification tag.  OFFSET is within
-   the same compilation unit.  */
+   the same compilation unit.  If *DECL_LINENO is 0, set it to the
+   DW_AT_decl_line of the DIE, or else of the DIE that it refers to in
+   turn.  */
 
 static const char *
 read_referenced_name (struct dwarf_data *ddata, struct unit *u,
 		      uint64_t offset, backtrace_error_callback error_callback,
-		      void *data)
+		      void *data, int *decl_lineno)
 {
   struct dwarf_buf unit_buf;
   uint64_t code;
   const struct abbrev *abbrev;
   const char *ret;
+  int have_linkage_name;
+  int lineno;
+  int spec_lineno;
   size_t i;
 
   /* OFFSET is from the start of the data for this compilation unit.
@@ -3118,6 +3141,9 @@ read_referenced_name (struct dwarf_data *ddata, struct unit *u,
     return NULL;
 
   ret = NULL;
+  have_linkage_name = 0;
+  lineno = 0;
+  spec_lineno = 0;
   for (i = 0; i < abbrev->num_attrs; ++i)
     {
       struct attr_val val;
@@ -3153,7 +3179,10 @@ read_referenced_name (struct dwarf_data *ddata, struct unit *u,
 				 &val, error_callback, data, &s))
 	      return NULL;
 	    if (s != NULL)
-	      return s;
+	      {
+		ret = s;
+		have_linkage_name = 1;
+	      }
 	  }
 	  break;
 
@@ -3164,17 +3193,26 @@ read_referenced_name (struct dwarf_data *ddata, struct unit *u,
 	    const char *name;
 
 	    name = read_referenced_name_from_attr (ddata, u, &abbrev->attrs[i],
-						   &val, error_callback, data);
-	    if (name != NULL)
+						   &val, error_callback, data,
+						   &spec_lineno);
+	    if (name != NULL && !have_linkage_name)
 	      ret = name;
 	  }
 	  break;
 
+	case DW_AT_decl_line:
+	  if (val.encoding == ATTR_VAL_UINT)
+	    lineno = (int) val.u.uint;
+	  break;
+
 	default:
 	  break;
 	}
     }
 
+  if (*decl_lineno == 0)
+    *decl_lineno = lineno != 0 ? lineno : spec_lineno;
+
   return ret;
 }
 
@@ -3322,20 +3360,30 @@ read_function_entry (struct backtrace_state *state, struct dwarf_data *ddata,
 		    function->caller_lineno = val.u.uint;
 		  break;
 
+		case DW_AT_GNU_discriminator:
+		  if (val.encoding == ATTR_VAL_UINT)
+		    function->caller_discriminator = val.u.uint;
+		  break;
+
+		case DW_AT_decl_line:
+		  if (val.encoding == ATTR_VAL_UINT)
+		    function->decl_lineno = val.u.uint;
+		  break;
+
 		case DW_AT_abstract_origin:
 		case DW_AT_specification:
 		  /* Second name preference: override DW_AT_name, don't override
-		     DW_AT_linkage_name.  */
-		  if (have_linkage_name)
-		    break;
+		     DW_AT_linkage_name.  The referenced DIE also gives the
+		     declaration line, unless this one has its own.  */
 		  {
 		    const char *name;
 
 		    name
 		      = read_referenced_name_from_attr (ddata, u,
 							&abbrev->attrs[i], &val,
-							error_callback, data);
-		    if (name != NULL)
+							error_callback, data,
+							&function->decl_lineno);
+		    if (name != NULL && !have_linkage_name)
 		      function->name = name;
 		  }
 		  break;
@@ -3556,14 +3604,35 @@ read_function_info (struct backtrace_state *state, struct dwarf_data *ddata,
   *ret_addrs_count = addrs_count;
 }
 
+/* Report the frame of FUNCTION at FILENAME and LINENO with
+   DISCRIMINATOR, where FUNCTION is declared at DECL_LINENO.  If
+   DETAIL_CALLBACK is not NULL, call it with DATA and all of them;
+   otherwise call CALLBACK with DATA and those it takes.  Returns
+   whatever the callback returns.  */
+
+static int
+dwarf_report (backtrace_full_callback callback,
+	      backtrace_detail_callback detail_callback, void *data,
+	      uintptr_t pc, const char *filename, int lineno,
+	      int discriminator, const char *function, int decl_lineno)
+{
+  if (detail_callback != NULL)
+    return detail_callback (data, pc, filename, lineno, discriminator,
+			    function, decl_lineno);
+  return callback (data, pc, filename, lineno, function);
+}
+
 /* See if PC is inlined in FUNCTION.  If it is, print out the inlined
-   information, and update FILENAME and LINENO for the caller.
-   Returns whatever CALLBACK returns, or 0 to keep going.  */
+   information, and update FILENAME, LINENO and DISCRIMINATOR for the
+   caller.  Returns whatever CALLBACK or DETAIL_CALLBACK returns, or 0
+   to keep going.  */
 
 static int
 report_inlined_functions (uintptr_t pc, struct function *function,
-			  backtrace_full_callback callback, void *data,
-			  const char **filename, int *lineno)
+			  backtrace_full_callback callback,
+			  backtrace_detail_callback detail_callback,
+			  void *data, const char **filename, int *lineno,
+			  int *discriminator)
 {
   struct function_addrs *p;
   struct function_addrs *match;
@@ -3615,32 +3684,116 @@ report_inlined_functions (uintptr_t pc, struct function *function,
   inlined = match->function;
 
   /* Report any calls inlined into this one.  */
-  ret = report_inlined_functions (pc, inlined, callback, data,
-				  filename, lineno);
+  ret = report_inlined_functions (pc, inlined, callback, detail_callback,
+				  data, filename, lineno, discriminator);
   if (ret != 0)
     return ret;
 
   /* Report this inlined call.  */
-  ret = callback (data, pc, *filename, *lineno, inlined->name);
+  ret = dwarf_report (callback, detail_callback, data, pc, *filename,
+		      *lineno, *discriminator, inlined->name,
+		      inlined->decl_lineno);
   if (ret != 0)
     return ret;
 
   /* Our caller will report the caller of the inlined function; tell
-     it the appropriate filename and line number.  */
+     it the appropriate filename, line number and discriminator.  */
   *filename = inlined->caller_filename;
   *lineno = inlined->caller_lineno;
+  *discriminator = inlined->caller_discriminator;
 
   return 0;
 }
 
+/* Read the line and function information for unit U of DDATA if that
+   has not been done yet, and return its lines, which are
+   (struct line *) -1 if there is no useful line information.  Set
+   *NEW_DATA to 1 if this call read the information, 0 otherwise.  */
+
+static struct line *
+read_unit_info (struct backtrace_state *state, struct dwarf_data *ddata,
+		struct unit *u, backtrace_error_callback error_callback,
+		void *data, int *new_data)
+{
+  struct line *lines;
+
+  /* We need the lines, lines_count, function_addrs,
+     function_addrs_count fields of u.  If they are not set, we need
+     to set them.  When running in threaded mode, we need to allow for
+     the possibility that some other thread is setting them
+     simultaneously.  */
+
+  lines = u->lines;
+  if (state->threaded)
+    lines = backtrace_atomic_load_pointer (&u->lines);
+
+  *new_data = 0;
+  if (lines == NULL)
+    {
+      struct function_addrs *function_addrs;
+      size_t function_addrs_count;
+      struct line_header lhdr;
+      size_t count;
+
+      /* We have never read the line information for this unit.  Read
+	 it now.  */
+
+      function_addrs = NULL;
+      function_addrs_count = 0;
+      if (read_line_info (state, ddata, error_callback, data, u, &lhdr,
+			  &lines, &count))
+	{
+	  struct function_vector *pfvec;
+
+	  /* If not threaded, reuse DDATA->FVEC for better memory
+	     consumption.  */
+	  if (state->threaded)
+	    pfvec = NULL;
+	  else
+	    pfvec = &ddata->fvec;
+	  read_function_info (state, ddata, &lhdr, error_callback, data,
+			      u, pfvec, &function_addrs,
+			      &function_addrs_count);
+	  free_line_header (state, &lhdr, error_callback, data);
+	  *new_data = 1;
+	}
+
+      /* Atomically store the information we just read into the unit.
+	 If another thread is simultaneously writing, it presumably
+	 read the same information, and we don't care which one we
+	 wind up with; we just leak the other one.  We do have to
+	 write the lines field last, so that the acquire-loads above
+	 ensure that the other fields are set.  */
+
+      if (!state->threaded)
+	{
+	  u->lines_count = count;
+	  u->function_addrs = function_addrs;
+	  u->function_addrs_count = function_addrs_count;
+	  u->lines = lines;
+	}
+      else
+	{
+	  backtrace_atomic_store_size_t (&u->lines_count, count);
+	  backtrace_atomic_store_pointer (&u->function_addrs, function_addrs);
+	  backtrace_atomic_store_size_t (&u->function_addrs_count,
+					 function_addrs_count);
+	  backtrace_atomic_store_pointer (&u->lines, lines);
+	}
+    }
+
+  return lines;
+}
+
 /* Look for a PC in the DWARF mapping for one module.  On success,
-   call CALLBACK and return whatever it returns.  On error, call
-   ERROR_CALLBACK and return 0.  Sets *FOUND to 1 if the PC is found,
-   0 if not.  */
+   call DETAIL_CALLBACK if it is not NULL, CALLBACK otherwise, and
+   return whatever it returns.  On error, call ERROR_CALLBACK and return
+   0.  Sets *FOUND to 1 if the PC is found, 0 if not.  */
 
 static int
 dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
 		 uintptr_t pc, backtrace_full_callback callback,
+		 backtrace_detail_callback detail_callback,
 		 backtrace_error_callback error_callback, void *data,
 		 int *found)
 {
@@ -3655,6 +3808,7 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
   struct function *function;
   const char *filename;
   int lineno;
+  int discriminator;
   int ret;
 
   *found = 1;
@@ -3700,12 +3854,6 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
       return 0;
     }
 
-  /* We need the lines, lines_count, function_addrs,
-     function_addrs_count fields of u.  If they are not set, we need
-     to set them.  When running in threaded mode, we need to allow for
-     the possibility that some other thread is setting them
-     simultaneously.  */
-
   u = entry->u;
   lines = u->lines;
 
@@ -3728,63 +3876,7 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
       lines = u->lines;
     }
 
-  if (state->threaded)
-    lines = backtrace_atomic_load_pointer (&u->lines);
-
-  new_data = 0;
-  if (lines == NULL)
-    {
-      struct function_addrs *function_addrs;
-      size_t function_addrs_count;
-      struct line_header lhdr;
-      size_t count;
-
-      /* We have never read the line information for this unit.  Read
-	 it now.  */
-
-      function_addrs = NULL;
-      function_addrs_count = 0;
-      if (read_line_info (state, ddata, error_callback, data, entry->u, &lhdr,
-			  &lines, &count))
-	{
-	  struct function_vector *pfvec;
-
-	  /* If not threaded, reuse DDATA->FVEC for better memory
-	     consumption.  */
-	  if (state->threaded)
-	    pfvec = NULL;
-	  else
-	    pfvec = &ddata->fvec;
-	  read_function_info (state, ddata, &lhdr, error_callback, data,
-			      entry->u, pfvec, &function_addrs,
-			      &function_addrs_count);
-	  free_line_header (state, &lhdr, error_callback, data);
-	  new_data = 1;
-	}
-
-      /* Atomically store the information we just read into the unit.
-	 If another thread is simultaneously writing, it presumably
-	 read the same information, and we don't care which one we
-	 wind up with; we just leak the other one.  We do have to
-	 write the lines field last, so that the acquire-loads above
-	 ensure that the other fields are set.  */
-
-      if (!state->threaded)
-	{
-	  u->lines_count = count;
-	  u->function_addrs = function_addrs;
-	  u->function_addrs_count = function_addrs_count;
-	  u->lines = lines;
-	}
-      else
-	{
-	  backtrace_atomic_store_size_t (&u->lines_count, count);
-	  backtrace_atomic_store_pointer (&u->function_addrs, function_addrs);
-	  backtrace_atomic_store_size_t (&u->function_addrs_count,
-					 function_addrs_count);
-	  backtrace_atomic_store_pointer (&u->lines, lines);
-	}
-    }
+  lines = read_unit_info (state, ddata, u, error_callback, data, &new_data);
 
   /* Now all fields of U have been initialized.  */
 
@@ -3794,9 +3886,10 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
 	 try again to see if there is a better compilation unit for
 	 this PC.  */
       if (new_data)
-	return dwarf_lookup_pc (state, ddata, pc, callback, error_callback,
-				data, found);
-      return callback (data, pc, NULL, 0, NULL);
+	return dwarf_lookup_pc (state, ddata, pc, callback, detail_callback,
+				error_callback, data, found);
+      return dwarf_report (callback, detail_callback, data, pc, NULL, 0, 0,
+			   NULL, 0);
     }
 
   /* Search for PC within this unit.  */
@@ -3843,13 +3936,15 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
 	  entry->u->abs_filename = filename;
 	}
 
-      return callback (data, pc, entry->u->abs_filename, 0, NULL);
+      return dwarf_report (callback, detail_callback, data, pc,
+			   entry->u->abs_filename, 0, 0, NULL, 0);
     }
 
   /* Search for function name within this unit.  */
 
   if (entry->u->function_addrs_count == 0)
-    return callback (data, pc, ln->filename, ln->lineno, NULL);
+    return dwarf_report (callback, detail_callback, data, pc, ln->filename,
+			 ln->lineno, ln->discriminator, NULL, 0);
 
   p = ((struct function_addrs *)
        bsearch (&pc, entry->u->function_addrs,
@@ -3857,7 +3952,8 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
 		sizeof (struct function_addrs),
 		function_addrs_search));
   if (p == NULL)
-    return callback (data, pc, ln->filename, ln->lineno, NULL);
+    return dwarf_report (callback, detail_callback, data, pc, ln->filename,
+			 ln->lineno, ln->discriminator, NULL, 0);
 
   /* Here pc >= p->low && pc < (p + 1)->low.  The function_addrs are
      sorted by low, so if pc > p->low we are at the end of a range of
@@ -3881,29 +3977,34 @@ dwarf_lookup_pc (struct backtrace_state *state, struct dwarf_data *ddata,
       --p;
     }
   if (fmatch == NULL)
-    return callback (data, pc, ln->filename, ln->lineno, NULL);
+    return dwarf_report (callback, detail_callback, data, pc, ln->filename,
+			 ln->lineno, ln->discriminator, NULL, 0);
 
   function = fmatch->function;
 
   filename = ln->filename;
   lineno = ln->lineno;
+  discriminator = ln->discriminator;
 
-  ret = report_inlined_functions (pc, function, callback, data,
-				  &filename, &lineno);
+  ret = report_inlined_functions (pc, function, callback, detail_callback,
+				  data, &filename, &lineno, &discriminator);
   if (ret != 0)
     return ret;
 
-  return callback (data, pc, filename, lineno, function->name);
+  return dwarf_report (callback, detail_callback, data, pc, filename, lineno,
+		       discriminator, function->name, function->decl_lineno);
 }
 
 
 /* Return the file/line information for a PC using the DWARF mapping
-   we built earlier.  */
+   we built earlier, through DETAIL_CALLBACK if it is not NULL and
+   through CALLBACK otherwise.  */
 
 static int
-dwarf_fileline (struct backtrace_state *state, uintptr_t pc,
-		backtrace_full_callback callback,
-		backtrace_error_callback error_callback, void *data)
+dwarf_fileline_1 (struct backtrace_state *state, uintptr_t pc,
+		  backtrace_full_callback callback,
+		  backtrace_detail_callback detail_callback,
+		  backtrace_error_callback error_callback, void *data)
 {
   struct dwarf_data *ddata;
   int found;
@@ -3915,8 +4016,8 @@ dwarf_fileline (struct backtrace_state *state, uintptr_t pc,
 	   ddata != NULL;
 	   ddata = ddata->next)
 	{
-	  ret = dwarf_lookup_pc (state, ddata, pc, callback, error_callback,
-				 data, &found);
+	  ret = dwarf_lookup_pc (state, ddata, pc, callback, detail_callback,
+				 error_callback, data, &found);
 	  if (ret != 0 || found)
 	    return ret;
 	}
@@ -3932,8 +4033,8 @@ dwarf_fileline (struct backtrace_state *state, uintptr_t pc,
 	  if (ddata == NULL)
 	    break;
 
-	  ret = dwarf_lookup_pc (state, ddata, pc, callback, error_callback,
-				 data, &found);
+	  ret = dwarf_lookup_pc (state, ddata, pc, callback, detail_callback,
+				 error_callback, data, &found);
 	  if (ret != 0 || found)
 	    return ret;
 
@@ -3943,7 +4044,216 @@ dwarf_fileline (struct backtrace_state *state, uintptr_t pc,
 
   /* FIXME: See if any libraries have been dlopen'ed.  */
 
-  return callback (data, pc, NULL, 0, NULL);
+  return dwarf_report (callback, detail_callback, data, pc, NULL, 0, 0, NULL,
+		       0);
+}
+
+/* Return the file/line information for a PC using the DWARF mapping
+   we built earlier.  */
+
+static int
+dwarf_fileline (struct backtrace_state *state, uintptr_t pc,
+		backtrace_full_callback callback,
+		backtrace_error_callback error_callback, void *data)
+{
+  return dwarf_fileline_1 (state, pc, callback, NULL, error_callback, data);
+}
+
+/* If the file/line information of STATE comes from DWARF, look up PC
+   as dwarf_fileline does but call the backtrace_detail_callback
+   CALLBACK, store what it returns in *RET and return 1.  Otherwise
+   return 0.  */
+
+int
+backtrace_dwarf_fileline_detail (struct backtrace_state *state,
+				 uintptr_t pc,
+				 backtrace_detail_callback callback,
+				 backtrace_error_callback error_callback,
+				 void *data, int *ret)
+{
+  fileline fileline_fn;
+
+  if (!state->threaded)
+    fileline_fn = state->fileline_fn;
+  else
+    fileline_fn = backtrace_atomic_load_pointer (&state->fileline_fn);
+  if (fileline_fn != dwarf_fileline)
+    return 0;
+
+  *ret = dwarf_fileline_1 (state, pc, NULL, callback, error_callback, data);
+  return 1;
+}
+
+/* Append PC - BASE_ADDRESS to the vector of addresses PCS.  Return 1
+   on success, 0 on failure.  */
+
+static int
+add_boundary (struct backtrace_state *state, uintptr_t pc,
+	      uintptr_t base_address, backtrace_error_callback error_callback,
+	      void *data, struct backtrace_vector *pcs)
+{
+  uintptr_t *p;
+
+  p = ((uintptr_t *)
+       backtrace_vector_grow (state, sizeof (uintptr_t), error_callback,
+			      data, pcs));
+  if (p == NULL)
+    return 0;
+  *p = pc - base_address;
+  return 1;
+}
+
+/* Append to PCS the starts and ends of those of the COUNT function
+   ranges in ADDRS that overlap [LOW, HIGH), and of the ranges of the
+   functions inlined into them.  A function with several ranges appears
+   once for each of them, so only the inlined ranges within the range
+   being walked are visited.  Return 1 on success, 0 on failure.  */
+
+static int
+add_function_boundaries (struct backtrace_state *state,
+			 const struct function_addrs *addrs, size_t count,
+			 uintptr_t low, uintptr_t high,
+			 uintptr_t base_address,
+			 backtrace_error_callback error_callback, void *data,
+			 struct backtrace_vector *pcs)
+{
+  size_t i;
+
+  for (i = 0; i < count; ++i)
+    {
+      const struct function *function;
+
+      /* ADDRS is sorted by low address.  */
+      if (addrs[i].low >= high)
+	break;
+      if (addrs[i].high <= low)
+	continue;
+
+      if (!add_boundary (state, addrs[i].low, base_address, error_callback,
+			 data, pcs)
+	  || !add_boundary (state, addrs[i].high, base_address,
+			    error_callback, data, pcs))
+	return 0;
+
+      function = addrs[i].function;
+      if (!add_function_boundaries (state, function->function_addrs,
+				    function->function_addrs_count,
+				    addrs[i].low, addrs[i].high,
+				    base_address, error_callback, data, pcs))
+	return 0;
+    }
+
+  return 1;
+}
+
+/* Compare two addresses for qsort.  */
+
+static int
+uintptr_compare (const void *v1, const void *v2)
+{
+  uintptr_t a1 = *(const uintptr_t *) v1;
+  uintptr_t a2 = *(const uintptr_t *) v2;
+
+  if (a1 < a2)
+    return -1;
+  else if (a1 > a2)
+    return 1;
+  else
+    return 0;
+}
+
+/* Collect the addresses at which the information that dwarf_fileline
+   reports for the first module of STATE may change: the bounds of the
+   address ranges of its units, of its functions and of the functions
+   inlined into them, and the addresses in its line tables.  Between two
+   such addresses the information is the same.  This reads the line and
+   function information of every unit of the module.  Store in the
+   vector VEC, which must be empty, a sorted array of *COUNT distinct
+   addresses, relative to *BASE_ADDRESS, the base address of the
+   module.  Return 1 on success, 0 on failure.  */
+
+int
+backtrace_dwarf_boundaries (struct backtrace_state *state,
+			    backtrace_error_callback error_callback,
+			    void *data, struct backtrace_vector *vec,
+			    size_t *count, uintptr_t *base_address)
+{
+  fileline fileline_fn;
+  struct dwarf_data *ddata;
+  uintptr_t *p;
+  size_t n;
+  size_t i;
+  size_t j;
+
+  if (!state->threaded)
+    {
+      fileline_fn = state->fileline_fn;
+      ddata = (struct dwarf_data *) state->fileline_data;
+    }
+  else
+    {
+      fileline_fn = backtrace_atomic_load_pointer (&state->fileline_fn);
+      ddata = ((struct dwarf_data *)
+	       backtrace_atomic_load_pointer (&state->fileline_data));
+    }
+  if (fileline_fn != dwarf_fileline || ddata == NULL)
+    {
+      error_callback (data, "no DWARF debug info", -1);
+      return 0;
+    }
+
+  for (i = 0; i < ddata->addrs_count; ++i)
+    {
+      if (!add_boundary (state, ddata->addrs[i].low, ddata->base_address,
+			 error_callback, data, vec)
+	  || !add_boundary (state, ddata->addrs[i].high, ddata->base_address,
+			    error_callback, data, vec))
+	goto fail;
+    }
+
+  for (i = 0; i < ddata->units_count; ++i)
+    {
+      struct unit *u;
+      struct line *lines;
+      int new_data;
+
+      u = ddata->units[i];
+      lines = read_unit_info (state, ddata, u, error_callback, data,
+			      &new_data);
+      if (lines == (struct line *) (uintptr_t) -1)
+	continue;
+
+      for (j = 0; j < u->lines_count; ++j)
+	if (!add_boundary (state, lines[j].pc, ddata->base_address,
+			   error_callback, data, vec))
+	  goto fail;
+
+      if (!add_function_boundaries (state, u->function_addrs,
+				    u->function_addrs_count, 0,
+				    (uintptr_t) -1, ddata->base_address,
+				    error_callback, data, vec))
+	goto fail;
+    }
+
+  p = (uintptr_t *) vec->base;
+  n = vec->size / sizeof (uintptr_t);
+  backtrace_qsort (p, n, sizeof (uintptr_t), uintptr_compare);
+
+  /* Remove duplicates.  */
+  j = 0;
+  for (i = 0; i < n; ++i)
+    if (j == 0 || p[i] != p[j - 1])
+      p[j++] = p[i];
+
+  vec->size = j * sizeof (uintptr_t);
+  vec->alc += (n - j) * sizeof (uintptr_t);
+  *count = j;
+  *base_address = ddata->base_address;
+  return 1;
+
+ fail:
+  backtrace_vector_free (state, vec, error_callback, data);
+  return 0;
 }
 
 /* Initialize our data structures from the DWARF debug info for a
@@ -37,6 +37,7 @@ POSSIBILITY OF SUCH DAMAGE.  */
 #include <errno.h>
 #include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #if defined (HAVE_KERN_PROC_ARGS) || defined (HAVE_KERN_PROC)
@@ -66,6 +67,14 @@ POSSIBILITY OF SUCH DAMAGE.  */
 #define getexecname() NULL
 #endif
 
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
 #if !defined (HAVE_KERN_PROC_ARGS) && !defined (HAVE_KERN_PROC)
 
 #define sysctl_exec_name1(state, error_callback, data) NULL
@@ -208,40 +217,18 @@ windows_get_executable_path (char *buf, backtrace_error_callback error_callback,
 
 #endif /* !defined (HAVE_WINDOWS_H) */
 
-/* Initialize the fileline information from the executable.  Returns 1
-   on success, 0 on failure.  */
+/* Open the executable.  Store its name in *FILENAME, using BUF, which
+   must have room for FILENAME_BUF_SIZE bytes, if needed.  Returns the
+   descriptor, or -1 after calling ERROR_CALLBACK on failure.  */
 
 static int
-fileline_initialize (struct backtrace_state *state,
-		     backtrace_error_callback error_callback, void *data)
+fileline_open_executable (struct backtrace_state *state,
+			  backtrace_error_callback error_callback,
+			  void *data, char *buf, const char **filename)
 {
-  int failed;
-  fileline fileline_fn;
   int pass;
   int called_error_callback;
   int descriptor;
-  const char *filename;
-  char buf[FILENAME_BUF_SIZE];
-
-  if (!state->threaded)
-    failed = state->fileline_initialization_failed;
-  else
-    failed = backtrace_atomic_load_int (&state->fileline_initialization_failed);
-
-  if (failed)
-    {
-      error_callback (data, "failed to read executable information", -1);
-      return 0;
-    }
-
-  if (!state->threaded)
-    fileline_fn = state->fileline_fn;
-  else
-    fileline_fn = backtrace_atomic_load_pointer (&state->fileline_fn);
-  if (fileline_fn != NULL)
-    return 1;
-
-  /* We have not initialized the information.  Do it now.  */
 
   descriptor = -1;
   called_error_callback = 0;
@@ -252,47 +239,47 @@ fileline_initialize (struct backtrace_state *state,
       switch (pass)
 	{
 	case 0:
-	  filename = state->filename;
+	  *filename = state->filename;
 	  break;
 	case 1:
-	  filename = getexecname ();
+	  *filename = getexecname ();
 	  break;
 	case 2:
 	  /* Test this before /proc/self/exe, as the latter exists but points
 	     to the wine binary (and thus doesn't work).  */
-	  filename = windows_executable_filename ();
+	  *filename = windows_executable_filename ();
 	  break;
 	case 3:
-	  filename = "/proc/self/exe";
+	  *filename = "/proc/self/exe";
 	  break;
 	case 4:
-	  filename = "/proc/curproc/file";
+	  *filename = "/proc/curproc/file";
 	  break;
 	case 5:
-	  snprintf (buf, sizeof (buf), "/proc/%ld/object/a.out",
+	  snprintf (buf, FILENAME_BUF_SIZE, "/proc/%ld/object/a.out",
 		    (long) getpid ());
-	  filename = buf;
+	  *filename = buf;
 	  break;
 	case 6:
-	  filename = sysctl_exec_name1 (state, error_callback, data);
+	  *filename = sysctl_exec_name1 (state, error_callback, data);
 	  break;
 	case 7:
-	  filename = sysctl_exec_name2 (state, error_callback, data);
+	  *filename = sysctl_exec_name2 (state, error_callback, data);
 	  break;
 	case 8:
-	  filename = macho_get_executable_path (state, error_callback, data);
+	  *filename = macho_get_executable_path (state, error_callback, data);
 	  break;
 	case 9:
-	  filename = windows_get_executable_path (buf, error_callback, data);
+	  *filename = windows_get_executable_path (buf, error_callback, data);
 	  break;
 	default:
 	  abort ();
 	}
 
-      if (filename == NULL)
+      if (*filename == NULL)
 	continue;
 
-      descriptor = backtrace_open (filename, error_callback, data,
+      descriptor = backtrace_open (*filename, error_callback, data,
 				   &does_not_exist);
       if (descriptor < 0 && !does_not_exist)
 	{
@@ -303,20 +290,57 @@ fileline_initialize (struct backtrace_state *state,
 	break;
     }
 
-  if (descriptor < 0)
+  if (descriptor < 0 && !called_error_callback)
     {
-      if (!called_error_callback)
-	{
-	  if (state->filename != NULL)
-	    error_callback (data, state->filename, ENOENT);
-	  else
-	    error_callback (data,
-			    "libbacktrace could not find executable to open",
-			    0);
-	}
-      failed = 1;
+      if (state->filename != NULL)
+	error_callback (data, state->filename, ENOENT);
+      else
+	error_callback (data,
+			"libbacktrace could not find executable to open",
+			0);
+    }
+
+  return descriptor;
+}
+
+/* Initialize the fileline information from the executable.  Returns 1
+   on success, 0 on failure.  */
+
+static int
+fileline_initialize (struct backtrace_state *state,
+		     backtrace_error_callback error_callback, void *data)
+{
+  int failed;
+  fileline fileline_fn;
+  int descriptor;
+  const char *filename;
+  char buf[FILENAME_BUF_SIZE];
+
+  if (!state->threaded)
+    failed = state->fileline_initialization_failed;
+  else
+    failed = backtrace_atomic_load_int (&state->fileline_initialization_failed);
+
+  if (failed)
+    {
+      error_callback (data, "failed to read executable information", -1);
+      return 0;
     }
 
+  if (!state->threaded)
+    fileline_fn = state->fileline_fn;
+  else
+    fileline_fn = backtrace_atomic_load_pointer (&state->fileline_fn);
+  if (fileline_fn != NULL)
+    return 1;
+
+  /* We have not initialized the information.  Do it now.  */
+
+  descriptor = fileline_open_executable (state, error_callback, data, buf,
+					 &filename);
+  if (descriptor < 0)
+    failed = 1;
+
   if (!failed)
     {
       if (!backtrace_initialize (state, filename, descriptor, error_callback,
@@ -346,6 +370,661 @@ fileline_initialize (struct backtrace_state *state,
   return 1;
 }
 
+/* The index written by backtrace_write_index describes the file/line
+   information of one module as a sorted array of address ranges, each of
+   which points to the frames that backtrace_pcinfo reports for all the
+   addresses in the range, innermost first.  The file is the header
+   below, followed by the ranges, the frames, and the strings that the
+   frames refer to.  Numbers are in the byte order of the host that wrote
+   the file, and the index is only used on a host with the same byte
+   order.  The header records the size and modification time of the
+   executable, and the index is only used if they still match.  */
+
+#define PCINDEX_MAGIC "BTPCIDX1"
+#define PCINDEX_VERSION 2
+#define PCINDEX_BYTE_ORDER 0x01020304
+#define PCINDEX_NO_STRING ((uint32_t) -1)
+
+struct pcindex_header
+{
+  /* PCINDEX_MAGIC, without the trailing NUL.  */
+  char magic[8];
+  /* PCINDEX_VERSION.  */
+  uint32_t version;
+  /* PCINDEX_BYTE_ORDER.  */
+  uint32_t byte_order;
+  /* The base address of the module when the index was written.  */
+  uint64_t base_address;
+  /* The size and modification time of the executable.  */
+  uint64_t executable_size;
+  int64_t executable_mtime;
+  /* The number of ranges, frames, and bytes of strings.  */
+  uint64_t ranges_count;
+  uint64_t frames_count;
+  uint64_t strings_size;
+};
+
+/* The addresses from LOW, relative to the base address of the module,
+   up to the LOW of the next range.  NFRAMES is 0 for the last range,
+   which marks the end of the module.  */
+
+struct pcindex_range
+{
+  uint64_t low;
+  uint32_t frame;
+  uint32_t nframes;
+};
+
+/* One frame of a range.  FILENAME and FUNCTION are offsets in the
+   strings, or PCINDEX_NO_STRING.  */
+
+struct pcindex_frame
+{
+  uint32_t filename;
+  uint32_t function;
+  int32_t lineno;
+};
+
+/* An index loaded by backtrace_load_index.  */
+
+struct backtrace_pcindex
+{
+  /* The mapped file.  */
+  struct backtrace_view view;
+  /* The base address of the module in this process.  */
+  uintptr_t base_address;
+  const struct pcindex_range *ranges;
+  size_t ranges_count;
+  const struct pcindex_frame *frames;
+  size_t frames_count;
+  const char *strings;
+  size_t strings_size;
+};
+
+/* Return the string at OFFSET in the strings of INDEX, or NULL.  */
+
+static const char *
+pcindex_string (const struct backtrace_pcindex *index, uint32_t offset)
+{
+  if (offset == PCINDEX_NO_STRING || offset >= index->strings_size)
+    return NULL;
+  return index->strings + offset;
+}
+
+/* Look up PC in INDEX.  If INDEX covers PC, set *FOUND to 1, call
+   CALLBACK for each frame and return the first non-zero value it
+   returns, or 0.  Otherwise set *FOUND to 0 and return 0.  */
+
+static int
+pcindex_lookup (const struct backtrace_pcindex *index, uintptr_t pc,
+		backtrace_full_callback callback, void *data, int *found)
+{
+  uint64_t rel;
+  size_t lo;
+  size_t hi;
+  const struct pcindex_range *range;
+  const struct pcindex_frame *frame;
+  size_t i;
+
+  *found = 0;
+  if (pc < index->base_address)
+    return 0;
+  rel = pc - index->base_address;
+
+  /* Find the last range that starts at or before REL.  */
+  lo = 0;
+  hi = index->ranges_count;
+  while (lo < hi)
+    {
+      size_t mid;
+
+      mid = lo + (hi - lo) / 2;
+      if (index->ranges[mid].low <= rel)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    return 0;
+
+  range = &index->ranges[lo - 1];
+  if (range->nframes == 0
+      || range->frame > index->frames_count
+      || range->nframes > index->frames_count - range->frame)
+    return 0;
+
+  *found = 1;
+  frame = &index->frames[range->frame];
+  for (i = 0; i < range->nframes; ++i, ++frame)
+    {
+      int ret;
+
+      ret = callback (data, pc, pcindex_string (index, frame->filename),
+		      frame->lineno, pcindex_string (index, frame->function));
+      if (ret != 0)
+	return ret;
+    }
+  return 0;
+}
+
+/* Return the index loaded for STATE, or NULL.  */
+
+static struct backtrace_pcindex *
+pcindex_get (struct backtrace_state *state)
+{
+  if (!state->threaded)
+    return (struct backtrace_pcindex *) state->pcindex;
+  return ((struct backtrace_pcindex *)
+	  backtrace_atomic_load_pointer (&state->pcindex));
+}
+
+/* Get the size and modification time of the executable of STATE.
+   Returns 1 on success, 0 on failure.  */
+
+static int
+pcindex_executable_stat (struct backtrace_state *state,
+			 backtrace_error_callback error_callback, void *data,
+			 uint64_t *size, int64_t *mtime)
+{
+  char buf[FILENAME_BUF_SIZE];
+  const char *filename;
+  int descriptor;
+  struct stat st;
+
+  descriptor = fileline_open_executable (state, error_callback, data, buf,
+					 &filename);
+  if (descriptor < 0)
+    return 0;
+  if (fstat (descriptor, &st) < 0)
+    {
+      error_callback (data, "fstat", errno);
+      backtrace_close (descriptor, error_callback, data);
+      return 0;
+    }
+  backtrace_close (descriptor, error_callback, data);
+  *size = (uint64_t) st.st_size;
+  *mtime = (int64_t) st.st_mtime;
+  return 1;
+}
+
+/* Free INDEX, which is no longer used.  */
+
+static void
+pcindex_free (struct backtrace_state *state, struct backtrace_pcindex *index,
+	      backtrace_error_callback error_callback, void *data)
+{
+  backtrace_release_view (state, &index->view, error_callback, data);
+  backtrace_free (state, index, sizeof *index, error_callback, data);
+}
+
+/* Load an index written by backtrace_write_index.  */
+
+int
+backtrace_load_index (struct backtrace_state *state, const char *filename,
+		      uintptr_t base_address,
+		      backtrace_error_callback error_callback, void *data)
+{
+  int descriptor;
+  struct stat st;
+  struct backtrace_view view;
+  const struct pcindex_header *header;
+  const char *p;
+  size_t left;
+  uint64_t executable_size;
+  int64_t executable_mtime;
+  struct backtrace_pcindex *index;
+
+  if (!pcindex_executable_stat (state, error_callback, data,
+				&executable_size, &executable_mtime))
+    return 0;
+
+  descriptor = backtrace_open (filename, error_callback, data, NULL);
+  if (descriptor < 0)
+    return 0;
+
+  if (fstat (descriptor, &st) < 0)
+    {
+      error_callback (data, "fstat", errno);
+      backtrace_close (descriptor, error_callback, data);
+      return 0;
+    }
+  if ((uint64_t) st.st_size < sizeof (struct pcindex_header)
+      || (uint64_t) st.st_size != (uint64_t) (size_t) st.st_size)
+    {
+      error_callback (data, "invalid backtrace index", 0);
+      backtrace_close (descriptor, error_callback, data);
+      return 0;
+    }
+
+  if (!backtrace_get_view (state, descriptor, 0, (uint64_t) st.st_size,
+			   error_callback, data, &view))
+    {
+      backtrace_close (descriptor, error_callback, data);
+      return 0;
+    }
+  backtrace_close (descriptor, error_callback, data);
+
+  /* Check the header and the sizes; the contents of the ranges and
+     frames are checked as they are used.  */
+  header = (const struct pcindex_header *) view.data;
+  p = (const char *) view.data + sizeof (struct pcindex_header);
+  left = (size_t) st.st_size - sizeof (struct pcindex_header);
+  if (memcmp (header->magic, PCINDEX_MAGIC, sizeof header->magic) != 0
+      || header->version != PCINDEX_VERSION
+      || header->byte_order != PCINDEX_BYTE_ORDER
+      || header->ranges_count > left / sizeof (struct pcindex_range)
+      || (header->frames_count
+	  > ((left - header->ranges_count * sizeof (struct pcindex_range))
+	     / sizeof (struct pcindex_frame)))
+      || (header->strings_size
+	  != (left - header->ranges_count * sizeof (struct pcindex_range)
+	      - header->frames_count * sizeof (struct pcindex_frame)))
+      || (header->strings_size > 0 && p[left - 1] != '\0'))
+    {
+      error_callback (data, "invalid backtrace index", 0);
+      backtrace_release_view (state, &view, error_callback, data);
+      return 0;
+    }
+  if (header->executable_size != executable_size
+      || header->executable_mtime != executable_mtime)
+    {
+      error_callback (data, "backtrace index does not match the executable",
+		      0);
+      backtrace_release_view (state, &view, error_callback, data);
+      return 0;
+    }
+
+  index = ((struct backtrace_pcindex *)
+	   backtrace_alloc (state, sizeof *index, error_callback, data));
+  if (index == NULL)
+    {
+      backtrace_release_view (state, &view, error_callback, data);
+      return 0;
+    }
+
+  index->view = view;
+  index->base_address = (base_address == (uintptr_t) -1
+			 ? (uintptr_t) header->base_address
+			 : base_address);
+  index->ranges = (const struct pcindex_range *) p;
+  index->ranges_count = header->ranges_count;
+  p += header->ranges_count * sizeof (struct pcindex_range);
+  index->frames = (const struct pcindex_frame *) p;
+  index->frames_count = header->frames_count;
+  p += header->frames_count * sizeof (struct pcindex_frame);
+  index->strings = p;
+  index->strings_size = header->strings_size;
+
+  if (!state->threaded)
+    {
+      if (state->pcindex != NULL)
+	pcindex_free (state, (struct backtrace_pcindex *) state->pcindex,
+		      error_callback, data);
+      state->pcindex = index;
+    }
+  else if (!__sync_bool_compare_and_swap (&state->pcindex, NULL, index))
+    {
+      /* Another thread may be using the index that is loaded, so it
+	 cannot be replaced.  */
+      error_callback (data, "backtrace index already loaded", 0);
+      pcindex_free (state, index, error_callback, data);
+      return 0;
+    }
+
+  return 1;
+}
+
+/* A frame collected by backtrace_write_index.  */
+
+struct pcindex_build_frame
+{
+  const char *filename;
+  const char *function;
+  int lineno;
+};
+
+/* The data passed to pcindex_collect.  */
+
+struct pcindex_collect_data
+{
+  struct backtrace_state *state;
+  backtrace_error_callback error_callback;
+  void *data;
+  /* The frames collected so far, a vector of struct
+     pcindex_build_frame.  */
+  struct backtrace_vector frames;
+  int failed;
+};
+
+/* A backtrace_full_callback that appends a frame to the frames of a
+   struct pcindex_collect_data.  */
+
+static int
+pcindex_collect (void *vdata, uintptr_t pc ATTRIBUTE_UNUSED,
+		 const char *filename, int lineno, const char *function)
+{
+  struct pcindex_collect_data *cdata;
+  struct pcindex_build_frame *frame;
+
+  cdata = (struct pcindex_collect_data *) vdata;
+  frame = ((struct pcindex_build_frame *)
+	   backtrace_vector_grow (cdata->state,
+				  sizeof (struct pcindex_build_frame),
+				  cdata->error_callback, cdata->data,
+				  &cdata->frames));
+  if (frame == NULL)
+    {
+      cdata->failed = 1;
+      return 1;
+    }
+  frame->filename = filename;
+  frame->function = function;
+  frame->lineno = lineno;
+  return 0;
+}
+
+/* An error callback that corresponds to pcindex_collect.  */
+
+static void
+pcindex_collect_error (void *vdata, const char *msg, int errnum)
+{
+  struct pcindex_collect_data *cdata;
+
+  cdata = (struct pcindex_collect_data *) vdata;
+  cdata->error_callback (cdata->data, msg, errnum);
+}
+
+/* Return whether the strings S1 and S2, which may be NULL, are equal.  */
+
+static int
+pcindex_string_equal (const char *s1, const char *s2)
+{
+  if (s1 == NULL || s2 == NULL)
+    return s1 == s2;
+  return s1 == s2 || strcmp (s1, s2) == 0;
+}
+
+/* Compare two strings for qsort and bsearch.  */
+
+static int
+pcindex_string_compare (const void *v1, const void *v2)
+{
+  return strcmp (*(const char * const *) v1, *(const char * const *) v2);
+}
+
+/* Return the offset of S, which may be NULL, in the strings of an index,
+   given the SORTED array of the COUNT distinct strings and their
+   OFFSETS.  */
+
+static uint32_t
+pcindex_string_offset (const char *s, const char **sorted,
+		       const uint32_t *offsets, size_t count)
+{
+  const char **p;
+
+  if (s == NULL)
+    return PCINDEX_NO_STRING;
+  p = (const char **) bsearch (&s, sorted, count, sizeof (const char *),
+			       pcindex_string_compare);
+  return offsets[p - sorted];
+}
+
+/* Write all of SIZE bytes of BUF to DESCRIPTOR.  Return 1 on success, 0
+   on failure.  */
+
+static int
+pcindex_write (int descriptor, const void *buf, size_t size,
+	       backtrace_error_callback error_callback, void *data)
+{
+  const char *p;
+
+  p = (const char *) buf;
+  while (size > 0)
+    {
+      ssize_t written;
+
+      written = write (descriptor, p, size);
+      if (written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  error_callback (data, "write", errno);
+	  return 0;
+	}
+      p += written;
+      size -= (size_t) written;
+    }
+  return 1;
+}
+
+/* Write an index of the file/line information of the first module with
+   debug info to FILENAME.  */
+
+int
+backtrace_write_index (struct backtrace_state *state, const char *filename,
+		       backtrace_error_callback error_callback, void *data)
+{
+  fileline fileline_fn;
+  struct backtrace_vector pcs;
+  size_t pcs_count;
+  uintptr_t base_address;
+  struct pcindex_collect_data cdata;
+  struct backtrace_vector ranges;
+  struct backtrace_vector strings;
+  const struct pcindex_build_frame *build_frames;
+  size_t frames_count;
+  const char **sorted;
+  uint32_t *offsets;
+  struct pcindex_frame *frames;
+  size_t strings_count;
+  struct pcindex_header header;
+  int descriptor;
+  int ret;
+  size_t i;
+  size_t j;
+
+  if (!fileline_initialize (state, error_callback, data))
+    return 0;
+  if (!state->threaded)
+    fileline_fn = state->fileline_fn;
+  else
+    fileline_fn = backtrace_atomic_load_pointer (&state->fileline_fn);
+
+  memset (&header, 0, sizeof header);
+  if (!pcindex_executable_stat (state, error_callback, data,
+				&header.executable_size,
+				&header.executable_mtime))
+    return 0;
+
+  memset (&pcs, 0, sizeof pcs);
+  if (!backtrace_dwarf_boundaries (state, error_callback, data, &pcs,
+				   &pcs_count, &base_address))
+    return 0;
+
+  ret = 0;
+  sorted = NULL;
+  offsets = NULL;
+  frames = NULL;
+  descriptor = -1;
+  memset (&cdata, 0, sizeof cdata);
+  cdata.state = state;
+  cdata.error_callback = error_callback;
+  cdata.data = data;
+  memset (&ranges, 0, sizeof ranges);
+  memset (&strings, 0, sizeof strings);
+
+  /* Look up the start of every range, and merge a range into the
+     previous one if its frames are the same.  */
+  for (i = 0; i < pcs_count; ++i)
+    {
+      uintptr_t pc;
+      size_t start;
+      size_t nframes;
+      struct pcindex_range *range;
+
+      pc = ((uintptr_t *) pcs.base)[i];
+      start = cdata.frames.size / sizeof (struct pcindex_build_frame);
+      if (i + 1 < pcs_count)
+	{
+	  fileline_fn (state, base_address + pc, pcindex_collect,
+		       pcindex_collect_error, &cdata);
+	  if (cdata.failed)
+	    goto fail;
+	}
+      nframes = (cdata.frames.size / sizeof (struct pcindex_build_frame)
+		 - start);
+
+      if (ranges.size > 0)
+	{
+	  const struct pcindex_range *prev;
+	  const struct pcindex_build_frame *pf;
+	  const struct pcindex_build_frame *nf;
+
+	  prev = ((const struct pcindex_range *)
+		  ((char *) ranges.base + ranges.size) - 1);
+	  pf = (const struct pcindex_build_frame *) cdata.frames.base;
+	  pf += prev->frame;
+	  nf = (const struct pcindex_build_frame *) cdata.frames.base;
+	  nf += start;
+	  if (prev->nframes == nframes)
+	    {
+	      for (j = 0; j < nframes; ++j)
+		if (pf[j].lineno != nf[j].lineno
+		    || !pcindex_string_equal (pf[j].filename, nf[j].filename)
+		    || !pcindex_string_equal (pf[j].function, nf[j].function))
+		  break;
+	      if (j == nframes)
+		{
+		  cdata.frames.size -= nframes * sizeof (*nf);
+		  cdata.frames.alc += nframes * sizeof (*nf);
+		  continue;
+		}
+	    }
+	}
+
+      range = ((struct pcindex_range *)
+	       backtrace_vector_grow (state, sizeof (struct pcindex_range),
+				      error_callback, data, &ranges));
+      if (range == NULL)
+	goto fail;
+      range->low = pc;
+      range->frame = (uint32_t) start;
+      range->nframes = (uint32_t) nframes;
+    }
+
+  /* Build the strings, sorted and without duplicates.  */
+  build_frames = (const struct pcindex_build_frame *) cdata.frames.base;
+  frames_count = cdata.frames.size / sizeof (struct pcindex_build_frame);
+  sorted = ((const char **)
+	    backtrace_alloc (state, 2 * frames_count * sizeof (const char *)
+			     + 1, error_callback, data));
+  if (sorted == NULL)
+    goto fail;
+  strings_count = 0;
+  for (i = 0; i < frames_count; ++i)
+    {
+      if (build_frames[i].filename != NULL)
+	sorted[strings_count++] = build_frames[i].filename;
+      if (build_frames[i].function != NULL)
+	sorted[strings_count++] = build_frames[i].function;
+    }
+  backtrace_qsort (sorted, strings_count, sizeof (const char *),
+		   pcindex_string_compare);
+  j = 0;
+  for (i = 0; i < strings_count; ++i)
+    if (j == 0 || strcmp (sorted[i], sorted[j - 1]) != 0)
+      sorted[j++] = sorted[i];
+  strings_count = j;
+
+  offsets = ((uint32_t *)
+	     backtrace_alloc (state, strings_count * sizeof (uint32_t) + 1,
+			      error_callback, data));
+  if (offsets == NULL)
+    goto fail;
+  for (i = 0; i < strings_count; ++i)
+    {
+      size_t len;
+      char *s;
+
+      len = strlen (sorted[i]) + 1;
+      offsets[i] = (uint32_t) strings.size;
+      s = ((char *)
+	   backtrace_vector_grow (state, len, error_callback, data,
+				  &strings));
+      if (s == NULL)
+	goto fail;
+      memcpy (s, sorted[i], len);
+    }
+
+  frames = ((struct pcindex_frame *)
+	    backtrace_alloc (state,
+			     frames_count * sizeof (struct pcindex_frame) + 1,
+			     error_callback, data));
+  if (frames == NULL)
+    goto fail;
+  for (i = 0; i < frames_count; ++i)
+    {
+      frames[i].filename = pcindex_string_offset (build_frames[i].filename,
+						  sorted, offsets,
+						  strings_count);
+      frames[i].function = pcindex_string_offset (build_frames[i].function,
+						  sorted, offsets,
+						  strings_count);
+      frames[i].lineno = build_frames[i].lineno;
+    }
+
+  memcpy (header.magic, PCINDEX_MAGIC, sizeof header.magic);
+  header.version = PCINDEX_VERSION;
+  header.byte_order = PCINDEX_BYTE_ORDER;
+  header.base_address = base_address;
+  header.ranges_count = ranges.size / sizeof (struct pcindex_range);
+  header.frames_count = frames_count;
+  header.strings_size = strings.size;
+
+  descriptor = open (filename,
+		     (int) (O_WRONLY | O_CREAT | O_TRUNC | O_BINARY
+			    | O_CLOEXEC),
+		     0666);
+  if (descriptor < 0)
+    {
+      error_callback (data, filename, errno);
+      goto fail;
+    }
+  if (pcindex_write (descriptor, &header, sizeof header, error_callback,
+		     data)
+      && pcindex_write (descriptor, ranges.base, ranges.size,
+			error_callback, data)
+      && pcindex_write (descriptor, frames,
+			frames_count * sizeof (struct pcindex_frame),
+			error_callback, data)
+      && pcindex_write (descriptor, strings.base, strings.size,
+			error_callback, data))
+    ret = 1;
+  if (close (descriptor) < 0 && ret)
+    {
+      error_callback (data, "close", errno);
+      ret = 0;
+    }
+
+ fail:
+  if (frames != NULL)
+    backtrace_free (state, frames,
+		    frames_count * sizeof (struct pcindex_frame) + 1,
+		    error_callback, data);
+  if (offsets != NULL)
+    backtrace_free (state, offsets, strings_count * sizeof (uint32_t) + 1,
+		    error_callback, data);
+  if (sorted != NULL)
+    backtrace_free (state, sorted,
+		    2 * frames_count * sizeof (const char *) + 1,
+		    error_callback, data);
+  backtrace_vector_free (state, &strings, error_callback, data);
+  backtrace_vector_free (state, &ranges, error_callback, data);
+  backtrace_vector_free (state, &cdata.frames, error_callback, data);
+  backtrace_vector_free (state, &pcs, error_callback, data);
+  return ret;
+}
+
 /* Given a PC, find the file name, line number, and function name.  */
 
 int
@@ -353,6 +1032,19 @@ backtrace_pcinfo (struct backtrace_state *state, uintptr_t pc,
 		  backtrace_full_callback callback,
 		  backtrace_error_callback error_callback, void *data)
 {
+  struct backtrace_pcindex *index;
+
+  index = pcindex_get (state);
+  if (index != NULL)
+    {
+      int found;
+      int ret;
+
+      ret = pcindex_lookup (index, pc, callback, data, &found);
+      if (found)
+	return ret;
+    }
+
   if (!fileline_initialize (state, error_callback, data))
     return 0;
 
@@ -362,6 +1054,115 @@ backtrace_pcinfo (struct backtrace_state *state, uintptr_t pc,
   return state->fileline_fn (state, pc, callback, error_callback, data);
 }
 
+/* Find the file name, line number, and function name for each of COUNT
+   PCs.  */
+
+int
+backtrace_pcinfo_batch (struct backtrace_state *state, const uintptr_t *pcs,
+			size_t count, backtrace_full_callback callback,
+			backtrace_error_callback error_callback, void *data)
+{
+  struct backtrace_pcindex *index;
+  fileline fileline_fn;
+  size_t i;
+
+  index = pcindex_get (state);
+  fileline_fn = NULL;
+  for (i = 0; i < count; ++i)
+    {
+      int ret;
+
+      if (index != NULL)
+	{
+	  int found;
+
+	  ret = pcindex_lookup (index, pcs[i], callback, data, &found);
+	  if (ret != 0)
+	    return ret;
+	  if (found)
+	    continue;
+	}
+
+      if (fileline_fn == NULL)
+	{
+	  if (!fileline_initialize (state, error_callback, data))
+	    return 0;
+	  if (!state->threaded)
+	    fileline_fn = state->fileline_fn;
+	  else
+	    fileline_fn = backtrace_atomic_load_pointer (&state->fileline_fn);
+	}
+
+      ret = fileline_fn (state, pcs[i], callback, error_callback, data);
+      if (ret != 0)
+	return ret;
+    }
+
+  return 0;
+}
+
+/* A data structure to pass to detail_to_full_callback.  */
+
+struct backtrace_call_detail
+{
+  backtrace_detail_callback detail_callback;
+  backtrace_error_callback detail_error_callback;
+  void *detail_data;
+};
+
+/* A backtrace_full_callback that calls into a
+   backtrace_detail_callback, used when the file/line information does
+   not come from DWARF and so has no discriminators or declaration
+   lines.  */
+
+static int
+detail_to_full_callback (void *data, uintptr_t pc, const char *filename,
+			 int lineno, const char *function)
+{
+  struct backtrace_call_detail *bdata = (struct backtrace_call_detail *) data;
+
+  return bdata->detail_callback (bdata->detail_data, pc, filename, lineno, 0,
+				 function, 0);
+}
+
+/* An error callback that corresponds to detail_to_full_callback.  */
+
+static void
+detail_to_full_error_callback (void *data, const char *msg, int errnum)
+{
+  struct backtrace_call_detail *bdata = (struct backtrace_call_detail *) data;
+
+  bdata->detail_error_callback (bdata->detail_data, msg, errnum);
+}
+
+/* Given a PC, find the file name, line number and discriminator, and
+   the function name and declaration line.  */
+
+int
+backtrace_pcinfo_detail (struct backtrace_state *state, uintptr_t pc,
+			 backtrace_detail_callback callback,
+			 backtrace_error_callback error_callback, void *data)
+{
+  struct backtrace_call_detail bdata;
+  int ret;
+
+  if (!fileline_initialize (state, error_callback, data))
+    return 0;
+
+  if (state->fileline_initialization_failed)
+    return 0;
+
+  if (backtrace_dwarf_fileline_detail (state, pc, callback, error_callback,
+				       data, &ret))
+    return ret;
+
+  bdata.detail_callback = callback;
+  bdata.detail_error_callback = error_callback;
+  bdata.detail_data = data;
+  return state->fileline_fn (state, pc, detail_to_full_callback,
+			     detail_to_full_error_callback, &bdata);
+}
+
 /* Given a PC, find the symbol for it, and its value.  */
 
 int
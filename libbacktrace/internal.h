@@ -152,6 +152,8 @@ struct backtrace_state
   void *syminfo_data;
   /* Whether initializing the file/line information failed.  */
   int fileline_initialization_failed;
+  /* The index loaded by backtrace_load_index, or NULL.  */
+  void *pcindex;
   /* The lock for the freelist.  */
   int lock_alloc;
   /* The freelist when using mmap.  */
@@ -334,6 +336,26 @@ extern int backtrace_dwarf_add (struct backtrace_state *state,
 				void *data, fileline *fileline_fn,
 				struct dwarf_data **fileline_entry);
 
+/* Collect the addresses at which the file/line information of the
+   first DWARF module of STATE may change, for backtrace_write_index.  */
+
+extern int backtrace_dwarf_boundaries (struct backtrace_state *state,
+				       backtrace_error_callback error_callback,
+				       void *data,
+				       struct backtrace_vector *vec,
+				       size_t *count,
+				       uintptr_t *base_address);
+
+/* Look up PC with a backtrace_detail_callback if the file/line
+   information of STATE comes from DWARF, for backtrace_pcinfo_detail.  */
+
+extern int backtrace_dwarf_fileline_detail (struct backtrace_state *state,
+					    uintptr_t pc,
+					    backtrace_detail_callback callback,
+					    backtrace_error_callback
+					      error_callback,
+					    void *data, int *ret);
+
 /* A data structure to pass to backtrace_syminfo_to_full.  */
 
 struct backtrace_call_full
@@ -1373,6 +1373,21 @@ free_file_hash_entries (cpp_reader *pfile)
     }
 }
 
+/* Record that DIR, a directory of the include path, does not exist.
+   Like the files looked for in the include path and not found, it is
+   then listed by deps_write_digests, so that the driver compiles again
+   once it is created.  */
+void
+cpp_add_nonexistent_dir (cpp_reader *pfile, const char *dir)
+{
+  hashval_t hv = htab_hash_string (dir);
+  void **pp = htab_find_slot_with_hash (pfile->nonexistent_file_hash,
+					dir, hv, INSERT);
+
+  if (*pp == NULL)
+    *pp = obstack_copy0 (&pfile->nonexistent_file_ob, dir, strlen (dir));
+}
+
 /* Returns TRUE if a file FNAME has ever been successfully opened.
    This routine is not intended to correctly handle filenames aliased
    by links or redundant . or .. traversals etc.  */
@@ -1405,6 +1405,8 @@ extern unsigned char *cpp_output_line_to_string (cpp_reader *,
 extern const unsigned char *cpp_alloc_token_string
   (cpp_reader *, const unsigned char *, unsigned);
 extern void cpp_output_token (const cpp_token *, FILE *);
+extern unsigned char *cpp_output_token_to_buffer (const cpp_token *,
+						  unsigned char *);
 extern const char *cpp_type2name (enum cpp_ttype, unsigned char flags);
 /* Returns the value of an escape sequence, truncated to the correct
    target precision.  PSTR points to the input pointer, which is just
@@ -1475,6 +1477,7 @@ extern cpp_buffer *cpp_get_buffer (cpp_reader *);
 extern struct _cpp_file *cpp_get_file (cpp_buffer *);
 extern cpp_buffer *cpp_get_prev (cpp_buffer *);
 extern void cpp_clear_file_cache (cpp_reader *);
+extern void cpp_add_nonexistent_dir (cpp_reader *, const char *);
 
 /* cpp_get_converted_source returns the contents of the given file, as it exists
    after cpplib has read it and converted it from the input charset to the
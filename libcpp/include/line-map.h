@@ -721,6 +721,30 @@ MACRO_MAP_LOCATIONS (const line_map_macro *macro_map)
    Essentially this is just a vector of T_linemap_subclass,
    which can only ever grow in size.  */
 
+/* The number of the maps most recently found by lookups that the next
+   lookup checks before searching.  */
+#define LINEMAP_LOOKUP_CACHE_SIZE 4
+
+/* The number of maps covered by each entry of the first level of a
+   maps_lookup_index.  */
+#define LINEMAP_INDEX_BLOCK 64
+
+/* A two-level index over the start locations of the maps in a
+   maps_info_ordinary or maps_info_macro, so that a lookup searches a
+   dense array instead of the maps themselves.  STARTS holds the start
+   location of each of the first INDEXED maps, and BLOCK_STARTS that of
+   every LINEMAP_INDEX_BLOCK-th one.  The index is extended lazily by
+   lookups; see linemap_update_index.  */
+
+struct GTY(()) maps_lookup_index {
+  location_t * GTY((atomic)) starts;
+  location_t * GTY((atomic)) block_starts;
+
+  /* The number of maps indexed, and the number there is room for.  */
+  unsigned int indexed;
+  unsigned int allocated;
+};
+
 struct GTY(()) maps_info_ordinary {
   /* This array contains the "ordinary" line maps, for all
      events other than macro expansion
@@ -734,9 +758,12 @@ struct GTY(()) maps_info_ordinary {
      or equal to ALLOCATED.  */
   unsigned int used;
 
-  /* The index of the last ordinary map that was looked up with
-     linemap_lookup.  */
-  mutable unsigned int m_cache;
+  /* The indices of the ordinary maps most recently looked up with
+     linemap_lookup, most recent first.  */
+  mutable unsigned int m_cache[LINEMAP_LOOKUP_CACHE_SIZE];
+
+  /* The index over the start locations of the maps.  */
+  mutable maps_lookup_index m_index;
 };
 
 struct GTY(()) maps_info_macro {
@@ -751,9 +778,12 @@ struct GTY(()) maps_info_macro {
      or equal to ALLOCATED.  */
   unsigned int used;
 
-  /* The index of the last macro map that was looked up with
-     linemap_lookup.  */
-  mutable unsigned int m_cache;
+  /* The indices of the macro maps most recently looked up with
+     linemap_lookup, most recent first.  */
+  mutable unsigned int m_cache[LINEMAP_LOOKUP_CACHE_SIZE];
+
+  /* The index over the start locations of the maps.  */
+  mutable maps_lookup_index m_index;
 };
 
 /* Data structure to associate a source_range together with an arbitrary
@@ -1385,6 +1415,8 @@ struct linemap_stats
   long ordinary_maps_used_size;
   long num_expanded_macros;
   long num_macro_tokens;
+  long num_macro_buffs;
+  long num_macro_buff_allocs;
   long num_macro_maps_used;
   long macro_maps_allocated_size;
   long macro_maps_used_size;
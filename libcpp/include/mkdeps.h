@@ -75,6 +75,14 @@ extern void deps_write (const cpp_reader *, FILE *, unsigned int);
 /* Write out a deps buffer to a specified file in P1689R5 format.  */
 extern void deps_write_p1689r5 (const struct mkdeps *, FILE *);
 
+/* Write out the MD5 digest of the contents of each dependency, and the
+   names of the files looked for in the include path and not found, in
+   the form the driver checks for -fdepfile-digests.  The third argument
+   is the key of the compilation, the fourth the time it started.
+   Returns nonzero if a digest could not be written.  */
+extern int deps_write_digests (const cpp_reader *, FILE *, const char *,
+			       time_t);
+
 /* Write out a deps buffer to a file, in a form that can be read back
    with deps_restore.  Returns nonzero on error, in which case the
    error number will be in errno.  */
@@ -355,6 +355,7 @@ cpp_destroy (cpp_reader *pfile)
   _cpp_free_buff (pfile->a_buff);
   _cpp_free_buff (pfile->u_buff);
   _cpp_free_buff (pfile->free_buffs);
+  _cpp_free_pooled_buffs (pfile);
 
   for (run = &pfile->base_run; run; run = runn)
     {
@@ -790,7 +791,7 @@ read_original_filename (cpp_reader *pfile)
 	      penult[1].reason = penult[0].reason;
 	      penult[0] = penult[1];
 	      pfile->line_table->info_ordinary.used--;
-	      pfile->line_table->info_ordinary.m_cache = 0;
+	      pfile->line_table->info_ordinary.m_cache[0] = 0;
 	    }
 
 	  return true;
@@ -108,9 +108,19 @@ extern void _cpp_release_buff (cpp_reader *, _cpp_buff *);
 extern void _cpp_extend_buff (cpp_reader *, _cpp_buff **, size_t);
 extern _cpp_buff *_cpp_append_extend_buff (cpp_reader *, _cpp_buff *, size_t);
 extern void _cpp_free_buff (_cpp_buff *);
+extern _cpp_buff *_cpp_get_pooled_buff (cpp_reader *, size_t);
+extern void _cpp_release_pooled_buff (cpp_reader *, _cpp_buff *);
+extern void _cpp_free_pooled_buffs (cpp_reader *);
 extern unsigned char *_cpp_aligned_alloc (cpp_reader *, size_t);
 extern unsigned char *_cpp_unaligned_alloc (cpp_reader *, size_t);
 
+/* The number of size classes of buffers kept by _cpp_release_pooled_buff
+   for reuse.  The smallest class holds buffers of BUFF_POOL_MIN_SIZE
+   bytes, and each class holds buffers twice the size of the one
+   before.  */
+#define BUFF_POOL_CLASSES 12
+#define BUFF_POOL_MIN_SIZE 256
+
 #define BUFF_ROOM(BUFF) (size_t) ((BUFF)->limit - (BUFF)->cur)
 #define BUFF_FRONT(BUFF) ((BUFF)->cur)
 #define BUFF_LIMIT(BUFF) ((BUFF)->limit)
@@ -223,16 +233,18 @@ struct cpp_context
      we are in a macro context, this is a pointer to an instance of
      cpp_hashnode, representing the name of the macro this context is
      for.  If we are not in a macro context, then this is just NULL.
-     Note that when tokens_kind is TOKEN_KIND_EXTENDED, the memory
-     used by the instance of macro_context pointed to by this member
-     is de-allocated upon de-allocation of the instance of struct
-     cpp_context.  */
+     Note that when tokens_kind is TOKEN_KIND_EXTENDED, the instance
+     of macro_context pointed to by this member is mc_storage below.  */
   union
   {
     macro_context *mc;
     cpp_hashnode *macro;
   } c;
 
+  /* The macro_context that c.mc points to, kept with the context so
+     that both are reused together.  */
+  macro_context mc_storage;
+
   /* This determines the type of tokens held by this context.  */
   enum context_tokens_kind tokens_kind;
 };
@@ -431,6 +443,7 @@ struct cpp_reader
   _cpp_buff *a_buff;		/* Aligned permanent storage.  */
   _cpp_buff *u_buff;		/* Unaligned permanent storage.  */
   _cpp_buff *free_buffs;	/* Free buffer chain.  */
+  _cpp_buff *buff_pool[BUFF_POOL_CLASSES]; /* Pooled free buffers.  */
 
   /* Context stack.  */
   struct cpp_context base_context;
@@ -3785,6 +3785,117 @@ _cpp_get_fresh_line (cpp_reader *pfile)
   return get_fresh_line_impl<false> (pfile);
 }
 
+/* Return true if C ends a run of characters that skip_inactive_line
+   can pass over without looking further: the end of the line, the
+   start of a literal or a comment, a backslash, a NUL (which is
+   diagnosed even in skipped blocks) and anything that is not ASCII.  */
+static inline bool
+inactive_line_stop_p (uchar c)
+{
+  return ((c <= '/'
+	   && (c == '/' || c == '"' || c == '\'' || c == '\n' || c == '\0'))
+	  || c == '\\' || c >= utf8_continuation);
+}
+
+/* Skip over the fresh logical line in pfile->buffer, which is part of
+   a conditional block being skipped, without lexing it into tokens.
+   Only a line whose first token is '#' can be a directive, so all
+   that matters about the rest of a line is that it does not start a
+   comment or raw string that continues onto the next line, or contain
+   something the lexer would diagnose even while skipping.  Lines
+   starting with something that might be (or precede) a '#', and
+   anything the scan is unsure of, are left to _cpp_lex_direct.
+
+   Returns true, with the line consumed as if its newline had been
+   lexed, if there was nothing of interest on it.  Otherwise returns
+   false, with buffer->cur where lexing should carry on; RESULT loses
+   its BOL flag if that is past the first token of the line.  */
+static bool
+skip_inactive_line (cpp_reader *pfile, cpp_token *result)
+{
+  cpp_buffer *buffer = pfile->buffer;
+  const uchar *cur = buffer->cur;
+
+  while (*cur == ' ' || *cur == '\t' || *cur == '\f' || *cur == '\v')
+    cur++;
+
+  /* A directive, a '%:' digraph or a comment that might precede one.  */
+  const uchar *first = cur;
+  if (*cur == '#' || *cur == '%' || *cur == '/')
+    return false;
+
+  for (;;)
+    {
+      uchar c = *cur;
+      if (!inactive_line_stop_p (c))
+	{
+	  cur++;
+	  continue;
+	}
+
+      if (c == '\n')
+	break;
+
+      if (c == '/' && cur[1] != '*' && cur[1] != '/')
+	{
+	  cur++;
+	  continue;
+	}
+
+      /* An ordinary string or character literal, which must end on
+	 this line.  Leave those with an encoding prefix, raw strings
+	 and quotes that might be digit separators in a pp-number to the
+	 lexer, as well as anything it might warn about.  */
+      if ((c == '"' || c == '\'')
+	  && (cur == first
+	      || !(ISIDNUM (cur[-1]) || cur[-1] == '$' || cur[-1] == '.'
+		   || cur[-1] == '+' || cur[-1] == '-')))
+	{
+	  const uchar *p = cur + 1;
+	  for (; *p != c; p++)
+	    {
+	      if (*p == '\n' || *p >= utf8_continuation)
+		break;
+	      if (*p == '\\')
+		{
+		  if (p[1] == '\n' || p[1] == 'u' || p[1] == 'U' || p[1] == 'N'
+		      || p[1] >= utf8_continuation)
+		    break;
+		  p++;
+		}
+	    }
+	  if (*p == c)
+	    {
+	      cur = p + 1;
+	      continue;
+	    }
+	}
+
+      /* Let the lexer take it from here, starting from a point that
+	 cannot be in the middle of an identifier, pp-number or literal
+	 prefix.  */
+      while (cur != first
+	     && (ISIDNUM (cur[-1]) || cur[-1] == '$' || cur[-1] == '.'
+		 || cur[-1] == '+' || cur[-1] == '-'))
+	cur--;
+      if (cur != first)
+	result->flags &= ~BOL;
+      buffer->cur = cur;
+      return false;
+    }
+
+  /* Process any escaped newlines and trigraphs, then do what lexing
+     the newline would.  */
+  buffer->cur = cur;
+  if (buffer->cur >= buffer->notes[buffer->cur_note].pos)
+    _cpp_process_line_notes (pfile, false);
+  buffer->cur++;
+  if (buffer->cur < buffer->rlimit)
+    CPP_INCREMENT_LINE (pfile, 0);
+  buffer->need_line = true;
+  return true;
+}
+
 
 #define IF_NEXT_IS(CHAR, THEN_TYPE, ELSE_TYPE)		\
   do							\
@@ -3865,6 +3976,12 @@ _cpp_lex_direct (cpp_reader *pfile)
       result->flags = BOL;
       if (pfile->state.parsing_args == 2)
 	result->flags |= PREV_WHITE;
+      /* Most lines of a skipped block need not be lexed at all.  */
+      if (pfile->state.skipping
+	  && !pfile->state.parsing_args
+	  && !pfile->overlaid_buffer
+	  && skip_inactive_line (pfile, result))
+	goto fresh_line;
     }
   buffer = pfile->buffer;
  update_tokens_line:
@@ -4580,6 +4697,54 @@ cpp_output_token (const cpp_token *token, FILE *fp)
     }
 }
 
+/* Writes the spelling of TOKEN to BUFFER, without any preceding space,
+   as cpp_output_token writes it to a stream.  BUFFER must have room
+   for cpp_token_len (TOKEN) + 2 characters.  Returns a pointer to the
+   character after the last character written.  */
+unsigned char *
+cpp_output_token_to_buffer (const cpp_token *token, unsigned char *buffer)
+{
+  switch (TOKEN_SPELL (token))
+    {
+    case SPELL_OPERATOR:
+      {
+	const unsigned char *spelling;
+	unsigned char c;
+
+	if (token->flags & DIGRAPH)
+	  spelling = cpp_digraph2name (token->type);
+	else if (token->flags & NAMED_OP)
+	  goto spell_ident;
+	else
+	  spelling = TOKEN_NAME (token);
+
+	while ((c = *spelling++) != '\0')
+	  *buffer++ = c;
+      }
+      break;
+
+    spell_ident:
+    case SPELL_IDENT:
+      buffer = _cpp_spell_ident_ucns (buffer, token->val.node.node);
+      break;
+
+    case SPELL_LITERAL:
+      if (token->type == CPP_HEADER_NAME)
+	*buffer++ = '"';
+      memcpy (buffer, token->val.str.text, token->val.str.len);
+      buffer += token->val.str.len;
+      if (token->type == CPP_HEADER_NAME)
+	*buffer++ = '"';
+      break;
+
+    case SPELL_NONE:
+      /* An error, most probably.  */
+      break;
+    }
+
+  return buffer;
+}
+
 /* Compare two tokens.  */
 int
 _cpp_equiv_tokens (const cpp_token *a, const cpp_token *b)
@@ -4758,16 +4923,15 @@ cpp_output_line_to_string (cpp_reader *pfile, const unsigned char *dir_name)
   #error BUFF_SIZE_UPPER_BOUND must be at least as large as MIN_BUFF_SIZE!
 #endif
 
-/* Create a new allocation buffer.  Place the control block at the end
-   of the buffer, so that buffer overflows will cause immediate chaos.  */
+/* Create a new allocation buffer of LEN bytes.  Place the control
+   block at the end of the buffer, so that buffer overflows will cause
+   immediate chaos.  */
 static _cpp_buff *
 new_buff (size_t len)
 {
   _cpp_buff *result;
   unsigned char *base;
 
-  if (len < MIN_BUFF_SIZE)
-    len = MIN_BUFF_SIZE;
   len = CPP_ALIGN (len);
 
 #ifdef ENABLE_VALGRIND_WORKAROUNDS
@@ -4811,7 +4975,7 @@ _cpp_get_buff (cpp_reader *pfile, size_t min_size)
       size_t size;
 
       if (*p == NULL)
-	return new_buff (min_size);
+	return new_buff (MAX (min_size, MIN_BUFF_SIZE));
       result = *p;
       size = result->limit - result->base;
       /* Return a buffer that's big enough, but don't waste one that's
@@ -4875,6 +5039,91 @@ _cpp_free_buff (_cpp_buff *buff)
     }
 }
 
+/* The number of buffers requested from, and the number of those that
+   had to be allocated by, _cpp_get_pooled_buff.  */
+unsigned num_pooled_buffs_counter = 0;
+unsigned num_pooled_buff_allocs_counter = 0;
+
+/* Return the size class of the pool holding buffers of at least SIZE
+   bytes, or BUFF_POOL_CLASSES if SIZE is too big to be pooled.  */
+static unsigned int
+buff_pool_class (size_t size)
+{
+  unsigned int cls = 0;
+
+  while (cls < BUFF_POOL_CLASSES && (size_t) BUFF_POOL_MIN_SIZE << cls < size)
+    cls++;
+  return cls;
+}
+
+/* Return a buffer of at least MIN_SIZE bytes for short-lived storage,
+   which should be given back with _cpp_release_pooled_buff.  Unlike
+   _cpp_get_buff, the buffer comes from a free list for its size
+   class, so that getting one is cheap and small requests are not
+   rounded up to MIN_BUFF_SIZE.  This is for the buffers that each
+   macro expansion needs.  */
+_cpp_buff *
+_cpp_get_pooled_buff (cpp_reader *pfile, size_t min_size)
+{
+  unsigned int cls = buff_pool_class (min_size);
+  _cpp_buff *result;
+
+  num_pooled_buffs_counter++;
+  if (cls < BUFF_POOL_CLASSES && pfile->buff_pool[cls])
+    {
+      result = pfile->buff_pool[cls];
+      pfile->buff_pool[cls] = result->next;
+      result->next = NULL;
+      result->cur = result->base;
+      return result;
+    }
+
+  num_pooled_buff_allocs_counter++;
+  if (cls < BUFF_POOL_CLASSES)
+    min_size = (size_t) BUFF_POOL_MIN_SIZE << cls;
+  return new_buff (min_size);
+}
+
+/* Put a chain of unwanted buffers, which need not have come from
+   _cpp_get_pooled_buff, in the pool for their size class.  Those too
+   small or too big to be pooled are freed.  */
+void
+_cpp_release_pooled_buff (cpp_reader *pfile, _cpp_buff *buff)
+{
+  _cpp_buff *next;
+
+  for (; buff; buff = next)
+    {
+      size_t size = buff->limit - buff->base;
+      unsigned int cls = buff_pool_class (size);
+
+      next = buff->next;
+      if (size < BUFF_POOL_MIN_SIZE || cls == BUFF_POOL_CLASSES)
+	{
+	  buff->next = NULL;
+	  _cpp_free_buff (buff);
+	  continue;
+	}
+      /* A buffer bigger than the size of its class goes in the class
+	 below, whose requests it can always satisfy.  */
+      if ((size_t) BUFF_POOL_MIN_SIZE << cls > size)
+	cls--;
+      buff->next = pfile->buff_pool[cls];
+      pfile->buff_pool[cls] = buff;
+    }
+}
+
+/* Free the buffers in the pool.  */
+void
+_cpp_free_pooled_buffs (cpp_reader *pfile)
+{
+  for (unsigned int cls = 0; cls < BUFF_POOL_CLASSES; cls++)
+    {
+      _cpp_free_buff (pfile->buff_pool[cls]);
+      pfile->buff_pool[cls] = NULL;
+    }
+}
+
 /* Allocate permanent, unaligned storage of length LEN.  */
 unsigned char *
 _cpp_unaligned_alloc (cpp_reader *pfile, size_t len)
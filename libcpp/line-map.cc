@@ -47,6 +47,8 @@ static location_t linemap_macro_loc_to_exp_point (const line_maps *,
 /* Counters defined in macro.cc.  */
 extern unsigned num_expanded_macros_counter;
 extern unsigned num_macro_tokens_counter;
+extern unsigned num_pooled_buffs_counter;
+extern unsigned num_pooled_buff_allocs_counter;
 
 /* Destructor for class line_maps.
    Ensure non-GC-managed memory is released.  */
@@ -461,6 +463,70 @@ linemap_check_files_exited (const line_maps *set)
 	     ORDINARY_MAP_FILE_NAME (map));
 }
 
+/* Record in CACHE, the lookup cache of a maps_info_ordinary or
+   maps_info_macro, that the map at index IX was the last one found.  */
+
+static void
+linemap_cache_insert (unsigned int *cache, unsigned int ix)
+{
+  unsigned int i;
+
+  for (i = 0; i < LINEMAP_LOOKUP_CACHE_SIZE - 1; i++)
+    if (cache[i] == ix)
+      break;
+  memmove (&cache[1], &cache[0], i * sizeof (*cache));
+  cache[0] = ix;
+}
+
+/* Extend INDEX, the lookup index of the maps of type MACRO_P of SET,
+   over the maps whose start locations are in order: increasing for
+   ordinary maps, decreasing for macro maps.  A map out of order has not
+   been given its start location yet (see line_map_new_raw), or was
+   created after locations ran out; lookups search the maps from there
+   on as they always did.  */
+
+static void
+linemap_update_index (const line_maps *set, bool macro_p,
+		      maps_lookup_index *index)
+{
+  unsigned used = LINEMAPS_USED (set, macro_p);
+
+  /* Maps can be dropped from the end; see read_original_filename in
+     init.cc.  Those that remain keep their start locations.  */
+  if (index->indexed > used)
+    index->indexed = used;
+  if (index->indexed == used)
+    return;
+
+  if (used > index->allocated)
+    {
+      unsigned alloc = LINEMAPS_ALLOCATED (set, macro_p);
+      index->starts
+	= (location_t *) set->m_reallocator (index->starts,
+					     alloc * sizeof (location_t));
+      index->block_starts
+	= (location_t *) set->m_reallocator (index->block_starts,
+					     (alloc / LINEMAP_INDEX_BLOCK + 1)
+					     * sizeof (location_t));
+      index->allocated = alloc;
+    }
+
+  unsigned i;
+  for (i = index->indexed; i < used; i++)
+    {
+      location_t start = MAP_START_LOCATION (LINEMAPS_MAP_AT (set, macro_p, i));
+      if (i > 0
+	  && (macro_p
+	      ? start > index->starts[i - 1]
+	      : start < index->starts[i - 1]))
+	break;
+      index->starts[i] = start;
+      if (i % LINEMAP_INDEX_BLOCK == 0)
+	index->block_starts[i / LINEMAP_INDEX_BLOCK] = start;
+    }
+  index->indexed = i;
+}
+
 /* Create NUM zero-initialized maps of type MACRO_P.  */
 
 line_map *
@@ -638,7 +704,8 @@ linemap_add (line_maps *set, enum lc_reason reason,
   map->sysp = sysp;
   map->to_file = to_file;
   map->to_line = to_line;
-  set->info_ordinary.m_cache = LINEMAPS_ORDINARY_USED (set) - 1;
+  linemap_cache_insert (set->info_ordinary.m_cache,
+			LINEMAPS_ORDINARY_USED (set) - 1);
   /* Do not store range_bits here.  That's readjusted in
      linemap_line_start.  */
   map->m_range_bits = map->m_column_and_range_bits = 0;
@@ -786,7 +853,8 @@ linemap_enter_macro (class line_maps *set, struct cpp_hashnode *macro_node,
   memset (MACRO_MAP_LOCATIONS (map), 0,
 	  2 * num_tokens * sizeof (location_t));
 
-  set->info_macro.m_cache = LINEMAPS_MACRO_USED (set) - 1;
+  linemap_cache_insert (set->info_macro.m_cache,
+			LINEMAPS_MACRO_USED (set) - 1);
 
   return map;
 }
@@ -1102,6 +1170,55 @@ linemap_lookup (const line_maps *set, location_t line)
   return linemap_ordinary_map_lookup (set, line);
 }
 
+/* Return the index of the last of the ordinary maps of SET that starts
+   at or before LINE, or 0 if there is none.  */
+
+static unsigned
+linemap_ordinary_index_search (const line_maps *set, location_t line)
+{
+  const maps_lookup_index *index = &set->info_ordinary.m_index;
+  unsigned n = index->indexed;
+  unsigned mn, mx;
+  if (n == 0 || line >= index->starts[n - 1])
+    {
+      /* Search the maps that are not indexed.  */
+      mn = n == 0 ? 0 : n - 1;
+      mx = LINEMAPS_ORDINARY_USED (set);
+      while (mx - mn > 1)
+	{
+	  unsigned md = (mn + mx) / 2;
+	  if (MAP_START_LOCATION (LINEMAPS_ORDINARY_MAP_AT (set, md)) > line)
+	    mx = md;
+	  else
+	    mn = md;
+	}
+      return mn;
+    }
+
+  mn = 0;
+  mx = (n + LINEMAP_INDEX_BLOCK - 1) / LINEMAP_INDEX_BLOCK;
+  while (mx - mn > 1)
+    {
+      unsigned md = (mn + mx) / 2;
+      if (index->block_starts[md] > line)
+	mx = md;
+      else
+	mn = md;
+    }
+
+  mn *= LINEMAP_INDEX_BLOCK;
+  mx = MIN (mn + LINEMAP_INDEX_BLOCK, n);
+  while (mx - mn > 1)
+    {
+      unsigned md = (mn + mx) / 2;
+      if (index->starts[md] > line)
+	mx = md;
+      else
+	mn = md;
+    }
+  return mn;
+}
+
 /* Given a source location yielded by an ordinary map, returns that
    map.  Since the set is built chronologically, the logical lines are
    monotonic increasing, and so the list is sorted and we can use a
@@ -1116,32 +1233,33 @@ linemap_ordinary_map_lookup (const line_maps *set, location_t line)
   if (set ==  NULL || line < RESERVED_LOCATION_COUNT)
     return NULL;
 
-  unsigned mn = set->info_ordinary.m_cache;
-  unsigned mx = LINEMAPS_ORDINARY_USED (set);
+  unsigned *cache = set->info_ordinary.m_cache;
+  unsigned used = LINEMAPS_ORDINARY_USED (set);
+  maps_lookup_index *index = &set->info_ordinary.m_index;
+  linemap_update_index (set, false, index);
 
-  const line_map_ordinary *cached = LINEMAPS_ORDINARY_MAP_AT (set, mn);
-  /* We should get a segfault if no line_maps have been added yet.  */
-  if (line >= MAP_START_LOCATION (cached))
+  /* Check the cached maps against the index rather than the maps
+     themselves, which are much more spread out in memory.  */
+  unsigned n = index->indexed;
+  for (unsigned i = 0; i < LINEMAP_LOOKUP_CACHE_SIZE; i++)
     {
-      if (mn + 1 == mx || line < MAP_START_LOCATION (&cached[1]))
-	return cached;
-    }
-  else
-    {
-      mx = mn;
-      mn = 0;
-    }
-
-  while (mx - mn > 1)
-    {
-      unsigned md = (mn + mx) / 2;
-      if (MAP_START_LOCATION (LINEMAPS_ORDINARY_MAP_AT (set, md)) > line)
-	mx = md;
-      else
-	mn = md;
+      unsigned ix = cache[i];
+      if (ix >= n || line < index->starts[ix])
+	continue;
+      if (ix + 1 == used
+	  || (ix + 1 < n
+	      ? line < index->starts[ix + 1]
+	      : line < MAP_START_LOCATION (LINEMAPS_ORDINARY_MAP_AT (set,
+								     ix + 1))))
+	{
+	  if (i != 0)
+	    linemap_cache_insert (cache, ix);
+	  return LINEMAPS_ORDINARY_MAP_AT (set, ix);
+	}
     }
 
-  set->info_ordinary.m_cache = mn;
+  unsigned mn = linemap_ordinary_index_search (set, line);
+  linemap_cache_insert (cache, mn);
   const line_map_ordinary *result = LINEMAPS_ORDINARY_MAP_AT (set, mn);
   linemap_assert (line >= MAP_START_LOCATION (result));
   return result;
@@ -1170,32 +1288,87 @@ linemap_macro_map_lookup (const line_maps *set, location_t line)
   return result;
 }
 
-unsigned
-linemap_lookup_macro_index (const line_maps *set, location_t line)
+/* Return the index of the first of the macro maps of SET that starts
+   at or before LINE, or the number of macro maps if there is none.  */
+
+static unsigned
+linemap_macro_index_search (const line_maps *set, location_t line)
 {
-  unsigned mn = set->info_macro.m_cache;
-  unsigned mx = LINEMAPS_MACRO_USED (set);
-  const struct line_map_macro *cached = LINEMAPS_MACRO_MAP_AT (set, mn);
+  const maps_lookup_index *index = &set->info_macro.m_index;
+  unsigned n = index->indexed;
+  unsigned mn, mx;
+  if (n < LINEMAPS_MACRO_USED (set)
+      && (n == 0 || line < index->starts[n - 1]))
+    {
+      /* Search the maps that are not indexed.  */
+      mn = n;
+      mx = LINEMAPS_MACRO_USED (set);
+      while (mn < mx)
+	{
+	  unsigned md = (mx + mn) / 2;
+	  if (MAP_START_LOCATION (LINEMAPS_MACRO_MAP_AT (set, md)) > line)
+	    mn = md + 1;
+	  else
+	    mx = md;
+	}
+      return mx;
+    }
 
-  if (line >= MAP_START_LOCATION (cached))
+  unsigned nblocks = (n + LINEMAP_INDEX_BLOCK - 1) / LINEMAP_INDEX_BLOCK;
+  mn = 0;
+  mx = nblocks;
+  while (mn < mx)
     {
-      if (line < (MAP_START_LOCATION (cached)
-		  + MACRO_MAP_NUM_MACRO_TOKENS (cached)))
-	return mn;
-      mx = mn - 1;
-      mn = 0;
+      unsigned md = (mx + mn) / 2;
+      if (index->block_starts[md] > line)
+	mn = md + 1;
+      else
+	mx = md;
     }
 
+  /* The first block that starts at or before LINE is MX, so the map we
+     want is its first one or one of the previous block.  */
+  unsigned block = mx;
+  mn = block == 0 ? 0 : (block - 1) * LINEMAP_INDEX_BLOCK + 1;
+  mx = block == nblocks ? n : block * LINEMAP_INDEX_BLOCK + 1;
   while (mn < mx)
     {
       unsigned md = (mx + mn) / 2;
-      if (MAP_START_LOCATION (LINEMAPS_MACRO_MAP_AT (set, md)) > line)
+      if (index->starts[md] > line)
 	mn = md + 1;
       else
 	mx = md;
     }
+  return mx;
+}
+
+unsigned
+linemap_lookup_macro_index (const line_maps *set, location_t line)
+{
+  unsigned *cache = set->info_macro.m_cache;
+  unsigned used = LINEMAPS_MACRO_USED (set);
+  maps_lookup_index *index = &set->info_macro.m_index;
+  linemap_update_index (set, true, index);
+
+  /* As for ordinary maps, check the cached maps against the index.  A
+     macro map ends where the one created before it starts.  */
+  unsigned n = index->indexed;
+  for (unsigned i = 0; i < LINEMAP_LOOKUP_CACHE_SIZE; i++)
+    {
+      unsigned ix = cache[i];
+      if (ix < n
+	  && line >= index->starts[ix]
+	  && (ix == 0 || line < index->starts[ix - 1]))
+	{
+	  if (i != 0)
+	    linemap_cache_insert (cache, ix);
+	  return ix;
+	}
+    }
 
-  set->info_macro.m_cache = mx;
+  unsigned mx = linemap_macro_index_search (set, line);
+  if (mx < used)
+    linemap_cache_insert (cache, mx);
   return mx;
 }
 
@@ -2105,6 +2278,8 @@ linemap_get_statistics (const line_maps *set,
   s->ordinary_maps_used_size = ordinary_maps_used_size;
   s->num_expanded_macros = num_expanded_macros_counter;
   s->num_macro_tokens = num_macro_tokens_counter;
+  s->num_macro_buffs = num_pooled_buffs_counter;
+  s->num_macro_buff_allocs = num_pooled_buff_allocs_counter;
   s->num_macro_maps_used = LINEMAPS_MACRO_USED (set);
   s->macro_maps_allocated_size = macro_maps_allocated_size;
   s->macro_maps_locations_size = macro_maps_locations_size;
@@ -44,6 +44,10 @@ struct macro_arg
   location_t *expanded_virt_locs; /* Where virtual locations for
 					  expanded tokens are
 					  stored.  */
+  _cpp_buff *virt_locs_buff;	/* Storage for VIRT_LOCS.  */
+  _cpp_buff *expanded_buff;	/* Storage for EXPANDED and
+				   EXPANDED_VIRT_LOCS, unless they are
+				   shared with FIRST and VIRT_LOCS.  */
 };
 
 /* The kind of macro tokens which the instance of
@@ -301,7 +305,8 @@ static bool paste_tokens (cpp_reader *, location_t,
 			  const cpp_token **, const cpp_token *);
 static void alloc_expanded_arg_mem (cpp_reader *, macro_arg *, size_t);
 static void ensure_expanded_arg_room (cpp_reader *, macro_arg *, size_t, size_t *);
-static void delete_macro_args (_cpp_buff*, unsigned num_args);
+static void delete_macro_args (cpp_reader *, _cpp_buff *, unsigned num_args);
+static size_t extend_pooled_array (cpp_reader *, _cpp_buff **, size_t, size_t);
 static void set_arg_token (macro_arg *, const cpp_token *,
 			   location_t, size_t,
 			   enum macro_arg_token_kind,
@@ -1179,7 +1184,8 @@ collect_args (cpp_reader *pfile, const cpp_hashnode *node,
 #define DEFAULT_NUM_TOKENS_PER_MACRO_ARG 50
 #define ARG_TOKENS_EXTENT 1000
 
-  buff = _cpp_get_buff (pfile, argc * (DEFAULT_NUM_TOKENS_PER_MACRO_ARG
+  buff = _cpp_get_pooled_buff (pfile,
+			       argc * (DEFAULT_NUM_TOKENS_PER_MACRO_ARG
 				       * sizeof (cpp_token *)
 				       + sizeof (macro_arg)));
   base_buff = buff;
@@ -1202,9 +1208,15 @@ collect_args (cpp_reader *pfile, const cpp_hashnode *node,
       arg->first = (const cpp_token **) buff->cur;
       if (track_macro_expansion_p)
 	{
-	  virt_locs_capacity = DEFAULT_NUM_TOKENS_PER_MACRO_ARG;
-	  arg->virt_locs = XNEWVEC (location_t,
-				    virt_locs_capacity);
+	  /* An excess argument overwrites the last one.  */
+	  if (arg->virt_locs_buff)
+	    _cpp_release_pooled_buff (pfile, arg->virt_locs_buff);
+	  arg->virt_locs_buff = NULL;
+	  virt_locs_capacity
+	    = extend_pooled_array (pfile, &arg->virt_locs_buff, 0,
+				   DEFAULT_NUM_TOKENS_PER_MACRO_ARG
+				   * sizeof (location_t)) / sizeof (location_t);
+	  arg->virt_locs = (location_t *) arg->virt_locs_buff->base;
 	}
 
       for (;;)
@@ -1220,10 +1232,13 @@ collect_args (cpp_reader *pfile, const cpp_hashnode *node,
 	  if (track_macro_expansion_p
 	      && (ntokens + 2 > virt_locs_capacity))
 	    {
-	      virt_locs_capacity += ARG_TOKENS_EXTENT;
-	      arg->virt_locs = XRESIZEVEC (location_t,
-					   arg->virt_locs,
-					   virt_locs_capacity);
+	      virt_locs_capacity
+		= extend_pooled_array (pfile, &arg->virt_locs_buff,
+				       ntokens * sizeof (location_t),
+				       (virt_locs_capacity + ARG_TOKENS_EXTENT)
+				       * sizeof (location_t))
+		  / sizeof (location_t);
+	      arg->virt_locs = (location_t *) arg->virt_locs_buff->base;
 	    }
 
 	  token = cpp_get_token_1 (pfile, &virt_loc);
@@ -1360,7 +1375,7 @@ collect_args (cpp_reader *pfile, const cpp_hashnode *node,
     }
 
   /* An error occurred.  */
-  _cpp_release_buff (pfile, base_buff);
+  delete_macro_args (pfile, base_buff, arg - args + 1);
   return NULL;
 }
 
@@ -1495,7 +1510,7 @@ enter_macro_context (cpp_reader *pfile, cpp_hashnode *node,
 	  /* Free the memory used by the arguments of this
 	     function-like macro.  This memory has been allocated by
 	     funlike_invocation_p and by replace_args.  */
-	  delete_macro_args (buff, num_args);
+	  delete_macro_args (pfile, buff, num_args);
 	}
 
       /* Disable the macro within its expansion.  */
@@ -1602,7 +1617,7 @@ enter_macro_context (cpp_reader *pfile, cpp_hashnode *node,
    of macro_arg.  NUM_ARGS is the number of instances of macro_arg
    present in BUFF.  */
 static void
-delete_macro_args (_cpp_buff *buff, unsigned num_args)
+delete_macro_args (cpp_reader *pfile, _cpp_buff *buff, unsigned num_args)
 {
   macro_arg *macro_args;
   unsigned i;
@@ -1612,27 +1627,16 @@ delete_macro_args (_cpp_buff *buff, unsigned num_args)
 
   macro_args = (macro_arg *) buff->base;
 
-  /* Walk instances of macro_arg to free their expanded tokens as well
-     as their macro_arg::virt_locs members.  */
+  /* Walk instances of macro_arg to release the storage of their
+     expanded tokens and virtual locations.  */
   for (i = 0; i < num_args; ++i)
     {
-      if (macro_args[i].expanded)
-	{
-	  free (macro_args[i].expanded);
-	  macro_args[i].expanded = NULL;
-	}
-      if (macro_args[i].virt_locs)
-	{
-	  free (macro_args[i].virt_locs);
-	  macro_args[i].virt_locs = NULL;
-	}
-      if (macro_args[i].expanded_virt_locs)
-	{
-	  free (macro_args[i].expanded_virt_locs);
-	  macro_args[i].expanded_virt_locs = NULL;
-	}
+      if (macro_args[i].expanded_buff)
+	_cpp_release_pooled_buff (pfile, macro_args[i].expanded_buff);
+      if (macro_args[i].virt_locs_buff)
+	_cpp_release_pooled_buff (pfile, macro_args[i].virt_locs_buff);
     }
-  _cpp_free_buff (buff);
+  _cpp_release_pooled_buff (pfile, buff);
 }
 
 /* Set the INDEXth token of the macro argument ARG. TOKEN is the token
@@ -2462,7 +2466,7 @@ push_extended_tokens_context (cpp_reader *pfile,
   context->tokens_kind = TOKENS_KIND_EXTENDED;
   context->buff = token_buff;
 
-  m = XNEW (macro_context);
+  m = &context->mc_storage;
   m->macro_node = macro;
   m->virt_locs = virt_locs;
   m->cur_virt_loc = virt_locs;
@@ -2487,21 +2491,26 @@ _cpp_push_text_context (cpp_reader *pfile, cpp_hashnode *macro,
 }
 
 /* Creates a buffer that holds tokens a.k.a "token buffer", usually
-   for the purpose of storing them on a cpp_context. If VIRT_LOCS is
-   non-null (which means that -ftrack-macro-expansion is on),
-   *VIRT_LOCS is set to a newly allocated buffer that is supposed to
-   hold the virtual locations of the tokens resulting from macro
+   for the purpose of storing them on a cpp_context.  The buffer
+   comes from the pool, and is released along with the context.  If
+   VIRT_LOCS is non-null (which means that -ftrack-macro-expansion is
+   on), *VIRT_LOCS is set to the part of the buffer that is supposed
+   to hold the virtual locations of the tokens resulting from macro
    expansion.  */
 static _cpp_buff*
 tokens_buff_new (cpp_reader *pfile, size_t len,
 		 location_t **virt_locs)
 {
   size_t tokens_size = len * sizeof (cpp_token *);
-  size_t locs_size = len * sizeof (location_t);
+  size_t locs_size = virt_locs != NULL ? len * sizeof (location_t) : 0;
+  _cpp_buff *buff = _cpp_get_pooled_buff (pfile, tokens_size + locs_size);
 
+  /* The virtual locations go in the same buffer, right after the
+     tokens; tokens_buff_add_token relies on that to check that no more
+     than LEN tokens are added.  */
   if (virt_locs != NULL)
-    *virt_locs = XNEWVEC (location_t, locs_size);
-  return _cpp_get_buff (pfile, tokens_size);
+    *virt_locs = (location_t *) (buff->base + tokens_size);
+  return buff;
 }
 
 /* Returns the number of tokens contained in a token buffer.  The
@@ -2614,8 +2623,11 @@ tokens_buff_add_token (_cpp_buff *buffer,
   unsigned token_index = 
     (BUFF_FRONT (buffer) - buffer->base) / sizeof (cpp_token *);
 
-  /* Abort if we pass the end the buffer.  */
-  if (BUFF_FRONT (buffer) > BUFF_LIMIT (buffer))
+  /* Abort if we pass the end the buffer, or with -ftrack-macro-expansion
+     the start of the virtual locations, which follow the tokens.  */
+  if (BUFF_FRONT (buffer) > BUFF_LIMIT (buffer)
+      || (virt_locs != NULL
+	  && BUFF_FRONT (buffer) >= (unsigned char *) virt_locs))
     abort ();
 
   if (virt_locs != NULL)
@@ -2630,20 +2642,59 @@ tokens_buff_add_token (_cpp_buff *buffer,
   return result;
 }
 
+/* Replace *BUFF, of which the first USED bytes are in use, with a
+   buffer from the pool holding at least SIZE bytes and a copy of them.
+   *BUFF may be NULL, in which case USED must be zero.  Return the size
+   of the new buffer.  */
+static size_t
+extend_pooled_array (cpp_reader *pfile, _cpp_buff **buff, size_t used,
+		     size_t size)
+{
+  _cpp_buff *new_buff = _cpp_get_pooled_buff (pfile, size);
+
+  if (*buff)
+    {
+      memcpy (new_buff->base, (*buff)->base, used);
+      _cpp_release_pooled_buff (pfile, *buff);
+    }
+  *buff = new_buff;
+  return new_buff->limit - new_buff->base;
+}
+
 /* Allocate space for the function-like macro argument ARG to store
    the tokens resulting from the macro-expansion of the tokens that
-   make up ARG itself. That space is allocated in ARG->expanded and
-   needs to be freed using free.  */
+   make up ARG itself, and their virtual locations, keeping the
+   EXPANDED_COUNT tokens already there.  That space is allocated in
+   ARG->expanded_buff and needs to be released with
+   _cpp_release_pooled_buff.  */
 static void
 alloc_expanded_arg_mem (cpp_reader *pfile, macro_arg *arg, size_t capacity)
 {
-  gcc_checking_assert (arg->expanded == NULL
-		       && arg->expanded_virt_locs == NULL);
+  size_t tokens_size = capacity * sizeof (const cpp_token *);
+  size_t locs_size = 0;
+  _cpp_buff *old_buff = arg->expanded_buff;
 
-  arg->expanded = XNEWVEC (const cpp_token *, capacity);
   if (CPP_OPTION (pfile, track_macro_expansion))
-    arg->expanded_virt_locs = XNEWVEC (location_t, capacity);
+    locs_size = capacity * sizeof (location_t);
 
+  arg->expanded_buff = _cpp_get_pooled_buff (pfile, tokens_size + locs_size);
+  const cpp_token **expanded = (const cpp_token **) arg->expanded_buff->base;
+  location_t *expanded_virt_locs = NULL;
+  if (locs_size)
+    expanded_virt_locs
+      = (location_t *) (arg->expanded_buff->base + tokens_size);
+
+  if (old_buff)
+    {
+      memcpy (expanded, arg->expanded,
+	      arg->expanded_count * sizeof (const cpp_token *));
+      if (locs_size)
+	memcpy (expanded_virt_locs, arg->expanded_virt_locs,
+		arg->expanded_count * sizeof (location_t));
+      _cpp_release_pooled_buff (pfile, old_buff);
+    }
+  arg->expanded = expanded;
+  arg->expanded_virt_locs = expanded_virt_locs;
 }
 
 /* If necessary, enlarge ARG->expanded to so that it can contain SIZE
@@ -2656,20 +2707,34 @@ ensure_expanded_arg_room (cpp_reader *pfile, macro_arg *arg,
     return;
 
   size *= 2;
-
-  arg->expanded =
-    XRESIZEVEC (const cpp_token *, arg->expanded, size);
+  alloc_expanded_arg_mem (pfile, arg, size);
   *expanded_capacity = size;
+}
 
-  if (CPP_OPTION (pfile, track_macro_expansion))
+/* Return true if expanding the tokens of the macro argument ARG would
+   give back the same tokens, at the same locations: none of them is
+   a name that might be a macro, a token to be pasted or a comment.  */
+static bool
+arg_expands_to_itself_p (cpp_reader *pfile, const macro_arg *arg)
+{
+  bool track_macro_exp_p = CPP_OPTION (pfile, track_macro_expansion);
+
+  if (pfile->state.directive_file_token)
+    return false;
+
+  for (unsigned int i = 0; i < arg->count; i++)
     {
-      if (arg->expanded_virt_locs == NULL)
-	arg->expanded_virt_locs = XNEWVEC (location_t, size);
-      else
-	arg->expanded_virt_locs = XRESIZEVEC (location_t,
-					      arg->expanded_virt_locs,
-					      size);
+      const cpp_token *token = arg->first[i];
+      if ((token->type == CPP_NAME
+	   && token->val.node.node->type != NT_VOID)
+	  || token->type == CPP_COMMENT
+	  || (token->flags & PASTE_LEFT)
+	  || (track_macro_exp_p
+	      && arg->virt_locs[i] == 0
+	      && token->src_loc != 0))
+	return false;
     }
+  return true;
 }
 
 /* Expand an argument ARG before replacing parameters in a
@@ -2690,6 +2755,16 @@ expand_arg (cpp_reader *pfile, macro_arg *arg)
       || arg->expanded != NULL)
     return;
 
+  /* Share the tokens of an argument that needs no expansion rather
+     than copying them.  */
+  if (arg_expands_to_itself_p (pfile, arg))
+    {
+      arg->expanded = arg->first;
+      arg->expanded_virt_locs = arg->virt_locs;
+      arg->expanded_count = arg->count;
+      return;
+    }
+
   /* Don't warn about funlike macros when pre-expanding.  */
   saved_warn_trad = CPP_WTRADITIONAL (pfile);
   CPP_WTRADITIONAL (pfile) = 0;
@@ -2763,9 +2838,10 @@ in_macro_expansion_p (cpp_reader *pfile)
 }
 
 /* Pop the current context off the stack, re-enabling the macro if the
-   context represented a macro's replacement list.  Initially the
-   context structure was not freed so that we can re-use it later, but
-   now we do free it to reduce peak memory consumption.  */
+   context represented a macro's replacement list.  The context
+   structure is kept for re-use by next_context, but the buffer it
+   owns goes back to the pool straight away so that it can be reused
+   by the next expansion and peak memory consumption stays low.  */
 void
 _cpp_pop_context (cpp_reader *pfile)
 {
@@ -2781,16 +2857,9 @@ _cpp_pop_context (cpp_reader *pfile)
 	{
 	  macro_context *mc = context->c.mc;
 	  macro = mc->macro_node;
-	  /* If context->buff is set, it means the life time of tokens
-	     is bound to the life time of this context; so we must
-	     free the tokens; that means we must free the virtual
-	     locations of these tokens too.  */
-	  if (context->buff && mc->virt_locs)
-	    {
-	      free (mc->virt_locs);
-	      mc->virt_locs = NULL;
-	    }
-	  free (mc);
+	  /* If context->buff is set, the virtual locations of the
+	     tokens are in it, and go with it.  */
+	  mc->virt_locs = NULL;
 	  context->c.mc = NULL;
 	}
       else
@@ -2818,15 +2887,11 @@ _cpp_pop_context (cpp_reader *pfile)
 
   if (context->buff)
     {
-      /* Decrease memory peak consumption by freeing the memory used
-	 by the context.  */
-      _cpp_free_buff (context->buff);
+      _cpp_release_pooled_buff (pfile, context->buff);
+      context->buff = NULL;
     }
 
   pfile->context = context->prev;
-  /* decrease peak memory consumption by feeing the context.  */
-  pfile->context->next = NULL;
-  free (context);
 }
 
 /* Return TRUE if we reached the end of the set of tokens stored in
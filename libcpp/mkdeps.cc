@@ -24,6 +24,7 @@ along with this program; see the file COPYING3.  If not see
 #include "system.h"
 #include "mkdeps.h"
 #include "internal.h"
+#include "md5.h"
 
 /* Not set up to just include std::vector et al, here's a simple
    implementation.  */
@@ -628,6 +629,81 @@ deps_write_p1689r5 (const struct mkdeps *d, FILE *fp)
   fputs ("}\n", fp);
 }
 
+/* htab_traverse callback for deps_write_digests: write the line for
+   the nonexistent file *SLOT to the FILE in DATA, or clear its FILE if
+   the name does not fit on one line.  */
+
+static int
+write_nonexistent_file (void **slot, void *data)
+{
+  const char *name = (const char *) *slot;
+  FILE **fpp = (FILE **) data;
+
+  if (strchr (name, '\n'))
+    {
+      *fpp = NULL;
+      return 0;
+    }
+  fprintf (*fpp, "-------------------------------- %s\n", name);
+  return 1;
+}
+
+/* Write out the MD5 digest of the contents of each dependency of
+   PFILE to FP, as a line "gcc-depfile-digests KEY" followed by a line
+   with the digest in hex and the name of each dependency.  Then write
+   a line with dashes in place of the digest for each file that was
+   looked for in the include path and not found, and for each
+   directory of the include path that does not exist: one created
+   since, by shadowing a dependency or by changing what #include_next
+   or __has_include find, may change the output.  The driver reuses the
+   output of the compilation while these all still match.  Returns
+   nonzero if a dependency cannot be read, a name does not fit on one
+   line, or a dependency was modified at or after SINCE, the time the
+   compilation started, as it might then have changed after it was
+   read; the digests must not be used in that case.  */
+
+int
+deps_write_digests (const cpp_reader *pfile, FILE *fp, const char *key,
+		    time_t since)
+{
+  const class mkdeps *d = pfile->deps;
+  FILE *nonexistent_fp = fp;
+
+  fprintf (fp, "gcc-depfile-digests %s\n", key);
+
+  for (unsigned i = 0; i < d->deps.size (); i++)
+    {
+      const char *name = d->deps[i];
+      unsigned char sum[16];
+      struct stat st;
+      FILE *f;
+      int bad;
+
+      if (strchr (name, '\n'))
+	return -1;
+      f = fopen (name, "rb");
+      if (!f)
+	return -1;
+      bad = (fstat (fileno (f), &st) != 0
+	     || st.st_mtime >= since
+	     || md5_stream (f, sum) != 0);
+      fclose (f);
+      if (bad)
+	return -1;
+
+      for (unsigned j = 0; j < sizeof (sum); j++)
+	fprintf (fp, "%02x", sum[j]);
+      fprintf (fp, " %s\n", name);
+    }
+
+  htab_traverse_noresize (pfile->nonexistent_file_hash,
+			  write_nonexistent_file, &nonexistent_fp);
+  if (!nonexistent_fp)
+    return -1;
+
+  return ferror (fp) ? -1 : 0;
+}
+
 /* Write out a deps buffer to a file, in a form that can be read back
    with deps_restore.  Returns nonzero on error, in which case the
    error number will be in errno.  */
@@ -256,13 +256,10 @@ allocate_filename_struct (struct gcov_filename *gf)
     gf->prefix = NULL;
 }
 
-/* Open a gcda file specified by GI_FILENAME.
-   Return -1 on error.  Return 0 on success.  */
+/* Build in GF->FILENAME the relocated name of the gcda file of GI_PTR.  */
 
-static int
-gcov_exit_open_gcda_file (struct gcov_info *gi_ptr,
-			  struct gcov_filename *gf,
-			  int mode)
+static void
+gcov_build_gcda_filename (struct gcov_info *gi_ptr, struct gcov_filename *gf)
 {
   int append_slash = 0;
   const char *fname = gi_ptr->filename;
@@ -309,6 +306,17 @@ gcov_exit_open_gcda_file (struct gcov_info *gi_ptr,
   strcat (gf->filename, fname);
 
   gf->filename = replace_filename_variables (gf->filename);
+}
+
+/* Open a gcda file specified by GI_FILENAME.
+   Return -1 on error.  Return 0 on success.  */
+
+static int
+gcov_exit_open_gcda_file (struct gcov_info *gi_ptr,
+			  struct gcov_filename *gf,
+			  int mode)
+{
+  gcov_build_gcda_filename (gi_ptr, gf);
 
   if (!gcov_open (gf->filename, mode))
     {
@@ -328,3 +336,90 @@ gcov_exit_open_gcda_file (struct gcov_info *gi_ptr,
 
   return 0;
 }
+
+#if !IN_GCOV_TOOL && GCOV_LOCKED
+/* Suffix of a profile shard being written.  gcov-tool merge-shards only
+   picks up files ending in GCOV_SHARD_SUFFIX, so it never reads a shard
+   before gcov_exit_close_shard_file linked it into place.  */
+#define GCOV_SHARD_TMP_SUFFIX ".tmp"
+
+/* Create a new profile shard for this process in directory DIR and open
+   it for writing under a temporary name.  The name is made unique with
+   O_EXCL rather than by locking, so processes sharing DIR (even across
+   hosts) never wait on each other.  Return the malloced temporary name,
+   or NULL on error.  */
+
+static char *
+gcov_exit_open_shard_file (const char *dir)
+{
+  size_t length = strlen (dir);
+  char *filename = (char *) xmalloc (length + 48);
+  unsigned seq = 0;
+  int made_dir = 0;
+  int fd;
+
+  while (1)
+    {
+      sprintf (filename, "%s/%ld.%u" GCOV_SHARD_SUFFIX GCOV_SHARD_TMP_SUFFIX,
+	       dir, (long) getpid (), seq);
+      fd = open (filename, O_WRONLY | O_CREAT | O_EXCL, 0666);
+      if (fd >= 0)
+	break;
+      if (errno == EEXIST)
+	seq++;
+      else if (errno == ENOENT && !made_dir
+	       && !create_file_directory (filename))
+	/* DIR was missing; it exists now, so retry.  */
+	made_dir = 1;
+      else
+	{
+	  fprintf (stderr, "profiling:%s:Cannot create shard\n", filename);
+	  free (filename);
+	  return NULL;
+	}
+    }
+  close (fd);
+
+  if (!gcov_open (filename, -1))
+    {
+      fprintf (stderr, "profiling:%s:Cannot open\n", filename);
+      unlink (filename);
+      free (filename);
+      return NULL;
+    }
+
+  return filename;
+}
+
+/* Publish the profile shard written in directory DIR under the temporary
+   name FILENAME, or remove it if FAILED is nonzero.  The shard is linked
+   to a free final name rather than renamed, as rename would silently
+   replace a shard of the same name published by a process with the same
+   pid on another host sharing DIR.  Return nonzero if the shard was not
+   published.  */
+
+static int
+gcov_exit_close_shard_file (const char *dir, char *filename, int failed)
+{
+  char *final = (char *) xmalloc (strlen (dir) + 48);
+  unsigned seq = 0;
+
+  while (!failed)
+    {
+      sprintf (final, "%s/%ld.%u" GCOV_SHARD_SUFFIX, dir, (long) getpid (),
+	       seq);
+      if (link (filename, final) == 0)
+	break;
+      if (errno == EEXIST)
+	seq++;
+      else
+	{
+	  fprintf (stderr, "profiling:%s:Cannot publish shard\n", filename);
+	  failed = 1;
+	}
+    }
+  unlink (filename);
+  free (final);
+  return failed;
+}
+#endif
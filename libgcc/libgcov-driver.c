@@ -608,21 +608,23 @@ write_one_data (const struct gcov_info *gi_ptr,
    this program's checksum to make sure we only accumulate whole program
    statistics to the correct summary. An object file might be embedded
    in two separate programs, and we must keep the two program
-   summaries separate.  */
+   summaries separate.  Return nonzero if the data could not be
+   written.  */
 
-static void
+static int
 dump_one_gcov (struct gcov_info *gi_ptr, struct gcov_filename *gf,
 	       unsigned run_counted ATTRIBUTE_UNUSED,
 	       gcov_type run_max ATTRIBUTE_UNUSED, int mode)
 {
   struct gcov_summary summary = {};
   int error;
+  int failed = 0;
   gcov_unsigned_t tag;
   fn_buffer = 0;
 
   error = gcov_exit_open_gcda_file (gi_ptr, gf, mode);
   if (error == -1)
-    return;
+    return 1;
 
   tag = gcov_read_unsigned ();
   if (tag)
@@ -632,11 +634,15 @@ dump_one_gcov (struct gcov_info *gi_ptr, struct gcov_filename *gf,
         {
 	  gcov_error (GCOV_PROF_PREFIX "Not a gcov data file\n",
 		      gf->filename);
+	  failed = 1;
           goto read_fatal;
         }
       error = merge_one_data (gf->filename, gi_ptr, &summary);
       if (error == -1)
-        goto read_fatal;
+	{
+	  failed = 1;
+	  goto read_fatal;
+	}
     }
 
   gcov_rewrite ();
@@ -660,23 +666,100 @@ read_fatal:;
     fn_buffer = free_fn_data (gi_ptr, fn_buffer, GCOV_COUNTERS);
 
   if ((error = gcov_close ()))
-    gcov_error ((error < 0 ? GCOV_PROF_PREFIX "Overflow writing\n"
-		 : GCOV_PROF_PREFIX "Error writing\n"), gf->filename);
+    {
+      gcov_error ((error < 0 ? GCOV_PROF_PREFIX "Overflow writing\n"
+		   : GCOV_PROF_PREFIX "Error writing\n"), gf->filename);
+      failed = 1;
+    }
+  return failed;
 }
 
 
+#if IN_GCOV_TOOL || GCOV_LOCKED
+/* Write every gcov_info object in LIST, each preceded by a filename header
+   naming its gcda file, to the already opened profile shard SHARD.  Unlike
+   dump_one_gcov nothing is read back: the summary only accounts for this
+   run and the counters are merged later by gcov-tool.  Return nonzero
+   if SHARD could not be written.  */
+
+static int
+write_gcov_stream (struct gcov_info *list, const char *shard,
+		   struct gcov_filename *gf, unsigned run_counted ATTRIBUTE_UNUSED,
+		   gcov_type run_max ATTRIBUTE_UNUSED)
+{
+  struct gcov_info *gi_ptr;
+  int error;
+
+  for (gi_ptr = list; gi_ptr; gi_ptr = gi_ptr->next)
+    {
+      struct gcov_summary summary = {};
+
+#if !IN_GCOV_TOOL
+      gcov_build_gcda_filename (gi_ptr, gf);
+      if (!run_counted)
+	{
+	  summary.runs = 1;
+	  summary.sum_max = run_max;
+	}
+#else
+      gf->filename = xstrdup (gi_ptr->filename);
+      summary = gi_ptr->summary;
+#endif
+
+      dump_unsigned (GCOV_FILENAME_MAGIC, gcov_dump_handler, NULL);
+      dump_unsigned (GCOV_VERSION, gcov_dump_handler, NULL);
+      dump_string (gf->filename, gcov_dump_handler, NULL);
+      fn_buffer = 0;
+      write_one_data (gi_ptr, &summary, gcov_dump_handler,
+		      gcov_allocate_handler, NULL);
+      free (gf->filename);
+    }
+
+  if ((error = gcov_close ()))
+    {
+      gcov_error ((error < 0 ? GCOV_PROF_PREFIX "Overflow writing\n"
+		   : GCOV_PROF_PREFIX "Error writing\n"), shard);
+      return 1;
+    }
+  return 0;
+}
+#endif
+
+#if IN_GCOV_TOOL
+/* Write the gcov_info objects in LIST as one profile shard FILENAME, in
+   the same format the runtime uses under GCOV_PROFILE_SHARDS.  Return
+   nonzero on error.  */
+
+int
+gcov_dump_stream (struct gcov_info *list, const char *filename)
+{
+  struct gcov_filename gf;
+
+  if (!gcov_open (filename, -1))
+    {
+      gcov_error (GCOV_PROF_PREFIX "Cannot open\n", filename);
+      return 1;
+    }
+
+  gf.prefix = NULL;
+  return write_gcov_stream (list, filename, &gf, 0, 0);
+}
+#endif
+
 /* Dump all the coverage counts for the program. It first computes program
    summary and then traverses gcov_list list and dumps the gcov_info
-   objects one by one.  Use MODE to open files.  */
+   objects one by one.  Use MODE to open files.  Return nonzero if any
+   of them could not be written.  */
 
 #if !IN_GCOV_TOOL
 static
 #endif
-void
+int
 gcov_do_dump (struct gcov_info *list, int run_counted, int mode)
 {
   struct gcov_info *gi_ptr;
   struct gcov_filename gf;
+  int failed = 0;
 
   /* Compute run_max of this program run.  */
   gcov_type run_max = 0;
@@ -693,14 +776,34 @@ gcov_do_dump (struct gcov_info *list, int run_counted, int mode)
 
   allocate_filename_struct (&gf);
 
+#if !IN_GCOV_TOOL && GCOV_LOCKED
+  /* With GCOV_PROFILE_SHARDS set, append-only shards replace the
+     read-merge-write cycle on the shared gcda files.  */
+  const char *shard_dir = getenv ("GCOV_PROFILE_SHARDS");
+  if (shard_dir && *shard_dir)
+    {
+      char *shard = gcov_exit_open_shard_file (shard_dir);
+      failed = 1;
+      if (shard)
+	{
+	  failed = write_gcov_stream (list, shard, &gf, run_counted, run_max);
+	  failed = gcov_exit_close_shard_file (shard_dir, shard, failed);
+	  free (shard);
+	}
+      free (gf.prefix);
+      return failed;
+    }
+#endif
+
   /* Now merge each file.  */
   for (gi_ptr = list; gi_ptr; gi_ptr = gi_ptr->next)
     {
-      dump_one_gcov (gi_ptr, &gf, run_counted, run_max, mode);
+      failed |= dump_one_gcov (gi_ptr, &gf, run_counted, run_max, mode);
       free (gf.filename);
     }
 
   free (gf.prefix);
+  return failed;
 }
 
 #if IN_GCOV_TOOL
@@ -719,6 +822,9 @@ __gcov_dump_one (struct gcov_root *root)
   if (root->dumped)
     return;
 
+  if (__gcov_shard_fold_hook)
+    __gcov_shard_fold_hook (0);
+
   gcov_do_dump (root->list, root->run_counted, 0);
   
   root->dumped = 1;
@@ -728,6 +834,9 @@ __gcov_dump_one (struct gcov_root *root)
 /* Per-dynamic-object gcov state.  */
 struct gcov_root __gcov_root;
 
+/* Folds the thread-local counter shards of this object, if any.  */
+void (*__gcov_shard_fold_hook) (int);
+
 /* Exactly one of these will be live in the process image.  */
 struct gcov_master __gcov_master = 
   {GCOV_VERSION, 0};
@@ -745,6 +854,8 @@ void
 __gcov_exit (void)
 {
   __gcov_dump_one (&__gcov_root);
+  if (__gcov_shard_fold_hook)
+    __gcov_shard_fold_hook (1);
   if (__gcov_root.next)
     __gcov_root.next->prev = __gcov_root.prev;
   if (__gcov_root.prev)
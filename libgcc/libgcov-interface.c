@@ -122,6 +122,11 @@ __gcov_reset_int (void)
 
   /* If we're compatible with the master, iterate over everything,
      otherise just do us.  */
+  /* Fold the counter shards first, so that what the threads counted so
+     far is cleared as well.  */
+  if (__gcov_shard_fold_hook)
+    __gcov_shard_fold_hook (0);
+
   for (root = __gcov_master.version == GCOV_VERSION
 	 ? __gcov_master.root : &__gcov_root; root; root = root->next)
     {
@@ -174,6 +179,196 @@ __gcov_dump (void)
 
 #endif /* L_gcov_dump */
 
+#ifdef L_gcov_shard
+#if defined(HAVE_CC_TLS) && !defined (USE_EMUTLS)
+/* With -fprofile-update=sharded each thread increments a thread-local
+   shard of the edge counters of a function, without atomic operations.
+   The thread registers the shard the first time it runs the function,
+   and the registered shards are added to the counters when the thread
+   exits and when the profile is dumped or reset.  Code that runs in a
+   thread after its shards were folded at exit increments the counters
+   directly.  */
+
+/* A registered shard of the N counters COUNTERS.  FLUSHED is the part of
+   SHARD already added to COUNTERS, so that the shard can be folded while
+   its thread keeps incrementing it.  */
+
+struct gcov_shard
+{
+  struct gcov_shard *next;
+  gcov_type *counters;
+  gcov_type *shard;
+  unsigned n;
+  gcov_type flushed[];
+};
+
+/* The shards registered by one thread.  */
+
+struct gcov_shard_thread
+{
+  struct gcov_shard_thread *next;
+  struct gcov_shard_thread **prevp;
+  struct gcov_shard *shards;
+};
+
+/* Live threads that registered shards, and the current one.  */
+static struct gcov_shard_thread *gcov_shard_threads;
+static __thread struct gcov_shard_thread *gcov_shard_self;
+
+/* Set once the shards of the current thread were folded at its exit.  */
+static __thread int gcov_shard_exited;
+
+/* Key whose destructor folds the shards of an exiting thread.  It is
+   deleted when the object's profile is finally dumped.  */
+static __gthread_key_t gcov_shard_key;
+static int gcov_shard_key_valid;
+
+#ifdef __GTHREAD_MUTEX_INIT
+static __gthread_mutex_t gcov_shard_mx = __GTHREAD_MUTEX_INIT;
+#else
+static __gthread_mutex_t gcov_shard_mx;
+#endif
+
+/* Add what the shards of thread T counted since the last call to their
+   counters.  T may be another thread, which keeps incrementing its
+   shards meanwhile.  */
+
+static void
+gcov_shard_fold_thread (struct gcov_shard_thread *t)
+{
+  struct gcov_shard *s;
+
+  for (s = t->shards; s; s = s->next)
+    for (unsigned i = 0; i != s->n; i++)
+      {
+#if GCOV_SUPPORTS_ATOMIC
+	gcov_type value = __atomic_load_n (&s->shard[i], __ATOMIC_RELAXED);
+#else
+	gcov_type value = s->shard[i];
+#endif
+	s->counters[i] += value - s->flushed[i];
+	s->flushed[i] = value;
+      }
+}
+
+/* Fold the shards of all threads.  If RELEASE, the profile is dumped for
+   the last time, stop folding the shards of exiting threads.  */
+
+static void
+gcov_shard_fold (int release)
+{
+  struct gcov_shard_thread *t;
+
+  __gthread_mutex_lock (&gcov_shard_mx);
+  for (t = gcov_shard_threads; t; t = t->next)
+    gcov_shard_fold_thread (t);
+  if (release && gcov_shard_key_valid)
+    {
+      __gthread_key_delete (gcov_shard_key);
+      gcov_shard_key_valid = 0;
+    }
+  __gthread_mutex_unlock (&gcov_shard_mx);
+}
+
+/* Fold and release the shards of the exiting thread ARG.  */
+
+static void
+gcov_shard_thread_exit (void *arg)
+{
+  struct gcov_shard_thread *t = (struct gcov_shard_thread *) arg;
+  struct gcov_shard *s, *next;
+
+  __gthread_mutex_lock (&gcov_shard_mx);
+  gcov_shard_fold_thread (t);
+  *t->prevp = t->next;
+  if (t->next)
+    t->next->prevp = t->prevp;
+  __gthread_mutex_unlock (&gcov_shard_mx);
+
+  /* Have the functions register their shards again, so that from now on
+     they increment the counters.  */
+  for (s = t->shards; s; s = next)
+    {
+      next = s->next;
+      s->shard[s->n] = 0;
+      free (s);
+    }
+  free (t);
+  gcov_shard_self = NULL;
+  gcov_shard_exited = 1;
+}
+
+static void
+gcov_shard_init (void)
+{
+#ifndef __GTHREAD_MUTEX_INIT
+  __GTHREAD_MUTEX_INIT_FUNCTION (&gcov_shard_mx);
+#endif
+  if (__gthread_key_create (&gcov_shard_key, gcov_shard_thread_exit) == 0)
+    gcov_shard_key_valid = 1;
+}
+
+/* Register SHARD, the current thread's shard of the N edge COUNTERS of a
+   function, and return the counters the function should increment.
+   SHARD[N] is set once SHARD is registered.  Once the shards of the
+   current thread were folded at its exit, or if SHARD cannot be
+   registered, return COUNTERS and leave SHARD[N] clear, so that the
+   function calls this again the next time it runs.  */
+
+gcov_type *
+__gcov_shard_register (gcov_type *counters, gcov_type *shard, unsigned n)
+{
+  static __gthread_once_t once = __GTHREAD_ONCE_INIT;
+  struct gcov_shard_thread *t;
+  struct gcov_shard *s;
+
+  /* Without threads there is no key, and the shards of the only thread
+     are folded when the profile is dumped.  */
+  __gthread_once (&once, gcov_shard_init);
+
+  if (gcov_shard_exited)
+    return counters;
+
+  s = (struct gcov_shard *) malloc (sizeof (struct gcov_shard)
+				    + n * sizeof (gcov_type));
+  if (!s)
+    return counters;
+  s->counters = counters;
+  s->shard = shard;
+  s->n = n;
+  memset (s->flushed, 0, n * sizeof (gcov_type));
+
+  __gthread_mutex_lock (&gcov_shard_mx);
+  t = gcov_shard_self;
+  if (!t)
+    {
+      t = (struct gcov_shard_thread *) calloc (1, sizeof (*t));
+      if (!t)
+	{
+	  __gthread_mutex_unlock (&gcov_shard_mx);
+	  free (s);
+	  return counters;
+	}
+      t->next = gcov_shard_threads;
+      t->prevp = &gcov_shard_threads;
+      if (t->next)
+	t->next->prevp = &t->next;
+      gcov_shard_threads = t;
+      gcov_shard_self = t;
+      if (gcov_shard_key_valid)
+	__gthread_setspecific (gcov_shard_key, t);
+      __gcov_shard_fold_hook = gcov_shard_fold;
+    }
+  s->next = t->shards;
+  t->shards = s;
+  __gthread_mutex_unlock (&gcov_shard_mx);
+
+  shard[n] = 1;
+  return shard;
+}
+#endif /* HAVE_CC_TLS && !USE_EMUTLS */
+#endif /* L_gcov_shard */
+
 #ifdef L_gcov_fork
 /* A wrapper for the fork function.  We reset counters in the child
    so that they are not counted twice.  */
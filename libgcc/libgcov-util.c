@@ -52,6 +52,7 @@ void gcov_set_verbose (void)
 /* The following part is to read Gcda and reconstruct GCOV_INFO.  */
 
 #include "obstack.h"
+#include "hashtab.h"
 #include <unistd.h>
 #ifdef HAVE_FTW_H
 #include <ftw.h>
@@ -830,6 +831,98 @@ gcov_profile_merge_stream (const char *filename, int w1, int w2)
   return gcov_profile_merge (tgt_profile, src_profile, w1, w2);
 }
 
+/* Hash and equality functions for the gcov_info table of
+   gcov_profile_fold_shards, keyed by gcda filename.  */
+
+static hashval_t
+htab_info_hash (const void *p)
+{
+  return htab_hash_string (((const struct gcov_info *) p)->filename);
+}
+
+static int
+htab_info_eq (const void *p1, const void *p2)
+{
+  return !strcmp (((const struct gcov_info *) p1)->filename,
+		  ((const struct gcov_info *) p2)->filename);
+}
+
+/* Read the N_SHARDS profile shards named by SHARDS and sum them into one
+   profile list holding a single gcov_info object per gcda file.  Shards
+   that cannot be read are skipped, and so are the profiles of a shard
+   that do not match the ones read before.  If FOLDED is not NULL, set
+   FOLDED[I] to 1 if all of shard I was summed and to 0 otherwise.
+   Return the list, or NULL if it is empty.  */
+
+struct gcov_info *
+gcov_profile_fold_shards (const char *const *shards, int n_shards,
+			  char *folded)
+{
+  struct gcov_info *head = NULL;
+  htab_t infos = htab_create (64, htab_info_hash, htab_info_eq, NULL);
+
+  for (int i = 0; i < n_shards; i++)
+    {
+      struct gcov_info *gi_ptr, *next;
+
+      if (folded)
+	folded[i] = 0;
+      if (!gcov_open (shards[i], 1))
+	{
+	  fnotice (stderr, "%s:cannot open:%s\n", shards[i],
+		   xstrerror (errno));
+	  continue;
+	}
+      if (verbose)
+	fnotice (stderr, "reading shard: %s\n", shards[i]);
+      gi_ptr = deserialize_profiles (shards[i]);
+      /* The stream was only read to its end if it stopped at EOF (2).  */
+      if (folded)
+	folded[i] = gcov_is_error () == 2;
+      gcov_close ();
+
+      for (; gi_ptr; gi_ptr = next)
+	{
+	  next = gi_ptr->next;
+
+	  void **slot = htab_find_slot (infos, gi_ptr, INSERT);
+	  struct gcov_info *match = (struct gcov_info *) *slot;
+	  if (!match)
+	    {
+	      *slot = gi_ptr;
+	      gi_ptr->next = head;
+	      head = gi_ptr;
+	    }
+	  else if (match->n_functions != gi_ptr->n_functions)
+	    {
+	      fnotice (stderr, "mismatched profiles in %s (%d functions"
+		       " vs %d functions)\n", match->filename,
+		       match->n_functions, gi_ptr->n_functions);
+	      if (folded)
+		folded[i] = 0;
+	    }
+	  else
+	    gcov_merge (match, gi_ptr, 1);
+	}
+    }
+
+  htab_delete (infos);
+  return head;
+}
+
+/* Merge the profile list SRC_PROFILE, as returned by
+   gcov_profile_fold_shards, into the gcda files it names using weights W1
+   for the existing files and W2 for SRC_PROFILE.  Return the list of merged
+   gcov_info objects.  Return NULL if the list is empty.  */
+
+struct gcov_info *
+gcov_profile_merge_into_gcda (struct gcov_info *src_profile, int w1, int w2)
+{
+  struct gcov_info *tgt_profile = get_target_profiles_for_merge (src_profile);
+
+  return gcov_profile_merge (tgt_profile, src_profile, w1, w2);
+}
+
 typedef gcov_type (*counter_op_fn) (gcov_type, void*, void*);
 
 /* Performing FN upon arc counters.  */
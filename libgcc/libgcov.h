@@ -294,6 +294,16 @@ extern void __gcov_dump_int (void) ATTRIBUTE_HIDDEN;
 /* Lock critical section for __gcov_dump and __gcov_reset functions.  */
 extern void __gcov_lock (void) ATTRIBUTE_HIDDEN;
 
+/* Add the thread-local shards of the edge counters to the counters, and
+   if the argument is nonzero stop folding them when threads exit.  Set
+   once a shard is registered.  */
+extern void (*__gcov_shard_fold_hook) (int) ATTRIBUTE_HIDDEN;
+
+/* Register the thread-local shard of the edge counters of a function and
+   return the counters it should increment.  */
+extern gcov_type *__gcov_shard_register (gcov_type *, gcov_type *,
+					 unsigned) ATTRIBUTE_HIDDEN;
+
 /* Unlock critical section for __gcov_dump and __gcov_reset functions.  */
 extern void __gcov_unlock (void) ATTRIBUTE_HIDDEN;
 
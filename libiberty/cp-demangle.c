@@ -6785,6 +6785,78 @@ cplus_demangle_init_info (const char *mangled, int options, size_t len,
   di->recursion_level = 0;
 }
 
+/* The kinds of string that the demangler entry points accept.  */
+
+enum d_string_kind
+{
+  DCT_NONE,
+  DCT_TYPE,
+  DCT_MANGLED,
+  DCT_GLOBAL_CTORS,
+  DCT_GLOBAL_DTORS
+};
+
+/* Return the kind of MANGLED, or DCT_NONE if it is not something we
+   should try to demangle with OPTIONS.  */
+
+static enum d_string_kind
+d_string_kind (const char *mangled, int options)
+{
+  if (mangled[0] == '_' && mangled[1] == 'Z')
+    return DCT_MANGLED;
+  else if (strncmp (mangled, "_GLOBAL_", 8) == 0
+	   && (mangled[8] == '.' || mangled[8] == '_' || mangled[8] == '$')
+	   && (mangled[9] == 'D' || mangled[9] == 'I')
+	   && mangled[10] == '_')
+    return mangled[9] == 'I' ? DCT_GLOBAL_CTORS : DCT_GLOBAL_DTORS;
+  else if ((options & DMGL_TYPES) != 0)
+    return DCT_TYPE;
+  else
+    return DCT_NONE;
+}
+
+/* Parse the string of kind TYPE that DI was initialized with, using
+   the comps and subs arrays DI already points to.  Return the tree, or
+   NULL on failure.  */
+
+static struct demangle_component *
+d_demangle_parse (struct d_info *di, enum d_string_kind type, int options)
+{
+  struct demangle_component *dc;
+
+  switch (type)
+    {
+    case DCT_TYPE:
+      dc = cplus_demangle_type (di);
+      break;
+    case DCT_MANGLED:
+      dc = cplus_demangle_mangled_name (di, 1);
+      break;
+    case DCT_GLOBAL_CTORS:
+    case DCT_GLOBAL_DTORS:
+      d_advance (di, 11);
+      dc = d_make_comp (di,
+			(type == DCT_GLOBAL_CTORS
+			 ? DEMANGLE_COMPONENT_GLOBAL_CONSTRUCTORS
+			 : DEMANGLE_COMPONENT_GLOBAL_DESTRUCTORS),
+			d_make_demangle_mangled_name (di, d_str (di)),
+			NULL);
+      d_advance (di, strlen (d_str (di)));
+      break;
+    default:
+      abort (); /* We have listed all the cases.  */
+    }
+
+  /* If DMGL_PARAMS is set, then if we didn't consume the entire
+     mangled string, then we didn't successfully demangle it.  If
+     DMGL_PARAMS is not set, we didn't look at the trailing
+     parameters.  */
+  if (((options & DMGL_PARAMS) != 0) && d_peek_char (di) != '\0')
+    dc = NULL;
+
+  return dc;
+}
+
 /* Internal implementation for the demangler.  If MANGLED is a g++ v3 ABI
    mangled name, return strings in repeated callback giving the demangled
    name.  OPTIONS is the usual libiberty demangler options.  On success,
@@ -6794,31 +6866,14 @@ static int
 d_demangle_callback (const char *mangled, int options,
                      demangle_callbackref callback, void *opaque)
 {
-  enum
-    {
-      DCT_TYPE,
-      DCT_MANGLED,
-      DCT_GLOBAL_CTORS,
-      DCT_GLOBAL_DTORS
-    }
-  type;
+  enum d_string_kind type;
   struct d_info di;
   struct demangle_component *dc;
   int status;
 
-  if (mangled[0] == '_' && mangled[1] == 'Z')
-    type = DCT_MANGLED;
-  else if (strncmp (mangled, "_GLOBAL_", 8) == 0
-	   && (mangled[8] == '.' || mangled[8] == '_' || mangled[8] == '$')
-	   && (mangled[9] == 'D' || mangled[9] == 'I')
-	   && mangled[10] == '_')
-    type = mangled[9] == 'I' ? DCT_GLOBAL_CTORS : DCT_GLOBAL_DTORS;
-  else
-    {
-      if ((options & DMGL_TYPES) == 0)
-	return 0;
-      type = DCT_TYPE;
-    }
+  type = d_string_kind (mangled, options);
+  if (type == DCT_NONE)
+    return 0;
 
   di.unresolved_name_state = 1;
 
@@ -6851,35 +6906,7 @@ d_demangle_callback (const char *mangled, int options,
     di.subs = alloca (di.num_subs * sizeof (*di.subs));
 #endif
 
-    switch (type)
-      {
-      case DCT_TYPE:
-	dc = cplus_demangle_type (&di);
-	break;
-      case DCT_MANGLED:
-	dc = cplus_demangle_mangled_name (&di, 1);
-	break;
-      case DCT_GLOBAL_CTORS:
-      case DCT_GLOBAL_DTORS:
-	d_advance (&di, 11);
-	dc = d_make_comp (&di,
-			  (type == DCT_GLOBAL_CTORS
-			   ? DEMANGLE_COMPONENT_GLOBAL_CONSTRUCTORS
-			   : DEMANGLE_COMPONENT_GLOBAL_DESTRUCTORS),
-			  d_make_demangle_mangled_name (&di, d_str (&di)),
-			  NULL);
-	d_advance (&di, strlen (d_str (&di)));
-	break;
-      default:
-	abort (); /* We have listed all the cases.  */
-      }
-
-    /* If DMGL_PARAMS is set, then if we didn't consume the entire
-       mangled string, then we didn't successfully demangle it.  If
-       DMGL_PARAMS is not set, we didn't look at the trailing
-       parameters.  */
-    if (((options & DMGL_PARAMS) != 0) && d_peek_char (&di) != '\0')
-      dc = NULL;
+    dc = d_demangle_parse (&di, type, options);
 
     /* See discussion in d_unresolved_name.  */
     if (dc == NULL && di.unresolved_name_state == -1)
@@ -7082,6 +7109,249 @@ cplus_demangle_v3_callback (const char *mangled, int options,
   return d_demangle_callback (mangled, options, callback, opaque);
 }
 
+/* The number of results a demangle_context remembers.  */
+
+#define D_MEMO_SIZE 256
+
+/* A remembered result.  The buffers are kept when the entry is
+   replaced, so that a context that has warmed up does not allocate.  */
+
+struct d_memo_entry
+{
+  /* The mangled name, or NULL if the entry is unused.  */
+  char *mangled;
+  /* The length of MANGLED, and its allocated size.  */
+  size_t mangled_len;
+  size_t mangled_alc;
+  /* The options the name was demangled with.  */
+  int options;
+  /* Whether demangling failed.  */
+  int failed;
+  /* The demangled name, if it did not fail.  */
+  struct d_growable_string result;
+};
+
+/* Scratch storage for demangling many names, so that the component
+   and substitution arrays and the output buffers are allocated once
+   rather than for every name.  */
+
+struct demangle_context
+{
+  /* The component array, and its allocated size.  */
+  struct demangle_component *comps;
+  int comps_alc;
+  /* The substitution array, and its allocated size.  */
+  struct demangle_component **subs;
+  int subs_alc;
+  /* Recent results, indexed by a hash of the name and options.
+     Symbol tables and dumps name the same functions many times.  */
+  struct d_memo_entry memo[D_MEMO_SIZE];
+};
+
+/* Return the memo hash of MANGLED, which is LEN characters long, for
+   OPTIONS.  This looks at no more than 16 characters, working back from
+   the end, since names in a symbol table mostly share long prefixes.
+   Names whose hashes collide just replace each other.  */
+
+static unsigned int
+d_memo_hash (const char *mangled, size_t len, int options)
+{
+  unsigned int hash;
+  size_t step;
+  size_t i;
+
+  hash = (unsigned int) len * 0x9e3779b1U ^ (unsigned int) options;
+  step = len / 16 + 1;
+  for (i = len; i > 0; i = i > step ? i - step : 0)
+    hash = (hash ^ (unsigned char) mangled[i - 1]) * 16777619U;
+  return hash;
+}
+
+/* Like d_demangle_callback, but take the arrays from CTX.  MANGLED is
+   LEN characters long and of kind TYPE.  Return 1 on success, 0 for a
+   bad name and -1 for a memory allocation failure.  */
+
+static int
+d_demangle_context_callback (struct demangle_context *ctx,
+			     const char *mangled, size_t len,
+			     enum d_string_kind type, int options,
+			     demangle_callbackref callback, void *opaque)
+{
+  struct d_info di;
+  struct demangle_component *dc;
+
+  di.unresolved_name_state = 1;
+
+ again:
+  cplus_demangle_init_info (mangled, options, len, &di);
+
+  /* Keep the limit d_demangle_callback has, so that both give the
+     same results.  */
+  if (((options & DMGL_NO_RECURSE_LIMIT) == 0)
+      && (unsigned long) di.num_comps > DEMANGLE_RECURSION_LIMIT)
+    return 0;
+
+  if (di.num_comps > ctx->comps_alc)
+    {
+      struct demangle_component *comps;
+
+      comps = ((struct demangle_component *)
+	       realloc (ctx->comps, di.num_comps * sizeof (*comps)));
+      if (comps == NULL)
+	return -1;
+      ctx->comps = comps;
+      ctx->comps_alc = di.num_comps;
+    }
+  if (di.num_subs > ctx->subs_alc)
+    {
+      struct demangle_component **subs;
+
+      subs = ((struct demangle_component **)
+	      realloc (ctx->subs, di.num_subs * sizeof (*subs)));
+      if (subs == NULL)
+	return -1;
+      ctx->subs = subs;
+      ctx->subs_alc = di.num_subs;
+    }
+  di.comps = ctx->comps;
+  di.subs = ctx->subs;
+
+  dc = d_demangle_parse (&di, type, options);
+
+  /* See discussion in d_unresolved_name.  */
+  if (dc == NULL && di.unresolved_name_state == -1)
+    {
+      di.unresolved_name_state = 0;
+      goto again;
+    }
+
+  if (dc == NULL)
+    return 0;
+  return cplus_demangle_print_callback (options, dc, callback, opaque);
+}
+
+/* Return a new context for cplus_demangle_v3_context, or NULL if
+   memory could not be allocated.  */
+
+struct demangle_context *
+cplus_demangle_context_new (void)
+{
+  struct demangle_context *ctx;
+
+  ctx = (struct demangle_context *) malloc (sizeof *ctx);
+  if (ctx != NULL)
+    memset (ctx, 0, sizeof *ctx);
+  return ctx;
+}
+
+/* Free CTX and everything it holds, including the strings returned by
+   cplus_demangle_v3_context.  */
+
+void
+cplus_demangle_context_free (struct demangle_context *ctx)
+{
+  int i;
+
+  if (ctx == NULL)
+    return;
+  for (i = 0; i < D_MEMO_SIZE; ++i)
+    {
+      free (ctx->memo[i].mangled);
+      free (ctx->memo[i].result.buf);
+    }
+  free (ctx->comps);
+  free (ctx->subs);
+  free (ctx);
+}
+
+/* Like cplus_demangle_v3, but use the scratch storage in CTX.  The
+   result belongs to CTX, and is valid until the next call with CTX.
+   Return NULL if MANGLED can not be demangled or on a memory
+   allocation failure.  */
+
+const char *
+cplus_demangle_v3_context (struct demangle_context *ctx,
+			   const char *mangled, int options)
+{
+  enum d_string_kind type;
+  size_t len;
+  unsigned int hash;
+  struct d_memo_entry *e;
+  int status;
+
+  type = d_string_kind (mangled, options);
+  if (type == DCT_NONE)
+    return NULL;
+
+  len = strlen (mangled);
+  hash = d_memo_hash (mangled, len, options);
+  e = &ctx->memo[hash % D_MEMO_SIZE];
+  if (e->mangled != NULL
+      && e->mangled_len == len
+      && e->options == options
+      && memcmp (e->mangled, mangled, len) == 0)
+    return e->failed ? NULL : e->result.buf;
+
+  if (len + 1 > e->mangled_alc)
+    {
+      char *p;
+
+      p = (char *) realloc (e->mangled, len + 1);
+      if (p == NULL)
+	return NULL;
+      e->mangled = p;
+      e->mangled_alc = len + 1;
+    }
+  memcpy (e->mangled, mangled, len + 1);
+  e->mangled_len = len;
+  e->options = options;
+  e->result.len = 0;
+  if (e->result.buf != NULL)
+    e->result.buf[0] = '\0';
+
+  status = d_demangle_context_callback (ctx, mangled, len, type, options,
+					d_growable_string_callback_adapter,
+					&e->result);
+  if (status < 0 || e->result.allocation_failure)
+    {
+      /* Do not remember allocation failures.  */
+      free (e->mangled);
+      e->mangled = NULL;
+      e->mangled_alc = 0;
+      e->result.allocation_failure = 0;
+      return NULL;
+    }
+
+  e->failed = status == 0;
+  return e->failed ? NULL : e->result.buf;
+}
+
+/* Demangle the COUNT names in MANGLED with OPTIONS using CTX, calling
+   CALLBACK with the index of each name and its demangled form, or NULL
+   if it can not be demangled.  The demangled string is only valid
+   during the call.  If CALLBACK returns non-zero, stop and return that
+   value; otherwise return 0.  */
+
+int
+cplus_demangle_v3_batch (struct demangle_context *ctx,
+			 const char *const *mangled, size_t count,
+			 int options, demangle_batch_callbackref callback,
+			 void *opaque)
+{
+  size_t i;
+  int ret;
+
+  for (i = 0; i < count; ++i)
+    {
+      ret = callback (i, cplus_demangle_v3_context (ctx, mangled[i],
+						    options),
+		      opaque);
+      if (ret != 0)
+	return ret;
+    }
+  return 0;
+}
+
 /* Demangle a Java symbol.  Java uses a subset of the V3 ABI C++ mangling 
    conventions, but the output formatting is a little different.
    This instructs the C++ demangler not to emit pointer characters ("*"), to
@@ -0,0 +1,240 @@
+/* Demangler throughput benchmark.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GNU libiberty.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Read the words starting with "_Z" from the named files, or from
+   standard input, and time demangling all of them with
+   cplus_demangle_v3, with cplus_demangle_v3_context and with
+   cplus_demangle_v3_batch.  The output of nm and the demangler's
+   expected-results files both work as input.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "demangle.h"
+
+#define OPTIONS (DMGL_PARAMS | DMGL_ANSI)
+
+static char *program_name;
+
+static char **names;
+static size_t names_count;
+static size_t names_alc;
+
+/* The total length of the demangled names, so that the work can not
+   be optimized away and the three ways can be compared.  */
+static size_t batch_total;
+
+static void
+print_usage (FILE *fp, int exit_value)
+{
+  fprintf (fp, "Usage: %s [OPTION]... [FILE]...\n", program_name);
+  fprintf (fp, "Options:\n");
+  fprintf (fp, "  -h           Display this message.\n");
+  fprintf (fp, "  -n COUNT     Demangle the names COUNT times (default 20).\n");
+  exit (exit_value);
+}
+
+static void
+add_name (const char *word, size_t len)
+{
+  if (names_count == names_alc)
+    {
+      names_alc = names_alc ? 2 * names_alc : 1024;
+      names = (char **) realloc (names, names_alc * sizeof (char *));
+      if (names == NULL)
+	abort ();
+    }
+  names[names_count] = (char *) malloc (len + 1);
+  if (names[names_count] == NULL)
+    abort ();
+  memcpy (names[names_count], word, len);
+  names[names_count][len] = '\0';
+  names_count++;
+}
+
+static void
+read_names (FILE *fp)
+{
+  char word[4096];
+  size_t len = 0;
+  int c;
+
+  do
+    {
+      c = getc (fp);
+      if (c == EOF || c == ' ' || c == '\t' || c == '\n' || c == '\r')
+	{
+	  if (len > 2 && word[0] == '_' && word[1] == 'Z')
+	    add_name (word, len);
+	  len = 0;
+	}
+      else if (len < sizeof word)
+	word[len++] = c;
+    }
+  while (c != EOF);
+}
+
+static double
+now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int
+batch_callback (size_t index, const char *demangled, void *opaque)
+{
+  (void) index;
+  (void) opaque;
+  if (demangled != NULL)
+    batch_total += strlen (demangled);
+  return 0;
+}
+
+static void
+report (const char *what, size_t count, int iterations, double secs,
+	size_t total)
+{
+  printf ("%-28s %10.3fs %12.0f names/s  (%lu bytes)\n", what, secs,
+	  (double) count * iterations / secs, (unsigned long) total);
+}
+
+int
+main (int argc, char *argv[])
+{
+  struct demangle_context *ctx;
+  int iterations = 20;
+  size_t plain_total = 0;
+  size_t context_total = 0;
+  size_t failures = 0;
+  double start;
+  size_t i;
+  int it;
+  int opt;
+
+  program_name = argv[0];
+  while ((opt = getopt (argc, argv, "hn:")) != -1)
+    {
+      switch (opt)
+	{
+	case 'n':
+	  iterations = atoi (optarg);
+	  if (iterations <= 0)
+	    print_usage (stderr, 1);
+	  break;
+
+	case 'h':
+	  print_usage (stdout, 0);
+
+	default:
+	  print_usage (stderr, 1);
+	}
+    }
+
+  if (optind == argc)
+    read_names (stdin);
+  for (; optind < argc; optind++)
+    {
+      FILE *fp = fopen (argv[optind], "r");
+
+      if (fp == NULL)
+	{
+	  perror (argv[optind]);
+	  return 1;
+	}
+      read_names (fp);
+      fclose (fp);
+    }
+
+  if (names_count == 0)
+    {
+      fprintf (stderr, "%s: no mangled names found\n", program_name);
+      return 1;
+    }
+
+  ctx = cplus_demangle_context_new ();
+  if (ctx == NULL)
+    abort ();
+
+  /* Check that the entry points agree before timing them.  */
+  for (i = 0; i < names_count; i++)
+    {
+      char *expect = cplus_demangle_v3 (names[i], OPTIONS);
+      const char *result = cplus_demangle_v3_context (ctx, names[i],
+						      OPTIONS);
+
+      if (result == NULL
+	  ? expect != NULL
+	  : expect == NULL || strcmp (result, expect) != 0)
+	{
+	  fprintf (stderr, "mismatch for %s\n", names[i]);
+	  failures++;
+	}
+      free (expect);
+    }
+
+  start = now ();
+  for (it = 0; it < iterations; it++)
+    for (i = 0; i < names_count; i++)
+      {
+	char *s = cplus_demangle_v3 (names[i], OPTIONS);
+
+	if (s != NULL)
+	  {
+	    plain_total += strlen (s);
+	    free (s);
+	  }
+      }
+  report ("cplus_demangle_v3", names_count, iterations, now () - start,
+	  plain_total);
+
+  start = now ();
+  for (it = 0; it < iterations; it++)
+    for (i = 0; i < names_count; i++)
+      {
+	const char *s = cplus_demangle_v3_context (ctx, names[i], OPTIONS);
+
+	if (s != NULL)
+	  context_total += strlen (s);
+      }
+  report ("cplus_demangle_v3_context", names_count, iterations,
+	  now () - start, context_total);
+
+  start = now ();
+  for (it = 0; it < iterations; it++)
+    cplus_demangle_v3_batch (ctx, (const char *const *) names, names_count,
+			     OPTIONS, batch_callback, NULL);
+  report ("cplus_demangle_v3_batch", names_count, iterations,
+	  now () - start, batch_total);
+
+  printf ("%lu names, %d iterations, %lu mismatches\n",
+	  (unsigned long) names_count, iterations, (unsigned long) failures);
+
+  cplus_demangle_context_free (ctx);
+  for (i = 0; i < names_count; i++)
+    free (names[i]);
+  free (names);
+
+  return failures != 0 || plain_total != context_total
+	 || plain_total != batch_total;
+}
@@ -149,6 +149,28 @@ exp: %s\n",
 	  lineno, opts, in, out != NULL ? out : "(null)", exp);
 }
 
+/* Check that demangling IN with OPTIONS through CTX gives the same
+   result as cplus_demangle_v3.  Return 1 if it does.  */
+
+static int
+check_context (struct demangle_context *ctx, const char *opts,
+	       const char *in, int options)
+{
+  char *expect;
+  const char *result;
+  int ok;
+
+  expect = cplus_demangle_v3 (in, options);
+  result = cplus_demangle_v3_context (ctx, in, options);
+  ok = (result == NULL
+	? expect == NULL
+	: expect != NULL && strcmp (result, expect) == 0);
+  if (!ok)
+    fail (lineno, opts, in, result, expect != NULL ? expect : "(null)");
+  free (expect);
+  return ok;
+}
+
 /* The tester operates on a data file consisting of groups of lines:
    options
    input to be demangled
@@ -183,6 +205,7 @@ main(argc, argv)
   struct line input;
   struct line expect;
   char *result;
+  struct demangle_context *ctx;
   int failures = 0;
   int tests = 0;
 
@@ -195,6 +218,7 @@ main(argc, argv)
   format.data = 0;
   input.data = 0;
   expect.data = 0;
+  ctx = cplus_demangle_context_new ();
 
   for (;;)
     {
@@ -327,6 +351,19 @@ main(argc, argv)
 	}
       free (result);
 
+      /* The context entry point must agree with the plain one, whether
+	 or not the result is remembered.  */
+      if (style == auto_demangling || style == gnu_v3_demangling)
+	{
+	  int options = (DMGL_PARAMS | DMGL_ANSI | DMGL_TYPES
+			 | (ret_postfix ? DMGL_RET_POSTFIX : 0)
+			 | (ret_drop ? DMGL_RET_DROP : 0));
+
+	  if (!check_context (ctx, format.data, inp, options)
+	      || !check_context (ctx, format.data, inp, options))
+	    failures++;
+	}
+
       if (no_params)
 	{
 	  get_line (&expect);
@@ -346,6 +383,7 @@ main(argc, argv)
   free (format.data);
   free (input.data);
   free (expect.data);
+  cplus_demangle_context_free (ctx);
 
   printf ("%s: %d tests, %d failures\n", argv[0], tests, failures);
   return failures ? 1 : 0;
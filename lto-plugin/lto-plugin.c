@@ -121,6 +121,15 @@ struct plugin_symtab
   unsigned long long id;
 };
 
+/* A symbol table extension section found during symbol scan, to be
+   parsed once all the symbol tables have been.  */
+struct plugin_section
+{
+  off_t offset;
+  off_t length;
+  unsigned long long id;
+};
+
 /* Encapsulates object file data during symbol scan.  */
 struct plugin_objfile
 {
@@ -129,6 +138,8 @@ struct plugin_objfile
   simple_object_read *objfile;
   struct plugin_symtab *out;
   const struct ld_plugin_input_file *file;
+  struct plugin_section *ext_sections;
+  unsigned int num_ext_sections;
 };
 
 /* All that we have to remember about a file. */
@@ -190,6 +201,9 @@ static struct plugin_file_info *claimed_files = NULL;
 static unsigned int num_claimed_files = 0;
 static unsigned int non_claimed_files = 0;
 
+/* With -v, the run time spent in claim_file_handler, in microseconds.  */
+static long claim_file_time;
+
 /* List of files with offloading.  */
 static struct plugin_offload_file *offload_files;
 /* Last file in the list.  */
@@ -764,6 +778,22 @@ use_original_files (void)
 }
 
 
+/* Report with -v where the time up to all_symbols_read went.  */
+
+static void
+report_claim_time (void)
+{
+  unsigned int i, nsyms = 0;
+
+  for (i = 0; i < num_claimed_files; i++)
+    nsyms += claimed_files[i].symtab.nsyms;
+
+  fprintf (stderr, "lto-plugin: claimed %u of %u files with %u symbols in "
+	   "%.3fs of the %.3fs run time of the linker so far\n",
+	   num_claimed_files, num_claimed_files + non_claimed_files, nsyms,
+	   claim_file_time / 1e6, get_run_time () / 1e6);
+}
+
 /* Called by the linker once all symbols have been read. */
 
 static enum ld_plugin_status
@@ -776,6 +806,10 @@ all_symbols_read_handler (void)
   char **lto_argv;
   const char *linker_output_str = NULL;
   const char **lto_arg_ptr;
+
+  if (verbose)
+    report_claim_time ();
+
   if (num_claimed_files + num_offload_files == 0)
     return LDPS_OK;
 
@@ -1072,21 +1106,15 @@ resolve_conflicts (struct plugin_symtab *t, struct plugin_symtab *conflicts)
   htab_delete (symtab);
 }
 
-/* Process one section of an object file.  */
+/* Read the LENGTH bytes at OFFSET in the object file of OBJ.  Returns
+   the data, which the caller must free, or NULL after reporting the
+   file as corrupt.  */
 
-static int 
-process_symtab (void *data, const char *name, off_t offset, off_t length)
+static char *
+read_section (struct plugin_objfile *obj, off_t offset, off_t length)
 {
-  struct plugin_objfile *obj = (struct plugin_objfile *)data;
-  char *s;
   char *secdatastart, *secdata;
 
-  if (!startswith (name, ".gnu.lto_.symtab"))
-    return 1;
-
-  s = strrchr (name, '.');
-  if (s)
-    sscanf (s, ".%" PRI_LL "x", &obj->out->id);
   secdata = secdatastart = xmalloc (length);
   offset += obj->file->offset;
   if (offset != lseek (obj->file->fd, offset, SEEK_SET))
@@ -1109,85 +1137,100 @@ process_symtab (void *data, const char *name, off_t offset, off_t length)
   if (length > 0)
     goto err;
 
-  translate (secdatastart, secdata, obj->out);
-  obj->found++;
-  free (secdatastart);
-  return 1;
+  return secdatastart;
 
 err:
   if (message)
     message (LDPL_FATAL, "%s: corrupt object file", obj->file->name);
-  /* Force claim_file_handler to abandon this file.  */
-  obj->found = 0;
   free (secdatastart);
-  return 0;
+  return NULL;
 }
 
-/* Process one section of an object file.  */
+/* Process one symbol table section of an object file.  */
 
 static int
-process_symtab_extension (void *data, const char *name, off_t offset,
-			  off_t length)
+process_symtab (struct plugin_objfile *obj, const char *name, off_t offset,
+		off_t length)
 {
-  struct plugin_objfile *obj = (struct plugin_objfile *)data;
   char *s;
-  char *secdatastart, *secdata;
-
-  if (!startswith (name, ".gnu.lto_.ext_symtab"))
-    return 1;
+  char *secdata;
 
   s = strrchr (name, '.');
   if (s)
     sscanf (s, ".%" PRI_LL "x", &obj->out->id);
-  secdata = secdatastart = xmalloc (length);
-  offset += obj->file->offset;
-  if (offset != lseek (obj->file->fd, offset, SEEK_SET))
-    goto err;
-
-  do
+  secdata = read_section (obj, offset, length);
+  if (!secdata)
     {
-      ssize_t got = read (obj->file->fd, secdata, length);
-      if (got == 0)
-	break;
-      else if (got > 0)
-	{
-	  secdata += got;
-	  length -= got;
-	}
-      else if (errno != EINTR)
-	goto err;
+      /* Force claim_file_handler to abandon this file.  */
+      obj->found = 0;
+      return 0;
     }
-  while (length > 0);
-  if (length > 0)
-    goto err;
 
-  parse_symtab_extension (secdatastart, secdata, obj->out);
+  translate (secdata, secdata + length, obj->out);
   obj->found++;
-  free (secdatastart);
+  free (secdata);
   return 1;
-
-err:
-  if (message)
-    message (LDPL_FATAL, "%s: corrupt object file", obj->file->name);
-  /* Force claim_file_handler to abandon this file.  */
-  obj->found = 0;
-  free (secdatastart);
-  return 0;
 }
 
-
-/* Find an offload section of an object file.  */
+/* Process one symbol table extension section SEC of an object file.  */
 
 static int
-process_offload_section (void *data, const char *name, off_t offset, off_t len)
+process_symtab_extension (struct plugin_objfile *obj,
+			  const struct plugin_section *sec)
 {
-  if (startswith (name, ".gnu.offload_lto_.opts"))
+  char *secdata;
+
+  obj->out->id = sec->id;
+  secdata = read_section (obj, sec->offset, sec->length);
+  if (!secdata)
     {
-      struct plugin_objfile *obj = (struct plugin_objfile *) data;
-      obj->offload = true;
+      /* Force claim_file_handler to abandon this file.  */
+      obj->found = 0;
       return 0;
     }
 
+  parse_symtab_extension (secdata, secdata + sec->length, obj->out);
+  obj->found++;
+  free (secdata);
+  return 1;
+}
+
+/* Process one section of an object file.  The symbol tables are
+   processed right away, the extensions are recorded to be processed
+   after all of them, and the presence of offload data is noted, so
+   that the section headers only need to be walked once.  */
+
+static int
+process_section (void *data, const char *name, off_t offset, off_t length)
+{
+  struct plugin_objfile *obj = (struct plugin_objfile *)data;
+
+  if (startswith (name, ".gnu.lto_.symtab"))
+    return process_symtab (obj, name, offset, length);
+
+  /*  Parsing symtab extension should be done only for add_symbols_v2 and
+      later versions.  */
+  if (add_symbols_v2 != NULL && startswith (name, ".gnu.lto_.ext_symtab"))
+    {
+      struct plugin_section *sec;
+      char *s;
+
+      obj->ext_sections
+	= xrealloc (obj->ext_sections, (obj->num_ext_sections + 1)
+					* sizeof (struct plugin_section));
+      sec = &obj->ext_sections[obj->num_ext_sections++];
+      sec->offset = offset;
+      sec->length = length;
+      sec->id = obj->out->id;
+      s = strrchr (name, '.');
+      if (s)
+	sscanf (s, ".%" PRI_LL "x", &sec->id);
+      return 1;
+    }
+
+  if (startswith (name, ".gnu.offload_lto_.opts"))
+    obj->offload = true;
+
   return 1;
 }
 
@@ -1207,6 +1250,10 @@ claim_file_handler_v2 (const struct ld_plugin_input_file *file, int *claimed,
   struct plugin_file_info lto_file;
   int err;
   const char *errmsg;
+  long start_time = 0;
+
+  if (verbose)
+    start_time = get_run_time ();
 
   memset (&lto_file, 0, sizeof (struct plugin_file_info));
 
@@ -1234,6 +1281,8 @@ claim_file_handler_v2 (const struct ld_plugin_input_file *file, int *claimed,
   obj.found = 0;
   obj.offload = false;
   obj.out = &lto_file.symtab;
+  obj.ext_sections = NULL;
+  obj.num_ext_sections = 0;
   errmsg = NULL;
   obj.objfile = simple_object_start_read (file->fd, file->offset, LTO_SEGMENT_NAME,
 			&errmsg, &err);
@@ -1243,16 +1292,16 @@ claim_file_handler_v2 (const struct ld_plugin_input_file *file, int *claimed,
 
    if (obj.objfile)
     {
-      errmsg = simple_object_find_sections (obj.objfile, process_symtab, &obj,
-					    &err);
-      /*  Parsing symtab extension should be done only for add_symbols_v2 and
-	  later versions.  */
-      if (!errmsg && add_symbols_v2 != NULL)
+      errmsg = simple_object_find_sections (obj.objfile, process_section,
+					    &obj, &err);
+      if (!errmsg && obj.found > 0)
 	{
+	  unsigned int i;
+
 	  obj.out->last_sym = 0;
-	  errmsg = simple_object_find_sections (obj.objfile,
-						process_symtab_extension,
-						&obj, &err);
+	  for (i = 0; i < obj.num_ext_sections; i++)
+	    if (!process_symtab_extension (&obj, &obj.ext_sections[i]))
+	      break;
 	}
     }
 
@@ -1266,10 +1315,6 @@ claim_file_handler_v2 (const struct ld_plugin_input_file *file, int *claimed,
       goto err;
     }
 
-  if (obj.objfile)
-    simple_object_find_sections (obj.objfile, process_offload_section,
-				 &obj, &err);
-
   if (obj.found == 0 && !obj.offload)
     goto err;
 
@@ -1374,6 +1419,15 @@ claim_file_handler_v2 (const struct ld_plugin_input_file *file, int *claimed,
  cleanup:
   if (obj.objfile)
     simple_object_release_read (obj.objfile);
+  free (obj.ext_sections);
+
+  if (verbose)
+    {
+      long elapsed = get_run_time () - start_time;
+      LOCK_SECTION;
+      claim_file_time += elapsed;
+      UNLOCK_SECTION;
+    }
 
   return LDPS_OK;
 }